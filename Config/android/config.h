@@ -162,6 +162,23 @@
 /* Define to 1 if you have the <sys/statfs.h> header file. */
 #define HAVE_SYS_STATFS_H 1
 
+/* Define to 1 if you have the <sys/inotify.h> header file. */
+#define HAVE_SYS_INOTIFY_H 1
+
+/* Define to 1 if you have the <sys/epoll.h> header file. */
+#define HAVE_SYS_EPOLL_H 1
+
+/* Define to 1 if you have the <sys/eventfd.h> header file. */
+#define HAVE_SYS_EVENTFD_H 1
+
+/* Define to 1 if you have the <sys/timerfd.h> header file. */
+#define HAVE_SYS_TIMERFD_H 1
+
+/* Define to 1 if you have the `statx' function (bionic from API level 30). */
+#if defined(__ANDROID_API__) && (__ANDROID_API__ >= 30)
+#  define HAVE_STATX 1
+#endif
+
 /* Define to 1 if you have the <sys/mount.h> header file. */
 #define HAVE_SYS_MOUNT_H 1
 
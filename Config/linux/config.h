@@ -97,6 +97,11 @@
 /* Define to 1 if you have the <inttypes.h> header file. */
 #define HAVE_INTTYPES_H 1
 
+/* Define to 1 if you have the <linux/io_uring.h> header file. */
+#ifdef __linux__
+#  define HAVE_LINUX_IO_URING_H 1
+#endif
+
 /* Whether the libm on the host has the log2 function */
 #define HAVE_LOG2 1
 
@@ -182,6 +187,31 @@
 #  define HAVE_SYS_STATFS_H 1
 #endif
 
+/* Define to 1 if you have the <sys/inotify.h> header file. */
+#ifdef __linux__
+#  define HAVE_SYS_INOTIFY_H 1
+#endif
+
+/* Define to 1 if you have the <sys/epoll.h> header file. */
+#ifdef __linux__
+#  define HAVE_SYS_EPOLL_H 1
+#endif
+
+/* Define to 1 if you have the <sys/eventfd.h> header file. */
+#ifdef __linux__
+#  define HAVE_SYS_EVENTFD_H 1
+#endif
+
+/* Define to 1 if you have the <sys/timerfd.h> header file. */
+#ifdef __linux__
+#  define HAVE_SYS_TIMERFD_H 1
+#endif
+
+/* Define to 1 if you have the `statx' function. */
+#ifdef __linux__
+#  define HAVE_STATX 1
+#endif
+
 /* Define to 1 if you have the <sys/mount.h> header file. */
 #define HAVE_SYS_MOUNT_H 1
 
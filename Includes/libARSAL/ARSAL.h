@@ -39,11 +39,21 @@
 
 #include <libARSAL/ARSAL_Endianness.h>
 #include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_DirIter.h>
+#include <libARSAL/ARSAL_PathFilter.h>
+#include <libARSAL/ARSAL_Snapshot.h>
+#include <libARSAL/ARSAL_Watcher.h>
 #include <libARSAL/ARSAL_Mutex.h>
 #include <libARSAL/ARSAL_Print.h>
 #include <libARSAL/ARSAL_Sem.h>
+#include <libARSAL/ARSAL_Future.h>
 #include <libARSAL/ARSAL_Socket.h>
+#include <libARSAL/ARSAL_EventLoop.h>
 #include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_ThreadPool.h>
+#include <libARSAL/ARSAL_Scheduler.h>
+#include <libARSAL/ARSAL_Parallel.h>
 #include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_Timer.h>
 
 #endif /* _ARSAL_H_ */
@@ -0,0 +1,130 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_DirIter.h
+ * @brief libARSAL pull based directory hierarchy iterator.
+ **/
+
+#ifndef _ARSAL_DIRITER_H_
+#define _ARSAL_DIRITER_H_
+
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_PathFilter.h>
+
+/**
+ * @brief Default maximum number of directories kept open by an iterator
+ * @see ARSAL_DirIter_New ()
+ */
+#define ARSAL_DIRITER_DEFAULT_MAX_OPEN_DIRS  (32)
+
+/**
+ * @brief Directory hierarchy iterator
+ * @see ARSAL_DirIter_New ()
+ */
+typedef struct _ARSAL_DirIter_t ARSAL_DirIter_t;
+
+/**
+ * @brief Entry returned by ARSAL_DirIter_Next ()
+ * @note The entry and its path are only valid until the next call on the iterator
+ */
+typedef struct
+{
+    const char *path; /**< The path of the entry, the directory given to ARSAL_DirIter_New () followed by the names of the entry and its parents */
+    struct stat sb; /**< The metadata of the entry, the fields out of the stat mask of the iterator are zeroed, all of them for ARSAL_FTW_NS */
+    eARSAL_FTW_TYPE type; /**< ARSAL_FTW_D for a directory, ARSAL_FTW_DNR for a directory which cannot be opened and is not descended, ARSAL_FTW_NS for an entry which cannot be stated, ARSAL_FTW_F otherwise */
+    int base; /**< The offset of the entry name in the path */
+    int level; /**< The depth of the entry, 0 for the directory given to ARSAL_DirIter_New () */
+} ARSAL_DirIter_Entry_t;
+
+/**
+ * @brief Create an iterator over a directory hierarchy
+ * @note The entries are returned in the order of ARSAL_Nftw (): a directory, then its entries, before its next sibling. Symbolic links are not followed.
+ * @note The iterator holds an open stream and the path of each directory between the root and the current entry: its memory does not grow with the number of entries.
+ * When the hierarchy is deeper than maxOpenDirs, the entries left to walk in the shallowest open directory are read in memory to close its stream.
+ * @param dirPath The directory to walk, or a single file
+ * @param maxOpenDirs The maximum number of directories kept open at a time, 0 for ARSAL_DIRITER_DEFAULT_MAX_OPEN_DIRS
+ * @param statMask The metadata read from the entries, a combination of eARSAL_FTW_STAT_MASK
+ * @param[out] error The error code
+ * @return The iterator, or NULL on error
+ * @see ARSAL_DirIter_Delete (), ARSAL_DirIter_Next ()
+ */
+ARSAL_DirIter_t* ARSAL_DirIter_New(const char *dirPath, int maxOpenDirs, int statMask, eARSAL_ERROR *error);
+
+/**
+ * @brief Delete an iterator, closing the directories left open
+ * @param iterAddr The address of the pointer on the iterator, set to NULL
+ * @see ARSAL_DirIter_New ()
+ */
+void ARSAL_DirIter_Delete(ARSAL_DirIter_t **iterAddr);
+
+/**
+ * @brief Get the next entry of the hierarchy
+ * @note The iterator only reads the hierarchy during this call: a walk is paused by not calling it, and may be resumed from any thread, one call at a time.
+ * @note As with nftw, an entry which cannot be stated is returned as ARSAL_FTW_NS, a directory which cannot be opened as ARSAL_FTW_DNR, and the walk goes on. Filtered walks skip them.
+ * @param iter The iterator
+ * @param[out] error The error code: ARSAL_OK at the end of the walk, ARSAL_ERROR_FILE if the directory given to ARSAL_DirIter_New () could not be stated
+ * @return The entry, or NULL at the end of the walk or on error
+ * @see ARSAL_DirIter_SkipSubtree ()
+ */
+const ARSAL_DirIter_Entry_t* ARSAL_DirIter_Next(ARSAL_DirIter_t *iter, eARSAL_ERROR *error);
+
+/**
+ * @brief Do not descend into the directory last returned by ARSAL_DirIter_Next ()
+ * @note Does nothing if the last entry is not a directory
+ * @param iter The iterator
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_DirIter_SkipSubtree(ARSAL_DirIter_t *iter);
+
+/**
+ * @brief Only return the files matching a filter
+ * @note The names and paths are checked before the entries are stated, the directories which cannot hold matching files are neither stated nor opened.
+ * The directories are not returned, so ARSAL_DirIter_SkipSubtree () has no effect.
+ * @param iter The iterator, before its first ARSAL_DirIter_Next ()
+ * @param filter The filter, NULL to return all the entries. It must be kept until the iterator is deleted.
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the walk already started
+ * @see ARSAL_PathFilter_New ()
+ */
+eARSAL_ERROR ARSAL_DirIter_SetFilter(ARSAL_DirIter_t *iter, const ARSAL_PathFilter_t *filter);
+
+/**
+ * @brief Return the entries of each directory sorted by name
+ * @note The entries of a directory are read and sorted when the walk enters it, then returned depth first, a directory being followed by its own entries.
+ * The names are compared with strcmp, so the walk is the same on any file system. Only the remaining entries of the directories of the current path are kept in memory.
+ * @param iter The iterator, before its first ARSAL_DirIter_Next ()
+ * @param sorted 1 to sort the entries, 0 to return them in the order of the file system
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the walk already started
+ */
+eARSAL_ERROR ARSAL_DirIter_SetSorted(ARSAL_DirIter_t *iter, int sorted);
+
+#endif /* _ARSAL_DIRITER_H_ */
@@ -43,6 +43,8 @@ typedef enum
     ARSAL_ERROR_SYSTEM,                        /**< ARSAL system error */
     ARSAL_ERROR_BAD_PARAMETER,                 /**< ARSAL bad parameter error */
     ARSAL_ERROR_FILE,                          /**< ARSAL file error */
+    ARSAL_ERROR_CANCELED,                      /**< ARSAL operation canceled */
+    ARSAL_ERROR_TIMEOUT,                       /**< ARSAL operation timed out */
     
     ARSAL_ERROR_MD5 = -2000,                   /**< ARSAL md5 error */
 
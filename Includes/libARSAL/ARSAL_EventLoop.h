@@ -0,0 +1,203 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_EventLoop.h
+ * @brief libARSAL event loop: file descriptor readiness, timers and cross-thread wakeups multiplexed on one thread.
+ **/
+
+#ifndef _ARSAL_EVENTLOOP_H_
+#define _ARSAL_EVENTLOOP_H_
+
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Error.h>
+
+/**
+ * @brief Identifier never given to a timer
+ */
+#define ARSAL_EVENTLOOP_INVALID_TIMER_ID    (0)
+
+/**
+ * @brief Event loop
+ * @see ARSAL_EventLoop_New ()
+ */
+typedef struct _ARSAL_EventLoop_t ARSAL_EventLoop_t;
+
+/**
+ * @brief Identifier of a timer of an event loop, stays invalid once a one-shot timer is fired or the timer is removed
+ * @see ARSAL_EventLoop_AddTimer ()
+ */
+typedef uint64_t ARSAL_EventLoop_TimerId_t;
+
+/**
+ * @brief Events of a file descriptor, combined as a bit field
+ */
+typedef enum
+{
+    ARSAL_EVENTLOOP_EVENT_READ = 1 << 0,    /**< Readable, or a connection to accept */
+    ARSAL_EVENTLOOP_EVENT_WRITE = 1 << 1,   /**< Writable, or a connection established */
+    ARSAL_EVENTLOOP_EVENT_ERROR = 1 << 2,   /**< Error pending, always reported */
+    ARSAL_EVENTLOOP_EVENT_HANGUP = 1 << 3,  /**< Closed by the peer, always reported */
+} eARSAL_EVENTLOOP_EVENT;
+
+/**
+ * @brief Triggering of the callback of a file descriptor
+ */
+typedef enum
+{
+    ARSAL_EVENTLOOP_MODE_LEVEL = 0, /**< Called as long as the file descriptor is ready */
+    ARSAL_EVENTLOOP_MODE_EDGE,      /**< Called when the file descriptor becomes ready, the callback must read or write until EAGAIN */
+} eARSAL_EVENTLOOP_MODE;
+
+/**
+ * @brief Callback of a file descriptor
+ * @param loop The event loop
+ * @param fd The file descriptor
+ * @param events The events of the file descriptor, a combination of eARSAL_EVENTLOOP_EVENT
+ * @param customData The custom data given to ARSAL_EventLoop_AddFd ()
+ */
+typedef void (*ARSAL_EventLoop_FdCallback_t) (ARSAL_EventLoop_t *loop, int fd, uint32_t events, void *customData);
+
+/**
+ * @brief Callback of a timer, or of a function posted to the loop
+ * @param loop The event loop
+ * @param customData The custom data given to ARSAL_EventLoop_AddTimer () or ARSAL_EventLoop_Post ()
+ */
+typedef void (*ARSAL_EventLoop_Callback_t) (ARSAL_EventLoop_t *loop, void *customData);
+
+/**
+ * @brief Create an event loop
+ * @note Based on epoll, with a timerfd per timer and an eventfd for the wakeups. Where they are not available, based on poll, with a pipe for the wakeups.
+ * @note Only ARSAL_EventLoop_Post (), ARSAL_EventLoop_Wakeup () and ARSAL_EventLoop_Stop () may be called from another thread than the one running the loop.
+ * @param[out] error Pointer on the error output
+ * @return Pointer on the new event loop, or NULL on error
+ * @see ARSAL_EventLoop_Delete ()
+ */
+ARSAL_EventLoop_t* ARSAL_EventLoop_New(eARSAL_ERROR *error);
+
+/**
+ * @brief Delete an event loop
+ * @note The file descriptors added are not closed, the functions posted and not run yet are dropped
+ * @param loopAddr Address of the pointer on the event loop, set to NULL
+ */
+void ARSAL_EventLoop_Delete(ARSAL_EventLoop_t **loopAddr);
+
+/**
+ * @brief Watch a file descriptor
+ * @note With poll, the edge mode is run as the level mode: a callback reading or writing until EAGAIN works the same.
+ * @param loop The event loop
+ * @param fd The file descriptor, preferably non-blocking
+ * @param events The events to watch, a combination of ARSAL_EVENTLOOP_EVENT_READ and ARSAL_EVENTLOOP_EVENT_WRITE
+ * @param mode The triggering of the callback
+ * @param callback The callback
+ * @param customData The custom data given to the callback
+ * @return ARSAL_OK, ARSAL_ERROR_BAD_PARAMETER if the file descriptor is already watched, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_AddFd(ARSAL_EventLoop_t *loop, int fd, uint32_t events, eARSAL_EVENTLOOP_MODE mode, ARSAL_EventLoop_FdCallback_t callback, void *customData);
+
+/**
+ * @brief Change the events watched on a file descriptor
+ * @param loop The event loop
+ * @param fd The file descriptor
+ * @param events The events to watch, 0 to pause the callback
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_ModifyFd(ARSAL_EventLoop_t *loop, int fd, uint32_t events);
+
+/**
+ * @brief Stop watching a file descriptor, to call before closing it
+ * @note Can be called from a callback, the pending events of the file descriptor are then dropped
+ * @param loop The event loop
+ * @param fd The file descriptor
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the file descriptor is not watched
+ */
+eARSAL_ERROR ARSAL_EventLoop_RemoveFd(ARSAL_EventLoop_t *loop, int fd);
+
+/**
+ * @brief Add a timer
+ * @note A periodic timer whose callback is late by whole periods is called once for them
+ * @param loop The event loop
+ * @param delayMs The delay before the first expiry, in milliseconds
+ * @param periodMs The period of the next expiries in milliseconds, 0 for a one-shot timer
+ * @param callback The callback
+ * @param customData The custom data given to the callback
+ * @param[out] id Pointer on the identifier of the timer, may be NULL
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_AddTimer(ARSAL_EventLoop_t *loop, uint32_t delayMs, uint32_t periodMs, ARSAL_EventLoop_Callback_t callback, void *customData, ARSAL_EventLoop_TimerId_t *id);
+
+/**
+ * @brief Remove a timer
+ * @param loop The event loop
+ * @param id The identifier of the timer
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the timer is unknown, already fired or removed
+ */
+eARSAL_ERROR ARSAL_EventLoop_RemoveTimer(ARSAL_EventLoop_t *loop, ARSAL_EventLoop_TimerId_t id);
+
+/**
+ * @brief Run a function on the thread of the loop, from any thread
+ * @note The functions are run in the order they are posted
+ * @param loop The event loop
+ * @param callback The function
+ * @param customData The custom data given to the function
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_Post(ARSAL_EventLoop_t *loop, ARSAL_EventLoop_Callback_t callback, void *customData);
+
+/**
+ * @brief Make the loop return from its current wait, from any thread
+ * @param loop The event loop
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_Wakeup(ARSAL_EventLoop_t *loop);
+
+/**
+ * @brief Wait for events once and call their callbacks
+ * @param loop The event loop
+ * @param timeoutMs The maximum time to wait in milliseconds, -1 to wait for an event, 0 to only check
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_RunOnce(ARSAL_EventLoop_t *loop, int timeoutMs);
+
+/**
+ * @brief Run the loop until ARSAL_EventLoop_Stop () is called
+ * @param loop The event loop
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_Run(ARSAL_EventLoop_t *loop);
+
+/**
+ * @brief Make ARSAL_EventLoop_Run () return, from any thread
+ * @param loop The event loop
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_EventLoop_Stop(ARSAL_EventLoop_t *loop);
+
+#endif /* _ARSAL_EVENTLOOP_H_ */
@@ -39,6 +39,9 @@
 #define _ARSAL_FTW_H_
 
 #include <sys/stat.h>
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_PathFilter.h>
 
  /**
  * @brief ARSAL_FTW_t structure equal to "struct FTW"
@@ -60,6 +63,8 @@ typedef enum
 {
     ARSAL_FTW_F = 0,
     ARSAL_FTW_D,
+    ARSAL_FTW_DNR, /**< Directory which cannot be read */
+    ARSAL_FTW_NS, /**< Entry which cannot be stated, sb is zeroed */
 } eARSAL_FTW_TYPE;
 
 /**
@@ -83,6 +88,36 @@ typedef enum
     ARSAL_FTW_SKIP_SUBTREE = 2,
 } eARSAL_FTW_RETURN;
 
+/**
+ * @brief ARSAL_Nftw_Parallel enum callback ordering
+ * @see ARSAL_Nftw_Parallel ()
+ */
+typedef enum
+{
+    ARSAL_FTW_ORDER_NONE = 0, /**< The callback is called from the worker threads as the entries are found, concurrently: it must be thread safe */
+    ARSAL_FTW_ORDER_SERIAL, /**< The callback is called from the worker threads as the entries are found, one call at a time */
+    ARSAL_FTW_ORDER_PREORDER, /**< The callback is called from the calling thread, in the order of ARSAL_Nftw (), while the workers read the tree ahead */
+} eARSAL_FTW_ORDER;
+
+/**
+ * @brief ARSAL_Ftw_WithStatMask and ARSAL_Nftw_WithStatMask metadata needed by the callback, to combine with a bitwise or
+ * @note The fields of the stat structure out of the mask are zeroed
+ * @see ARSAL_Ftw_WithStatMask (), ARSAL_Nftw_WithStatMask ()
+ */
+typedef enum
+{
+    ARSAL_FTW_STAT_TYPE = 0, /**< The file type bits of st_mode only, read from the directory entries without any stat call when the file system provides them */
+    ARSAL_FTW_STAT_SIZE = (1 << 0), /**< st_size, st_blocks and st_blksize */
+    ARSAL_FTW_STAT_TIMES = (1 << 1), /**< st_atime, st_mtime and st_ctime */
+    ARSAL_FTW_STAT_OWNER = (1 << 2), /**< The permission bits of st_mode, st_nlink, st_uid and st_gid */
+    ARSAL_FTW_STAT_ALL = 0xFF, /**< The whole stat structure, as ARSAL_Ftw () */
+} eARSAL_FTW_STAT_MASK;
+
+/**
+ * @brief Default number of threads of ARSAL_Nftw_Parallel ()
+ * @note Walking a tree is bound by the I/O latency rather than by the CPU, so it is not the number of CPUs
+ */
+#define ARSAL_FTW_PARALLEL_DEFAULT_THREADS  (8)
 
 /**
  * @brief User Callback called for each file discover in the directory hierarchy
@@ -109,7 +144,7 @@ typedef int (*ARSAL_NftwCallback) (const char *fpath, const struct stat *sb, eAR
  * @brief Recursively descends the directory hierarchy
  * @param dirpath The directory to descend
  * @param cb The callback recursively on each element of run through the directories
- * @param nopenfd The maximum number of directories depth
+ * @param nopenfd The maximum number of directories kept open at a time
  * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
  * @see ftw standard documentation
  */
@@ -119,13 +154,145 @@ int ARSAL_Ftw(const char *dirpath, ARSAL_FtwCallback cb, int nopenfd);
  * @brief Recursively descends the directory hierarchy
  * @param dirpath The directory to descend
  * @param cb The callback recursively on each element of run through the directories
- * @param nopenfd The maximum number of directories depth
+ * @param nopenfd The maximum number of directories kept open at a time
  * @param flags The flag of the type of tree explore
  * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
  * @see nftw standard documentation
  */
 int ARSAL_Nftw(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags);
 
+/**
+ * @brief Recursively descends the directory hierarchy, getting only the metadata the callback needs
+ * @note With ARSAL_FTW_STAT_TYPE, the entries are not stated at all, except on the file systems which do not report the type of the directory entries (DT_UNKNOWN). Otherwise they are stated with statx, asking for the fields of the mask only.
+ * @note Symbolic links are not followed, they are reported as ARSAL_FTW_F
+ * @param dirpath The directory to descend
+ * @param cb The callback recursively on each element of run through the directories
+ * @param nopenfd The maximum number of directories kept open at a time
+ * @param statMask The metadata read by the callback, a combination of eARSAL_FTW_STAT_MASK
+ * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
+ * @see ARSAL_Ftw (), eARSAL_FTW_STAT_MASK
+ */
+int ARSAL_Ftw_WithStatMask(const char *dirpath, ARSAL_FtwCallback cb, int nopenfd, int statMask);
+
+/**
+ * @brief Recursively descends the directory hierarchy, getting only the metadata the callback needs
+ * @note With ARSAL_FTW_STAT_TYPE, the entries are not stated at all, except on the file systems which do not report the type of the directory entries (DT_UNKNOWN). Otherwise they are stated with statx, asking for the fields of the mask only.
+ * @note Symbolic links are not followed, they are reported as ARSAL_FTW_F
+ * @param dirpath The directory to descend
+ * @param cb The callback recursively on each element of run through the directories
+ * @param nopenfd The maximum number of directories kept open at a time
+ * @param flags The flag of the type of tree explore
+ * @param statMask The metadata read by the callback, a combination of eARSAL_FTW_STAT_MASK
+ * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
+ * @see ARSAL_Nftw (), eARSAL_FTW_STAT_MASK
+ */
+int ARSAL_Nftw_WithStatMask(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags, int statMask);
+
+/**
+ * @brief Recursively descends the directory hierarchy, calling back on the files matching a filter only
+ * @note The names and paths are checked before the entries are stated, the directories which cannot hold matching files are neither stated nor opened.
+ * The directories are not given to the callback. Symbolic links are not followed, they are reported as ARSAL_FTW_F.
+ * @param dirpath The directory to descend
+ * @param cb The callback called on each matching file
+ * @param nopenfd The maximum number of directories kept open at a time
+ * @param flags The flag of the type of tree explore
+ * @param filter The filter
+ * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
+ * @see ARSAL_Nftw (), ARSAL_PathFilter_New ()
+ */
+int ARSAL_Nftw_Filtered(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags, const ARSAL_PathFilter_t *filter);
+
+/**
+ * @brief Recursively descends the directory hierarchy, calling back on the entries of each directory sorted by name
+ * @note The walk order only depends on the names, not on the file system, so that the output can be compared or hashed.
+ * A directory is called back before its entries, its entries being read and sorted once the callback returns. Only the entries of the directories of the current path are kept in memory.
+ * @param dirpath The directory to descend
+ * @param cb The callback recursively on each element of run through the directories
+ * @param nopenfd The maximum number of directories kept open at a time
+ * @param flags The flag of the type of tree explore
+ * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
+ * @see ARSAL_Nftw (), ARSAL_DirIter_SetSorted ()
+ */
+int ARSAL_Nftw_Sorted(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags);
+
+/**
+ * @brief Recursively descends the directory hierarchy, listing the subdirectories concurrently
+ * @note Each thread lists whole directories and steals the pending subdirectories of the others when it runs out of work
+ * @note The callback of a directory is always called before the ones of its entries. fpath, sb and ftwbuf are only valid during the call.
+ * @note With ARSAL_FTW_ACTIONRETVAL, ARSAL_FTW_SKIP_SUBTREE skips the entries of a directory and ARSAL_FTW_STOP stops the walk, as with ARSAL_Nftw ()
+ * @note When the walk is stopped, callbacks already running in other threads complete, no other callback is called
+ * @note Each directory is opened relatively to the one it was found in, without following symbolic links. A directory which cannot be opened is reported as ARSAL_FTW_DNR instead of ARSAL_FTW_D, an entry which cannot be stated as ARSAL_FTW_NS, and the walk goes on.
+ * @note With ARSAL_FTW_ORDER_PREORDER, the entries of each directory read ahead are kept in memory until they are called back, and the workers pause once 256 directories are read ahead: with a slow callback, the memory used is bound by these directories and by the ones of the current path, not by the size of the tree.
+ * @param dirpath The directory to descend
+ * @param cb The callback recursively on each element of run through the directories
+ * @param threadCount The number of threads listing directories, 0 for ARSAL_FTW_PARALLEL_DEFAULT_THREADS
+ * @param flags The flag of the type of tree explore
+ * @param order The ordering of the callbacks
+ * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
+ * @see ARSAL_Nftw (), eARSAL_FTW_ORDER
+ */
+int ARSAL_Nftw_Parallel(const char *dirpath, ARSAL_NftwCallback cb, int threadCount, eARSAL_FTW_FLAG flags, eARSAL_FTW_ORDER order);
+
+/**
+ * @brief Space used by a directory hierarchy
+ * @see ARSAL_Ftw_DiskUsage ()
+ */
+typedef struct
+{
+    uint64_t size; /**< Sum of the sizes of the files */
+    uint64_t diskSize; /**< Sum of the blocks allocated to the files and directories, in bytes */
+    uint64_t fileCount; /**< Number of files, symbolic links and other non-directory entries */
+    uint64_t dirCount; /**< Number of directories, the top one included */
+} ARSAL_Ftw_Usage_t;
+
+/**
+ * @brief Callback giving the usage of a directory once its whole hierarchy has been counted
+ * @param customData The custom data given to ARSAL_Ftw_DiskUsage ()
+ * @param path The path of the directory, only valid during the call
+ * @param level The depth of the directory, 0 for the top one
+ * @param usage The usage of the directory hierarchy
+ * @see ARSAL_Ftw_DiskUsage ()
+ */
+typedef void (*ARSAL_Ftw_UsageCallback_t) (void *customData, const char *path, int level, const ARSAL_Ftw_Usage_t *usage);
+
+/**
+ * @brief Progress callback of the tree operations
+ * @param customData The custom data given to the operation
+ * @param entryCount The number of entries counted or removed so far
+ * @param size The size of the files counted so far, 0 when removing
+ * @see ARSAL_Ftw_DiskUsage (), ARSAL_Ftw_RemoveTree ()
+ */
+typedef void (*ARSAL_Ftw_Progress_t) (void *customData, uint64_t entryCount, uint64_t size);
+
+/**
+ * @brief Computes the space used by a directory hierarchy, as du does
+ * @note The directories are listed concurrently, the entries being stated relatively to their directory. Hard linked files are counted once per link.
+ * @note The callbacks are called from the walking threads, one at a time. The progress is reported after each directory.
+ * @param dirPath The directory to measure
+ * @param threadCount The number of threads listing directories, 0 for ARSAL_FTW_PARALLEL_DEFAULT_THREADS
+ * @param reportDepth The depth down to which usageCallback is called, -1 for all the directories
+ * @param usageCallback The callback called on the directories once counted, may be NULL
+ * @param progressCallback The progress callback, may be NULL
+ * @param customData The custom data given to the callbacks
+ * @param[out] usage The usage of the whole hierarchy, may be NULL
+ * @return ARSAL_OK, or ARSAL_ERROR_FILE if some entries could not be read, the usage then counts the others
+ * @see ARSAL_Ftw_Usage_t
+ */
+eARSAL_ERROR ARSAL_Ftw_DiskUsage(const char *dirPath, int threadCount, int reportDepth, ARSAL_Ftw_UsageCallback_t usageCallback, ARSAL_Ftw_Progress_t progressCallback, void *customData, ARSAL_Ftw_Usage_t *usage);
+
+/**
+ * @brief Removes a directory hierarchy, as rm -r does
+ * @note The directories are listed concurrently, the files being unlinked relatively to their directory. A directory is removed as soon as its last entry is.
+ * Symbolic links are removed, not followed, even when one replaces a directory during the removal: the directories are opened and removed relatively to their parent descriptor. dirPath may be a file.
+ * @note The progress callback is called from the walking threads, one at a time, after each directory.
+ * @param dirPath The directory to remove
+ * @param threadCount The number of threads removing directories, 0 for ARSAL_FTW_PARALLEL_DEFAULT_THREADS
+ * @param progressCallback The progress callback, may be NULL
+ * @param customData The custom data given to the callback
+ * @return ARSAL_OK, or ARSAL_ERROR_FILE if some entries could not be removed, the others being removed anyway
+ */
+eARSAL_ERROR ARSAL_Ftw_RemoveTree(const char *dirPath, int threadCount, ARSAL_Ftw_Progress_t progressCallback, void *customData);
+
 #endif /* _ARSAL_FTW_H_ */
 
 
@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Future.h
+ * @brief libARSAL futures: completion of an asynchronous operation, set once by its promise and waited for or chained by the consumers.
+ **/
+
+#ifndef _ARSAL_FUTURE_H_
+#define _ARSAL_FUTURE_H_
+
+#include <libARSAL/ARSAL_Error.h>
+
+/**
+ * @brief Waiting thread registered on a future (private)
+ */
+struct _ARSAL_Future_Link_t;
+
+/**
+ * @brief Future, shared by the promise which completes it and by its consumers
+ * @note Embedded in the structure of the asynchronous operation, or a local variable: no allocation is needed. The fields are private.
+ * @see ARSAL_Future_Init (), ARSAL_Promise_SetValue ()
+ */
+typedef struct _ARSAL_Future_t ARSAL_Future_t;
+
+/**
+ * @brief Continuation of a future
+ * @param future The completed future
+ * @param customData The custom data given to ARSAL_Future_Then ()
+ */
+typedef void (*ARSAL_Future_Callback_t) (ARSAL_Future_t *future, void *customData);
+
+struct _ARSAL_Future_t
+{
+    int state; /**< Atomic completion flags */
+    eARSAL_ERROR error; /**< Set by the promise */
+    void *value; /**< Set by the promise */
+    ARSAL_Future_Callback_t callback; /**< Continuation */
+    void *customData; /**< Custom data of the continuation */
+    struct _ARSAL_Future_Link_t *links; /**< Waiting threads */
+};
+
+/**
+ * @brief Initialize a future, pending
+ * @note A completed future can be initialized again for reuse, once no thread waits for it
+ * @param future The future
+ */
+void ARSAL_Future_Init(ARSAL_Future_t *future);
+
+/**
+ * @brief Check if a future is completed
+ * @note A single atomic load, without lock
+ * @param future The future
+ * @return 1 if completed, 0 otherwise
+ */
+int ARSAL_Future_IsReady(ARSAL_Future_t *future);
+
+/**
+ * @brief Wait for a future to complete
+ * @note A completed future returns at once, without lock. Otherwise the thread sleeps on a condition variable of a table shared by the futures, chosen by address.
+ * @param future The future
+ * @param timeoutMs The maximum time to wait in milliseconds, -1 to wait until completion, 0 to only check
+ * @param[out] value The value set by the promise, may be NULL
+ * @return ARSAL_OK, the error set by the promise, or ARSAL_ERROR_TIMEOUT
+ */
+eARSAL_ERROR ARSAL_Future_Wait(ARSAL_Future_t *future, int timeoutMs, void **value);
+
+/**
+ * @brief Wait for any of several futures to complete
+ * @param futures The futures
+ * @param count The number of futures
+ * @param timeoutMs The maximum time to wait in milliseconds, -1 to wait until a completion, 0 to only check
+ * @param[out] index The index of a completed future, the first one if several are
+ * @return ARSAL_OK, ARSAL_ERROR_TIMEOUT, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_Future_WaitAny(ARSAL_Future_t **futures, int count, int timeoutMs, int *index);
+
+/**
+ * @brief Wait for all of several futures to complete
+ * @param futures The futures
+ * @param count The number of futures
+ * @param timeoutMs The maximum time to wait for all of them in milliseconds, -1 to wait until completion, 0 to only check
+ * @return ARSAL_OK, ARSAL_ERROR_TIMEOUT, or ARSAL_ERROR_BAD_PARAMETER. The errors set by the promises are given by ARSAL_Future_Wait ().
+ */
+eARSAL_ERROR ARSAL_Future_WaitAll(ARSAL_Future_t **futures, int count, int timeoutMs);
+
+/**
+ * @brief Set the continuation of a future
+ * @note The continuation is called once, by the thread completing the future, or at once by the calling thread if the future is already completed
+ * @param future The future
+ * @param callback The continuation
+ * @param customData The custom data given to the continuation
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if a continuation is already set
+ */
+eARSAL_ERROR ARSAL_Future_Then(ARSAL_Future_t *future, ARSAL_Future_Callback_t callback, void *customData);
+
+/**
+ * @brief Complete a future with a value
+ * @note Without any waiting thread nor continuation, a single atomic operation besides the stores of the result
+ * @param future The future
+ * @param value The value
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the future is already completed
+ */
+eARSAL_ERROR ARSAL_Promise_SetValue(ARSAL_Future_t *future, void *value);
+
+/**
+ * @brief Complete a future with an error
+ * @param future The future
+ * @param error The error, other than ARSAL_OK
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the future is already completed
+ */
+eARSAL_ERROR ARSAL_Promise_SetError(ARSAL_Future_t *future, eARSAL_ERROR error);
+
+#endif /* _ARSAL_FUTURE_H_ */
@@ -38,6 +38,8 @@
 #ifndef _ARSAL_MD5_H_
 #define _ARSAL_MD5_H_
 
+#include <inttypes.h>
+#include <stddef.h>
 #include "libARSAL/ARSAL_Error.h"
 
 #define ARSAL_MD5_LENGTH        16
@@ -62,11 +64,114 @@ typedef eARSAL_ERROR (*ARSAL_MD5_Check_t)(void *md5Object, const char *filePath,
  */
 typedef eARSAL_ERROR (*ARSAL_MD5_Compute_t)(void *md5Object, const char *filePath, uint8_t *md5, int md5Len);
 
+/**
+ * @brief Default number of buffers of the read ring
+ * @see ARSAL_MD5_Options_t
+ */
+#define ARSAL_MD5_DEFAULT_BUFFER_COUNT  1
+
+/**
+ * @brief Default size of each read buffer, in bytes
+ * @see ARSAL_MD5_Options_t
+ */
+#define ARSAL_MD5_DEFAULT_BUFFER_SIZE   (64 * 1024)
+
+/**
+ * @brief Default file size from which ARSAL_MD5_IO_MODE_AUTO bypasses the page cache, in bytes
+ * @see ARSAL_MD5_Options_t
+ */
+#define ARSAL_MD5_DEFAULT_DIRECT_THRESHOLD  (16 * 1024 * 1024)
+
+/**
+ * @brief Read mode of the native MD5 engine
+ * @see ARSAL_MD5_Options_t
+ */
+typedef enum
+{
+    ARSAL_MD5_IO_MODE_BUFFERED = 0, /**< Read through the page cache */
+    ARSAL_MD5_IO_MODE_DIRECT, /**< Bypass the page cache (O_DIRECT), so that hashing does not evict the cached data of the rest of the system */
+    ARSAL_MD5_IO_MODE_AUTO, /**< Bypass the page cache for the files of at least directThreshold bytes only */
+} eARSAL_MD5_IO_MODE;
+
+/**
+ * @brief Options of the native MD5 engine
+ * @param bufferCount The number of buffers of the read ring. With 2 or more buffers, a reader thread fills the ring while the calling thread hashes, so that disk and CPU work in parallel. 1 reads and hashes alternately.
+ * @param bufferSize The size of each read buffer, in bytes. It is rounded up to a multiple of 4096 when the page cache is bypassed.
+ * @param ioMode The read mode
+ * @param directThreshold The file size from which ARSAL_MD5_IO_MODE_AUTO bypasses the page cache, in bytes
+ * @note When the file system does not support O_DIRECT, the file is read through the page cache and the pages read are dropped as the hashing goes
+ * @see ARSAL_MD5_Manager_SetOptions ()
+ */
+typedef struct
+{
+    int bufferCount;
+    size_t bufferSize;
+    eARSAL_MD5_IO_MODE ioMode;
+    uint64_t directThreshold;
+} ARSAL_MD5_Options_t;
+
+/**
+ * @brief Size of the serialized manifest header, in bytes
+ * @see ARSAL_MD5_Manifest_Serialize ()
+ */
+#define ARSAL_MD5_MANIFEST_HEADER_SIZE  40
+
+/**
+ * @brief Chunked digest manifest of a file
+ * @param fileSize The size of the file, in bytes
+ * @param chunkSize The size of each chunk, in bytes. The last chunk may be shorter.
+ * @param chunkCount The number of chunks
+ * @param md5 The md5 of the whole file
+ * @param chunks The md5 of each chunk, chunkCount * ARSAL_MD5_LENGTH bytes
+ * @see ARSAL_MD5_Manager_ComputeManifest ()
+ */
+typedef struct
+{
+    uint64_t fileSize;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    uint8_t md5[ARSAL_MD5_LENGTH];
+    uint8_t *chunks;
+} ARSAL_MD5_Manifest_t;
+
+/**
+ * @brief Progress callback of an asynchronous MD5 computation
+ * @param customData The custom data given to ARSAL_MD5_Manager_ComputeAsync ()
+ * @param hashedSize The number of bytes already hashed
+ * @param totalSize The size of the file being hashed
+ * @param rate The average hashing rate since the job started, in MB/s
+ * @see ARSAL_MD5_Manager_ComputeAsync ()
+ */
+typedef void (*ARSAL_MD5_Progress_t)(void *customData, uint64_t hashedSize, uint64_t totalSize, float rate);
+
+/**
+ * @brief Completion callback of an asynchronous MD5 computation
+ * @param customData The custom data given to ARSAL_MD5_Manager_ComputeAsync ()
+ * @param error ARSAL_OK on success, ARSAL_ERROR_CANCELED if the job was canceled, or another error of eARSAL_ERROR
+ * @param md5 The computed md5, NULL if error is not ARSAL_OK
+ * @param md5Len The md5 length
+ * @see ARSAL_MD5_Manager_ComputeAsync ()
+ */
+typedef void (*ARSAL_MD5_Completion_t)(void *customData, eARSAL_ERROR error, const uint8_t *md5, int md5Len);
+
+/**
+ * @brief Asynchronous MD5 job
+ * @see ARSAL_MD5_Manager_ComputeAsync ()
+ */
+typedef struct _ARSAL_MD5_Job_t ARSAL_MD5_Job_t;
+
+/**
+ * @brief Incremental md5 computation of memory buffers
+ * @see ARSAL_MD5_Context_New ()
+ */
+typedef struct _ARSAL_MD5_Context_t ARSAL_MD5_Context_t;
+
 /**
  * @brief MD5 Manager structure
  * @retval md5Check The Check function
  * @retval md5Compute The Compute function
  * @retval md5Object The md5 object
+ * @retval options The options of the native engine
  * @see ARSAL_MD5_Manager_New
  */
 typedef struct _ARSAL_MD5_Manager_t 
@@ -74,6 +179,7 @@ typedef struct _ARSAL_MD5_Manager_t
     ARSAL_MD5_Check_t md5Check;
     ARSAL_MD5_Compute_t md5Compute;
     void *md5Object;
+    ARSAL_MD5_Options_t options;
 } ARSAL_MD5_Manager_t;
 
 
@@ -132,6 +238,236 @@ eARSAL_ERROR ARSAL_MD5_Manager_Check(ARSAL_MD5_Manager_t *manager, const char *f
  */
 eARSAL_ERROR ARSAL_MD5_Manager_Compute(ARSAL_MD5_Manager_t *manager, const char *filePath, uint8_t *md5, int md5Size);
 
+/**
+ * @brief Set the options of the native MD5 engine
+ * @note The options apply to the next computations, jobs already started keep their options
+ * @param manager The MD5 Manager
+ * @param options The options, NULL to restore the default ones
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Options_t
+ */
+eARSAL_ERROR ARSAL_MD5_Manager_SetOptions(ARSAL_MD5_Manager_t *manager, const ARSAL_MD5_Options_t *options);
+
+/**
+ * @brief Compute the md5 of a file with specific options, leaving the options of the manager unchanged
+ * @param manager The md5 manager
+ * @param filePath The path of the file to hash
+ * @param options The options of this computation, NULL to use the ones of the manager
+ * @param[out] md5 The md5 buffer to receive the md5
+ * @param md5Len md5 buffer length
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Options_t
+ */
+eARSAL_ERROR ARSAL_MD5_Manager_ComputeWithOptions(ARSAL_MD5_Manager_t *manager, const char *filePath, const ARSAL_MD5_Options_t *options, uint8_t *md5, int md5Len);
+
+/**
+ * @brief Compute an MD5 in a background thread
+ * @warning This function allocates memory
+ * @note The job always hashes with the native libARSAL engine, whatever the md5Compute function of the manager
+ * @note The callbacks are called from the job thread, they must not delete the job
+ * @param manager The MD5 Manager
+ * @param filePath The file path onto compute its md5
+ * @param progressCallback The progress callback, may be NULL
+ * @param progressInterval The minimum interval between two progress callbacks, in ms
+ * @param completionCallback The completion callback, may be NULL
+ * @param customData The custom data given to the callbacks
+ * @param[out] error A pointer on the error output
+ * @return Pointer on the new MD5 job
+ * @see ARSAL_MD5_Job_Wait (), ARSAL_MD5_Job_Cancel (), ARSAL_MD5_Job_Delete ()
+ */
+ARSAL_MD5_Job_t* ARSAL_MD5_Manager_ComputeAsync(ARSAL_MD5_Manager_t *manager, const char *filePath, ARSAL_MD5_Progress_t progressCallback, int progressInterval, ARSAL_MD5_Completion_t completionCallback, void *customData, eARSAL_ERROR *error);
+
+/**
+ * @brief Cancel an MD5 job
+ * @note The job completes with ARSAL_ERROR_CANCELED unless it was already done
+ * @param job The MD5 job
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Manager_ComputeAsync ()
+ */
+eARSAL_ERROR ARSAL_MD5_Job_Cancel(ARSAL_MD5_Job_t *job);
+
+/**
+ * @brief Wait for the completion of an MD5 job
+ * @param job The MD5 job
+ * @param[out] md5 The md5 buffer to receive the md5, may be NULL
+ * @param md5Len md5 buffer length
+ * @retval Returns the result of the job, ARSAL_OK on success. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Manager_ComputeAsync ()
+ */
+eARSAL_ERROR ARSAL_MD5_Job_Wait(ARSAL_MD5_Job_t *job, uint8_t *md5, int md5Len);
+
+/**
+ * @brief Delete an MD5 job
+ * @warning This function frees memory
+ * @note A running job is canceled and joined before being freed
+ * @param jobAddr The address of the pointer on the MD5 job
+ * @see ARSAL_MD5_Manager_ComputeAsync ()
+ */
+void ARSAL_MD5_Job_Delete(ARSAL_MD5_Job_t **jobAddr);
+
+/**
+ * @brief Compute the chunked digest manifest of a file
+ * @warning This function allocates memory
+ * @note The whole file md5 and the md5 of each chunk are computed in a single read of the file
+ * @param manager The MD5 Manager
+ * @param filePath The file path onto compute its manifest
+ * @param chunkSize The size of each chunk, in bytes. ARSAL_ERROR_BAD_PARAMETER if the file has more than UINT32_MAX chunks.
+ * @param[out] error A pointer on the error output
+ * @return Pointer on the new manifest
+ * @see ARSAL_MD5_Manifest_Delete (), ARSAL_MD5_Manifest_Diff ()
+ */
+ARSAL_MD5_Manifest_t* ARSAL_MD5_Manager_ComputeManifest(ARSAL_MD5_Manager_t *manager, const char *filePath, uint32_t chunkSize, eARSAL_ERROR *error);
+
+/**
+ * @brief Delete a manifest
+ * @warning This function frees memory
+ * @param manifestAddr The address of the pointer on the manifest
+ * @see ARSAL_MD5_Manager_ComputeManifest (), ARSAL_MD5_Manifest_Deserialize ()
+ */
+void ARSAL_MD5_Manifest_Delete(ARSAL_MD5_Manifest_t **manifestAddr);
+
+/**
+ * @brief Get the byte range covered by a chunk
+ * @param manifest The manifest
+ * @param index The chunk index
+ * @param[out] offset The offset of the chunk in the file
+ * @param[out] size The size of the chunk
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_Manifest_GetChunkRange(const ARSAL_MD5_Manifest_t *manifest, uint32_t index, uint64_t *offset, uint64_t *size);
+
+/**
+ * @brief Get the size of a serialized manifest
+ * @param manifest The manifest
+ * @return The number of bytes written by ARSAL_MD5_Manifest_Serialize (), 0 if manifest is NULL or has more chunks than a manifest can hold
+ */
+size_t ARSAL_MD5_Manifest_GetSerializedSize(const ARSAL_MD5_Manifest_t *manifest);
+
+/**
+ * @brief Serialize a manifest
+ * @note The format is a ARSAL_MD5_MANIFEST_HEADER_SIZE bytes header ("AMD5" magic, version, chunk size, chunk count, file size and whole file md5, integers in device endianness), followed by the md5 of each chunk
+ * @param manifest The manifest
+ * @param[out] buffer The buffer to receive the serialized manifest
+ * @param bufferSize The buffer size
+ * @param[out] written The number of bytes written, may be NULL
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Manifest_Deserialize ()
+ */
+eARSAL_ERROR ARSAL_MD5_Manifest_Serialize(const ARSAL_MD5_Manifest_t *manifest, uint8_t *buffer, size_t bufferSize, size_t *written);
+
+/**
+ * @brief Create a manifest from its serialized form
+ * @warning This function allocates memory
+ * @param buffer The serialized manifest
+ * @param bufferSize The buffer size
+ * @param[out] error A pointer on the error output
+ * @return Pointer on the new manifest
+ * @see ARSAL_MD5_Manifest_Serialize (), ARSAL_MD5_Manifest_Delete ()
+ */
+ARSAL_MD5_Manifest_t* ARSAL_MD5_Manifest_Deserialize(const uint8_t *buffer, size_t bufferSize, eARSAL_ERROR *error);
+
+/**
+ * @brief List the chunks of a received file which do not match the reference manifest
+ * @note Chunks of the reference missing from the received manifest are reported as mismatching
+ * @param reference The manifest of the original file
+ * @param received The manifest of the received file
+ * @param[out] chunks The array to receive the mismatching chunk indexes, may be NULL
+ * @param maxChunks The capacity of the chunks array
+ * @param[out] chunkCount The total number of mismatching chunks, which may be greater than maxChunks
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_Manifest_Diff(const ARSAL_MD5_Manifest_t *reference, const ARSAL_MD5_Manifest_t *received, uint32_t *chunks, uint32_t maxChunks, uint32_t *chunkCount);
+
+/**
+ * @brief Compute the tree digest of a file, hashing its chunks in parallel
+ * @note The tree digest is the md5 of the concatenated md5s of all chunks. It differs from the md5 of the file, both the producer and the verifier must use it, with the same chunk size.
+ * @param manager The MD5 Manager
+ * @param filePath The file path onto compute its tree digest
+ * @param chunkSize The size of each chunk, in bytes
+ * @param threadCount The number of hashing threads including the calling one, 0 for one per online CPU
+ * @param[out] md5 The md5 buffer to receive the root digest
+ * @param md5Len md5 buffer length
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Manifest_GetTreeRoot ()
+ */
+eARSAL_ERROR ARSAL_MD5_Manager_ComputeTree(ARSAL_MD5_Manager_t *manager, const char *filePath, uint32_t chunkSize, int threadCount, uint8_t *md5, int md5Len);
+
+/**
+ * @brief Compute the tree digest from the chunk md5s of a manifest
+ * @note The result equals the one of ARSAL_MD5_Manager_ComputeTree () with the same chunk size
+ * @param manifest The manifest
+ * @param[out] md5 The md5 buffer to receive the root digest
+ * @param md5Len md5 buffer length
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ * @see ARSAL_MD5_Manager_ComputeTree ()
+ */
+eARSAL_ERROR ARSAL_MD5_Manifest_GetTreeRoot(const ARSAL_MD5_Manifest_t *manifest, uint8_t *md5, int md5Len);
+
+/**
+ * @brief Compute the md5 of many files at once
+ * @note On Linux the files are opened, read and closed through io_uring with up to queueDepth files in flight, so that a single syscall submits and reaps the I/O of the whole batch
+ * @note If io_uring is not available, the files are hashed by a pool of at most 16 threads using pread
+ * @param manager The md5 manager
+ * @param filePaths Array of the paths of the files to hash
+ * @param fileCount Number of files in filePaths
+ * @param queueDepth Maximum number of files in flight, 0 for the default (32)
+ * @param[out] md5s Buffer of fileCount * ARSAL_MD5_LENGTH bytes receiving the md5 of each file, in the order of filePaths
+ * @param[out] results Optional array of fileCount errors receiving the result of each file, may be NULL
+ * @retval On success, returns ARSAL_OK. If some files could not be hashed, returns ARSAL_ERROR_FILE and the md5 of the failed files is left untouched. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_Manager_ComputeBatch(ARSAL_MD5_Manager_t *manager, const char * const *filePaths, int fileCount, int queueDepth, uint8_t *md5s, eARSAL_ERROR *results);
+
+/**
+ * @brief Create a new incremental md5 context
+ * @warning This function allocates memory
+ * @param[out] error The error
+ * @retval On success, returns the context. Otherwise, it returns NULL and error is set
+ * @see ARSAL_MD5_Context_Delete ()
+ */
+ARSAL_MD5_Context_t* ARSAL_MD5_Context_New(eARSAL_ERROR *error);
+
+/**
+ * @brief Delete an incremental md5 context
+ * @warning This function frees memory
+ * @param contextAddr The address of the pointer on the context
+ * @see ARSAL_MD5_Context_New ()
+ */
+void ARSAL_MD5_Context_Delete(ARSAL_MD5_Context_t **contextAddr);
+
+/**
+ * @brief Discard the data hashed so far and start a new message
+ * @param context The context
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_Context_Reset(ARSAL_MD5_Context_t *context);
+
+/**
+ * @brief Hash the next part of the message, in place
+ * @param context The context
+ * @param data The data
+ * @param dataSize The size of the data, in bytes
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_Context_Update(ARSAL_MD5_Context_t *context, const uint8_t *data, size_t dataSize);
+
+/**
+ * @brief Get the md5 of the data hashed so far, then start a new message
+ * @param context The context
+ * @param[out] md5 The md5 buffer to receive the md5
+ * @param md5Len md5 buffer length
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_Context_Final(ARSAL_MD5_Context_t *context, uint8_t *md5, int md5Len);
+
+/**
+ * @brief Compute the md5 of a memory buffer
+ * @param data The data
+ * @param dataSize The size of the data, in bytes
+ * @param[out] md5 The md5 buffer to receive the md5
+ * @param md5Len md5 buffer length
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_ComputeBuffer(const uint8_t *data, size_t dataSize, uint8_t *md5, int md5Len);
 
 #endif /* _ARSAL_MD5_H_ */
 
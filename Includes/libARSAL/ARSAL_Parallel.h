@@ -0,0 +1,116 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Parallel.h
+ * @brief libARSAL parallel loops and reductions over index ranges, run on a work-stealing scheduler.
+ **/
+
+#ifndef _ARSAL_PARALLEL_H_
+#define _ARSAL_PARALLEL_H_
+
+#include <stddef.h>
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Scheduler.h>
+
+/**
+ * @brief Grain size chosen from the size of the range and the number of workers
+ */
+#define ARSAL_PARALLEL_AUTO_GRAIN               (0)
+
+/**
+ * @brief Number of chunks per worker with ARSAL_PARALLEL_AUTO_GRAIN, to balance uneven chunks
+ */
+#define ARSAL_PARALLEL_CHUNKS_PER_THREAD        (8)
+
+/**
+ * @brief Body of a parallel loop
+ * @param begin The first index of the chunk
+ * @param end The index after the last one of the chunk
+ * @param customData The custom data given to ARSAL_Parallel_For ()
+ */
+typedef void (*ARSAL_Parallel_ForBody_t) (size_t begin, size_t end, void *customData);
+
+/**
+ * @brief Body of a parallel reduction
+ * @param begin The first index of the chunk
+ * @param end The index after the last one of the chunk
+ * @param partial The partial result of the chunk to accumulate to, initialized with the identity
+ * @param customData The custom data given to ARSAL_Parallel_Reduce ()
+ */
+typedef void (*ARSAL_Parallel_ReduceBody_t) (size_t begin, size_t end, void *partial, void *customData);
+
+/**
+ * @brief Combination of two partial results of a parallel reduction
+ * @param partial The partial result of the lower indexes, to combine to
+ * @param other The partial result of the following indexes
+ * @param customData The custom data given to ARSAL_Parallel_Reduce ()
+ */
+typedef void (*ARSAL_Parallel_Join_t) (void *partial, const void *other, void *customData);
+
+/**
+ * @brief Get the scheduler shared by the parallel algorithms
+ * @note Created at the first call with a worker per online CPU, and never deleted
+ * @return Pointer on the scheduler, or NULL on error
+ */
+ARSAL_Scheduler_t* ARSAL_Parallel_GetDefaultScheduler(void);
+
+/**
+ * @brief Run a loop body over a range of indexes, by chunks in parallel
+ * @note The range is split in chunks of grainSize indexes, then recursively halved into tasks, so the workers steal the biggest halves first. The calling thread waits for all chunks. Can be called from a task of the scheduler.
+ * @note Without a scheduler, or for a single chunk, the body is run by the calling thread.
+ * @param scheduler The scheduler, NULL for ARSAL_Parallel_GetDefaultScheduler ()
+ * @param begin The first index
+ * @param end The index after the last one
+ * @param grainSize The number of indexes of a chunk, or ARSAL_PARALLEL_AUTO_GRAIN
+ * @param body The loop body
+ * @param customData The custom data given to the body
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_Parallel_For(ARSAL_Scheduler_t *scheduler, size_t begin, size_t end, size_t grainSize, ARSAL_Parallel_ForBody_t body, void *customData);
+
+/**
+ * @brief Reduce a range of indexes in parallel
+ * @note Each chunk accumulates to its own partial result, initialized with a copy of the identity. The partial results are joined in the order of the indexes, so the result does not depend on the scheduling for a given grain size, even for non-associative floating-point operations.
+ * @param scheduler The scheduler, NULL for ARSAL_Parallel_GetDefaultScheduler ()
+ * @param begin The first index
+ * @param end The index after the last one
+ * @param grainSize The number of indexes of a chunk, or ARSAL_PARALLEL_AUTO_GRAIN
+ * @param partialSize The size of a partial result, in bytes
+ * @param identity The identity of the reduction, partialSize bytes
+ * @param body The reduction body
+ * @param join The combination of the partial results
+ * @param customData The custom data given to the body and to the join
+ * @param[out] result The result, partialSize bytes, the identity for an empty range
+ * @return ARSAL_OK, ARSAL_ERROR_BAD_PARAMETER or ARSAL_ERROR_ALLOC
+ */
+eARSAL_ERROR ARSAL_Parallel_Reduce(ARSAL_Scheduler_t *scheduler, size_t begin, size_t end, size_t grainSize, size_t partialSize, const void *identity, ARSAL_Parallel_ReduceBody_t body, ARSAL_Parallel_Join_t join, void *customData, void *result);
+
+#endif /* _ARSAL_PARALLEL_H_ */
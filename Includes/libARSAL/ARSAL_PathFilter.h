@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_PathFilter.h
+ * @brief libARSAL path filters, evaluated by the directory walks before stating the entries.
+ **/
+
+#ifndef _ARSAL_PATHFILTER_H_
+#define _ARSAL_PATHFILTER_H_
+
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Error.h>
+
+/**
+ * @brief Path filter
+ * @note A file matches when it matches one of the globs or extensions (or there is none), and all the ranges.
+ * Directories are walked as long as they can hold matching files, they are not reported.
+ * @see ARSAL_PathFilter_New (), ARSAL_DirIter_SetFilter (), ARSAL_Nftw_Filtered ()
+ */
+typedef struct _ARSAL_PathFilter_t ARSAL_PathFilter_t;
+
+/**
+ * @brief Create an empty path filter, matching all the files
+ * @param[out] error The error code
+ * @return The filter, or NULL on error
+ * @see ARSAL_PathFilter_Delete ()
+ */
+ARSAL_PathFilter_t* ARSAL_PathFilter_New(eARSAL_ERROR *error);
+
+/**
+ * @brief Delete a path filter
+ * @param filterAddr The address of the pointer on the filter, set to NULL
+ * @see ARSAL_PathFilter_New ()
+ */
+void ARSAL_PathFilter_Delete(ARSAL_PathFilter_t **filterAddr);
+
+/**
+ * @brief Add a glob
+ * @note A glob without '/' is matched against the file names, for example "*.mp4".
+ * Otherwise it is matched against the paths relative to the walked directory, for example "media/DCIM?/[0-9]*.jpg", and the directories out of it are not walked.
+ * '*' matches any characters but '/', '?' one character but '/', and [a-z] or [!a-z] a character of a class, never '/'.
+ * A path component made of "**" alone matches any number of directories; elsewhere "**" is the same as '*'.
+ * Globs are compiled when they are added, and matched in a time bounded by the product of the glob and path lengths.
+ * @param filter The filter
+ * @param glob The glob
+ * @return ARSAL_OK, or an error code
+ */
+eARSAL_ERROR ARSAL_PathFilter_AddGlob(ARSAL_PathFilter_t *filter, const char *glob);
+
+/**
+ * @brief Add a file name extension, compared case insensitively
+ * @param filter The filter
+ * @param extension The extension, with or without its leading dot: "jpg" or ".jpg"
+ * @return ARSAL_OK, or an error code
+ */
+eARSAL_ERROR ARSAL_PathFilter_AddExtension(ARSAL_PathFilter_t *filter, const char *extension);
+
+/**
+ * @brief Only match the files whose size is in a range
+ * @param filter The filter
+ * @param minSize The minimum size, included
+ * @param maxSize The maximum size, included, UINT64_MAX for no maximum
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_PathFilter_SetSizeRange(ARSAL_PathFilter_t *filter, uint64_t minSize, uint64_t maxSize);
+
+/**
+ * @brief Only match the files whose modification time is in a range
+ * @param filter The filter
+ * @param minMtime The minimum modification time, in seconds since the Epoch, included
+ * @param maxMtime The maximum modification time, in seconds since the Epoch, included, INT64_MAX for no maximum
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_PathFilter_SetMtimeRange(ARSAL_PathFilter_t *filter, int64_t minMtime, int64_t maxMtime);
+
+/**
+ * @brief Only match the files whose depth is in a range, the entries of the walked directory are at depth 1
+ * @note The directories deeper than maxDepth are not walked
+ * @param filter The filter
+ * @param minDepth The minimum depth, included
+ * @param maxDepth The maximum depth, included, -1 for no maximum
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_PathFilter_SetDepthRange(ARSAL_PathFilter_t *filter, int minDepth, int maxDepth);
+
+#endif /* _ARSAL_PATHFILTER_H_ */
@@ -0,0 +1,117 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Scheduler.h
+ * @brief libARSAL work-stealing task scheduler for fine-grained and recursive parallelism.
+ **/
+
+#ifndef _ARSAL_SCHEDULER_H_
+#define _ARSAL_SCHEDULER_H_
+
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Thread.h>
+
+/**
+ * @brief Work-stealing scheduler
+ * @see ARSAL_Scheduler_New ()
+ */
+typedef struct _ARSAL_Scheduler_t ARSAL_Scheduler_t;
+
+/**
+ * @brief Group of tasks waited for together
+ * @note Usually a local variable of the function spawning the tasks. The fields are private.
+ * @see ARSAL_Scheduler_Group_Init (), ARSAL_Scheduler_Wait ()
+ */
+typedef struct
+{
+    int pending; /**< Tasks of the group not complete yet, and a flag when a thread sleeps until the group completes */
+} ARSAL_Scheduler_Group_t;
+
+/**
+ * @brief Task run by the scheduler
+ * @param scheduler The scheduler running the task, to spawn child tasks
+ * @param customData The custom data given to ARSAL_Scheduler_Spawn ()
+ */
+typedef void (*ARSAL_Scheduler_Task_t) (ARSAL_Scheduler_t *scheduler, void *customData);
+
+/**
+ * @brief Create a scheduler and start its workers
+ * @note Each worker owns a deque: it pushes and takes its tasks at the bottom, depth first, while the idle workers steal the oldest, biggest, tasks at the top of the deque of a random victim
+ * @param threadCount The number of workers, 0 for the number of online CPUs
+ * @param threadAttr The attributes of the workers, NULL for the defaults
+ * @param[out] error Pointer on the error output
+ * @return Pointer on the new scheduler, or NULL on error
+ * @see ARSAL_Scheduler_Delete ()
+ */
+ARSAL_Scheduler_t* ARSAL_Scheduler_New(int threadCount, const ARSAL_Thread_Attr_t *threadAttr, eARSAL_ERROR *error);
+
+/**
+ * @brief Stop the workers and delete a scheduler
+ * @note The tasks not started yet are dropped, wait for their groups before
+ * @warning Must not be called from a task
+ * @param schedulerAddr Address of the pointer on the scheduler, set to NULL
+ */
+void ARSAL_Scheduler_Delete(ARSAL_Scheduler_t **schedulerAddr);
+
+/**
+ * @brief Initialize an empty group of tasks
+ * @param group The group
+ */
+void ARSAL_Scheduler_Group_Init(ARSAL_Scheduler_Group_t *group);
+
+/**
+ * @brief Spawn a task in a group
+ * @note From a task, the child task is pushed on the deque of the worker, without any lock. From another thread, it is queued for the workers.
+ * @param scheduler The scheduler
+ * @param group The group of the task, which must stay valid until the group is waited for
+ * @param task The task
+ * @param customData The custom data given to the task
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_Scheduler_Spawn(ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Group_t *group, ARSAL_Scheduler_Task_t task, void *customData);
+
+/**
+ * @brief Wait for the tasks of a group to complete, child tasks spawned in the same group included
+ * @note From a task, the worker runs tasks while it waits, its own ones first. So a task can wait for its children without blocking a worker. Another thread sleeps until the group completes.
+ * @param scheduler The scheduler
+ * @param group The group
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_Scheduler_Wait(ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Group_t *group);
+
+/**
+ * @brief Get the number of workers of a scheduler
+ * @param scheduler The scheduler
+ * @return The number of workers, or -1 on error
+ */
+int ARSAL_Scheduler_GetThreadCount(ARSAL_Scheduler_t *scheduler);
+
+#endif /* _ARSAL_SCHEDULER_H_ */
@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Snapshot.h
+ * @brief libARSAL directory hierarchy snapshots and change detection.
+ **/
+
+#ifndef _ARSAL_SNAPSHOT_H_
+#define _ARSAL_SNAPSHOT_H_
+
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Ftw.h>
+
+/**
+ * @brief Snapshot of a directory hierarchy
+ * @see ARSAL_Snapshot_New ()
+ */
+typedef struct _ARSAL_Snapshot_t ARSAL_Snapshot_t;
+
+/**
+ * @brief Snapshot flags
+ * @see ARSAL_Snapshot_Update ()
+ */
+typedef enum
+{
+    ARSAL_SNAPSHOT_FLAG_NONE = 0, /**< The files of the directories which did not change are not stated */
+    ARSAL_SNAPSHOT_FLAG_CHECK_FILES = (1 << 0), /**< The files of the directories which did not change are stated too, to detect the files rewritten in place */
+} eARSAL_SNAPSHOT_FLAG;
+
+/**
+ * @brief Kind of change reported by ARSAL_Snapshot_Update ()
+ */
+typedef enum
+{
+    ARSAL_SNAPSHOT_CHANGE_ADDED = 0, /**< The entry was not in the previous snapshot */
+    ARSAL_SNAPSHOT_CHANGE_REMOVED, /**< The entry is no longer in the hierarchy */
+    ARSAL_SNAPSHOT_CHANGE_MODIFIED, /**< The size, the modification time or the inode of a file changed */
+} eARSAL_SNAPSHOT_CHANGE;
+
+/**
+ * @brief Entry of a snapshot
+ */
+typedef struct
+{
+    eARSAL_FTW_TYPE type; /**< ARSAL_FTW_D for a directory, ARSAL_FTW_F otherwise */
+    uint64_t size; /**< The size of the entry */
+    int64_t mtimeSec; /**< The modification time of the entry, seconds */
+    uint32_t mtimeNsec; /**< The modification time of the entry, nanoseconds */
+    uint64_t inode; /**< The inode number of the entry */
+} ARSAL_Snapshot_Entry_t;
+
+/**
+ * @brief Callback called for each change found by ARSAL_Snapshot_Update ()
+ * @param customData The custom data given to ARSAL_Snapshot_Update ()
+ * @param path The path of the entry
+ * @param change The kind of change
+ * @param oldEntry The entry in the previous snapshot, NULL if added
+ * @param newEntry The entry in the new snapshot, NULL if removed
+ * @note The entries of a removed or added directory are reported after it
+ */
+typedef void (*ARSAL_Snapshot_Diff_t)(void *customData, const char *path, eARSAL_SNAPSHOT_CHANGE change, const ARSAL_Snapshot_Entry_t *oldEntry, const ARSAL_Snapshot_Entry_t *newEntry);
+
+/**
+ * @brief Take the snapshot of a directory hierarchy
+ * @note Symbolic links are not followed
+ * @param dirPath The directory
+ * @param[out] error The error code
+ * @return The snapshot, or NULL on error
+ * @see ARSAL_Snapshot_Delete ()
+ */
+ARSAL_Snapshot_t* ARSAL_Snapshot_New(const char *dirPath, eARSAL_ERROR *error);
+
+/**
+ * @brief Delete a snapshot
+ * @param snapshotAddr The address of the pointer on the snapshot, set to NULL
+ * @see ARSAL_Snapshot_New ()
+ */
+void ARSAL_Snapshot_Delete(ARSAL_Snapshot_t **snapshotAddr);
+
+/**
+ * @brief Take a new snapshot of the hierarchy of a previous one, reporting the changes
+ * @note The directories whose modification and change times did not move since the previous snapshot are not read again: only their subdirectories are stated.
+ * Without ARSAL_SNAPSHOT_FLAG_CHECK_FILES, a file rewritten in place, which does not touch its directory, is therefore not seen as modified.
+ * @note The hierarchy may change during the walk: a directory removed before it is read is reported as removed, and the entries of a directory which cannot be read anymore (EACCES) are kept as they were in the previous snapshot.
+ * @param previous The previous snapshot
+ * @param flags The flags, a combination of eARSAL_SNAPSHOT_FLAG
+ * @param diffCallback The callback called for each change, can be NULL
+ * @param customData The custom data given to the callback
+ * @param[out] error The error code
+ * @return The new snapshot, or NULL on error
+ * @see ARSAL_Snapshot_New ()
+ */
+ARSAL_Snapshot_t* ARSAL_Snapshot_Update(const ARSAL_Snapshot_t *previous, int flags, ARSAL_Snapshot_Diff_t diffCallback, void *customData, eARSAL_ERROR *error);
+
+/**
+ * @brief Get the number of entries of a snapshot, its root included
+ * @param snapshot The snapshot
+ * @return The number of entries, 0 if snapshot is NULL
+ */
+int ARSAL_Snapshot_GetEntryCount(const ARSAL_Snapshot_t *snapshot);
+
+/**
+ * @brief Save a snapshot to a file
+ * @param snapshot The snapshot
+ * @param filePath The file to write
+ * @return ARSAL_OK, or an error code
+ * @see ARSAL_Snapshot_Load ()
+ */
+eARSAL_ERROR ARSAL_Snapshot_Save(const ARSAL_Snapshot_t *snapshot, const char *filePath);
+
+/**
+ * @brief Load a snapshot saved by ARSAL_Snapshot_Save ()
+ * @param filePath The file to read
+ * @param[out] error The error code, ARSAL_ERROR_FILE if the file is not a valid snapshot
+ * @return The snapshot, or NULL on error
+ * @see ARSAL_Snapshot_Save (), ARSAL_Snapshot_Delete ()
+ */
+ARSAL_Snapshot_t* ARSAL_Snapshot_Load(const char *filePath, eARSAL_ERROR *error);
+
+#endif /* _ARSAL_SNAPSHOT_H_ */
@@ -37,6 +37,9 @@
 #ifndef _ARSAL_THREAD_H_
 #define _ARSAL_THREAD_H_
 
+#include <stddef.h>
+#include <inttypes.h>
+
 /**
  * @brief Define a thread type.
  */
@@ -47,6 +50,41 @@ typedef void* ARSAL_Thread_t;
  */
 typedef void* (*ARSAL_Thread_Routine_t) (void *);
 
+/**
+ * @brief Maximum length of a thread name, the terminating null byte excluded
+ */
+#define ARSAL_THREAD_NAME_MAX_LENGTH (15)
+
+/**
+ * @brief Value of ARSAL_Thread_Attr_t guardSize keeping the guard of the system
+ */
+#define ARSAL_THREAD_DEFAULT_GUARD_SIZE ((size_t)-1)
+
+/**
+ * @brief Thread scheduling policies
+ */
+typedef enum
+{
+    ARSAL_THREAD_SCHED_OTHER = 0, /**< Default time sharing policy, the priority is ignored */
+    ARSAL_THREAD_SCHED_FIFO, /**< Real-time first in first out policy (SCHED_FIFO) */
+    ARSAL_THREAD_SCHED_RR, /**< Real-time round robin policy (SCHED_RR) */
+} eARSAL_THREAD_SCHED_POLICY;
+
+/**
+ * @brief Attributes of a thread, applied at its creation
+ * @note Initialize it with ARSAL_Thread_Attr_Init () then set the fields to change
+ * @see ARSAL_Thread_CreateWithAttr ()
+ */
+typedef struct
+{
+    size_t stackSize; /**< Stack size in bytes, 0 for the default one */
+    size_t guardSize; /**< Size of the guard area at the end of the stack, ARSAL_THREAD_DEFAULT_GUARD_SIZE for the default one */
+    eARSAL_THREAD_SCHED_POLICY policy; /**< Scheduling policy, the real-time ones usually need privileges */
+    int priority; /**< Real-time priority, between sched_get_priority_min () and sched_get_priority_max () of the policy */
+    uint64_t affinity; /**< CPUs the thread may run on, bit n being CPU n, 0 for all of them */
+    char name[ARSAL_THREAD_NAME_MAX_LENGTH + 1]; /**< Name of the thread, empty to keep the one of the system */
+} ARSAL_Thread_Attr_t;
+
 /**
  * @brief Create a new thread
  *
@@ -57,6 +95,29 @@ typedef void* (*ARSAL_Thread_Routine_t) (void *);
  */
 int ARSAL_Thread_Create(ARSAL_Thread_t *thread, ARSAL_Thread_Routine_t routine, void *arg);
 
+/**
+ * @brief Initialize thread attributes to the defaults of ARSAL_Thread_Create ()
+ *
+ * @param attr The attributes to initialize
+ */
+void ARSAL_Thread_Attr_Init(ARSAL_Thread_Attr_t *attr);
+
+/**
+ * @brief Create a new thread with attributes
+ *
+ * The stack and the scheduling are set before the thread starts, its affinity and name before it runs the routine.
+ * When an attribute cannot be applied, the thread does not run the routine and the error is returned.
+ *
+ * @param thread The thread to create
+ * @param routine The routine to invoke by thread
+ * @param arg The argument passed to routine()
+ * @param attr The attributes of the thread, NULL for the defaults
+ * @retval On success, ARSAL_Thread_CreateWithAttr() returns 0. Otherwise, it returns an error number (See errno.h),
+ * EPERM when the scheduling policy or the affinity is not allowed, ENOTSUP when the platform does not support an attribute
+ * @see ARSAL_Thread_Attr_Init ()
+ */
+int ARSAL_Thread_CreateWithAttr(ARSAL_Thread_t *thread, ARSAL_Thread_Routine_t routine, void *arg, const ARSAL_Thread_Attr_t *attr);
+
 /**
  * @brief Join a thread
  *
@@ -0,0 +1,142 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_ThreadPool.h
+ * @brief libARSAL thread pool running short tasks on a fixed or elastic set of workers.
+ **/
+
+#ifndef _ARSAL_THREADPOOL_H_
+#define _ARSAL_THREADPOOL_H_
+
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_Future.h>
+
+/**
+ * @brief Default number of workers of a pool created without configuration
+ */
+#define ARSAL_THREADPOOL_DEFAULT_THREADS            (4)
+
+/**
+ * @brief Default time after which the idle workers above the minimum exit, in milliseconds
+ */
+#define ARSAL_THREADPOOL_DEFAULT_IDLE_TIMEOUT_MS    (5000)
+
+/**
+ * @brief Thread pool
+ * @see ARSAL_ThreadPool_New ()
+ */
+typedef struct _ARSAL_ThreadPool_t ARSAL_ThreadPool_t;
+
+/**
+ * @brief Task run by a worker of the pool
+ * @param customData The custom data given to ARSAL_ThreadPool_Submit ()
+ * @return The result of the task, the value of its future
+ */
+typedef void* (*ARSAL_ThreadPool_Task_t) (void *customData);
+
+/**
+ * @brief Configuration of a pool
+ * @note With minThreads equal to maxThreads the pool is fixed, its workers being started at creation.
+ * Otherwise workers are started when tasks are queued while none is idle, up to maxThreads, and exit after idleTimeoutMs without task, down to minThreads.
+ */
+typedef struct
+{
+    int minThreads; /**< Number of workers always running, may be 0 */
+    int maxThreads; /**< Maximum number of workers, at least 1 */
+    int idleTimeoutMs; /**< Idle time after which the workers above minThreads exit, 0 for ARSAL_THREADPOOL_DEFAULT_IDLE_TIMEOUT_MS */
+    const ARSAL_Thread_Attr_t *threadAttr; /**< Attributes of the workers, NULL for the defaults, copied at creation */
+} ARSAL_ThreadPool_Config_t;
+
+/**
+ * @brief Counters of a pool
+ * @see ARSAL_ThreadPool_GetMetrics ()
+ */
+typedef struct
+{
+    int threadCount; /**< Running workers */
+    int idleThreadCount; /**< Workers waiting for a task */
+    int activeTaskCount; /**< Tasks being run */
+    int queueDepth; /**< Tasks waiting for a worker */
+    int maxQueueDepth; /**< Highest queue depth since the creation of the pool */
+    uint64_t submittedCount; /**< Tasks submitted */
+    uint64_t completedCount; /**< Tasks run */
+    uint64_t canceledCount; /**< Tasks dropped by ARSAL_ThreadPool_Shutdown () */
+} ARSAL_ThreadPool_Metrics_t;
+
+/**
+ * @brief Create a thread pool
+ * @param config The configuration of the pool, NULL for ARSAL_THREADPOOL_DEFAULT_THREADS fixed workers
+ * @param[out] error Pointer on the error output
+ * @return Pointer on the new pool, or NULL on error
+ * @see ARSAL_ThreadPool_Delete ()
+ */
+ARSAL_ThreadPool_t* ARSAL_ThreadPool_New(const ARSAL_ThreadPool_Config_t *config, eARSAL_ERROR *error);
+
+/**
+ * @brief Shut a pool down, running the queued tasks, then delete it
+ * @warning Must not be called from a task of the pool
+ * @param poolAddr Address of the pointer on the pool, set to NULL
+ * @see ARSAL_ThreadPool_New (), ARSAL_ThreadPool_Shutdown ()
+ */
+void ARSAL_ThreadPool_Delete(ARSAL_ThreadPool_t **poolAddr);
+
+/**
+ * @brief Queue a task, run by the first available worker
+ * @param pool The pool
+ * @param task The task
+ * @param customData The custom data given to the task
+ * @param future The future completed with the result of the task, NULL if the completion is not needed. It is initialized by the call, and completed with ARSAL_ERROR_CANCELED if the task is dropped, or with the error returned if it is not queued.
+ * It must stay valid until it completes, which ARSAL_ThreadPool_Delete () guarantees.
+ * @return ARSAL_OK, ARSAL_ERROR_CANCELED if the pool is shut down, ARSAL_ERROR_SYSTEM if the pool has no worker and none can be started, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_ThreadPool_Submit(ARSAL_ThreadPool_t *pool, ARSAL_ThreadPool_Task_t task, void *customData, ARSAL_Future_t *future);
+
+/**
+ * @brief Stop a pool and wait for its workers to exit
+ * @note The tasks submitted afterwards are refused. The tasks being run complete.
+ * @warning Must not be called from a task of the pool
+ * @param pool The pool
+ * @param drain 1 to run the queued tasks before the workers exit, 0 to drop them, their futures completing with ARSAL_ERROR_CANCELED
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_ThreadPool_Shutdown(ARSAL_ThreadPool_t *pool, int drain);
+
+/**
+ * @brief Get the counters of a pool
+ * @param pool The pool
+ * @param[out] metrics The counters
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_ThreadPool_GetMetrics(ARSAL_ThreadPool_t *pool, ARSAL_ThreadPool_Metrics_t *metrics);
+
+#endif /* _ARSAL_THREADPOOL_H_ */
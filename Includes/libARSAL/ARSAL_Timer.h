@@ -0,0 +1,144 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Timer.h
+ * @brief libARSAL timer service: one-shot and periodic timers run by a single thread on a hierarchical timing wheel.
+ **/
+
+#ifndef _ARSAL_TIMER_H_
+#define _ARSAL_TIMER_H_
+
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_ThreadPool.h>
+
+/**
+ * @brief Default duration of a tick of the wheel, in milliseconds
+ */
+#define ARSAL_TIMER_DEFAULT_RESOLUTION_MS   (1)
+
+/**
+ * @brief Identifier never given to a timer
+ */
+#define ARSAL_TIMER_INVALID_ID              (0)
+
+/**
+ * @brief Timer service
+ * @see ARSAL_Timer_New ()
+ */
+typedef struct _ARSAL_Timer_t ARSAL_Timer_t;
+
+/**
+ * @brief Identifier of a timer, stays invalid once the timer is fired or canceled
+ * @see ARSAL_Timer_Add ()
+ */
+typedef uint64_t ARSAL_Timer_Id_t;
+
+/**
+ * @brief Callback of a timer
+ * @param customData The custom data given to ARSAL_Timer_Add ()
+ */
+typedef void (*ARSAL_Timer_Callback_t) (void *customData);
+
+/**
+ * @brief Configuration of a timer service
+ */
+typedef struct
+{
+    int resolutionMs; /**< Duration of a tick, the delays are rounded up to, 0 for ARSAL_TIMER_DEFAULT_RESOLUTION_MS */
+    ARSAL_ThreadPool_t *pool; /**< Pool running the callbacks, NULL to run them on the timer thread. Must outlive the service */
+    const ARSAL_Thread_Attr_t *threadAttr; /**< Attributes of the timer thread, NULL for the defaults */
+} ARSAL_Timer_Config_t;
+
+/**
+ * @brief Counters of a timer service
+ * @note The drift of a timer is the delay between its expiry time and the time its callback is called or submitted to the pool, measured with ARSAL_Time_GetTime ()
+ * @see ARSAL_Timer_GetMetrics ()
+ */
+typedef struct
+{
+    int activeCount; /**< Timers armed */
+    uint64_t firedCount; /**< Callbacks called or submitted */
+    uint64_t canceledCount; /**< Timers canceled */
+    uint64_t overrunCount; /**< Periods of periodic timers skipped because the service was late */
+    uint32_t meanDriftUs; /**< Mean drift, in microseconds */
+    uint32_t maxDriftUs; /**< Highest drift, in microseconds */
+} ARSAL_Timer_Metrics_t;
+
+/**
+ * @brief Create a timer service and start its thread
+ * @param config The configuration of the service, NULL for the defaults
+ * @param[out] error Pointer on the error output
+ * @return Pointer on the new timer service, or NULL on error
+ * @see ARSAL_Timer_Delete ()
+ */
+ARSAL_Timer_t* ARSAL_Timer_New(const ARSAL_Timer_Config_t *config, eARSAL_ERROR *error);
+
+/**
+ * @brief Stop the thread of a timer service and delete it, the armed timers are dropped
+ * @warning Must not be called from a callback run on the timer thread
+ * @param timerAddr Address of the pointer on the timer service, set to NULL
+ */
+void ARSAL_Timer_Delete(ARSAL_Timer_t **timerAddr);
+
+/**
+ * @brief Arm a timer
+ * @note O(1): the timer is linked in the slot of the wheel of its expiry tick, the farthest ones on the coarser levels of the wheel, which are moved down when the wheel reaches them.
+ * @note A periodic timer is rearmed relative to its previous expiry, not to the call of its callback, so it does not drift. If the service is late by whole periods, they are skipped and counted as overruns.
+ * @param timer The timer service
+ * @param delayMs The delay before the first expiry, in milliseconds
+ * @param periodMs The period of the next expiries in milliseconds, 0 for a one-shot timer
+ * @param callback The callback
+ * @param customData The custom data given to the callback
+ * @param[out] id Pointer on the identifier of the timer, may be NULL
+ * @return ARSAL_OK, or another error of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_Timer_Add(ARSAL_Timer_t *timer, uint32_t delayMs, uint32_t periodMs, ARSAL_Timer_Callback_t callback, void *customData, ARSAL_Timer_Id_t *id);
+
+/**
+ * @brief Disarm a timer
+ * @note O(1). A callback already being run is not waited for.
+ * @param timer The timer service
+ * @param id The identifier of the timer
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER if the timer is unknown, already fired or canceled
+ */
+eARSAL_ERROR ARSAL_Timer_Cancel(ARSAL_Timer_t *timer, ARSAL_Timer_Id_t id);
+
+/**
+ * @brief Get the counters of a timer service
+ * @param timer The timer service
+ * @param[out] metrics The counters
+ * @return ARSAL_OK, or ARSAL_ERROR_BAD_PARAMETER
+ */
+eARSAL_ERROR ARSAL_Timer_GetMetrics(ARSAL_Timer_t *timer, ARSAL_Timer_Metrics_t *metrics);
+
+#endif /* _ARSAL_TIMER_H_ */
@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Watcher.h
+ * @brief libARSAL live directory hierarchy watcher.
+ **/
+
+#ifndef _ARSAL_WATCHER_H_
+#define _ARSAL_WATCHER_H_
+
+#include <libARSAL/ARSAL_Error.h>
+#include <libARSAL/ARSAL_Ftw.h>
+
+/**
+ * @brief Directory hierarchy watcher
+ * @see ARSAL_Watcher_New ()
+ */
+typedef struct _ARSAL_Watcher_t ARSAL_Watcher_t;
+
+/**
+ * @brief Kind of change reported by ARSAL_Watcher_ReadEvents ()
+ */
+typedef enum
+{
+    ARSAL_WATCHER_EVENT_ADDED = 0, /**< The entry was created, or moved into the hierarchy */
+    ARSAL_WATCHER_EVENT_REMOVED, /**< The entry was deleted, or moved out of the hierarchy */
+    ARSAL_WATCHER_EVENT_MODIFIED, /**< A file was closed after being written, or an entry was replaced */
+    ARSAL_WATCHER_EVENT_OVERFLOW, /**< Events were lost: the whole hierarchy must be walked again, for example with ARSAL_Snapshot_Update () */
+} eARSAL_WATCHER_EVENT;
+
+/**
+ * @brief Change event
+ * @note The path is only valid until the next call of ARSAL_Watcher_ReadEvents ()
+ */
+typedef struct
+{
+    const char *path; /**< The path of the entry, the directory given to ARSAL_Watcher_New () followed by the names of the entry and its parents */
+    eARSAL_WATCHER_EVENT event; /**< The kind of change */
+    eARSAL_FTW_TYPE type; /**< ARSAL_FTW_D for a directory, ARSAL_FTW_F otherwise */
+} ARSAL_Watcher_Event_t;
+
+/**
+ * @brief Create a watcher of a directory hierarchy
+ * @note The hierarchy is walked once to watch all its directories, the directories created or moved in afterwards are watched as they appear.
+ * @note Only available on Linux and Android (inotify), returns ARSAL_ERROR_SYSTEM on the other platforms
+ * @param dirPath The directory to watch
+ * @param[out] error The error code
+ * @return The watcher, or NULL on error
+ * @see ARSAL_Watcher_Delete ()
+ */
+ARSAL_Watcher_t* ARSAL_Watcher_New(const char *dirPath, eARSAL_ERROR *error);
+
+/**
+ * @brief Delete a watcher
+ * @param watcherAddr The address of the pointer on the watcher, set to NULL
+ * @see ARSAL_Watcher_New ()
+ */
+void ARSAL_Watcher_Delete(ARSAL_Watcher_t **watcherAddr);
+
+/**
+ * @brief Get the file descriptor of a watcher, to wait for its events with poll, select or epoll
+ * @note The descriptor becomes readable when changes are pending. It must only be read through ARSAL_Watcher_ReadEvents ().
+ * @param watcher The watcher
+ * @return The file descriptor, -1 if watcher is NULL
+ */
+int ARSAL_Watcher_GetFd(const ARSAL_Watcher_t *watcher);
+
+/**
+ * @brief Read the pending changes, without blocking
+ * @note The changes read at once are coalesced: an entry is reported once, with its resulting change (a file created then written is ADDED, a file created then deleted is not reported).
+ * @note The entries of a directory created or moved into the hierarchy are reported too. The entries of a directory moved out of the hierarchy are not.
+ * @note When the descriptor is readable, call it until it returns 0: the changes which did not fit in events are kept for the next call, but are not signaled by the descriptor.
+ * @param watcher The watcher
+ * @param[out] events The changes
+ * @param maxEvents The size of the events array
+ * @param[out] error The error code
+ * @return The number of changes written in events, 0 if none is pending or on error
+ */
+int ARSAL_Watcher_ReadEvents(ARSAL_Watcher_t *watcher, ARSAL_Watcher_Event_t *events, int maxEvents, eARSAL_ERROR *error);
+
+#endif /* _ARSAL_WATCHER_H_ */
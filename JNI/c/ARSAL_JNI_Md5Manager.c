@@ -48,6 +48,7 @@
 #include <jni.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <libARSAL/ARSAL_Sem.h>
 #include <libARSAL/ARSAL_Print.h>
@@ -63,6 +64,19 @@ jclass classARSALMd5 = NULL;
 jmethodID methodId_ARSALMd5_check = NULL;
 jmethodID methodId_ARSALMd5_compute = NULL;
 
+jclass classARSALMd5Listener = NULL;
+jmethodID methodId_ARSALMd5Listener_onMd5Progress = NULL;
+jmethodID methodId_ARSALMd5Listener_onMd5Completed = NULL;
+
+/**
+ * @brief Native context of an ARSALMd5Job
+ */
+typedef struct
+{
+    ARSAL_MD5_Job_t *job;
+    jobject jListener;
+} ARSAL_JNI_MD5_Job_t;
+
 
 int ARSAL_JNI_Md5Manager_NewARSALMd5_JNI(JNIEnv *env)
 {
@@ -118,6 +132,132 @@ int ARSAL_JNI_Md5Manager_NewARSALMd5_JNI(JNIEnv *env)
     return error;
 }
 
+int ARSAL_JNI_Md5Manager_NewARSALMd5Listener_JNI(JNIEnv *env)
+{
+    jclass localClassARSALMd5Listener = NULL;
+    int error = JNI_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    if (classARSALMd5Listener == NULL)
+    {
+        localClassARSALMd5Listener = (*env)->FindClass(env, "com/parrot/arsdk/arsal/ARSALMd5Listener");
+
+        if (localClassARSALMd5Listener == NULL)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "ARSALMd5Listener class not found");
+            error = JNI_FAILED;
+        }
+
+        if (error == JNI_OK)
+        {
+            classARSALMd5Listener = (*env)->NewGlobalRef(env, localClassARSALMd5Listener);
+
+            if (classARSALMd5Listener == NULL)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "ARSALMd5Listener global ref failed");
+                error = JNI_FAILED;
+            }
+        }
+
+        if (error == JNI_OK)
+        {
+            methodId_ARSALMd5Listener_onMd5Progress = (*env)->GetMethodID(env, classARSALMd5Listener, "onMd5Progress", "(JJF)V");
+
+            if (methodId_ARSALMd5Listener_onMd5Progress == NULL)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "onMd5Progress method not found");
+                error = JNI_FAILED;
+            }
+        }
+
+        if (error == JNI_OK)
+        {
+            methodId_ARSALMd5Listener_onMd5Completed = (*env)->GetMethodID(env, classARSALMd5Listener, "onMd5Completed", "(Lcom/parrot/arsdk/arsal/ARSAL_ERROR_ENUM;[B)V");
+
+            if (methodId_ARSALMd5Listener_onMd5Completed == NULL)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "onMd5Completed method not found");
+                error = JNI_FAILED;
+            }
+        }
+    }
+
+    return error;
+}
+
+void ARSAL_JNI_MD5_ProgressCallback(void *customData, uint64_t hashedSize, uint64_t totalSize, float rate)
+{
+    ARSAL_JNI_MD5_Job_t *jobContext = (ARSAL_JNI_MD5_Job_t *)customData;
+    JNIEnv *env = NULL;
+    jint jResultEnv = 0;
+
+    jResultEnv = (*ARSAL_JNI_Manager_VM)->GetEnv(ARSAL_JNI_Manager_VM, (void **) &env, JNI_VERSION_1_6);
+
+    if (jResultEnv == JNI_EDETACHED)
+    {
+         (*ARSAL_JNI_Manager_VM)->AttachCurrentThread(ARSAL_JNI_Manager_VM, &env, NULL);
+    }
+
+    if ((env != NULL) && (jobContext->jListener != NULL) && (methodId_ARSALMd5Listener_onMd5Progress != NULL))
+    {
+        (*env)->CallVoidMethod(env, jobContext->jListener, methodId_ARSALMd5Listener_onMd5Progress, (jlong)hashedSize, (jlong)totalSize, (jfloat)rate);
+    }
+
+    if ((jResultEnv == JNI_EDETACHED) && (env != NULL))
+    {
+         (*ARSAL_JNI_Manager_VM)->DetachCurrentThread(ARSAL_JNI_Manager_VM);
+    }
+}
+
+void ARSAL_JNI_MD5_CompletionCallback(void *customData, eARSAL_ERROR error, const uint8_t *md5, int md5Len)
+{
+    ARSAL_JNI_MD5_Job_t *jobContext = (ARSAL_JNI_MD5_Job_t *)customData;
+    JNIEnv *env = NULL;
+    jobject jError = NULL;
+    jbyteArray jMd5 = NULL;
+    jint jResultEnv = 0;
+
+    jResultEnv = (*ARSAL_JNI_Manager_VM)->GetEnv(ARSAL_JNI_Manager_VM, (void **) &env, JNI_VERSION_1_6);
+
+    if (jResultEnv == JNI_EDETACHED)
+    {
+         (*ARSAL_JNI_Manager_VM)->AttachCurrentThread(ARSAL_JNI_Manager_VM, &env, NULL);
+    }
+
+    if ((env != NULL) && (jobContext->jListener != NULL) && (methodId_ARSALMd5Listener_onMd5Completed != NULL))
+    {
+        jError = ARSAL_JNI_Manager_NewERROR_ENUM(env, error);
+
+        if (md5 != NULL)
+        {
+            jMd5 = (*env)->NewByteArray(env, md5Len);
+
+            if (jMd5 != NULL)
+            {
+                (*env)->SetByteArrayRegion(env, jMd5, 0, md5Len, (const jbyte *)md5);
+            }
+        }
+
+        (*env)->CallVoidMethod(env, jobContext->jListener, methodId_ARSALMd5Listener_onMd5Completed, jError, jMd5);
+
+        if (jError != NULL)
+        {
+            (*env)->DeleteLocalRef(env, jError);
+        }
+
+        if (jMd5 != NULL)
+        {
+            (*env)->DeleteLocalRef(env, jMd5);
+        }
+    }
+
+    if ((jResultEnv == JNI_EDETACHED) && (env != NULL))
+    {
+         (*ARSAL_JNI_Manager_VM)->DetachCurrentThread(ARSAL_JNI_Manager_VM);
+    }
+}
+
 eARSAL_ERROR ARSAL_JNI_MD5_Check(void *md5Object, const char *filePath, const char *md5Txt)
 {
     jobject jARSALMd5Object = (jobject)md5Object;
@@ -286,6 +426,11 @@ JNIEXPORT jboolean JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Manager_nativeSta
         error = ARSAL_JNI_Md5Manager_NewARSALMd5_JNI(env);
     }
 
+    if (error == JNI_OK)
+    {
+        error = ARSAL_JNI_Md5Manager_NewARSALMd5Listener_JNI(env);
+    }
+
     if (error == JNI_OK)
     {
         error = ARSAL_JNI_Manager_NewARSALExceptionJNI(env);
@@ -336,7 +481,7 @@ JNIEXPORT jlong JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Manager_nativeNew(JN
         ARSAL_JNI_Manager_ThrowARSALException(env, result);
     }
 
-    return (long)nativeManager;
+    return (jlong) (intptr_t) nativeManager;
 }
 
 JNIEXPORT void JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Manager_nativeDelete(JNIEnv *env, jobject jThis, jlong jManager)
@@ -494,3 +639,273 @@ JNIEXPORT jbyteArray JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Manager_nativeC
 
     return jMd5;
 }
+
+JNIEXPORT jlong JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Manager_nativeComputeAsync(JNIEnv *env, jobject jThis, jlong jManager, jstring jFilePath, jobject jListener, jint jProgressInterval)
+{
+    ARSAL_MD5_Manager_t *nativeManager = (ARSAL_MD5_Manager_t*) (intptr_t) jManager;
+    ARSAL_JNI_MD5_Job_t *jobContext = NULL;
+    const char *nativeFilePath = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    if (nativeManager == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        nativeFilePath = (*env)->GetStringUTFChars(env, jFilePath, 0);
+        if (nativeFilePath == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        jobContext = calloc(1, sizeof(ARSAL_JNI_MD5_Job_t));
+        if (jobContext == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if ((result == ARSAL_OK) && (jListener != NULL))
+    {
+        jobContext->jListener = (*env)->NewGlobalRef(env, jListener);
+        if (jobContext->jListener == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        jobContext->job = ARSAL_MD5_Manager_ComputeAsync(nativeManager, nativeFilePath,
+                                                         (jListener != NULL) ? ARSAL_JNI_MD5_ProgressCallback : NULL, jProgressInterval,
+                                                         (jListener != NULL) ? ARSAL_JNI_MD5_CompletionCallback : NULL, jobContext, &result);
+    }
+
+    if (nativeFilePath != NULL)
+    {
+        (*env)->ReleaseStringUTFChars(env, jFilePath, nativeFilePath);
+    }
+
+    if ((result != ARSAL_OK) && (jobContext != NULL))
+    {
+        if (jobContext->jListener != NULL)
+        {
+            (*env)->DeleteGlobalRef(env, jobContext->jListener);
+        }
+        free(jobContext);
+        jobContext = NULL;
+    }
+
+    if (result != ARSAL_OK)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_JNI_MD5_MANAGER_TAG, "error: %d occurred", result);
+
+        ARSAL_JNI_Manager_ThrowARSALException(env, result);
+    }
+
+    return (jlong) (intptr_t) jobContext;
+}
+
+JNIEXPORT jint JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Job_nativeCancel(JNIEnv *env, jobject jThis, jlong jJob)
+{
+    ARSAL_JNI_MD5_Job_t *jobContext = (ARSAL_JNI_MD5_Job_t*) (intptr_t) jJob;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    if (jobContext == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_Job_Cancel(jobContext->job);
+    }
+
+    return result;
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Job_nativeWait(JNIEnv *env, jobject jThis, jlong jJob)
+{
+    ARSAL_JNI_MD5_Job_t *jobContext = (ARSAL_JNI_MD5_Job_t*) (intptr_t) jJob;
+    uint8_t md5Hex[ARSAL_MD5_LENGTH];
+    eARSAL_ERROR result = ARSAL_OK;
+    jbyteArray jMd5 = NULL;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    if (jobContext == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_Job_Wait(jobContext->job, md5Hex, sizeof(md5Hex));
+    }
+
+    if (result == ARSAL_OK)
+    {
+        jMd5 = (*env)->NewByteArray(env, sizeof(md5Hex));
+
+        if (jMd5 == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        (*env)->SetByteArrayRegion(env, jMd5, 0, sizeof(md5Hex), (jbyte*)md5Hex);
+    }
+
+    if (result != ARSAL_OK)
+    {
+        ARSAL_JNI_Manager_ThrowARSALException(env, result);
+    }
+
+    return jMd5;
+}
+
+JNIEXPORT void JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Job_nativeDelete(JNIEnv *env, jobject jThis, jlong jJob)
+{
+    ARSAL_JNI_MD5_Job_t *jobContext = (ARSAL_JNI_MD5_Job_t*) (intptr_t) jJob;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    if (jobContext != NULL)
+    {
+        ARSAL_MD5_Job_Delete(&jobContext->job);
+
+        if (jobContext->jListener != NULL)
+        {
+            (*env)->DeleteGlobalRef(env, jobContext->jListener);
+        }
+
+        free(jobContext);
+    }
+}
+
+JNIEXPORT jlong JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Digest_nativeNew(JNIEnv *env, jobject jThis)
+{
+    ARSAL_MD5_Context_t *context = NULL;
+    eARSAL_ERROR error = ARSAL_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    context = ARSAL_MD5_Context_New(&error);
+
+    if (error != ARSAL_OK)
+    {
+        ARSAL_JNI_Manager_ThrowARSALException(env, error);
+    }
+
+    return (jlong) (intptr_t) context;
+}
+
+JNIEXPORT void JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Digest_nativeDelete(JNIEnv *env, jobject jThis, jlong jContext)
+{
+    ARSAL_MD5_Context_t *context = (ARSAL_MD5_Context_t*) (intptr_t) jContext;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARSAL_JNI_MD5_MANAGER_TAG, "%s", "");
+
+    ARSAL_MD5_Context_Delete(&context);
+}
+
+JNIEXPORT jint JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Digest_nativeReset(JNIEnv *env, jobject jThis, jlong jContext)
+{
+    ARSAL_MD5_Context_t *context = (ARSAL_MD5_Context_t*) (intptr_t) jContext;
+
+    return ARSAL_MD5_Context_Reset(context);
+}
+
+JNIEXPORT jint JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Digest_nativeUpdateBuffer(JNIEnv *env, jobject jThis, jlong jContext, jobject jBuffer, jint jOffset, jint jLength)
+{
+    ARSAL_MD5_Context_t *context = (ARSAL_MD5_Context_t*) (intptr_t) jContext;
+    eARSAL_ERROR result = ARSAL_OK;
+    uint8_t *data = NULL;
+    jlong capacity = 0;
+
+    if ((jBuffer == NULL) || (jOffset < 0) || (jLength < 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        /* Hash the buffer in place, only direct buffers have a stable native address */
+        data = (*env)->GetDirectBufferAddress(env, jBuffer);
+        capacity = (*env)->GetDirectBufferCapacity(env, jBuffer);
+
+        if ((data == NULL) || (capacity < 0) || ((jlong)jOffset + jLength > capacity))
+        {
+            result = ARSAL_ERROR_BAD_PARAMETER;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_Context_Update(context, data + jOffset, jLength);
+    }
+
+    return result;
+}
+
+JNIEXPORT jint JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Digest_nativeUpdateData(JNIEnv *env, jobject jThis, jlong jContext, jlong jData, jint jDataSize)
+{
+    ARSAL_MD5_Context_t *context = (ARSAL_MD5_Context_t*) (intptr_t) jContext;
+    uint8_t *data = (uint8_t*) (intptr_t) jData;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    if (jDataSize < 0)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_Context_Update(context, data, jDataSize);
+    }
+
+    return result;
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_parrot_arsdk_arsal_ARSALMd5Digest_nativeDigest(JNIEnv *env, jobject jThis, jlong jContext)
+{
+    ARSAL_MD5_Context_t *context = (ARSAL_MD5_Context_t*) (intptr_t) jContext;
+    uint8_t md5Hex[ARSAL_MD5_LENGTH];
+    eARSAL_ERROR result = ARSAL_OK;
+    jbyteArray jMd5 = NULL;
+
+    result = ARSAL_MD5_Context_Final(context, md5Hex, sizeof(md5Hex));
+
+    if (result == ARSAL_OK)
+    {
+        jMd5 = (*env)->NewByteArray(env, sizeof(md5Hex));
+
+        if (jMd5 == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        (*env)->SetByteArrayRegion(env, jMd5, 0, sizeof(md5Hex), (jbyte*)md5Hex);
+    }
+
+    if (result != ARSAL_OK)
+    {
+        ARSAL_JNI_Manager_ThrowARSALException(env, result);
+    }
+
+    return jMd5;
+}
@@ -0,0 +1,192 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+
+package com.parrot.arsdk.arsal;
+
+import java.nio.ByteBuffer;
+
+/**
+ * Native incremental md5 computation of in-memory data<br>
+ * The data of direct <code>ByteBuffer</code>s and <code>ARNativeData</code> is hashed in place, without copy
+ */
+public class ARSALMd5Digest
+{
+    /* Native Functions */
+    private native long nativeNew() throws ARSALException;
+    private native void nativeDelete(long jContext);
+    private native int nativeReset(long jContext);
+    private native int nativeUpdateBuffer(long jContext, ByteBuffer buffer, int offset, int length);
+    private native int nativeUpdateData(long jContext, long data, int dataSize);
+    private native byte[] nativeDigest(long jContext) throws ARSALException;
+
+    private long m_contextPtr;
+
+    /**
+     * Constructor
+     */
+    public ARSALMd5Digest() throws ARSALException
+    {
+        m_contextPtr = nativeNew();
+    }
+
+    /**
+     * Hash the remaining bytes of a direct buffer, from its position to its limit<br>
+     * The position of the buffer is moved to its limit
+     * @param buffer the direct buffer
+     * @throws ARSALException if the buffer is not direct
+     */
+    public void update(ByteBuffer buffer) throws ARSALException
+    {
+        int position = buffer.position();
+        int length = buffer.remaining();
+
+        update(buffer, position, length);
+        buffer.position(position + length);
+    }
+
+    /**
+     * Hash a part of a direct buffer, the position of the buffer is left unchanged
+     * @param buffer the direct buffer
+     * @param offset the offset of the data from the start of the buffer, in bytes
+     * @param length the size of the data, in bytes
+     * @throws ARSALException if the buffer is not direct or the range is out of the buffer
+     */
+    public void update(ByteBuffer buffer, int offset, int length) throws ARSALException
+    {
+        int resultCode = nativeUpdateBuffer(m_contextPtr, buffer, offset, length);
+
+        ARSAL_ERROR_ENUM result = ARSAL_ERROR_ENUM.getFromValue(resultCode);
+        if (result != ARSAL_ERROR_ENUM.ARSAL_OK)
+        {
+            throw new ARSALException(result);
+        }
+    }
+
+    /**
+     * Hash the used bytes of a native data
+     * @param data the native data
+     * @throws ARSALException if the native data is not valid
+     */
+    public void update(ARNativeData data) throws ARSALException
+    {
+        if ((data == null) || (!data.isValid()))
+        {
+            throw new ARSALException(ARSAL_ERROR_ENUM.ARSAL_ERROR_BAD_PARAMETER);
+        }
+
+        int resultCode = nativeUpdateData(m_contextPtr, data.getData(), data.getDataSize());
+
+        ARSAL_ERROR_ENUM result = ARSAL_ERROR_ENUM.getFromValue(resultCode);
+        if (result != ARSAL_ERROR_ENUM.ARSAL_OK)
+        {
+            throw new ARSALException(result);
+        }
+    }
+
+    /**
+     * Get the md5 of the data hashed so far, the digest is then reset for a new message
+     * @return the md5
+     */
+    public byte[] digest() throws ARSALException
+    {
+        return nativeDigest(m_contextPtr);
+    }
+
+    /**
+     * Discard the data hashed so far
+     */
+    public ARSAL_ERROR_ENUM reset()
+    {
+        int resultCode = nativeReset(m_contextPtr);
+
+        ARSAL_ERROR_ENUM result = ARSAL_ERROR_ENUM.getFromValue(resultCode);
+
+        return result;
+    }
+
+    /**
+     * Dispose
+     */
+    public void dispose()
+    {
+        if (m_contextPtr != 0)
+        {
+            nativeDelete(m_contextPtr);
+            m_contextPtr = 0;
+        }
+    }
+
+    /**
+     * Compute the md5 of the remaining bytes of a direct buffer, the position of the buffer is left unchanged
+     * @param buffer the direct buffer
+     * @return the md5
+     */
+    public static byte[] compute(ByteBuffer buffer) throws ARSALException
+    {
+        ARSALMd5Digest digest = new ARSALMd5Digest();
+        byte[] md5 = null;
+
+        try
+        {
+            digest.update(buffer, buffer.position(), buffer.remaining());
+            md5 = digest.digest();
+        }
+        finally
+        {
+            digest.dispose();
+        }
+
+        return md5;
+    }
+
+    /**
+     * Compute the md5 of the used bytes of a native data
+     * @param data the native data
+     * @return the md5
+     */
+    public static byte[] compute(ARNativeData data) throws ARSALException
+    {
+        ARSALMd5Digest digest = new ARSALMd5Digest();
+        byte[] md5 = null;
+
+        try
+        {
+            digest.update(data);
+            md5 = digest.digest();
+        }
+        finally
+        {
+            digest.dispose();
+        }
+
+        return md5;
+    }
+}
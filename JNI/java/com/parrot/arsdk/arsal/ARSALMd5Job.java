@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+
+package com.parrot.arsdk.arsal;
+
+/**
+ * Asynchronous md5 computation
+ * @see ARSALMd5Manager#computeAsync
+ */
+public class ARSALMd5Job
+{
+    /* Native Functions */
+    private native int nativeCancel(long jJob);
+    private native byte[] nativeWait(long jJob) throws ARSALException;
+    private native void nativeDelete(long jJob);
+
+    private long m_jobPtr;
+
+    ARSALMd5Job(long jobPtr)
+    {
+        m_jobPtr = jobPtr;
+    }
+
+    /**
+     * Request the cancellation of the job
+     * @return ARSAL_OK if the request was taken into account
+     */
+    public ARSAL_ERROR_ENUM cancel()
+    {
+        int resultCode = nativeCancel(m_jobPtr);
+
+        ARSAL_ERROR_ENUM result = ARSAL_ERROR_ENUM.getFromValue(resultCode);
+
+        return result;
+    }
+
+    /**
+     * Block until the job is done
+     * @return the computed md5
+     * @throws ARSALException if the job failed or was canceled
+     */
+    public byte[] waitCompletion() throws ARSALException
+    {
+        return nativeWait(m_jobPtr);
+    }
+
+    /**
+     * Dispose, cancels the job if it is still running and waits for its thread
+     * Must not be called from an {@link ARSALMd5Listener} callback, which runs on that thread
+     */
+    public void dispose()
+    {
+        if (m_jobPtr != 0)
+        {
+            nativeDelete(m_jobPtr);
+            m_jobPtr = 0;
+        }
+    }
+}
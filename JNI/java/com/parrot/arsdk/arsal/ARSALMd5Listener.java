@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+
+package com.parrot.arsdk.arsal;
+
+/**
+ * Listener of an asynchronous md5 computation
+ * The callbacks are called from the job thread, they must not call {@link ARSALMd5Job#dispose}, which waits for that thread
+ * @see ARSALMd5Manager#computeAsync
+ */
+public interface ARSALMd5Listener
+{
+    /**
+     * Called periodically while the file is hashed, from the job thread
+     * @param hashedSize number of bytes already hashed
+     * @param totalSize size of the file
+     * @param rate average hashing rate in MB/s
+     */
+    public void onMd5Progress (long hashedSize, long totalSize, float rate);
+
+    /**
+     * Called once the job is done, from the job thread
+     * @param error ARSAL_OK, ARSAL_ERROR_CANCELED or the error which occurred
+     * @param md5 the computed md5, null on error
+     */
+    public void onMd5Completed (ARSAL_ERROR_ENUM error, byte[] md5);
+}
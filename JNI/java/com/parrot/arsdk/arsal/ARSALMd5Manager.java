@@ -43,6 +43,7 @@ public class ARSALMd5Manager
     
     private native int nativeCheck(long jManager, String filePath, String md5Txt);
     private native byte[] nativeCompute(long jManager, String filePath) throws ARSALException;
+    private native long nativeComputeAsync(long jManager, String filePath, ARSALMd5Listener listener, int progressInterval) throws ARSALException;
     
     private long m_managerPtr;
     private boolean m_initOk;
@@ -119,6 +120,20 @@ public class ARSALMd5Manager
     {
         return nativeCompute(m_managerPtr, filePath);
     }
+    
+    /**
+     * Compute the md5 of a file without blocking the caller
+     * @param filePath the file to hash
+     * @param listener the listener notified of the progress and completion, may be null
+     * @param progressInterval minimum interval between two progress notifications, in ms
+     * @return the job, which must be disposed once done
+     */
+    public ARSALMd5Job computeAsync(String filePath, ARSALMd5Listener listener, int progressInterval) throws ARSALException
+    {
+        long jobPtr = nativeComputeAsync(m_managerPtr, filePath, listener, progressInterval);
+        
+        return new ARSALMd5Job(jobPtr);
+    }
 }
     
 
@@ -0,0 +1,968 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_DirIter.c
+ * @brief libARSAL pull based directory hierarchy iterator, also the walk core of ARSAL_Ftw.
+ **/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* statx */
+#endif
+
+#include <config.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
+
+#include "libARSAL/ARSAL_DirIter.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "ARSAL_PathFilter.h"
+
+#define ARSAL_DIRITER_TAG   "DirIter"
+
+#ifdef DT_UNKNOWN
+#define ARSAL_DIRITER_DIRENT_TYPE(ent)  ((ent)->d_type)
+#else
+/* No d_type in struct dirent: every entry is stated */
+#define DT_UNKNOWN  0
+#define DT_FIFO     1
+#define DT_CHR      2
+#define DT_DIR      4
+#define DT_BLK      6
+#define DT_REG      8
+#define DT_LNK      10
+#define DT_SOCK     12
+#define ARSAL_DIRITER_DIRENT_TYPE(ent)  (DT_UNKNOWN)
+#endif
+
+/**
+ * Directory being walked
+ */
+typedef struct
+{
+    DIR *dir; /**< Open stream, NULL once closed to honor the maxOpenDirs budget */
+    char *names; /**< Entries left to walk once the stream is closed, each one is its d_type byte followed by its '\0' terminated name */
+    size_t namesSize;
+    size_t namesCapacity;
+    size_t namesPos;
+    int buffered; /**< The entries are read from names even though the stream is open, it only serves the relative opens and stats */
+    size_t pathLen; /**< Length of the path of the directory in the path buffer */
+} ARSAL_DirIter_Level_t;
+
+/**
+ * Walk state, the path buffer and the levels are reused for all the entries
+ */
+struct _ARSAL_DirIter_t
+{
+    int statMask;
+    int noStatx;
+    int maxOpenDirs;
+    int openCount;
+    char *path;
+    size_t pathCapacity;
+    size_t rootLen;
+    ARSAL_DirIter_Level_t *levels;
+    int levelCapacity;
+    int depth; /**< Index of the deepest level, -1 once the walk is over */
+    int started;
+    DIR *pending; /**< Stream of the directory last returned, pushed on the next call unless skipped */
+    size_t pendingPathLen;
+    const ARSAL_PathFilter_t *filter;
+    int sorted;
+    char *sortNames; /**< Spare names buffer, swapped with the one of each directory sorted */
+    size_t sortNamesCapacity;
+    const char **sortIndex;
+    size_t sortIndexCapacity;
+    ARSAL_DirIter_Entry_t entry;
+};
+
+static int ARSAL_DirIter_EnsurePath (ARSAL_DirIter_t *iter, size_t size)
+{
+    char *path;
+    size_t capacity;
+    int retVal = 0;
+
+    if (size > iter->pathCapacity)
+    {
+        capacity = (iter->pathCapacity > 0) ? iter->pathCapacity : 256;
+        while (capacity < size)
+        {
+            capacity *= 2;
+        }
+        path = realloc (iter->path, capacity);
+        if (path == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to realloc buffer");
+            retVal = -1;
+        }
+        else
+        {
+            iter->path = path;
+            iter->pathCapacity = capacity;
+        }
+    }
+    // No else --> No need to realloc in this case
+
+    return retVal;
+}
+
+/**
+ * Read the remaining entries of the stream of a directory in its names buffer
+ */
+static int ARSAL_DirIter_ReadAll (ARSAL_DirIter_Level_t *level)
+{
+    struct dirent *ent;
+    size_t nameSize;
+    size_t capacity;
+    char *names;
+    int retVal = 0;
+
+    while ((retVal == 0) && ((ent = readdir (level->dir)) != NULL))
+    {
+        if ((ent->d_name[0] == '.') &&
+            ((ent->d_name[1] == '\0') || ((ent->d_name[1] == '.') && (ent->d_name[2] == '\0'))))
+        {
+            // Skip "." and ".."
+            continue;
+        }
+        // No else --> Keep the entry
+
+        nameSize = strlen (ent->d_name) + 2;
+        if (level->namesSize + nameSize > level->namesCapacity)
+        {
+            capacity = (level->namesCapacity > 0) ? level->namesCapacity : 1024;
+            while (capacity < level->namesSize + nameSize)
+            {
+                capacity *= 2;
+            }
+            names = realloc (level->names, capacity);
+            if (names == NULL)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to realloc buffer");
+                retVal = -1;
+            }
+            else
+            {
+                level->names = names;
+                level->namesCapacity = capacity;
+            }
+        }
+        // No else --> No need to realloc in this case
+
+        if (retVal == 0)
+        {
+            level->names[level->namesSize] = ARSAL_DIRITER_DIRENT_TYPE (ent);
+            memcpy (&level->names[level->namesSize + 1], ent->d_name, nameSize - 1);
+            level->namesSize += nameSize;
+        }
+        // No else --> Processing block
+    }
+
+    return retVal;
+}
+
+/**
+ * Close the stream of the shallowest open directory to free a descriptor, its remaining entries are kept in memory
+ */
+static int ARSAL_DirIter_Evict (ARSAL_DirIter_t *iter)
+{
+    ARSAL_DirIter_Level_t *level = NULL;
+    int retVal = 0;
+    int i;
+
+    for (i = 0; (level == NULL) && (i <= iter->depth); i++)
+    {
+        if (iter->levels[i].dir != NULL)
+        {
+            level = &iter->levels[i];
+        }
+        // No else --> Already closed
+    }
+
+    if ((level != NULL) && (!level->buffered))
+    {
+        retVal = ARSAL_DirIter_ReadAll (level);
+    }
+    // No else --> Nothing to read
+
+    if ((level != NULL) && (retVal == 0))
+    {
+        closedir (level->dir);
+        level->dir = NULL;
+        iter->openCount--;
+    }
+    // No else --> Nothing to close
+
+    return retVal;
+}
+
+/**
+ * Open a directory relatively to its parent stream when it is still open, by path otherwise
+ */
+static DIR* ARSAL_DirIter_OpenDir (ARSAL_DirIter_t *iter, ARSAL_DirIter_Level_t *parent, const char *name)
+{
+    DIR *dir = NULL;
+    int fd = -1;
+
+    if ((iter->openCount >= iter->maxOpenDirs) && (ARSAL_DirIter_Evict (iter) != 0))
+    {
+        return NULL;
+    }
+    // No else --> A descriptor is available
+
+    if ((parent != NULL) && (parent->dir != NULL))
+    {
+        fd = openat (dirfd (parent->dir), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    }
+    else
+    {
+        // Parent evicted, or root: a directory swapped for a symbolic link meanwhile is not followed either
+        fd = open (iter->path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    }
+
+    if (fd >= 0)
+    {
+        dir = fdopendir (fd);
+        if (dir == NULL)
+        {
+            close (fd);
+        }
+        else
+        {
+            iter->openCount++;
+        }
+    }
+    // No else --> Open error
+
+    if (dir == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to open dir %s", iter->path);
+    }
+    // No else --> Opened
+
+    return dir;
+}
+
+static int ARSAL_DirIter_CompareNames (const void *a, const void *b)
+{
+    // Skip the d_type bytes
+    return strcmp (*(const char * const *)a + 1, *(const char * const *)b + 1);
+}
+
+/**
+ * Read all the entries of a directory and sort them by name, they are then walked from the names buffer
+ */
+static int ARSAL_DirIter_Sort (ARSAL_DirIter_t *iter, ARSAL_DirIter_Level_t *level)
+{
+    const char **index;
+    size_t capacity;
+    size_t count = 0;
+    size_t pos;
+    size_t nameSize;
+    size_t i;
+    char *names;
+    int retVal;
+
+    retVal = ARSAL_DirIter_ReadAll (level);
+
+    for (pos = 0; (retVal == 0) && (pos < level->namesSize); pos += strlen (&level->names[pos + 1]) + 2)
+    {
+        if (count >= iter->sortIndexCapacity)
+        {
+            capacity = (iter->sortIndexCapacity > 0) ? iter->sortIndexCapacity * 2 : 256;
+            index = realloc (iter->sortIndex, capacity * sizeof (const char *));
+            if (index == NULL)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to realloc buffer");
+                retVal = -1;
+                break;
+            }
+            // No else --> Realloc check
+            iter->sortIndex = index;
+            iter->sortIndexCapacity = capacity;
+        }
+        // No else --> No need to realloc in this case
+        iter->sortIndex[count++] = &level->names[pos];
+    }
+
+    if ((retVal == 0) && (iter->sortNamesCapacity < level->namesSize))
+    {
+        names = realloc (iter->sortNames, level->namesCapacity);
+        if (names == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to realloc buffer");
+            retVal = -1;
+        }
+        else
+        {
+            iter->sortNames = names;
+            iter->sortNamesCapacity = level->namesCapacity;
+        }
+    }
+    // No else --> No need to realloc in this case
+
+    if (retVal == 0)
+    {
+        qsort (iter->sortIndex, count, sizeof (const char *), ARSAL_DirIter_CompareNames);
+
+        // Copy the entries in order to the spare buffer, which then becomes the names buffer of the directory
+        for (pos = 0, i = 0; i < count; i++)
+        {
+            nameSize = strlen (iter->sortIndex[i] + 1) + 2;
+            memcpy (&iter->sortNames[pos], iter->sortIndex[i], nameSize);
+            pos += nameSize;
+        }
+
+        names = level->names;
+        capacity = level->namesCapacity;
+        level->names = iter->sortNames;
+        level->namesCapacity = iter->sortNamesCapacity;
+        iter->sortNames = names;
+        iter->sortNamesCapacity = capacity;
+        level->buffered = 1;
+    }
+    // No else --> Processing block
+
+    return retVal;
+}
+
+/**
+ * Push an open directory on the walk stack
+ */
+static int ARSAL_DirIter_Push (ARSAL_DirIter_t *iter, DIR *dir, size_t pathLen)
+{
+    ARSAL_DirIter_Level_t *levels;
+    int capacity;
+    int retVal = 0;
+
+    if (iter->depth + 1 >= iter->levelCapacity)
+    {
+        capacity = (iter->levelCapacity > 0) ? iter->levelCapacity * 2 : 16;
+        levels = realloc (iter->levels, capacity * sizeof (ARSAL_DirIter_Level_t));
+        if (levels == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to realloc buffer");
+            retVal = -1;
+        }
+        else
+        {
+            memset (&levels[iter->levelCapacity], 0, (capacity - iter->levelCapacity) * sizeof (ARSAL_DirIter_Level_t));
+            iter->levels = levels;
+            iter->levelCapacity = capacity;
+        }
+    }
+    // No else --> No need to realloc in this case
+
+    if (retVal == 0)
+    {
+        iter->depth++;
+        iter->levels[iter->depth].dir = dir;
+        iter->levels[iter->depth].namesSize = 0;
+        iter->levels[iter->depth].namesPos = 0;
+        iter->levels[iter->depth].buffered = 0;
+        iter->levels[iter->depth].pathLen = pathLen;
+
+        if ((iter->sorted) && (ARSAL_DirIter_Sort (iter, &iter->levels[iter->depth]) != 0))
+        {
+            // Not pushed, the caller keeps the stream
+            iter->levels[iter->depth].dir = NULL;
+            iter->depth--;
+            retVal = -1;
+        }
+        // No else --> Walk the entries in the order of the stream, or sorted
+    }
+    // No else --> Processing block
+
+    return retVal;
+}
+
+/**
+ * Get the next entry of the deepest directory
+ * @param[out] type The d_type of the entry, DT_UNKNOWN if the file system does not provide it
+ * @return The entry name, or NULL at the end of the directory
+ */
+static const char* ARSAL_DirIter_ReadName (ARSAL_DirIter_Level_t *level, unsigned char *type)
+{
+    const char *name = NULL;
+    struct dirent *ent;
+
+    while (name == NULL)
+    {
+        if ((level->dir != NULL) && (!level->buffered))
+        {
+            ent = readdir (level->dir);
+            if (ent == NULL)
+            {
+                break;
+            }
+            // No else --> Got an entry
+            name = ent->d_name;
+            *type = ARSAL_DIRITER_DIRENT_TYPE (ent);
+        }
+        else
+        {
+            if (level->namesPos >= level->namesSize)
+            {
+                break;
+            }
+            // No else --> Got an entry
+            *type = (unsigned char)level->names[level->namesPos];
+            name = &level->names[level->namesPos + 1];
+            level->namesPos += strlen (name) + 2;
+        }
+
+        if ((name[0] == '.') &&
+            ((name[1] == '\0') || ((name[1] == '.') && (name[2] == '\0'))))
+        {
+            // Skip "." and ".."
+            name = NULL;
+        }
+        // No else --> Regular entry
+    }
+
+    return name;
+}
+
+/**
+ * Convert a d_type to the file type bits of st_mode
+ */
+static mode_t ARSAL_DirIter_DirentTypeToMode (unsigned char type)
+{
+    mode_t mode = 0;
+
+    switch (type)
+    {
+    case DT_DIR:
+        mode = S_IFDIR;
+        break;
+    case DT_REG:
+        mode = S_IFREG;
+        break;
+    case DT_LNK:
+        mode = S_IFLNK;
+        break;
+    case DT_FIFO:
+        mode = S_IFIFO;
+        break;
+    case DT_SOCK:
+        mode = S_IFSOCK;
+        break;
+    case DT_CHR:
+        mode = S_IFCHR;
+        break;
+    case DT_BLK:
+        mode = S_IFBLK;
+        break;
+    default:
+        break;
+    }
+
+    return mode;
+}
+
+/**
+ * Get the metadata of an entry, no more than the stat mask asks for
+ * @param level The directory of the entry
+ * @param name The entry name, the path buffer of the iterator holds its full path
+ * @param type The d_type of the entry
+ * @param[out] sb The metadata, the fields out of the stat mask are zeroed
+ * @return 0 on success, -1 otherwise
+ */
+static int ARSAL_DirIter_Stat (ARSAL_DirIter_t *iter, ARSAL_DirIter_Level_t *level, const char *name, unsigned char type, struct stat *sb)
+{
+    int dirFd = (level->dir != NULL) ? dirfd (level->dir) : AT_FDCWD;
+    const char *statPath = (level->dir != NULL) ? name : iter->path;
+    int done = 0;
+    int retVal = -1;
+#ifdef HAVE_STATX
+    struct statx stx;
+    unsigned int mask = STATX_TYPE | STATX_INO;
+#endif
+
+    if ((iter->statMask == ARSAL_FTW_STAT_TYPE) && (type != DT_UNKNOWN))
+    {
+        // The directory entry is enough
+        memset (sb, 0, sizeof (struct stat));
+        sb->st_mode = ARSAL_DirIter_DirentTypeToMode (type);
+        retVal = 0;
+        done = 1;
+    }
+    // No else --> Need the inode
+
+#ifdef HAVE_STATX
+    if ((!done) && (iter->statMask != ARSAL_FTW_STAT_ALL) && (!iter->noStatx))
+    {
+        if (iter->statMask & ARSAL_FTW_STAT_SIZE)
+        {
+            mask |= STATX_SIZE | STATX_BLOCKS;
+        }
+        if (iter->statMask & ARSAL_FTW_STAT_TIMES)
+        {
+            mask |= STATX_ATIME | STATX_MTIME | STATX_CTIME;
+        }
+        if (iter->statMask & ARSAL_FTW_STAT_OWNER)
+        {
+            mask |= STATX_MODE | STATX_NLINK | STATX_UID | STATX_GID;
+        }
+
+        retVal = statx (dirFd, statPath, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, mask, &stx);
+        if (retVal == 0)
+        {
+            memset (sb, 0, sizeof (struct stat));
+            sb->st_dev = makedev (stx.stx_dev_major, stx.stx_dev_minor);
+            sb->st_ino = stx.stx_ino;
+            sb->st_mode = stx.stx_mode & S_IFMT;
+            if (iter->statMask & ARSAL_FTW_STAT_SIZE)
+            {
+                sb->st_size = stx.stx_size;
+                sb->st_blksize = stx.stx_blksize;
+                sb->st_blocks = stx.stx_blocks;
+            }
+            if (iter->statMask & ARSAL_FTW_STAT_TIMES)
+            {
+                sb->st_atim.tv_sec = stx.stx_atime.tv_sec;
+                sb->st_atim.tv_nsec = stx.stx_atime.tv_nsec;
+                sb->st_mtim.tv_sec = stx.stx_mtime.tv_sec;
+                sb->st_mtim.tv_nsec = stx.stx_mtime.tv_nsec;
+                sb->st_ctim.tv_sec = stx.stx_ctime.tv_sec;
+                sb->st_ctim.tv_nsec = stx.stx_ctime.tv_nsec;
+            }
+            if (iter->statMask & ARSAL_FTW_STAT_OWNER)
+            {
+                sb->st_mode = stx.stx_mode;
+                sb->st_nlink = stx.stx_nlink;
+                sb->st_uid = stx.stx_uid;
+                sb->st_gid = stx.stx_gid;
+            }
+            done = 1;
+        }
+        else if ((errno == ENOSYS) || (errno == EPERM))
+        {
+            // Kernel without statx, or filtered out by a sandbox: stat the next entries directly
+            iter->noStatx = 1;
+        }
+        else
+        {
+            done = 1;
+        }
+    }
+    // No else --> Full stat
+#endif
+
+    if (!done)
+    {
+        retVal = fstatat (dirFd, statPath, sb, AT_SYMLINK_NOFOLLOW);
+    }
+    // No else --> Got the metadata, or a real error
+
+    return retVal;
+}
+
+/**
+ * Close the stream of the directory last returned, when it is not walked
+ */
+static void ARSAL_DirIter_ClosePending (ARSAL_DirIter_t *iter)
+{
+    if (iter->pending != NULL)
+    {
+        closedir (iter->pending);
+        iter->pending = NULL;
+        iter->openCount--;
+    }
+    // No else --> Close only if non-null
+}
+
+ARSAL_DirIter_t* ARSAL_DirIter_New(const char *dirPath, int maxOpenDirs, int statMask, eARSAL_ERROR *error)
+{
+    ARSAL_DirIter_t *iter = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    size_t pathLen = 0;
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "%s", dirPath ? dirPath : "null");
+
+    if ((dirPath == NULL) || (maxOpenDirs < 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        iter = calloc (1, sizeof (ARSAL_DirIter_t));
+        if (iter == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Allocated
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        iter->statMask = statMask;
+        iter->maxOpenDirs = (maxOpenDirs > 0) ? maxOpenDirs : ARSAL_DIRITER_DEFAULT_MAX_OPEN_DIRS;
+        iter->depth = -1;
+
+        pathLen = strlen (dirPath);
+        if (ARSAL_DirIter_EnsurePath (iter, pathLen + 1) != 0)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            memcpy (iter->path, dirPath, pathLen + 1);
+            iter->rootLen = pathLen;
+            iter->entry.path = iter->path;
+        }
+    }
+    // No else --> Processing block
+
+    if (result != ARSAL_OK)
+    {
+        ARSAL_DirIter_Delete (&iter);
+    }
+    // No else --> Keep the iterator
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return iter;
+}
+
+void ARSAL_DirIter_Delete(ARSAL_DirIter_t **iterAddr)
+{
+    ARSAL_DirIter_t *iter;
+    int i;
+
+    if ((iterAddr != NULL) && (*iterAddr != NULL))
+    {
+        iter = *iterAddr;
+
+        ARSAL_DirIter_ClosePending (iter);
+        for (; iter->depth >= 0; iter->depth--)
+        {
+            if (iter->levels[iter->depth].dir != NULL)
+            {
+                closedir (iter->levels[iter->depth].dir);
+            }
+            // No else --> Close only if non-null
+        }
+        for (i = 0; i < iter->levelCapacity; i++)
+        {
+            free (iter->levels[i].names);
+        }
+        free (iter->levels);
+        free (iter->sortIndex);
+        free (iter->sortNames);
+        free (iter->path);
+        free (iter);
+
+        *iterAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+/**
+ * Check the path of an entry against the filter of the iterator, before stating it
+ * @param pathLen The length of the path of the entry, in the path buffer
+ * @param relPath The path of the entry relative to the root
+ * @return 1 if the entry must be walked (directory) or can match (file), 0 if it is filtered out
+ */
+static int ARSAL_DirIter_FilterPath (ARSAL_DirIter_t *iter, size_t pathLen, const char *relPath, const char *name, int isDir, int depth)
+{
+    int retVal;
+
+    if (isDir)
+    {
+        // Temporarily end the path with a '/' to match it as a directory
+        iter->path[pathLen] = '/';
+        iter->path[pathLen + 1] = '\0';
+        retVal = ARSAL_PathFilter_CanDescend (iter->filter, relPath, depth);
+        iter->path[pathLen] = '\0';
+    }
+    else
+    {
+        retVal = ARSAL_PathFilter_MatchName (iter->filter, relPath, name, depth);
+    }
+
+    return retVal;
+}
+
+/**
+ * Stat the root of the walk, and open it if it is a directory
+ */
+static eARSAL_ERROR ARSAL_DirIter_Start (ARSAL_DirIter_t *iter)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    const char *name;
+
+    iter->started = 1;
+
+    if (lstat (iter->path, &iter->entry.sb) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to lstat %s", iter->path);
+        result = ARSAL_ERROR_FILE;
+    }
+    else if (S_ISDIR (iter->entry.sb.st_mode))
+    {
+        // As for the entries, a directory which cannot be opened is returned as ARSAL_FTW_DNR
+        iter->pending = ARSAL_DirIter_OpenDir (iter, NULL, NULL);
+        iter->pendingPathLen = iter->rootLen;
+    }
+    // No else --> Single file
+
+    if (result == ARSAL_OK)
+    {
+        iter->entry.type = (!S_ISDIR (iter->entry.sb.st_mode)) ? ARSAL_FTW_F : (iter->pending != NULL) ? ARSAL_FTW_D : ARSAL_FTW_DNR;
+        iter->entry.base = 0;
+        iter->entry.level = 0;
+        name = strrchr (iter->path, '/');
+        if ((name != NULL) && (name[1] != '\0'))
+        {
+            iter->entry.base = name + 1 - iter->path;
+        }
+        // No else --> No parent in the path
+    }
+    // No else --> Processing block
+
+    return result;
+}
+
+const ARSAL_DirIter_Entry_t* ARSAL_DirIter_Next(ARSAL_DirIter_t *iter, eARSAL_ERROR *error)
+{
+    const ARSAL_DirIter_Entry_t *entry = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_DirIter_Level_t *level;
+    const char *name;
+    unsigned char type = DT_UNKNOWN;
+    eARSAL_FTW_TYPE entryType;
+    size_t nameLen;
+
+    if (iter == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    else if (!iter->started)
+    {
+        result = ARSAL_DirIter_Start (iter);
+        entry = (result == ARSAL_OK) ? &iter->entry : NULL;
+        if ((entry != NULL) && (iter->filter != NULL) &&
+            ((entry->type != ARSAL_FTW_F) ||
+             (!ARSAL_PathFilter_MatchName (iter->filter, &iter->path[entry->base], &iter->path[entry->base], 0)) ||
+             (!ARSAL_PathFilter_MatchStat (iter->filter, &entry->sb))))
+        {
+            // Filtered walks only return files
+            entry = NULL;
+        }
+        // No else --> Return the root
+    }
+    // No else --> Walk
+
+    if ((result == ARSAL_OK) && (entry == NULL) && (iter->pending != NULL))
+    {
+        // Walk the entries of the directory last returned
+        if (ARSAL_DirIter_Push (iter, iter->pending, iter->pendingPathLen) != 0)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            iter->pending = NULL;
+        }
+    }
+    // No else --> Resume the deepest directory
+
+    while ((result == ARSAL_OK) && (entry == NULL) && (iter->depth >= 0))
+    {
+        level = &iter->levels[iter->depth];
+        name = ARSAL_DirIter_ReadName (level, &type);
+        if (name == NULL)
+        {
+            // End of the directory, back to its parent
+            if (level->dir != NULL)
+            {
+                closedir (level->dir);
+                level->dir = NULL;
+                iter->openCount--;
+            }
+            // No else --> Already closed
+            iter->depth--;
+            continue;
+        }
+        // No else --> Continue processing the current directory
+
+        nameLen = strlen (name);
+        if (ARSAL_DirIter_EnsurePath (iter, level->pathLen + nameLen + 3) != 0)
+        {
+            result = ARSAL_ERROR_ALLOC;
+            break;
+        }
+        // No else --> Path buffer is large enough
+        iter->path[level->pathLen] = '/';
+        memcpy (&iter->path[level->pathLen + 1], name, nameLen + 1);
+        iter->entry.path = iter->path;
+
+        if ((iter->filter != NULL) && (type != DT_UNKNOWN) &&
+            (!ARSAL_DirIter_FilterPath (iter, level->pathLen + nameLen + 1, &iter->path[iter->rootLen + 1], name, (type == DT_DIR), iter->depth + 1)))
+        {
+            // Filtered out before being stated
+            continue;
+        }
+        // No else --> Stat the entry
+
+        if (ARSAL_DirIter_Stat (iter, level, name, type, &iter->entry.sb) != 0)
+        {
+            // Removed meanwhile, or not allowed: returned as by nftw, and the walk goes on
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_DIRITER_TAG, "Unable to lstat %s", iter->path);
+            memset (&iter->entry.sb, 0, sizeof (struct stat));
+            entryType = ARSAL_FTW_NS;
+        }
+        else
+        {
+            entryType = (S_ISDIR (iter->entry.sb.st_mode)) ? ARSAL_FTW_D : ARSAL_FTW_F;
+        }
+
+        if ((iter->filter != NULL) &&
+            ((entryType == ARSAL_FTW_NS) ||
+             ((type == DT_UNKNOWN) && (!ARSAL_DirIter_FilterPath (iter, level->pathLen + nameLen + 1, &iter->path[iter->rootLen + 1], name, S_ISDIR (iter->entry.sb.st_mode), iter->depth + 1))) ||
+             ((!S_ISDIR (iter->entry.sb.st_mode)) && (!ARSAL_PathFilter_MatchStat (iter->filter, &iter->entry.sb)))))
+        {
+            // Filtered walks only return the files they could check
+            continue;
+        }
+        // No else --> Not filtered out
+
+        if (entryType == ARSAL_FTW_D)
+        {
+            iter->pending = ARSAL_DirIter_OpenDir (iter, level, name);
+            if (iter->pending == NULL)
+            {
+                // Not descended, returned as by nftw
+                if (iter->filter != NULL)
+                {
+                    continue;
+                }
+                // No else --> Return the directory
+                entryType = ARSAL_FTW_DNR;
+            }
+            else
+            {
+                iter->pendingPathLen = level->pathLen + nameLen + 1;
+
+                if (iter->filter != NULL)
+                {
+                    // Filtered walks only return files
+                    if (ARSAL_DirIter_Push (iter, iter->pending, iter->pendingPathLen) != 0)
+                    {
+                        result = ARSAL_ERROR_ALLOC;
+                        break;
+                    }
+                    // No else --> Walk it
+                    iter->pending = NULL;
+                    continue;
+                }
+                // No else --> Return the directory
+            }
+        }
+        // No else --> Not a directory
+
+        iter->entry.type = entryType;
+        iter->entry.base = level->pathLen + 1;
+        iter->entry.level = iter->depth + 1;
+        entry = &iter->entry;
+    }
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return entry;
+}
+
+eARSAL_ERROR ARSAL_DirIter_SkipSubtree(ARSAL_DirIter_t *iter)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+
+    if (iter == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    else
+    {
+        ARSAL_DirIter_ClosePending (iter);
+    }
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_DirIter_SetFilter(ARSAL_DirIter_t *iter, const ARSAL_PathFilter_t *filter)
+{
+    if ((iter == NULL) || (iter->started))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    iter->filter = filter;
+    if (filter != NULL)
+    {
+        iter->statMask |= ARSAL_PathFilter_GetStatMask (filter);
+    }
+    // No else --> No filter
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_DirIter_SetSorted(ARSAL_DirIter_t *iter, int sorted)
+{
+    if ((iter == NULL) || (iter->started))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    iter->sorted = sorted;
+
+    return ARSAL_OK;
+}
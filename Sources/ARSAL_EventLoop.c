@@ -0,0 +1,998 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_EventLoop.c
+ * @brief libARSAL event loop: file descriptor readiness, timers and cross-thread wakeups multiplexed on one thread.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_SYS_EVENTFD_H) && defined(HAVE_SYS_TIMERFD_H)
+#define ARSAL_EVENTLOOP_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
+
+#include "libARSAL/ARSAL_EventLoop.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Time.h"
+
+#define ARSAL_EVENTLOOP_TAG                 "EventLoop"
+
+#define ARSAL_EVENTLOOP_MAX_EVENTS          (256) /**< Events read by a single epoll_wait () */
+#define ARSAL_EVENTLOOP_MIN_CAPACITY        (64)
+
+/**
+ * Use of a file descriptor by the loop
+ */
+typedef enum
+{
+    ARSAL_EVENTLOOP_FD_NONE = 0,
+    ARSAL_EVENTLOOP_FD_IO, /**< Added by ARSAL_EventLoop_AddFd () */
+    ARSAL_EVENTLOOP_FD_TIMER, /**< timerfd of a timer */
+    ARSAL_EVENTLOOP_FD_WAKEUP, /**< eventfd or pipe of the wakeups */
+} eARSAL_EVENTLOOP_FD;
+
+/**
+ * A watched file descriptor, indexed by its number
+ */
+typedef struct
+{
+    eARSAL_EVENTLOOP_FD type;
+    uint32_t events; /**< Watched events, of eARSAL_EVENTLOOP_EVENT */
+    eARSAL_EVENTLOOP_MODE mode;
+    uint32_t sequence; /**< Changed at each add, to drop the events still pending for a removed file descriptor */
+    ARSAL_EventLoop_FdCallback_t callback;
+    void *customData;
+    uint32_t timerIndex; /**< Timer of a timerfd */
+    int pollIndex; /**< Index in the poll array */
+} ARSAL_EventLoop_Fd_t;
+
+/**
+ * A timer, indexed by the low half of its identifier
+ */
+typedef struct _ARSAL_EventLoop_Timer_t ARSAL_EventLoop_Timer_t;
+struct _ARSAL_EventLoop_Timer_t
+{
+    ARSAL_EventLoop_Timer_t *next; /**< Next timer of the free list */
+    uint32_t index;
+    uint32_t generation; /**< High half of the identifier, changed when the timer is released */
+    int active;
+    int fd; /**< timerfd, with epoll */
+    int64_t expiresUs; /**< Expiry time from ARSAL_Time_GetTime (), with poll */
+    int64_t periodUs;
+    ARSAL_EventLoop_Callback_t callback;
+    void *customData;
+};
+
+/**
+ * A function posted to the loop
+ */
+typedef struct _ARSAL_EventLoop_Post_t ARSAL_EventLoop_Post_t;
+struct _ARSAL_EventLoop_Post_t
+{
+    ARSAL_EventLoop_Callback_t callback;
+    void *customData;
+    ARSAL_EventLoop_Post_t *next;
+};
+
+#ifndef ARSAL_EVENTLOOP_EPOLL
+/**
+ * A ready file descriptor returned by poll (), copied before calling the callbacks which may change the poll array
+ */
+typedef struct
+{
+    int fd;
+    short revents;
+    uint32_t sequence;
+} ARSAL_EventLoop_Ready_t;
+#endif
+
+struct _ARSAL_EventLoop_t
+{
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    int epollFd;
+    int wakeupFd; /**< eventfd */
+#else
+    struct pollfd *pollFds;
+    int pollCount;
+    int pollCapacity;
+    ARSAL_EventLoop_Ready_t *ready;
+    int wakeupFds[2]; /**< Pipe, read from the loop */
+#endif
+    ARSAL_EventLoop_Fd_t *fds;
+    int fdCapacity;
+    uint32_t sequence;
+    ARSAL_EventLoop_Timer_t **timers;
+    uint32_t timerCount;
+    uint32_t timerCapacity;
+    ARSAL_EventLoop_Timer_t *freeTimers;
+    ARSAL_Mutex_t postMutex; /**< Protects the posted functions and wakeupPending */
+    ARSAL_EventLoop_Post_t *postHead;
+    ARSAL_EventLoop_Post_t *postTail;
+    int wakeupPending; /**< A wakeup is written and not read yet */
+    int stop;
+};
+
+/**
+ * Make the fd table big enough for a file descriptor
+ */
+static int ARSAL_EventLoop_GrowFds (ARSAL_EventLoop_t *loop, int fd)
+{
+    ARSAL_EventLoop_Fd_t *fds;
+    int capacity = (loop->fdCapacity > 0) ? loop->fdCapacity : ARSAL_EVENTLOOP_MIN_CAPACITY;
+
+    while (capacity <= fd)
+    {
+        capacity *= 2;
+    }
+
+    if (capacity > loop->fdCapacity)
+    {
+        fds = realloc (loop->fds, capacity * sizeof (ARSAL_EventLoop_Fd_t));
+        if (fds == NULL)
+        {
+            return -1;
+        }
+        // No else --> Alloc check
+        memset (fds + loop->fdCapacity, 0, (capacity - loop->fdCapacity) * sizeof (ARSAL_EventLoop_Fd_t));
+        loop->fds = fds;
+        loop->fdCapacity = capacity;
+    }
+    // No else --> Big enough
+
+    return 0;
+}
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+
+static uint32_t ARSAL_EventLoop_ToSystemEvents (uint32_t events, eARSAL_EVENTLOOP_MODE mode)
+{
+    uint32_t systemEvents = 0;
+
+    systemEvents |= (events & ARSAL_EVENTLOOP_EVENT_READ) ? (EPOLLIN | EPOLLRDHUP) : 0;
+    systemEvents |= (events & ARSAL_EVENTLOOP_EVENT_WRITE) ? EPOLLOUT : 0;
+    systemEvents |= (mode == ARSAL_EVENTLOOP_MODE_EDGE) ? EPOLLET : 0;
+
+    return systemEvents;
+}
+
+static uint32_t ARSAL_EventLoop_FromSystemEvents (uint32_t systemEvents)
+{
+    uint32_t events = 0;
+
+    events |= (systemEvents & EPOLLIN) ? ARSAL_EVENTLOOP_EVENT_READ : 0;
+    events |= (systemEvents & EPOLLOUT) ? ARSAL_EVENTLOOP_EVENT_WRITE : 0;
+    events |= (systemEvents & EPOLLERR) ? ARSAL_EVENTLOOP_EVENT_ERROR : 0;
+    events |= (systemEvents & (EPOLLHUP | EPOLLRDHUP)) ? ARSAL_EVENTLOOP_EVENT_HANGUP : 0;
+
+    return events;
+}
+
+static int ARSAL_EventLoop_Control (ARSAL_EventLoop_t *loop, int operation, int fd)
+{
+    struct epoll_event event;
+
+    memset (&event, 0, sizeof (event));
+    event.events = ARSAL_EventLoop_ToSystemEvents (loop->fds[fd].events, loop->fds[fd].mode);
+    event.data.u64 = ((uint64_t)loop->fds[fd].sequence << 32) | (uint32_t)fd;
+
+    return epoll_ctl (loop->epollFd, operation, fd, &event);
+}
+
+#else
+
+static short ARSAL_EventLoop_ToSystemEvents (uint32_t events, eARSAL_EVENTLOOP_MODE mode)
+{
+    short systemEvents = 0;
+
+    // No edge triggering with poll
+    (void)mode;
+    systemEvents |= (events & ARSAL_EVENTLOOP_EVENT_READ) ? POLLIN : 0;
+    systemEvents |= (events & ARSAL_EVENTLOOP_EVENT_WRITE) ? POLLOUT : 0;
+
+    return systemEvents;
+}
+
+static uint32_t ARSAL_EventLoop_FromSystemEvents (short systemEvents)
+{
+    uint32_t events = 0;
+
+    events |= (systemEvents & POLLIN) ? ARSAL_EVENTLOOP_EVENT_READ : 0;
+    events |= (systemEvents & POLLOUT) ? ARSAL_EVENTLOOP_EVENT_WRITE : 0;
+    events |= (systemEvents & (POLLERR | POLLNVAL)) ? ARSAL_EVENTLOOP_EVENT_ERROR : 0;
+    events |= (systemEvents & POLLHUP) ? ARSAL_EVENTLOOP_EVENT_HANGUP : 0;
+
+    return events;
+}
+
+#endif
+
+/**
+ * Watch a file descriptor of any type
+ */
+static eARSAL_ERROR ARSAL_EventLoop_Register (ARSAL_EventLoop_t *loop, int fd, eARSAL_EVENTLOOP_FD type, uint32_t events, eARSAL_EVENTLOOP_MODE mode)
+{
+    ARSAL_EventLoop_Fd_t *entry;
+#ifndef ARSAL_EVENTLOOP_EPOLL
+    struct pollfd *pollFds;
+    ARSAL_EventLoop_Ready_t *ready;
+    int capacity;
+#endif
+
+    if (ARSAL_EventLoop_GrowFds (loop, fd) != 0)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Alloc check
+
+    entry = &loop->fds[fd];
+    if (entry->type != ARSAL_EVENTLOOP_FD_NONE)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Not watched yet
+
+    entry->events = events;
+    entry->mode = mode;
+    entry->sequence = ++loop->sequence;
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    if (ARSAL_EventLoop_Control (loop, EPOLL_CTL_ADD, fd) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_EVENTLOOP_TAG, "Unable to watch the fd %d: %s", fd, strerror (errno));
+        return (errno == ENOMEM) ? ARSAL_ERROR_ALLOC : ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Watched
+#else
+    if (loop->pollCount == loop->pollCapacity)
+    {
+        capacity = (loop->pollCapacity > 0) ? loop->pollCapacity * 2 : ARSAL_EVENTLOOP_MIN_CAPACITY;
+        pollFds = realloc (loop->pollFds, capacity * sizeof (struct pollfd));
+        if (pollFds != NULL)
+        {
+            loop->pollFds = pollFds;
+        }
+        // No else --> Alloc error
+        ready = realloc (loop->ready, capacity * sizeof (ARSAL_EventLoop_Ready_t));
+        if (ready != NULL)
+        {
+            loop->ready = ready;
+        }
+        // No else --> Alloc error
+        if ((pollFds == NULL) || (ready == NULL))
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Alloc check
+        loop->pollCapacity = capacity;
+    }
+    // No else --> Room left
+
+    entry->pollIndex = loop->pollCount++;
+    loop->pollFds[entry->pollIndex].fd = fd;
+    loop->pollFds[entry->pollIndex].events = ARSAL_EventLoop_ToSystemEvents (events, mode);
+    loop->pollFds[entry->pollIndex].revents = 0;
+#endif
+
+    entry->type = type;
+
+    return ARSAL_OK;
+}
+
+static void ARSAL_EventLoop_Unregister (ARSAL_EventLoop_t *loop, int fd)
+{
+    ARSAL_EventLoop_Fd_t *entry = &loop->fds[fd];
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    epoll_ctl (loop->epollFd, EPOLL_CTL_DEL, fd, NULL);
+#else
+    // Move the last poll entry to the freed place
+    loop->pollCount--;
+    if (entry->pollIndex != loop->pollCount)
+    {
+        loop->pollFds[entry->pollIndex] = loop->pollFds[loop->pollCount];
+        loop->fds[loop->pollFds[entry->pollIndex].fd].pollIndex = entry->pollIndex;
+    }
+    // No else --> Was the last one
+#endif
+
+    memset (entry, 0, sizeof (ARSAL_EventLoop_Fd_t));
+}
+
+static void ARSAL_EventLoop_ReleaseTimer (ARSAL_EventLoop_t *loop, ARSAL_EventLoop_Timer_t *timer)
+{
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    ARSAL_EventLoop_Unregister (loop, timer->fd);
+    close (timer->fd);
+    timer->fd = -1;
+#endif
+    timer->active = 0;
+    timer->generation++;
+    if (timer->generation == 0)
+    {
+        timer->generation = 1;
+    }
+    // No else --> Never 0, so no identifier is ARSAL_EVENTLOOP_INVALID_TIMER_ID
+    timer->callback = NULL;
+    timer->customData = NULL;
+    timer->next = loop->freeTimers;
+    loop->freeTimers = timer;
+}
+
+/**
+ * Call the callback of an expired timer, releasing it first if it is a one-shot one
+ */
+static void ARSAL_EventLoop_FireTimer (ARSAL_EventLoop_t *loop, ARSAL_EventLoop_Timer_t *timer)
+{
+    ARSAL_EventLoop_Callback_t callback = timer->callback;
+    void *customData = timer->customData;
+
+    if (timer->periodUs == 0)
+    {
+        ARSAL_EventLoop_ReleaseTimer (loop, timer);
+    }
+    // No else --> Periodic, rearmed by the timerfd or by the caller
+
+    callback (loop, customData);
+}
+
+/**
+ * Run the posted functions, after a wakeup
+ */
+static void ARSAL_EventLoop_RunPosted (ARSAL_EventLoop_t *loop)
+{
+    ARSAL_EventLoop_Post_t *post;
+    ARSAL_EventLoop_Post_t *next;
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    uint64_t value;
+
+    while (read (loop->wakeupFd, &value, sizeof (value)) > 0);
+#else
+    char buffer[64];
+
+    while (read (loop->wakeupFds[0], buffer, sizeof (buffer)) > 0);
+#endif
+
+    ARSAL_Mutex_Lock (&loop->postMutex);
+    post = loop->postHead;
+    loop->postHead = NULL;
+    loop->postTail = NULL;
+    loop->wakeupPending = 0;
+    ARSAL_Mutex_Unlock (&loop->postMutex);
+
+    while (post != NULL)
+    {
+        next = post->next;
+        post->callback (loop, post->customData);
+        free (post);
+        post = next;
+    }
+}
+
+/**
+ * Handle the events of a ready file descriptor
+ * @param sequence The sequence of the file descriptor when it was ready
+ */
+static void ARSAL_EventLoop_Dispatch (ARSAL_EventLoop_t *loop, int fd, uint32_t sequence, uint32_t events)
+{
+    ARSAL_EventLoop_Fd_t *entry;
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    uint64_t expirations;
+#endif
+
+    if ((fd < 0) || (fd >= loop->fdCapacity) || (loop->fds[fd].type == ARSAL_EVENTLOOP_FD_NONE) || (loop->fds[fd].sequence != sequence))
+    {
+        // Removed by a previous callback
+        return;
+    }
+    // No else --> Still watched
+
+    entry = &loop->fds[fd];
+    switch (entry->type)
+    {
+    case ARSAL_EVENTLOOP_FD_IO:
+        events &= entry->events | ARSAL_EVENTLOOP_EVENT_ERROR | ARSAL_EVENTLOOP_EVENT_HANGUP;
+        if (events != 0)
+        {
+            entry->callback (loop, fd, events, entry->customData);
+        }
+        // No else --> Paused meanwhile
+        break;
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    case ARSAL_EVENTLOOP_FD_TIMER:
+        if (read (fd, &expirations, sizeof (expirations)) == sizeof (expirations))
+        {
+            ARSAL_EventLoop_FireTimer (loop, loop->timers[entry->timerIndex]);
+        }
+        // No else --> Rearmed meanwhile
+        break;
+#endif
+
+    case ARSAL_EVENTLOOP_FD_WAKEUP:
+        ARSAL_EventLoop_RunPosted (loop);
+        break;
+
+    default:
+        break;
+    }
+}
+
+#ifndef ARSAL_EVENTLOOP_EPOLL
+static int64_t ARSAL_EventLoop_GetTimeUs (void)
+{
+    struct timespec now;
+
+    ARSAL_Time_GetTime (&now);
+
+    return ((int64_t)now.tv_sec * 1000000) + (now.tv_nsec / 1000);
+}
+
+/**
+ * Time until the next expiry of a timer, to wait for in poll ()
+ */
+static int ARSAL_EventLoop_GetTimerTimeout (ARSAL_EventLoop_t *loop, int timeoutMs)
+{
+    int64_t nowUs = ARSAL_EventLoop_GetTimeUs ();
+    int64_t waitUs;
+    uint32_t i;
+
+    for (i = 0; i < loop->timerCount; i++)
+    {
+        if (loop->timers[i]->active)
+        {
+            waitUs = loop->timers[i]->expiresUs - nowUs;
+            waitUs = (waitUs > 0) ? (waitUs + 999) / 1000 : 0;
+            if ((timeoutMs < 0) || (waitUs < timeoutMs))
+            {
+                timeoutMs = (int)waitUs;
+            }
+            // No else --> Later than the timeout
+        }
+        // No else --> Free timer
+    }
+
+    return timeoutMs;
+}
+
+static void ARSAL_EventLoop_FireTimers (ARSAL_EventLoop_t *loop)
+{
+    ARSAL_EventLoop_Timer_t *timer;
+    int64_t nowUs = ARSAL_EventLoop_GetTimeUs ();
+    uint32_t i;
+
+    // The callbacks may add timers, the table is read again at each step
+    for (i = 0; i < loop->timerCount; i++)
+    {
+        timer = loop->timers[i];
+        if ((timer->active) && (timer->expiresUs <= nowUs))
+        {
+            if (timer->periodUs != 0)
+            {
+                // Rearmed relative to the expiry, the periods already past are called once
+                timer->expiresUs += ((nowUs - timer->expiresUs) / timer->periodUs + 1) * timer->periodUs;
+            }
+            // No else --> Released
+            ARSAL_EventLoop_FireTimer (loop, timer);
+        }
+        // No else --> Not expired
+    }
+}
+#endif
+
+ARSAL_EventLoop_t* ARSAL_EventLoop_New(eARSAL_ERROR *error)
+{
+    ARSAL_EventLoop_t *loop = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    int wakeupFd = -1;
+#ifndef ARSAL_EVENTLOOP_EPOLL
+    int i;
+#endif
+
+    loop = calloc (1, sizeof (ARSAL_EventLoop_t));
+    if (loop == NULL)
+    {
+        result = ARSAL_ERROR_ALLOC;
+    }
+    else if (ARSAL_Mutex_Init (&loop->postMutex) != 0)
+    {
+        free (loop);
+        loop = NULL;
+        result = ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+#ifdef ARSAL_EVENTLOOP_EPOLL
+        loop->epollFd = epoll_create1 (EPOLL_CLOEXEC);
+        loop->wakeupFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        wakeupFd = loop->wakeupFd;
+        if ((loop->epollFd < 0) || (loop->wakeupFd < 0))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_EVENTLOOP_TAG, "Unable to create the epoll and event fds: %s", strerror (errno));
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        // No else --> Created
+#else
+        if (pipe (loop->wakeupFds) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_EVENTLOOP_TAG, "Unable to create the wakeup pipe: %s", strerror (errno));
+            loop->wakeupFds[0] = -1;
+            loop->wakeupFds[1] = -1;
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            for (i = 0; i < 2; i++)
+            {
+                fcntl (loop->wakeupFds[i], F_SETFL, fcntl (loop->wakeupFds[i], F_GETFL) | O_NONBLOCK);
+                fcntl (loop->wakeupFds[i], F_SETFD, FD_CLOEXEC);
+            }
+            wakeupFd = loop->wakeupFds[0];
+        }
+#endif
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_EventLoop_Register (loop, wakeupFd, ARSAL_EVENTLOOP_FD_WAKEUP, ARSAL_EVENTLOOP_EVENT_READ, ARSAL_EVENTLOOP_MODE_LEVEL);
+    }
+    // No else --> Processing block
+
+    if ((result != ARSAL_OK) && (loop != NULL))
+    {
+        ARSAL_EventLoop_Delete (&loop);
+    }
+    // No else --> Keep the loop
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return loop;
+}
+
+void ARSAL_EventLoop_Delete(ARSAL_EventLoop_t **loopAddr)
+{
+    ARSAL_EventLoop_t *loop;
+    ARSAL_EventLoop_Post_t *post;
+    uint32_t i;
+
+    if ((loopAddr != NULL) && (*loopAddr != NULL))
+    {
+        loop = *loopAddr;
+
+        for (i = 0; i < loop->timerCount; i++)
+        {
+#ifdef ARSAL_EVENTLOOP_EPOLL
+            if (loop->timers[i]->active)
+            {
+                close (loop->timers[i]->fd);
+            }
+            // No else --> Already closed
+#endif
+            free (loop->timers[i]);
+        }
+        free (loop->timers);
+
+        while (loop->postHead != NULL)
+        {
+            post = loop->postHead;
+            loop->postHead = post->next;
+            free (post);
+        }
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+        if (loop->epollFd >= 0)
+        {
+            close (loop->epollFd);
+        }
+        // No else --> Not created
+        if (loop->wakeupFd >= 0)
+        {
+            close (loop->wakeupFd);
+        }
+        // No else --> Not created
+#else
+        if (loop->wakeupFds[0] >= 0)
+        {
+            close (loop->wakeupFds[0]);
+            close (loop->wakeupFds[1]);
+        }
+        // No else --> Not created
+        free (loop->pollFds);
+        free (loop->ready);
+#endif
+        free (loop->fds);
+        ARSAL_Mutex_Destroy (&loop->postMutex);
+        free (loop);
+
+        *loopAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+eARSAL_ERROR ARSAL_EventLoop_AddFd(ARSAL_EventLoop_t *loop, int fd, uint32_t events, eARSAL_EVENTLOOP_MODE mode, ARSAL_EventLoop_FdCallback_t callback, void *customData)
+{
+    eARSAL_ERROR result;
+
+    if ((loop == NULL) || (fd < 0) || (callback == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    result = ARSAL_EventLoop_Register (loop, fd, ARSAL_EVENTLOOP_FD_IO, events, mode);
+    if (result == ARSAL_OK)
+    {
+        loop->fds[fd].callback = callback;
+        loop->fds[fd].customData = customData;
+    }
+    // No else --> Not watched
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_ModifyFd(ARSAL_EventLoop_t *loop, int fd, uint32_t events)
+{
+    if ((loop == NULL) || (fd < 0) || (fd >= loop->fdCapacity) || (loop->fds[fd].type != ARSAL_EVENTLOOP_FD_IO))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    loop->fds[fd].events = events;
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    if (ARSAL_EventLoop_Control (loop, EPOLL_CTL_MOD, fd) != 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_EVENTLOOP_TAG, "Unable to modify the fd %d: %s", fd, strerror (errno));
+        return ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Modified
+#else
+    loop->pollFds[loop->fds[fd].pollIndex].events = ARSAL_EventLoop_ToSystemEvents (events, loop->fds[fd].mode);
+#endif
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_RemoveFd(ARSAL_EventLoop_t *loop, int fd)
+{
+    if ((loop == NULL) || (fd < 0) || (fd >= loop->fdCapacity) || (loop->fds[fd].type != ARSAL_EVENTLOOP_FD_IO))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_EventLoop_Unregister (loop, fd);
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_AddTimer(ARSAL_EventLoop_t *loop, uint32_t delayMs, uint32_t periodMs, ARSAL_EventLoop_Callback_t callback, void *customData, ARSAL_EventLoop_TimerId_t *id)
+{
+    ARSAL_EventLoop_Timer_t *timer;
+    ARSAL_EventLoop_Timer_t **timers;
+    eARSAL_ERROR result = ARSAL_OK;
+    uint32_t capacity;
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    struct itimerspec spec;
+#endif
+
+    if ((loop == NULL) || (callback == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    timer = loop->freeTimers;
+    if (timer != NULL)
+    {
+        loop->freeTimers = timer->next;
+    }
+    else
+    {
+        if (loop->timerCount == loop->timerCapacity)
+        {
+            capacity = (loop->timerCapacity > 0) ? loop->timerCapacity * 2 : ARSAL_EVENTLOOP_MIN_CAPACITY;
+            timers = realloc (loop->timers, capacity * sizeof (ARSAL_EventLoop_Timer_t *));
+            if (timers == NULL)
+            {
+                return ARSAL_ERROR_ALLOC;
+            }
+            // No else --> Alloc check
+            loop->timers = timers;
+            loop->timerCapacity = capacity;
+        }
+        // No else --> Room left
+
+        timer = calloc (1, sizeof (ARSAL_EventLoop_Timer_t));
+        if (timer == NULL)
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Alloc check
+        timer->index = loop->timerCount;
+        timer->generation = 1;
+        loop->timers[loop->timerCount++] = timer;
+    }
+
+    timer->periodUs = (int64_t)periodMs * 1000;
+    timer->callback = callback;
+    timer->customData = customData;
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    timer->fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer->fd < 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_EVENTLOOP_TAG, "Unable to create a timer fd: %s", strerror (errno));
+        result = ARSAL_ERROR_SYSTEM;
+    }
+    else
+    {
+        // A zero value would disarm the timer
+        memset (&spec, 0, sizeof (spec));
+        spec.it_value.tv_sec = delayMs / 1000;
+        spec.it_value.tv_nsec = (delayMs > 0) ? (long)(delayMs % 1000) * 1000000 : 1;
+        spec.it_interval.tv_sec = periodMs / 1000;
+        spec.it_interval.tv_nsec = (long)(periodMs % 1000) * 1000000;
+        if (timerfd_settime (timer->fd, 0, &spec, NULL) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            result = ARSAL_EventLoop_Register (loop, timer->fd, ARSAL_EVENTLOOP_FD_TIMER, ARSAL_EVENTLOOP_EVENT_READ, ARSAL_EVENTLOOP_MODE_LEVEL);
+        }
+
+        if (result != ARSAL_OK)
+        {
+            close (timer->fd);
+        }
+        else
+        {
+            loop->fds[timer->fd].timerIndex = timer->index;
+        }
+    }
+#else
+    timer->expiresUs = ARSAL_EventLoop_GetTimeUs () + (int64_t)delayMs * 1000;
+#endif
+
+    if (result == ARSAL_OK)
+    {
+        timer->active = 1;
+        if (id != NULL)
+        {
+            *id = ((ARSAL_EventLoop_TimerId_t)timer->generation << 32) | timer->index;
+        }
+        // No else --> Identifier not wanted
+    }
+    else
+    {
+        timer->callback = NULL;
+        timer->customData = NULL;
+        timer->next = loop->freeTimers;
+        loop->freeTimers = timer;
+    }
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_RemoveTimer(ARSAL_EventLoop_t *loop, ARSAL_EventLoop_TimerId_t id)
+{
+    ARSAL_EventLoop_Timer_t *timer;
+    uint32_t index = (uint32_t)(id & 0xFFFFFFFF);
+
+    if ((loop == NULL) || (index >= loop->timerCount))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    timer = loop->timers[index];
+    if ((!timer->active) || (timer->generation != (uint32_t)(id >> 32)))
+    {
+        // Fired, removed, or reused by another timer
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Active
+
+    ARSAL_EventLoop_ReleaseTimer (loop, timer);
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_Post(ARSAL_EventLoop_t *loop, ARSAL_EventLoop_Callback_t callback, void *customData)
+{
+    ARSAL_EventLoop_Post_t *post;
+    int wakeup;
+
+    if ((loop == NULL) || (callback == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    post = malloc (sizeof (ARSAL_EventLoop_Post_t));
+    if (post == NULL)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Alloc check
+    post->callback = callback;
+    post->customData = customData;
+    post->next = NULL;
+
+    ARSAL_Mutex_Lock (&loop->postMutex);
+    if (loop->postTail != NULL)
+    {
+        loop->postTail->next = post;
+    }
+    else
+    {
+        loop->postHead = post;
+    }
+    loop->postTail = post;
+    // A single wakeup for the functions posted until the loop runs them
+    wakeup = !loop->wakeupPending;
+    loop->wakeupPending = 1;
+    ARSAL_Mutex_Unlock (&loop->postMutex);
+
+    return wakeup ? ARSAL_EventLoop_Wakeup (loop) : ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_Wakeup(ARSAL_EventLoop_t *loop)
+{
+    ssize_t written;
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    uint64_t value = 1;
+#else
+    char value = 1;
+#endif
+
+    if (loop == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    written = write (loop->wakeupFd, &value, sizeof (value));
+#else
+    written = write (loop->wakeupFds[1], &value, sizeof (value));
+#endif
+
+    // EAGAIN: a wakeup is already pending
+    return ((written == sizeof (value)) || ((written < 0) && (errno == EAGAIN))) ? ARSAL_OK : ARSAL_ERROR_SYSTEM;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_RunOnce(ARSAL_EventLoop_t *loop, int timeoutMs)
+{
+    int count;
+    int i;
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    struct epoll_event events[ARSAL_EVENTLOOP_MAX_EVENTS];
+#endif
+
+    if (loop == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    count = epoll_wait (loop->epollFd, events, ARSAL_EVENTLOOP_MAX_EVENTS, timeoutMs);
+#else
+    count = poll (loop->pollFds, loop->pollCount, ARSAL_EventLoop_GetTimerTimeout (loop, timeoutMs));
+#endif
+    if (count < 0)
+    {
+        return (errno == EINTR) ? ARSAL_OK : ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Events, or timeout
+
+#ifdef ARSAL_EVENTLOOP_EPOLL
+    for (i = 0; i < count; i++)
+    {
+        ARSAL_EventLoop_Dispatch (loop, (int)(events[i].data.u64 & 0xFFFFFFFF), (uint32_t)(events[i].data.u64 >> 32),
+                                  ARSAL_EventLoop_FromSystemEvents (events[i].events));
+    }
+#else
+    // Copied first: the callbacks may change the poll array
+    count = 0;
+    for (i = 0; i < loop->pollCount; i++)
+    {
+        if (loop->pollFds[i].revents != 0)
+        {
+            loop->ready[count].fd = loop->pollFds[i].fd;
+            loop->ready[count].revents = loop->pollFds[i].revents;
+            loop->ready[count].sequence = loop->fds[loop->pollFds[i].fd].sequence;
+            count++;
+        }
+        // No else --> Not ready
+    }
+    for (i = 0; i < count; i++)
+    {
+        ARSAL_EventLoop_Dispatch (loop, loop->ready[i].fd, loop->ready[i].sequence, ARSAL_EventLoop_FromSystemEvents (loop->ready[i].revents));
+    }
+
+    ARSAL_EventLoop_FireTimers (loop);
+#endif
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_Run(ARSAL_EventLoop_t *loop)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+
+    if (loop == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    while ((result == ARSAL_OK) && (!__atomic_load_n (&loop->stop, __ATOMIC_ACQUIRE)))
+    {
+        result = ARSAL_EventLoop_RunOnce (loop, -1);
+    }
+    __atomic_store_n (&loop->stop, 0, __ATOMIC_RELAXED);
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_EventLoop_Stop(ARSAL_EventLoop_t *loop)
+{
+    if (loop == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    __atomic_store_n (&loop->stop, 1, __ATOMIC_RELEASE);
+
+    return ARSAL_EventLoop_Wakeup (loop);
+}
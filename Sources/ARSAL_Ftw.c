@@ -38,19 +38,20 @@
 #include <config.h>
 #include <sys/types.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
 #include "libARSAL/ARSAL_Ftw.h"
+#include "libARSAL/ARSAL_DirIter.h"
 #include "libARSAL/ARSAL_Print.h"
 
 #ifdef HAVE_FTW_H
 #define __USE_XOPEN_EXTENDED    1
 #include <ftw.h>
-#else
-#include <dirent.h>
-#include "ARSAL_Ftw.h"
 #endif
 
+#include "ARSAL_Ftw.h"
+
 #define ARSAL_FTW_TAG   "Ftw"
 
 #ifdef HAVE_FTW_H
@@ -77,241 +78,92 @@ int ARSAL_Nftw(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_F
     return ARSAL_Nftw_internal(dirpath, cb, nopenfd, flags, 0, 0);
 }
 
-static eARSAL_FTW_TYPE ARSAL_Ftw_typeFlagGet (struct stat *sb)
-{
-    if (S_ISDIR (sb->st_mode))
-    {
-        return ARSAL_FTW_D;
-    }
-    // No else --> We only handle files or directories
-    return ARSAL_FTW_F;
-}
+#endif /* HAVE_FTW_H */
 
 /**
- * fwt-like function
+ * Walk state
  */
-int ARSAL_Ftw_internal(const char *dirPath, ARSAL_FtwCallback cb, int nopenfd)
+typedef struct
 {
-    eARSAL_FTW_TYPE typeFlag;
-    struct stat sb;
-    int retVal = 0;
+    ARSAL_FtwCallback ftwCb;
+    ARSAL_NftwCallback nftwCb;
+    eARSAL_FTW_FLAG flags;
+    int retVal;
+} ARSAL_Ftw_Walker_t;
 
-    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "%s", dirPath ? dirPath : "null");
-
-    if (dirPath == NULL)
-    {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "dirPath is NULL !");
-        retVal = -1;
-    }
-    // No else --> Args check (setting retVal to -1 stops the processing)
+/**
+ * Call the user callback and analyse its return
+ */
+static eARSAL_FTW_ACTION ARSAL_Ftw_Walk_Visit (ARSAL_Ftw_Walker_t *walker, const ARSAL_DirIter_Entry_t *entry, int currentLevel, int currentBase)
+{
+    eARSAL_FTW_ACTION action = ARSAL_FTW_ACTION_CONTINUE;
+    ARSAL_FTW_t cbStruct = {currentBase + entry->base, currentLevel + entry->level};
+    int cbRet;
 
-    if (cb == NULL)
+    if (walker->nftwCb != NULL)
     {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "Callback is NULL !");
-        retVal = -1;
+        cbRet = walker->nftwCb (entry->path, &entry->sb, entry->type, &cbStruct);
     }
-    // No else --> Args check (setting retVal to -1 stops the processing)
-
-    if (nopenfd <= 0)
+    else
     {
-        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Not enough FD");
-        retVal = -1;
+        cbRet = walker->ftwCb (entry->path, &entry->sb, entry->type);
     }
-    // No else --> Args check (setting retVal to -1 stops the processing)
 
-    if (retVal == 0)
+    if (walker->flags == ARSAL_FTW_ACTIONRETVAL)
     {
-        // Call stat and the callback
-        retVal = lstat (dirPath, &sb);
-        if (retVal != 0)
+        if (cbRet == ARSAL_FTW_SKIP_SUBTREE)
         {
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to lstat");
+            action = ARSAL_FTW_ACTION_SKIP;
         }
-        else
+        else if (cbRet != ARSAL_FTW_CONTINUE)
         {
-            typeFlag = ARSAL_Ftw_typeFlagGet(&sb);
-
-            if (typeFlag != ARSAL_FTW_D)
-            {
-                retVal = cb (dirPath, &sb, typeFlag);
-                if (retVal != 0)
-                {
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
-                }
-                // No else --> Print only when the callback returns a non-zero status
-            }
-            // No else --> Directory handling is done afterwards
+            action = ARSAL_FTW_ACTION_STOP;
         }
+        // No else --> Continue
     }
-    // No else --> Processing block
-
-    // If we're searching a directory, call this on all this directory entries
-    if ((retVal == 0) && (typeFlag == ARSAL_FTW_D))
+    else if (cbRet != 0)
     {
-        // List the directory
-        DIR *dir = NULL;
-        struct dirent *ent;
-        char *newName = NULL;
-        int rootSize = strlen (dirPath);
-        int nameSize = rootSize + 2;
-
-        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "%s is a directory !", dirPath);
-        newName = (char*) malloc (nameSize);
-        if (newName == NULL)
-        {
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to alloc buffer for filename");
-            retVal = -1;
-        }
-        // No else --> Alloc check (setting retVal to -1 stops the processing)
-
-        if (retVal == 0)
-        {
-            strncpy (newName, dirPath, nameSize);
-            newName[rootSize] = '/';
-            if ((dir = opendir (dirPath)) == NULL)
-            {
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to open dir");
-                retVal = -1;
-            }
-            // No else --> Open check (setting retVal to -1 stops the processing)
-        }
-        // No else --> Processing block
-
-        if (retVal == 0)
-        {
-            retVal = cb (dirPath, &sb, typeFlag);
-            if (retVal != 0)
-            {
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
-            }
-            // No else --> Print only when the callback returns a non-zero status
-        }
-        // No else --> Processing block
-
-        while ((retVal == 0) && ((ent = readdir (dir)) != NULL))
-        {
-            int newNameSize;
-
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Working on file %s for dir %s", ent->d_name, dirPath);
-            if ((ent->d_name[0] == '.') && // first char is .
-                (((ent->d_name[1] == '.') && (ent->d_name[2] == '\0')) // second char is . (".."), or a null char (".")
-                 || (ent->d_name[1] == '\0'))) // Third char is null ("..")
-            {
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Skipping");
-                // Skip "." and ".."
-                continue;
-            }
-            // No else --> continue processing the current directory
-            newNameSize = rootSize + strlen (ent->d_name) + 2;
-            if (nameSize < newNameSize)
-            {
-                nameSize = newNameSize;
-                char *prevNewName = newName;
-                newName = (char*) realloc (newName, nameSize);
-                if (newName == NULL)
-                {
-                    retVal = -1;
-                    free (prevNewName);
-                    closedir (dir);
-                    dir = NULL;
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to realloc buffer");
-                }
-                // No else --> Realloc error handling (setting retVal to -1 stops the processing)
-            }
-            // No else --> No need to realloc in this case
-
-            if (retVal == 0)
-            {
-                strncpy (&newName[rootSize + 1], ent->d_name, strlen (ent->d_name) + 1);
-                retVal = ARSAL_Ftw_internal (newName, cb, nopenfd - 1);
-                if (retVal != 0)
-                {
-                    closedir (dir);
-                    dir = NULL;
-                    free (newName);
-                    newName = NULL;
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
-                }
-                // No else --> Recursive call error handling (stops the processing if the child stopped with an error code)
-            }
-            // No else --> Processing block
-        }
-
-        if (newName != NULL)
-        {
-            free (newName);
-            newName = NULL;
-        }
-        // No else --> Free only if non-null
-        if (dir != NULL)
-        {
-            closedir (dir);
-            dir = NULL;
-        }
-        // No else --> Close only if non-null
+        action = ARSAL_FTW_ACTION_STOP;
     }
-    // No else --> End of directory processing, files were processed before
-
-    return retVal;
-}
+    // No else --> Continue
 
-static eARSAL_FTW_RESULT ARSAL_Ftw_Nftw_retValTest (int retVal, eARSAL_FTW_FLAG flags, int isDir)
-{
-    eARSAL_FTW_RESULT testVal = ARSAL_FTW_FAIL;
-
-    if (flags == ARSAL_FTW_ACTIONRETVAL)
-    {
-        switch(retVal)
-        {
-        case ARSAL_FTW_CONTINUE:
-            testVal = ARSAL_FTW_OK;
-            break;
-        case ARSAL_FTW_SKIP_SUBTREE:
-            testVal = (isDir == 1) ? ARSAL_FTW_FAIL : ARSAL_FTW_OK;
-            break;
-        case ARSAL_FTW_STOP:
-            testVal = ARSAL_FTW_FAIL;
-            break;
-        default:
-            testVal = ARSAL_FTW_FAIL;
-            break;
-        }
-    }
-    else
+    if (action == ARSAL_FTW_ACTION_STOP)
     {
-        testVal = (retVal == 0) ? ARSAL_FTW_OK : ARSAL_FTW_FAIL;
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
+        walker->retVal = cbRet;
     }
-    return testVal;
+    // No else --> Keep walking
+
+    return action;
 }
 
 /**
- * nftw-like function
+ * Directory traversal core of the ftw/nftw-like functions, calling back on each entry of an ARSAL_DirIter
  */
-int ARSAL_Nftw_internal(const char *dirPath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags, int currentLevel, int currentBase)
+static int ARSAL_Ftw_Walk (const char *dirPath, ARSAL_FtwCallback ftwCb, ARSAL_NftwCallback nftwCb, int nopenfd, eARSAL_FTW_FLAG flags, int statMask, const ARSAL_PathFilter_t *filter, int sorted, int currentLevel, int currentBase)
 {
-    ARSAL_FTW_t cbStruct = {currentBase, currentLevel};
-    eARSAL_FTW_TYPE typeFlag;
-    struct stat sb;
+    ARSAL_Ftw_Walker_t walker;
+    ARSAL_DirIter_t *iter = NULL;
+    const ARSAL_DirIter_Entry_t *entry;
+    eARSAL_FTW_ACTION action;
+    eARSAL_ERROR error = ARSAL_OK;
     int retVal = 0;
 
     ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "%s", dirPath ? dirPath : "null");
 
-    if (dirPath == NULL)
-    {
-        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "dirPath is NULL !");
-        retVal = -1;
-    }
-    // No else --> Args check (setting retVal to -1 stops the processing)
+    memset (&walker, 0, sizeof (walker));
+    walker.ftwCb = ftwCb;
+    walker.nftwCb = nftwCb;
+    walker.flags = flags;
 
-    if (cb == NULL)
+    if ((dirPath == NULL) || ((ftwCb == NULL) && (nftwCb == NULL)))
     {
-        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback is NULL !");
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "Bad parameters !");
         retVal = -1;
     }
     // No else --> Args check (setting retVal to -1 stops the processing)
 
-    if (flags != ARSAL_FTW_NOFLAGS &&
-        flags != ARSAL_FTW_ACTIONRETVAL)
+    if ((flags != ARSAL_FTW_NOFLAGS) && (flags != ARSAL_FTW_ACTIONRETVAL))
     {
         ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unsupported flag !");
         retVal = -1;
@@ -327,146 +179,83 @@ int ARSAL_Nftw_internal(const char *dirPath, ARSAL_NftwCallback cb, int nopenfd,
 
     if (retVal == 0)
     {
-        // Call stat and the callback
-        retVal = lstat (dirPath, &sb);
-        if (retVal != 0)
-        {
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to lstat");
-        }
-        else
+        iter = ARSAL_DirIter_New (dirPath, nopenfd, statMask, &error);
+        if ((iter == NULL) || (ARSAL_DirIter_SetFilter (iter, filter) != ARSAL_OK) || (ARSAL_DirIter_SetSorted (iter, sorted) != ARSAL_OK))
         {
-            typeFlag = ARSAL_Ftw_typeFlagGet(&sb);
-
-            if (typeFlag != ARSAL_FTW_D)
-            {
-                retVal = cb (dirPath, &sb, typeFlag, &cbStruct);
-
-                if (ARSAL_Ftw_Nftw_retValTest(retVal, flags, typeFlag == ARSAL_FTW_D) == ARSAL_FTW_FAIL)
-                {
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
-                }
-                else
-                {
-                    retVal = 0;
-                }
-            }
-            // No else --> Directory handling is done afterwards
+            retVal = -1;
         }
+        // No else --> Iterator created
     }
     // No else --> Processing block
 
-    // If we're searching a directory, call this on all this directory entries
-    if ((retVal == 0) && (typeFlag == ARSAL_FTW_D))
+    while ((retVal == 0) && ((entry = ARSAL_DirIter_Next (iter, &error)) != NULL))
     {
-        // List the directory
-        DIR *dir = NULL;
-        struct dirent *ent;
-        char *newName = NULL;
-        int rootSize = strlen (dirPath);
-        int nameSize = rootSize + 2;
-
-        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "%s is a directory !", dirPath);
-        newName = (char*)malloc (nameSize);
-        if (newName == NULL)
-        {
-            retVal = -1;
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to alloc buffer for filename");
-        }
-        // No else --> Alloc check (setting retVal to -1 stops the processing)
-
-        if (retVal == 0)
+        action = ARSAL_Ftw_Walk_Visit (&walker, entry, currentLevel, currentBase);
+        if (action == ARSAL_FTW_ACTION_STOP)
         {
-            strncpy (newName, dirPath, nameSize);
-            newName[rootSize] = '/';
-            if ((dir = opendir (dirPath)) == NULL)
-            {
-                retVal = -1;
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to open dir");
-            }
-            // No else --> Open check (setting retVal to -1 stops the processing)
+            retVal = walker.retVal;
         }
-        // No else --> Processing block
-
-        if (retVal == 0)
+        else if (action == ARSAL_FTW_ACTION_SKIP)
         {
-            retVal = cb (dirPath, &sb, typeFlag, &cbStruct);
-            if (ARSAL_Ftw_Nftw_retValTest(retVal, flags, typeFlag == ARSAL_FTW_D) == ARSAL_FTW_FAIL)
-            {
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
-            }
-            else
-            {
-                retVal = 0;
-            }
+            ARSAL_DirIter_SkipSubtree (iter);
         }
-        // No else --> Processing block
+        // No else --> Continue
+    }
 
-        while ((retVal == 0) && (ent = readdir (dir)) != NULL)
-        {
-            int newNameSize;
-
-            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Working on file %s for dir %s", ent->d_name, dirPath);
-            if ((ent->d_name[0] == '.') && // first char is .
-                (((ent->d_name[1] == '.') && (ent->d_name[2] == '\0')) // second char is . (".."), or a null char (".")
-                 || (ent->d_name[1] == '\0'))) // Third char is null ("..")
-            {
-                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Skipping");
-                // Skip "." and ".."
-                continue;
-            }
-            // No else --> Continue processing the current directory
-            newNameSize = rootSize + strlen (ent->d_name) + 2;
-            if (nameSize < newNameSize)
-            {
-                nameSize = newNameSize;
-                char *prevNewName = newName;
-                newName = (char*)realloc (newName, nameSize);
-                if (newName == NULL)
-                {
-                    retVal = -1;
-                    free (prevNewName);
-                    closedir (dir);
-                    dir = NULL;
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to realloc buffer");
-                }
-                // No else --> Realloc error handling (setting retVal to -1 stops the processing)
-            }
-            // No else --> No need to realloc in this case
-
-            if (retVal == 0)
-            {
-                strncpy (&newName[rootSize + 1], ent->d_name, strlen (ent->d_name) + 1);
-                retVal = ARSAL_Nftw_internal (newName, cb, nopenfd - 1, flags, currentLevel + 1, strlen (dirPath) + 1);
-
-                if (ARSAL_Ftw_Nftw_retValTest (retVal, flags, 0) == ARSAL_FTW_FAIL)
-                {
-                    closedir (dir);
-                    dir = NULL;
-                    free (newName);
-                    newName = NULL;
-                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
-                }
-                else
-                {
-                    retVal = 0;
-                }
-            }
-            // No else --> Processing block
-        }
-        if (newName != NULL)
-        {
-            free (newName);
-        }
-        // No else --> Free only if non-null
-        if (dir != NULL)
-        {
-            closedir (dir);
-        }
-        // No else --> Close only if non-null
+    if ((retVal == 0) && (error != ARSAL_OK))
+    {
+        retVal = -1;
     }
-    // No else --> End of directory processing, files were processed before
+    // No else --> Walk over, or stopped
+
+    ARSAL_DirIter_Delete (&iter);
 
     return retVal;
 }
 
+int ARSAL_Ftw_WithStatMask(const char *dirpath, ARSAL_FtwCallback cb, int nopenfd, int statMask)
+{
+    return ARSAL_Ftw_Walk (dirpath, cb, NULL, nopenfd, ARSAL_FTW_NOFLAGS, statMask, NULL, 0, 0, 0);
+}
+
+int ARSAL_Nftw_WithStatMask(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags, int statMask)
+{
+    return ARSAL_Ftw_Walk (dirpath, NULL, cb, nopenfd, flags, statMask, NULL, 0, 0, 0);
+}
+
+int ARSAL_Nftw_Filtered(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags, const ARSAL_PathFilter_t *filter)
+{
+    return ARSAL_Ftw_Walk (dirpath, NULL, cb, nopenfd, flags, ARSAL_FTW_STAT_ALL, filter, 0, 0, 0);
+}
+
+int ARSAL_Nftw_Sorted(const char *dirpath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags)
+{
+    return ARSAL_Ftw_Walk (dirpath, NULL, cb, nopenfd, flags, ARSAL_FTW_STAT_ALL, NULL, 1, 0, 0);
+}
+
+#ifndef HAVE_FTW_H
+
+/**
+ * fwt-like function
+ */
+int ARSAL_Ftw_internal(const char *dirPath, ARSAL_FtwCallback cb, int nopenfd)
+{
+    return ARSAL_Ftw_Walk (dirPath, cb, NULL, nopenfd, ARSAL_FTW_NOFLAGS, ARSAL_FTW_STAT_ALL, NULL, 0, 0, 0);
+}
+
+/**
+ * nftw-like function
+ */
+int ARSAL_Nftw_internal(const char *dirPath, ARSAL_NftwCallback cb, int nopenfd, eARSAL_FTW_FLAG flags, int currentLevel, int currentBase)
+{
+    if (cb == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback is NULL !");
+        return -1;
+    }
+    // No else --> Args check
+
+    return ARSAL_Ftw_Walk (dirPath, NULL, cb, nopenfd, flags, ARSAL_FTW_STAT_ALL, NULL, 0, currentLevel, currentBase);
+}
+
 #endif /* HAVE_FTW_H */
@@ -38,6 +38,21 @@
 #ifndef _ARSAL_FTW_PRIVATE_H_
 #define _ARSAL_FTW_PRIVATE_H_
 
+/**
+ * Action to take after the analyse of an ARSAL_NftwCallback return
+ */
+typedef enum
+{
+    ARSAL_FTW_ACTION_CONTINUE = 0,
+    ARSAL_FTW_ACTION_SKIP,
+    ARSAL_FTW_ACTION_STOP,
+} eARSAL_FTW_ACTION;
+
+/**
+ * Maximum number of threads of the parallel walks
+ */
+#define ARSAL_FTW_PARALLEL_MAX_THREADS      (64)
+
 #ifdef HAVE_FTW_H
 //The ftw.h will provide all defined values
 #else
@@ -46,20 +61,11 @@
  * (Android as of ndk r7, r8, r9)
  */
 
-/**
- * Internal result values get from ARSAL_NftwCallback return analyse 
- */
-typedef enum 
-{
-    ARSAL_FTW_FAIL = 0,
-    ARSAL_FTW_OK,
-} eARSAL_FTW_RESULT;
-
 /**
  * @brief ftw-like function legacy support implementation, Recursively descends the directory hierarchy
  * @param dirpath The directory to descend
  * @param cb The callback recursively on each element of run through the directories
- * @param nopenfd The maximum number of directories depth
+ * @param nopenfd The maximum number of directories kept open at a time
  * @retval On success, returns 0. Otherwise, it returns -1, or callack user value
  * @see ftw standard documentation
  */
@@ -69,7 +75,7 @@ int ARSAL_Ftw_internal(const char *dirPath, ARSAL_FtwCallback cb, int nopenfd);
  * @brief nftw-like function legacy support implementation, recursively descends the directory hierarchy
  * @param dirpath The directory to descend
  * @param cb The callback recursively on each element of run through the directories
- * @param nopenfd The maximum number of directories depth
+ * @param nopenfd The maximum number of directories kept open at a time
  * @param flags The flag of the type of tree explore
  * @param currentLevel The current depth level, should be 0
  * @param currentBase The base depth level, should be 0
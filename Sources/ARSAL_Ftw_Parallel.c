@@ -0,0 +1,1210 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Ftw_Parallel.c
+ * @brief libARSAL parallel nftw-like walker, directories are listed concurrently by a work-stealing pool.
+ **/
+
+#include <config.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "libARSAL/ARSAL_Ftw.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Thread.h"
+#include "ARSAL_Ftw.h"
+
+#define ARSAL_FTW_TAG   "Ftw"
+
+#define ARSAL_FTW_PARALLEL_DEQUE_MIN_SIZE   (16)
+#define ARSAL_FTW_PARALLEL_MAX_READ_AHEAD   (256) /**< Directories listed by the workers and not delivered yet, ARSAL_FTW_ORDER_PREORDER */
+
+/**
+ * Stream of a directory, kept open while its subdirectories are waiting to be opened relatively to it
+ */
+typedef struct _ARSAL_Ftw_Dir_t ARSAL_Ftw_Dir_t;
+struct _ARSAL_Ftw_Dir_t
+{
+    DIR *stream;
+    int refCount; /**< The listing of the directory plus its subdirectories not opened yet */
+    int detached; /**< Freed with its stream (unordered modes), owned by the tree otherwise */
+};
+
+/**
+ * A directory to list (unordered modes)
+ */
+typedef struct
+{
+    ARSAL_Ftw_Dir_t dir;
+    ARSAL_Ftw_Dir_t *parent; /**< Directory to open it from, until opened. NULL for the top directory */
+    struct stat sb;
+    int base;
+    int level;
+    int length;
+    char path[]; /**< Path of the directory, its name starting at base */
+} ARSAL_Ftw_Branch_t;
+
+/**
+ * Entry of the tree read ahead by the workers in ARSAL_FTW_ORDER_PREORDER mode
+ */
+typedef struct _ARSAL_Ftw_Node_t ARSAL_Ftw_Node_t;
+struct _ARSAL_Ftw_Node_t
+{
+    ARSAL_Ftw_Dir_t dir;
+    ARSAL_Ftw_Node_t *parent;
+    ARSAL_Ftw_Node_t *children; /**< The entries of the directory, set once listed */
+    char *names; /**< The names of the entries, one after the other */
+    int name; /**< Offset of the name in the names of the parent */
+    int level;
+    eARSAL_FTW_TYPE type;
+    struct stat sb;
+    int childCount;
+    int listed; /**< The directory has been read, or discarded */
+    int skipped; /**< The directory contents are not needed anymore */
+    int unreadable; /**< The directory could not be opened */
+    int deque; /**< The deque its task was pushed to */
+};
+
+/**
+ * A directory to list
+ */
+typedef struct
+{
+    ARSAL_Ftw_Branch_t *branch; /**< Unordered modes */
+    ARSAL_Ftw_Node_t *node; /**< ARSAL_FTW_ORDER_PREORDER */
+} ARSAL_Ftw_Task_t;
+
+/**
+ * Task deque of a worker: the owner works depth first from the tail, thieves take the oldest, biggest, subtrees from the head
+ */
+typedef struct
+{
+    ARSAL_Ftw_Task_t *tasks;
+    int capacity;
+    int head;
+    int count;
+    ARSAL_Mutex_t mutex;
+} ARSAL_Ftw_Deque_t;
+
+typedef struct
+{
+    ARSAL_NftwCallback cb;
+    eARSAL_FTW_FLAG flags;
+    eARSAL_FTW_ORDER order;
+    int dequeCount;
+    ARSAL_Ftw_Deque_t *deques;
+    ARSAL_Mutex_t cbMutex;
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t workCond;
+    ARSAL_Cond_t listedCond;
+    int queued; /**< Tasks in the deques */
+    int pending; /**< Tasks in the deques or being processed */
+    int readAhead; /**< Directories listed and not delivered yet (ARSAL_FTW_ORDER_PREORDER), set under the mutex, read atomically */
+    int stop; /**< Set under the mutex, read atomically */
+    int retVal;
+    const char *rootPath;
+} ARSAL_Ftw_Walk_t;
+
+typedef struct
+{
+    ARSAL_Ftw_Walk_t *walk;
+    int index;
+    char *path; /**< Path of the entry being listed or delivered, reused from an entry to the next */
+    int pathSize;
+} ARSAL_Ftw_Worker_t;
+
+static int ARSAL_Ftw_Deque_Push (ARSAL_Ftw_Deque_t *deque, const ARSAL_Ftw_Task_t *task)
+{
+    ARSAL_Ftw_Task_t *tasks;
+    int capacity;
+    int retVal = 0;
+    int i;
+
+    ARSAL_Mutex_Lock (&deque->mutex);
+    if (deque->count == deque->capacity)
+    {
+        capacity = (deque->capacity > 0) ? deque->capacity * 2 : ARSAL_FTW_PARALLEL_DEQUE_MIN_SIZE;
+        tasks = malloc (capacity * sizeof (ARSAL_Ftw_Task_t));
+        if (tasks == NULL)
+        {
+            retVal = -1;
+        }
+        else
+        {
+            for (i = 0; i < deque->count; i++)
+            {
+                tasks[i] = deque->tasks[(deque->head + i) % deque->capacity];
+            }
+            free (deque->tasks);
+            deque->tasks = tasks;
+            deque->capacity = capacity;
+            deque->head = 0;
+        }
+    }
+    // No else --> Room left
+
+    if (retVal == 0)
+    {
+        deque->tasks[(deque->head + deque->count) % deque->capacity] = *task;
+        deque->count++;
+    }
+    ARSAL_Mutex_Unlock (&deque->mutex);
+
+    return retVal;
+}
+
+static int ARSAL_Ftw_Deque_Take (ARSAL_Ftw_Deque_t *deque, ARSAL_Ftw_Task_t *task, int steal)
+{
+    int retVal = -1;
+
+    ARSAL_Mutex_Lock (&deque->mutex);
+    if (deque->count > 0)
+    {
+        if (steal)
+        {
+            *task = deque->tasks[deque->head];
+            deque->head = (deque->head + 1) % deque->capacity;
+        }
+        else
+        {
+            *task = deque->tasks[(deque->head + deque->count - 1) % deque->capacity];
+        }
+        deque->count--;
+        retVal = 0;
+    }
+    ARSAL_Mutex_Unlock (&deque->mutex);
+
+    return retVal;
+}
+
+/**
+ * Remove the task of a node from a deque, wherever it is
+ * @return 0 if removed, -1 if it was already taken
+ */
+static int ARSAL_Ftw_Deque_Remove (ARSAL_Ftw_Deque_t *deque, const ARSAL_Ftw_Node_t *node)
+{
+    int retVal = -1;
+    int found = -1;
+    int i;
+
+    ARSAL_Mutex_Lock (&deque->mutex);
+    // The directory waited for is usually one of the oldest tasks
+    for (i = 0; (found < 0) && (i < deque->count); i++)
+    {
+        if (deque->tasks[(deque->head + i) % deque->capacity].node == node)
+        {
+            found = i;
+        }
+        // No else --> Not this one
+    }
+
+    if (found >= 0)
+    {
+        for (i = found; i < deque->count - 1; i++)
+        {
+            deque->tasks[(deque->head + i) % deque->capacity] = deque->tasks[(deque->head + i + 1) % deque->capacity];
+        }
+        deque->count--;
+        retVal = 0;
+    }
+    // No else --> Taken by a worker
+    ARSAL_Mutex_Unlock (&deque->mutex);
+
+    return retVal;
+}
+
+static int ARSAL_Ftw_Parallel_IsStopped (ARSAL_Ftw_Walk_t *walk)
+{
+    return __atomic_load_n (&walk->stop, __ATOMIC_RELAXED);
+}
+
+static void ARSAL_Ftw_Parallel_Stop (ARSAL_Ftw_Walk_t *walk, int retVal)
+{
+    ARSAL_Mutex_Lock (&walk->mutex);
+    if (!ARSAL_Ftw_Parallel_IsStopped (walk))
+    {
+        // The first stop wins
+        __atomic_store_n (&walk->stop, 1, __ATOMIC_RELAXED);
+        walk->retVal = retVal;
+    }
+    ARSAL_Mutex_Unlock (&walk->mutex);
+}
+
+static eARSAL_FTW_ACTION ARSAL_Ftw_Parallel_Call (ARSAL_Ftw_Walk_t *walk, const char *path, const struct stat *sb, eARSAL_FTW_TYPE typeFlag, ARSAL_FTW_t *ftwbuf)
+{
+    eARSAL_FTW_ACTION action = ARSAL_FTW_ACTION_CONTINUE;
+    int cbRet;
+
+    if (walk->order == ARSAL_FTW_ORDER_SERIAL)
+    {
+        ARSAL_Mutex_Lock (&walk->cbMutex);
+    }
+    cbRet = walk->cb (path, sb, typeFlag, ftwbuf);
+    if (walk->order == ARSAL_FTW_ORDER_SERIAL)
+    {
+        ARSAL_Mutex_Unlock (&walk->cbMutex);
+    }
+
+    if (walk->flags == ARSAL_FTW_ACTIONRETVAL)
+    {
+        if (cbRet == ARSAL_FTW_SKIP_SUBTREE)
+        {
+            action = ARSAL_FTW_ACTION_SKIP;
+        }
+        else if (cbRet != ARSAL_FTW_CONTINUE)
+        {
+            action = ARSAL_FTW_ACTION_STOP;
+        }
+        // No else --> Continue
+    }
+    else if (cbRet != 0)
+    {
+        action = ARSAL_FTW_ACTION_STOP;
+    }
+    // No else --> Continue
+
+    if (action == ARSAL_FTW_ACTION_STOP)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Callback said stop");
+        ARSAL_Ftw_Parallel_Stop (walk, cbRet);
+    }
+    // No else --> Keep walking
+
+    return action;
+}
+
+static int ARSAL_Ftw_Parallel_Push (ARSAL_Ftw_Walk_t *walk, int index, const ARSAL_Ftw_Task_t *task)
+{
+    int retVal;
+
+    // Counted first, so that the walk can not be seen as finished while the task is being pushed
+    ARSAL_Mutex_Lock (&walk->mutex);
+    walk->queued++;
+    walk->pending++;
+    ARSAL_Mutex_Unlock (&walk->mutex);
+
+    retVal = ARSAL_Ftw_Deque_Push (&walk->deques[index], task);
+
+    ARSAL_Mutex_Lock (&walk->mutex);
+    if (retVal != 0)
+    {
+        walk->queued--;
+        walk->pending--;
+    }
+    else
+    {
+        ARSAL_Cond_Signal (&walk->workCond);
+    }
+    ARSAL_Mutex_Unlock (&walk->mutex);
+
+    return retVal;
+}
+
+static int ARSAL_Ftw_Parallel_Take (ARSAL_Ftw_Walk_t *walk, int index, ARSAL_Ftw_Task_t *task)
+{
+    int retVal;
+    int i;
+
+    retVal = ARSAL_Ftw_Deque_Take (&walk->deques[index], task, 0);
+    for (i = 1; (retVal != 0) && (i < walk->dequeCount); i++)
+    {
+        retVal = ARSAL_Ftw_Deque_Take (&walk->deques[(index + i) % walk->dequeCount], task, 1);
+    }
+
+    if (retVal == 0)
+    {
+        ARSAL_Mutex_Lock (&walk->mutex);
+        walk->queued--;
+        ARSAL_Mutex_Unlock (&walk->mutex);
+    }
+    // No else --> Nothing to do
+
+    return retVal;
+}
+
+/**
+ * Open a directory relatively to the directory it was found in, without following symbolic links
+ */
+static DIR* ARSAL_Ftw_Parallel_OpenDir (ARSAL_Ftw_Dir_t *parent, const char *name)
+{
+    DIR *stream = NULL;
+    int fd;
+
+    fd = openat ((parent != NULL) ? dirfd (parent->stream) : AT_FDCWD, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        stream = fdopendir (fd);
+        if (stream == NULL)
+        {
+            close (fd);
+        }
+        // No else --> The stream owns the descriptor
+    }
+    // No else --> Open check
+
+    return stream;
+}
+
+/**
+ * Release a reference on a directory, closing it with the last one
+ */
+static void ARSAL_Ftw_Parallel_Unref (ARSAL_Ftw_Dir_t *dir)
+{
+    if (__atomic_sub_fetch (&dir->refCount, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        if (dir->stream != NULL)
+        {
+            closedir (dir->stream);
+            dir->stream = NULL;
+        }
+        // No else --> Never opened
+
+        if (dir->detached)
+        {
+            // The stream is the first member of the branch
+            free (dir);
+        }
+        // No else --> Freed with the tree
+    }
+    // No else --> Still used
+}
+
+/**
+ * Get the offset of the last component of a path, as nftw reports it for the root
+ */
+static int ARSAL_Ftw_Parallel_GetBase (const char *path)
+{
+    int end = strlen (path);
+
+    // Trailing slashes are part of the last component
+    while ((end > 0) && (path[end - 1] == '/'))
+    {
+        end--;
+    }
+    while ((end > 0) && (path[end - 1] != '/'))
+    {
+        end--;
+    }
+
+    return end;
+}
+
+/**
+ * Make sure that a path buffer can hold size bytes, keeping its contents
+ */
+static int ARSAL_Ftw_Parallel_Reserve (char **path, int *pathSize, int size)
+{
+    char *newPath;
+    int newSize = (*pathSize > 0) ? *pathSize : 256;
+
+    if (size <= *pathSize)
+    {
+        return 0;
+    }
+    // No else --> Grow
+
+    while (newSize < size)
+    {
+        newSize *= 2;
+    }
+
+    newPath = realloc (*path, newSize);
+    if (newPath == NULL)
+    {
+        return -1;
+    }
+    // No else --> Realloc check
+
+    *path = newPath;
+    *pathSize = newSize;
+
+    return 0;
+}
+
+/**
+ * Open a directory, call the callback on it then on each of its entries, and push its subdirectories (unordered modes)
+ */
+static void ARSAL_Ftw_Parallel_ListDir (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Worker_t *worker, ARSAL_Ftw_Branch_t *branch)
+{
+    ARSAL_Ftw_Branch_t *subBranch;
+    ARSAL_Ftw_Task_t subTask;
+    ARSAL_FTW_t ftwbuf = {branch->base, branch->level};
+    eARSAL_FTW_TYPE typeFlag;
+    struct dirent *ent;
+    struct stat sb;
+    DIR *stream = NULL;
+    int nameSize;
+
+    if (!ARSAL_Ftw_Parallel_IsStopped (walk))
+    {
+        stream = ARSAL_Ftw_Parallel_OpenDir (branch->parent, (branch->parent != NULL) ? &branch->path[branch->base] : branch->path);
+        if (stream == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to open dir %s", branch->path);
+        }
+        // No else --> Open check
+    }
+    // No else --> Only drain the deques once stopped
+
+    if (branch->parent != NULL)
+    {
+        ARSAL_Ftw_Parallel_Unref (branch->parent);
+        branch->parent = NULL;
+    }
+    // No else --> Opened from its path
+    branch->dir.stream = stream;
+
+    if ((!ARSAL_Ftw_Parallel_IsStopped (walk)) &&
+        (ARSAL_Ftw_Parallel_Call (walk, branch->path, &branch->sb, (stream != NULL) ? ARSAL_FTW_D : ARSAL_FTW_DNR, &ftwbuf) == ARSAL_FTW_ACTION_CONTINUE) &&
+        (stream != NULL))
+    {
+        if (ARSAL_Ftw_Parallel_Reserve (&worker->path, &worker->pathSize, branch->length + 2) != 0)
+        {
+            ARSAL_Ftw_Parallel_Stop (walk, -1);
+        }
+        else
+        {
+            memcpy (worker->path, branch->path, branch->length);
+            worker->path[branch->length] = '/';
+        }
+
+        ftwbuf.base = branch->length + 1;
+        ftwbuf.level = branch->level + 1;
+        while ((!ARSAL_Ftw_Parallel_IsStopped (walk)) && ((ent = readdir (stream)) != NULL))
+        {
+            if ((ent->d_name[0] == '.') &&
+                ((ent->d_name[1] == '\0') || ((ent->d_name[1] == '.') && (ent->d_name[2] == '\0'))))
+            {
+                // Skip "." and ".."
+                continue;
+            }
+            // No else --> Continue processing the current directory
+
+            nameSize = strlen (ent->d_name) + 1;
+            if (ARSAL_Ftw_Parallel_Reserve (&worker->path, &worker->pathSize, ftwbuf.base + nameSize) != 0)
+            {
+                ARSAL_Ftw_Parallel_Stop (walk, -1);
+                break;
+            }
+            // No else --> Room left
+            memcpy (&worker->path[ftwbuf.base], ent->d_name, nameSize);
+
+            if (fstatat (dirfd (stream), ent->d_name, &sb, AT_SYMLINK_NOFOLLOW) != 0)
+            {
+                // Removed meanwhile, or not allowed
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to lstat %s", worker->path);
+                memset (&sb, 0, sizeof (sb));
+                typeFlag = ARSAL_FTW_NS;
+            }
+            else
+            {
+                typeFlag = (S_ISDIR (sb.st_mode)) ? ARSAL_FTW_D : ARSAL_FTW_F;
+            }
+
+            if (typeFlag != ARSAL_FTW_D)
+            {
+                ARSAL_Ftw_Parallel_Call (walk, worker->path, &sb, typeFlag, &ftwbuf);
+                continue;
+            }
+            // No else --> The callback of a subdirectory is called once it is opened
+
+            subBranch = malloc (sizeof (ARSAL_Ftw_Branch_t) + ftwbuf.base + nameSize);
+            if (subBranch == NULL)
+            {
+                ARSAL_Ftw_Parallel_Stop (walk, -1);
+                break;
+            }
+            // No else --> Alloc check
+
+            subBranch->dir.stream = NULL;
+            subBranch->dir.refCount = 1;
+            subBranch->dir.detached = 1;
+            subBranch->parent = &branch->dir;
+            subBranch->sb = sb;
+            subBranch->base = ftwbuf.base;
+            subBranch->level = ftwbuf.level;
+            subBranch->length = ftwbuf.base + nameSize - 1;
+            memcpy (subBranch->path, worker->path, ftwbuf.base + nameSize);
+
+            // Referenced before it is pushed, another worker may open it at once
+            __atomic_add_fetch (&branch->dir.refCount, 1, __ATOMIC_RELAXED);
+            subTask.branch = subBranch;
+            subTask.node = NULL;
+            if (ARSAL_Ftw_Parallel_Push (walk, worker->index, &subTask) != 0)
+            {
+                __atomic_sub_fetch (&branch->dir.refCount, 1, __ATOMIC_RELAXED);
+                free (subBranch);
+                ARSAL_Ftw_Parallel_Stop (walk, -1);
+            }
+            // No else --> Pushed
+        }
+    }
+    // No else --> Stopped, skipped, or not readable
+
+    ARSAL_Ftw_Parallel_Unref (&branch->dir);
+}
+
+static int ARSAL_Ftw_Parallel_IsSkipped (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Node_t *node)
+{
+    int skipped = ARSAL_Ftw_Parallel_IsStopped (walk);
+
+    ARSAL_Mutex_Lock (&walk->mutex);
+    for (; (!skipped) && (node != NULL); node = node->parent)
+    {
+        skipped = node->skipped;
+    }
+    ARSAL_Mutex_Unlock (&walk->mutex);
+
+    return skipped;
+}
+
+/**
+ * Read a directory into its node and push the subdirectories, the callbacks are called by the calling thread (ARSAL_FTW_ORDER_PREORDER)
+ */
+static void ARSAL_Ftw_Parallel_ReadDir (ARSAL_Ftw_Walk_t *walk, int index, ARSAL_Ftw_Node_t *node)
+{
+    ARSAL_Ftw_Node_t *children = NULL;
+    ARSAL_Ftw_Node_t *newChildren;
+    ARSAL_Ftw_Node_t *child;
+    ARSAL_Ftw_Task_t subTask;
+    struct dirent *ent;
+    DIR *stream = NULL;
+    char *names = NULL;
+    char *newNames;
+    int namesCapacity = 0;
+    int namesSize = 0;
+    int nameSize;
+    int capacity = 0;
+    int count = 0;
+    int unreadable = 0;
+    int error = 0;
+    int i;
+
+    if (!ARSAL_Ftw_Parallel_IsSkipped (walk, node))
+    {
+        stream = ARSAL_Ftw_Parallel_OpenDir ((node->parent != NULL) ? &node->parent->dir : NULL,
+                                             (node->parent != NULL) ? &node->parent->names[node->name] : walk->rootPath);
+        if (stream == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to open dir %s", (node->parent != NULL) ? &node->parent->names[node->name] : walk->rootPath);
+            unreadable = 1;
+        }
+        // No else --> Open check
+    }
+    // No else --> Nobody will read it
+
+    if (node->parent != NULL)
+    {
+        ARSAL_Ftw_Parallel_Unref (&node->parent->dir);
+    }
+    // No else --> Opened from its path
+    node->dir.stream = stream;
+
+    while ((stream != NULL) && (!error) && ((ent = readdir (stream)) != NULL))
+    {
+        if ((ent->d_name[0] == '.') &&
+            ((ent->d_name[1] == '\0') || ((ent->d_name[1] == '.') && (ent->d_name[2] == '\0'))))
+        {
+            // Skip "." and ".."
+            continue;
+        }
+        // No else --> Continue processing the current directory
+
+        if (count == capacity)
+        {
+            capacity = (capacity > 0) ? capacity * 2 : ARSAL_FTW_PARALLEL_DEQUE_MIN_SIZE;
+            newChildren = realloc (children, capacity * sizeof (ARSAL_Ftw_Node_t));
+            if (newChildren == NULL)
+            {
+                error = 1;
+                break;
+            }
+            // No else --> Realloc check
+            children = newChildren;
+        }
+        // No else --> Room left
+
+        nameSize = strlen (ent->d_name) + 1;
+        if (namesSize + nameSize > namesCapacity)
+        {
+            namesCapacity = (namesCapacity > 0) ? namesCapacity * 2 : 1024;
+            while (namesSize + nameSize > namesCapacity)
+            {
+                namesCapacity *= 2;
+            }
+            newNames = realloc (names, namesCapacity);
+            if (newNames == NULL)
+            {
+                error = 1;
+                break;
+            }
+            // No else --> Realloc check
+            names = newNames;
+        }
+        // No else --> Room left
+
+        child = &children[count];
+        memset (child, 0, sizeof (ARSAL_Ftw_Node_t));
+        child->dir.refCount = 1;
+        child->parent = node;
+        child->name = namesSize;
+        child->level = node->level + 1;
+        child->deque = index;
+        memcpy (&names[namesSize], ent->d_name, nameSize);
+        namesSize += nameSize;
+        count++;
+
+        if (fstatat (dirfd (stream), ent->d_name, &child->sb, AT_SYMLINK_NOFOLLOW) != 0)
+        {
+            // Removed meanwhile, or not allowed
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to lstat %s", ent->d_name);
+            memset (&child->sb, 0, sizeof (child->sb));
+            child->type = ARSAL_FTW_NS;
+        }
+        else
+        {
+            child->type = (S_ISDIR (child->sb.st_mode)) ? ARSAL_FTW_D : ARSAL_FTW_F;
+        }
+    }
+
+    if (error)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "Unable to allocate the entries");
+        ARSAL_Ftw_Parallel_Stop (walk, -1);
+        count = 0;
+    }
+    // No else --> Read through
+
+    node->children = children;
+    node->names = names;
+
+    // The children array does not move anymore, the subdirectories can be handed out
+    for (i = 0; i < count; i++)
+    {
+        if (children[i].type == ARSAL_FTW_D)
+        {
+            // Referenced before it is pushed, another worker may open it at once
+            __atomic_add_fetch (&node->dir.refCount, 1, __ATOMIC_RELAXED);
+            subTask.branch = NULL;
+            subTask.node = &children[i];
+            if (ARSAL_Ftw_Parallel_Push (walk, index, &subTask) != 0)
+            {
+                // Entries up to i are already handed out, drop the others
+                __atomic_sub_fetch (&node->dir.refCount, 1, __ATOMIC_RELAXED);
+                ARSAL_Ftw_Parallel_Stop (walk, -1);
+                count = i;
+            }
+            // No else --> Pushed
+        }
+        // No else --> Not a directory
+    }
+
+    ARSAL_Ftw_Parallel_Unref (&node->dir);
+
+    ARSAL_Mutex_Lock (&walk->mutex);
+    node->childCount = count;
+    node->unreadable = unreadable;
+    node->listed = 1;
+    if (children != NULL)
+    {
+        __atomic_store_n (&walk->readAhead, walk->readAhead + 1, __ATOMIC_RELAXED);
+    }
+    // No else --> Nothing kept
+    ARSAL_Cond_Broadcast (&walk->listedCond);
+    ARSAL_Mutex_Unlock (&walk->mutex);
+}
+
+/**
+ * Account for a processed task, waking the idle workers up once the walk is done
+ */
+static void ARSAL_Ftw_Parallel_Done (ARSAL_Ftw_Walk_t *walk)
+{
+    ARSAL_Mutex_Lock (&walk->mutex);
+    walk->pending--;
+    if (walk->pending == 0)
+    {
+        ARSAL_Cond_Broadcast (&walk->workCond);
+    }
+    // No else --> Still some work
+    ARSAL_Mutex_Unlock (&walk->mutex);
+}
+
+/**
+ * Check whether the workers must wait for the callbacks to catch up before reading further (ARSAL_FTW_ORDER_PREORDER)
+ */
+static int ARSAL_Ftw_Parallel_IsAhead (ARSAL_Ftw_Walk_t *walk)
+{
+    return __atomic_load_n (&walk->readAhead, __ATOMIC_RELAXED) >= ARSAL_FTW_PARALLEL_MAX_READ_AHEAD;
+}
+
+/**
+ * Take a task and process it
+ * @return 1 if a task was processed, 0 if there was nothing to take
+ */
+static int ARSAL_Ftw_Parallel_ProcessOne (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Worker_t *worker)
+{
+    ARSAL_Ftw_Task_t task;
+    int processed = 0;
+
+    if ((!ARSAL_Ftw_Parallel_IsAhead (walk)) && (ARSAL_Ftw_Parallel_Take (walk, worker->index, &task) == 0))
+    {
+        if (task.node != NULL)
+        {
+            ARSAL_Ftw_Parallel_ReadDir (walk, worker->index, task.node);
+        }
+        else
+        {
+            ARSAL_Ftw_Parallel_ListDir (walk, worker, task.branch);
+        }
+        ARSAL_Ftw_Parallel_Done (walk);
+
+        processed = 1;
+    }
+    // No else --> Nothing to do, or too far ahead
+
+    return processed;
+}
+
+static void* ARSAL_Ftw_Parallel_Worker (void *arg)
+{
+    ARSAL_Ftw_Worker_t *worker = (ARSAL_Ftw_Worker_t *)arg;
+    ARSAL_Ftw_Walk_t *walk = worker->walk;
+    int done = 0;
+
+    while (!done)
+    {
+        if (!ARSAL_Ftw_Parallel_ProcessOne (walk, worker))
+        {
+            ARSAL_Mutex_Lock (&walk->mutex);
+            while (((walk->queued == 0) || (walk->readAhead >= ARSAL_FTW_PARALLEL_MAX_READ_AHEAD)) && (walk->pending > 0))
+            {
+                ARSAL_Cond_Wait (&walk->workCond, &walk->mutex);
+            }
+            done = (walk->pending == 0);
+            ARSAL_Mutex_Unlock (&walk->mutex);
+        }
+        // No else --> Look for the next task
+    }
+
+    return NULL;
+}
+
+/**
+ * Wait for a directory to be read, reading it from the calling thread if no worker took it yet
+ */
+static void ARSAL_Ftw_Parallel_WaitListed (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Worker_t *worker, ARSAL_Ftw_Node_t *node)
+{
+    int listed;
+
+    ARSAL_Mutex_Lock (&walk->mutex);
+    listed = node->listed;
+    ARSAL_Mutex_Unlock (&walk->mutex);
+
+    if ((!listed) && (ARSAL_Ftw_Deque_Remove (&walk->deques[node->deque], node) == 0))
+    {
+        // Still queued: the walk never waits for the workers, even when they are too far ahead
+        ARSAL_Mutex_Lock (&walk->mutex);
+        walk->queued--;
+        ARSAL_Mutex_Unlock (&walk->mutex);
+        ARSAL_Ftw_Parallel_ReadDir (walk, worker->index, node);
+        ARSAL_Ftw_Parallel_Done (walk);
+    }
+    else if (!listed)
+    {
+        // Being read by a worker
+        ARSAL_Mutex_Lock (&walk->mutex);
+        while (!node->listed)
+        {
+            ARSAL_Cond_Wait (&walk->listedCond, &walk->mutex);
+        }
+        ARSAL_Mutex_Unlock (&walk->mutex);
+    }
+    // No else --> Already listed
+}
+
+/**
+ * Free the entries of a listed node, letting the workers read further ahead
+ */
+static void ARSAL_Ftw_Parallel_FreeEntries (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Node_t *node)
+{
+    if (node->children != NULL)
+    {
+        ARSAL_Mutex_Lock (&walk->mutex);
+        __atomic_store_n (&walk->readAhead, walk->readAhead - 1, __ATOMIC_RELAXED);
+        ARSAL_Cond_Broadcast (&walk->workCond);
+        ARSAL_Mutex_Unlock (&walk->mutex);
+    }
+    // No else --> Nothing kept
+
+    free (node->children);
+    free (node->names);
+    node->children = NULL;
+    node->names = NULL;
+    node->childCount = 0;
+}
+
+/**
+ * Free the entries of a node, once no worker can use them anymore
+ */
+static void ARSAL_Ftw_Parallel_Release (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Worker_t *worker, ARSAL_Ftw_Node_t *node)
+{
+    int i;
+
+    if (node->type == ARSAL_FTW_D)
+    {
+        ARSAL_Mutex_Lock (&walk->mutex);
+        node->skipped = 1;
+        ARSAL_Mutex_Unlock (&walk->mutex);
+
+        // Once listed, the subdirectories do not use the node anymore
+        ARSAL_Ftw_Parallel_WaitListed (walk, worker, node);
+        for (i = 0; i < node->childCount; i++)
+        {
+            ARSAL_Ftw_Parallel_Release (walk, worker, &node->children[i]);
+        }
+        ARSAL_Ftw_Parallel_FreeEntries (walk, node);
+    }
+    // No else --> Nothing below a file
+}
+
+/**
+ * Call the callback on a node then on its entries, in order (ARSAL_FTW_ORDER_PREORDER)
+ * @param base The offset of the name of the node in the path of the worker
+ * @param length The length of the path of the node, in the path of the worker
+ * @return 0 to go on, or the value to return from ARSAL_Nftw_Parallel ()
+ */
+static int ARSAL_Ftw_Parallel_Deliver (ARSAL_Ftw_Walk_t *walk, ARSAL_Ftw_Worker_t *worker, ARSAL_Ftw_Node_t *node, int base, int length)
+{
+    ARSAL_FTW_t ftwbuf = {base, node->level};
+    eARSAL_FTW_TYPE typeFlag = node->type;
+    eARSAL_FTW_ACTION action;
+    const char *name;
+    int nameSize;
+    int retVal = 0;
+    int i;
+
+    if (typeFlag == ARSAL_FTW_D)
+    {
+        // Read before its callback, to report it as not readable instead
+        ARSAL_Ftw_Parallel_WaitListed (walk, worker, node);
+        if (node->unreadable)
+        {
+            typeFlag = ARSAL_FTW_DNR;
+        }
+        // No else --> Listed
+    }
+    // No else --> Nothing to read
+
+    action = ARSAL_Ftw_Parallel_Call (walk, worker->path, &node->sb, typeFlag, &ftwbuf);
+    if (action == ARSAL_FTW_ACTION_STOP)
+    {
+        retVal = walk->retVal;
+    }
+    // No else --> Go on
+
+    if ((action == ARSAL_FTW_ACTION_CONTINUE) && (typeFlag == ARSAL_FTW_D))
+    {
+        for (i = 0; (retVal == 0) && (i < node->childCount); i++)
+        {
+            if (ARSAL_Ftw_Parallel_IsStopped (walk))
+            {
+                // Stopped by a worker
+                ARSAL_Mutex_Lock (&walk->mutex);
+                retVal = walk->retVal;
+                ARSAL_Mutex_Unlock (&walk->mutex);
+                break;
+            }
+            // No else --> Go on
+
+            name = &node->names[node->children[i].name];
+            nameSize = strlen (name) + 1;
+            if (ARSAL_Ftw_Parallel_Reserve (&worker->path, &worker->pathSize, length + 1 + nameSize) != 0)
+            {
+                retVal = -1;
+                break;
+            }
+            // No else --> Room left
+            worker->path[length] = '/';
+            memcpy (&worker->path[length + 1], name, nameSize);
+
+            retVal = ARSAL_Ftw_Parallel_Deliver (walk, worker, &node->children[i], length + 1, length + nameSize);
+        }
+
+        if (retVal != 0)
+        {
+            // Let the workers drain their deques
+            ARSAL_Ftw_Parallel_Stop (walk, retVal);
+        }
+        // No else --> Walked through
+
+        // Delivered: free the entries, the workers read further ahead
+        for (i = 0; i < node->childCount; i++)
+        {
+            ARSAL_Ftw_Parallel_Release (walk, worker, &node->children[i]);
+        }
+        ARSAL_Ftw_Parallel_FreeEntries (walk, node);
+    }
+    // No else --> Skipped, stopped, not a directory or not readable
+
+    return retVal;
+}
+
+int ARSAL_Nftw_Parallel (const char *dirpath, ARSAL_NftwCallback cb, int threadCount, eARSAL_FTW_FLAG flags, eARSAL_FTW_ORDER order)
+{
+    ARSAL_Ftw_Walk_t walk;
+    ARSAL_Ftw_Worker_t workers[ARSAL_FTW_PARALLEL_MAX_THREADS + 1];
+    ARSAL_Thread_t threads[ARSAL_FTW_PARALLEL_MAX_THREADS];
+    ARSAL_Ftw_Node_t root;
+    ARSAL_Ftw_Task_t task;
+    ARSAL_FTW_t ftwbuf = {0, 0};
+    struct stat sb;
+    int started = 0;
+    int initialized = 0;
+    int retVal = 0;
+    int i;
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "%s", dirpath ? dirpath : "null");
+
+    memset (&walk, 0, sizeof (walk));
+    memset (&root, 0, sizeof (root));
+
+    if ((dirpath == NULL) || (cb == NULL) || (threadCount < 0) ||
+        ((flags != ARSAL_FTW_NOFLAGS) && (flags != ARSAL_FTW_ACTIONRETVAL)) ||
+        ((order != ARSAL_FTW_ORDER_NONE) && (order != ARSAL_FTW_ORDER_SERIAL) && (order != ARSAL_FTW_ORDER_PREORDER)))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "Bad parameters !");
+        retVal = -1;
+    }
+    // No else --> Args check (setting retVal to -1 stops the processing)
+
+    if (retVal == 0)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = ARSAL_FTW_PARALLEL_DEFAULT_THREADS;
+        }
+        else if (threadCount > ARSAL_FTW_PARALLEL_MAX_THREADS)
+        {
+            threadCount = ARSAL_FTW_PARALLEL_MAX_THREADS;
+        }
+        // No else --> Thread count as requested
+
+        // The root is reported with the offset of its name, as by ARSAL_Nftw ()
+        ftwbuf.base = ARSAL_Ftw_Parallel_GetBase (dirpath);
+        walk.cb = cb;
+        walk.flags = flags;
+        walk.order = order;
+        // The calling thread owns the deque 0. It is a worker in the unordered modes, the consumer otherwise.
+        walk.dequeCount = (order == ARSAL_FTW_ORDER_PREORDER) ? threadCount + 1 : threadCount;
+
+        retVal = lstat (dirpath, &sb);
+        if (retVal != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TAG, "Unable to lstat");
+        }
+        // No else --> Stat check
+    }
+    // No else --> Processing block
+
+    if ((retVal == 0) && (!S_ISDIR (sb.st_mode)))
+    {
+        // Nothing to walk
+        retVal = cb (dirpath, &sb, ARSAL_FTW_F, &ftwbuf);
+        if ((flags == ARSAL_FTW_ACTIONRETVAL) && (retVal == ARSAL_FTW_SKIP_SUBTREE))
+        {
+            retVal = 0;
+        }
+        // No else --> Return the callback value
+        return retVal;
+    }
+    // No else --> Walk the directory
+
+    if (retVal == 0)
+    {
+        walk.deques = calloc (walk.dequeCount, sizeof (ARSAL_Ftw_Deque_t));
+        if ((walk.deques == NULL) ||
+            (ARSAL_Mutex_Init (&walk.mutex) != 0) ||
+            (ARSAL_Mutex_Init (&walk.cbMutex) != 0) ||
+            (ARSAL_Cond_Init (&walk.workCond) != 0) ||
+            (ARSAL_Cond_Init (&walk.listedCond) != 0))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FTW_TAG, "Unable to allocate the walk");
+            retVal = -1;
+        }
+        // No else --> Alloc check
+
+        for (i = 0; (retVal == 0) && (i < walk.dequeCount); i++)
+        {
+            if (ARSAL_Mutex_Init (&walk.deques[i].mutex) != 0)
+            {
+                retVal = -1;
+            }
+            // No else --> Init check
+        }
+        initialized = i;
+    }
+    // No else --> Processing block
+
+    if (retVal == 0)
+    {
+        walk.rootPath = dirpath;
+        for (i = 0; i < walk.dequeCount; i++)
+        {
+            workers[i].walk = &walk;
+            workers[i].index = i;
+            workers[i].path = NULL;
+            workers[i].pathSize = 0;
+        }
+        memset (&task, 0, sizeof (task));
+
+        if (order == ARSAL_FTW_ORDER_PREORDER)
+        {
+            // Start reading ahead while the root is delivered
+            root.dir.refCount = 1;
+            root.type = ARSAL_FTW_D;
+            root.sb = sb;
+            task.node = &root;
+            retVal = ARSAL_Ftw_Parallel_Push (&walk, 0, &task);
+        }
+        else
+        {
+            task.branch = malloc (sizeof (ARSAL_Ftw_Branch_t) + strlen (dirpath) + 1);
+            if (task.branch == NULL)
+            {
+                retVal = -1;
+            }
+            else
+            {
+                task.branch->dir.stream = NULL;
+                task.branch->dir.refCount = 1;
+                task.branch->dir.detached = 1;
+                task.branch->parent = NULL;
+                task.branch->sb = sb;
+                task.branch->base = ftwbuf.base;
+                task.branch->level = 0;
+                task.branch->length = strlen (dirpath);
+                strcpy (task.branch->path, dirpath);
+                retVal = ARSAL_Ftw_Parallel_Push (&walk, 0, &task);
+                if (retVal != 0)
+                {
+                    free (task.branch);
+                }
+                // No else --> Owned by the walk
+            }
+        }
+    }
+    // No else --> Processing block
+
+    if (retVal == 0)
+    {
+        for (i = 1; i < walk.dequeCount; i++)
+        {
+            if (ARSAL_Thread_Create (&threads[started], ARSAL_Ftw_Parallel_Worker, &workers[i]) == 0)
+            {
+                started++;
+            }
+            // No else --> Fewer threads, the others still steal the work
+        }
+
+        if (order == ARSAL_FTW_ORDER_PREORDER)
+        {
+            // The calling thread only reads the directories it is waiting for
+            if (ARSAL_Ftw_Parallel_Reserve (&workers[0].path, &workers[0].pathSize, strlen (dirpath) + 1) != 0)
+            {
+                retVal = -1;
+            }
+            else
+            {
+                strcpy (workers[0].path, dirpath);
+                retVal = ARSAL_Ftw_Parallel_Deliver (&walk, &workers[0], &root, ftwbuf.base, strlen (dirpath));
+            }
+
+            if (retVal != 0)
+            {
+                ARSAL_Ftw_Parallel_Stop (&walk, retVal);
+            }
+            // No else --> Walked through
+            ARSAL_Ftw_Parallel_Release (&walk, &workers[0], &root);
+        }
+        else
+        {
+            ARSAL_Ftw_Parallel_Worker (&workers[0]);
+        }
+
+        for (i = 0; i < started; i++)
+        {
+            ARSAL_Thread_Join (threads[i], NULL);
+            ARSAL_Thread_Destroy (&threads[i]);
+        }
+
+        for (i = 0; i < walk.dequeCount; i++)
+        {
+            free (workers[i].path);
+        }
+    }
+    // No else --> Processing block
+
+    if ((retVal == 0) && (walk.stop))
+    {
+        retVal = walk.retVal;
+    }
+    // No else --> Keep the error
+
+    if ((flags == ARSAL_FTW_ACTIONRETVAL) && (retVal == ARSAL_FTW_SKIP_SUBTREE))
+    {
+        // Skipping the root is not an error
+        retVal = 0;
+    }
+    // No else --> Return the value as is
+
+    if (walk.deques != NULL)
+    {
+        for (i = 0; i < initialized; i++)
+        {
+            free (walk.deques[i].tasks);
+            ARSAL_Mutex_Destroy (&walk.deques[i].mutex);
+        }
+        free (walk.deques);
+        ARSAL_Cond_Destroy (&walk.listedCond);
+        ARSAL_Cond_Destroy (&walk.workCond);
+        ARSAL_Mutex_Destroy (&walk.cbMutex);
+        ARSAL_Mutex_Destroy (&walk.mutex);
+    }
+    // No else --> Nothing allocated
+
+    return retVal;
+}
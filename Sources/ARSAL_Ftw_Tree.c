@@ -0,0 +1,634 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Ftw_Tree.c
+ * @brief libARSAL directory hierarchy operations, disk usage and removal, on a parallel fd-relative walk.
+ **/
+
+#include <config.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "libARSAL/ARSAL_Ftw.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_ThreadPool.h"
+#include "ARSAL_Ftw.h"
+
+#define ARSAL_FTW_TREE_TAG  "FtwTree"
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC   (0)
+#endif
+
+#ifndef F_DUPFD_CLOEXEC
+#define F_DUPFD_CLOEXEC F_DUPFD
+#endif
+
+#ifdef DT_UNKNOWN
+#define ARSAL_FTW_TREE_DIRENT_TYPE(ent) ((ent)->d_type)
+#else
+/* No d_type in struct dirent: every entry is stated */
+#define DT_UNKNOWN  0
+#define DT_DIR      4
+#define ARSAL_FTW_TREE_DIRENT_TYPE(ent) (DT_UNKNOWN)
+#endif
+
+typedef struct _ARSAL_Ftw_Tree_t ARSAL_Ftw_Tree_t;
+
+/**
+ * A directory of the hierarchy, freed once it and all its subdirectories are done
+ * @note The directory is opened relatively to its parent descriptor, and removed from it: a directory replaced by a symbolic link is never followed.
+ */
+typedef struct _ARSAL_Ftw_TreeDir_t ARSAL_Ftw_TreeDir_t;
+struct _ARSAL_Ftw_TreeDir_t
+{
+    ARSAL_Ftw_Tree_t *tree;
+    ARSAL_Ftw_TreeDir_t *parent;
+    ARSAL_Ftw_TreeDir_t *next; /**< Next directory to list by the same task */
+    int fd; /**< Descriptor kept while the subdirectories are not done, -1 otherwise */
+    int level;
+    int pending; /**< 1 until the directory is listed, plus the number of subdirectories not done */
+    ARSAL_Ftw_Usage_t usage; /**< Usage of the directory and of its subdirectories done */
+    char name[]; /**< Name in the parent, the given path for the root */
+};
+
+struct _ARSAL_Ftw_Tree_t
+{
+    int remove; /**< Remove the entries instead of counting them */
+    int reportDepth;
+    ARSAL_Ftw_UsageCallback_t usageCallback;
+    ARSAL_Ftw_Progress_t progressCallback;
+    void *customData;
+    ARSAL_ThreadPool_t *pool; /**< Workers taking the subdirectories found while they are idle, NULL for a single thread */
+    ARSAL_Mutex_t mutex; /**< Protects the fields below and the pending counts of the directories */
+    ARSAL_Mutex_t cbMutex; /**< Serializes the callbacks */
+    ARSAL_Cond_t doneCond;
+    int done; /**< The root is complete */
+    int error;
+    uint64_t entryCount;
+    uint64_t size;
+    ARSAL_Ftw_Usage_t usage; /**< Usage of the whole hierarchy */
+};
+
+/**
+ * Directories walked by a task of the pool, depth first to keep the open descriptors few
+ */
+typedef struct
+{
+    ARSAL_Ftw_TreeDir_t *stack; /**< Directories to list, the last found first */
+    char *path; /**< Path buffer of the callbacks and logs */
+    size_t pathSize;
+} ARSAL_Ftw_TreeTask_t;
+
+static void ARSAL_Ftw_Tree_AddUsage (ARSAL_Ftw_Usage_t *usage, const ARSAL_Ftw_Usage_t *add)
+{
+    usage->size += add->size;
+    usage->diskSize += add->diskSize;
+    usage->fileCount += add->fileCount;
+    usage->dirCount += add->dirCount;
+}
+
+static ARSAL_Ftw_TreeDir_t* ARSAL_Ftw_Tree_NewDir (ARSAL_Ftw_Tree_t *tree, ARSAL_Ftw_TreeDir_t *parent, const char *name, size_t nameLen)
+{
+    ARSAL_Ftw_TreeDir_t *dir = calloc (1, sizeof (ARSAL_Ftw_TreeDir_t) + nameLen + 1);
+
+    if (dir != NULL)
+    {
+        memcpy (dir->name, name, nameLen);
+        dir->name[nameLen] = '\0';
+        dir->tree = tree;
+        dir->parent = parent;
+        dir->fd = -1;
+        dir->level = (parent != NULL) ? parent->level + 1 : 0;
+        dir->pending = 1;
+    }
+    // No else --> Alloc error
+
+    return dir;
+}
+
+/**
+ * Build the path of a directory, for the callbacks and the logs
+ * @return The path, or its name if the buffer cannot grow
+ */
+static const char* ARSAL_Ftw_Tree_GetPath (ARSAL_Ftw_TreeTask_t *task, const ARSAL_Ftw_TreeDir_t *dir)
+{
+    const ARSAL_Ftw_TreeDir_t *ancestor;
+    size_t len = 0;
+    size_t nameLen;
+    char *path;
+
+    for (ancestor = dir; ancestor != NULL; ancestor = ancestor->parent)
+    {
+        len += strlen (ancestor->name) + 1;
+    }
+
+    if (len > task->pathSize)
+    {
+        path = realloc (task->path, len);
+        if (path == NULL)
+        {
+            return dir->name;
+        }
+        // No else --> Reallocated
+        task->path = path;
+        task->pathSize = len;
+    }
+    // No else --> Long enough
+
+    // Fill from the end: the name, then its ancestors each followed by a '/'
+    task->path[--len] = '\0';
+    for (ancestor = dir; ancestor != NULL; ancestor = ancestor->parent)
+    {
+        nameLen = strlen (ancestor->name);
+        len -= nameLen;
+        memcpy (&task->path[len], ancestor->name, nameLen);
+        if (len > 0)
+        {
+            task->path[--len] = '/';
+        }
+        // No else --> Root
+    }
+
+    return task->path;
+}
+
+/**
+ * Drop a reference on a directory, completing it and then its parents as long as nothing is left below them:
+ * the directory is removed, or its usage is reported and added to the parent
+ */
+static void ARSAL_Ftw_Tree_Release (ARSAL_Ftw_TreeTask_t *task, ARSAL_Ftw_TreeDir_t *dir)
+{
+    ARSAL_Ftw_Tree_t *tree = dir->tree;
+    ARSAL_Ftw_TreeDir_t *parent;
+    int complete = 1;
+    int error;
+
+    while ((dir != NULL) && (complete))
+    {
+        ARSAL_Mutex_Lock (&tree->mutex);
+        dir->pending--;
+        complete = (dir->pending == 0);
+        ARSAL_Mutex_Unlock (&tree->mutex);
+
+        if (complete)
+        {
+            error = 0;
+            parent = dir->parent;
+            if (dir->fd >= 0)
+            {
+                close (dir->fd);
+            }
+            // No else --> No subdirectory
+
+            if (tree->remove)
+            {
+                // The parent keeps its descriptor until its last subdirectory is done
+                if (unlinkat ((parent != NULL) ? parent->fd : AT_FDCWD, dir->name, AT_REMOVEDIR) != 0)
+                {
+                    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "Unable to remove %s: %s", ARSAL_Ftw_Tree_GetPath (task, dir), strerror (errno));
+                    error = 1;
+                }
+                // No else --> Removed
+            }
+            else if ((tree->usageCallback != NULL) && ((tree->reportDepth < 0) || (dir->level <= tree->reportDepth)))
+            {
+                ARSAL_Mutex_Lock (&tree->cbMutex);
+                tree->usageCallback (tree->customData, ARSAL_Ftw_Tree_GetPath (task, dir), dir->level, &dir->usage);
+                ARSAL_Mutex_Unlock (&tree->cbMutex);
+            }
+            // No else --> Not reported
+
+            ARSAL_Mutex_Lock (&tree->mutex);
+            tree->entryCount++;
+            tree->error |= error;
+            ARSAL_Ftw_Tree_AddUsage ((parent != NULL) ? &parent->usage : &tree->usage, &dir->usage);
+            if (parent == NULL)
+            {
+                tree->done = 1;
+                ARSAL_Cond_Broadcast (&tree->doneCond);
+            }
+            // No else --> Not the root
+            ARSAL_Mutex_Unlock (&tree->mutex);
+
+            free (dir);
+            dir = parent;
+        }
+        // No else --> Still used by a subdirectory or by its listing
+    }
+}
+
+static void* ARSAL_Ftw_Tree_Task (void *arg);
+
+/**
+ * List a directory: count or unlink its files, then give its subdirectories to the idle workers or to the task
+ */
+static void ARSAL_Ftw_Tree_List (ARSAL_Ftw_TreeTask_t *task, ARSAL_Ftw_TreeDir_t *dir)
+{
+    ARSAL_Ftw_Tree_t *tree = dir->tree;
+    ARSAL_Ftw_TreeDir_t *first = NULL;
+    ARSAL_Ftw_TreeDir_t *child;
+    ARSAL_ThreadPool_Metrics_t metrics;
+    ARSAL_Ftw_Usage_t usage;
+    struct dirent *ent;
+    struct stat sb;
+    DIR *dp = NULL;
+    uint64_t entryCount = 0;
+    int childCount = 0;
+    int idleCount = 0;
+    int error = 0;
+    int isDir;
+    int fd;
+
+    memset (&usage, 0, sizeof (usage));
+
+    fd = openat ((dir->parent != NULL) ? dir->parent->fd : AT_FDCWD, dir->name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        dp = fdopendir (fd);
+        if (dp == NULL)
+        {
+            close (fd);
+        }
+        // No else --> The stream owns the descriptor
+    }
+    // No else --> Open error
+
+    if (dp == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "Unable to open %s: %s", ARSAL_Ftw_Tree_GetPath (task, dir), strerror (errno));
+        error = 1;
+    }
+    // No else --> Read the entries
+
+    while ((dp != NULL) && ((ent = readdir (dp)) != NULL))
+    {
+        if ((strcmp (ent->d_name, ".") == 0) || (strcmp (ent->d_name, "..") == 0))
+        {
+            continue;
+        }
+        // No else --> Real entry
+
+        isDir = (ARSAL_FTW_TREE_DIRENT_TYPE (ent) == DT_DIR);
+        if ((!tree->remove) || (ARSAL_FTW_TREE_DIRENT_TYPE (ent) == DT_UNKNOWN))
+        {
+            // The removal only stats when the file system does not give the type
+            if (fstatat (fd, ent->d_name, &sb, AT_SYMLINK_NOFOLLOW) != 0)
+            {
+                error = 1;
+                continue;
+            }
+            // No else --> Stated
+            isDir = S_ISDIR (sb.st_mode);
+        }
+        // No else --> Typed by the directory
+
+        if (isDir)
+        {
+            child = ARSAL_Ftw_Tree_NewDir (tree, dir, ent->d_name, strlen (ent->d_name));
+            if (child == NULL)
+            {
+                error = 1;
+                continue;
+            }
+            // No else --> Alloc check
+
+            if (!tree->remove)
+            {
+                child->usage.dirCount = 1;
+                child->usage.diskSize = (uint64_t)sb.st_blocks * 512;
+            }
+            // No else --> Nothing to count
+
+            child->next = first;
+            first = child;
+            childCount++;
+        }
+        else if (tree->remove)
+        {
+            if ((unlinkat (fd, ent->d_name, 0) == 0) || (errno == ENOENT))
+            {
+                entryCount++;
+            }
+            else
+            {
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "Unable to remove %s/%s: %s", ARSAL_Ftw_Tree_GetPath (task, dir), ent->d_name, strerror (errno));
+                error = 1;
+            }
+        }
+        else
+        {
+            usage.fileCount++;
+            usage.size += (uint64_t)sb.st_size;
+            usage.diskSize += (uint64_t)sb.st_blocks * 512;
+            entryCount++;
+        }
+    }
+
+    if (childCount > 0)
+    {
+        // The subdirectories are opened and removed relatively to this descriptor, the stream is released now
+        dir->fd = fcntl (fd, F_DUPFD_CLOEXEC, 0);
+        if (dir->fd < 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "Unable to keep %s open: %s", ARSAL_Ftw_Tree_GetPath (task, dir), strerror (errno));
+            error = 1;
+            while (first != NULL)
+            {
+                child = first;
+                first = child->next;
+                free (child);
+            }
+            childCount = 0;
+        }
+        // No else --> Subdirectories can be walked
+    }
+    // No else --> No subdirectory
+
+    if (dp != NULL)
+    {
+        closedir (dp);
+    }
+    // No else --> Not opened
+
+    ARSAL_Mutex_Lock (&tree->mutex);
+    ARSAL_Ftw_Tree_AddUsage (&dir->usage, &usage);
+    dir->pending += childCount;
+    tree->entryCount += entryCount;
+    tree->size += usage.size;
+    tree->error |= error;
+    ARSAL_Mutex_Unlock (&tree->mutex);
+
+    if ((first != NULL) && (tree->pool != NULL) && (ARSAL_ThreadPool_GetMetrics (tree->pool, &metrics) == ARSAL_OK))
+    {
+        idleCount = metrics.idleThreadCount - metrics.queueDepth;
+    }
+    // No else --> No worker to feed
+
+    while (first != NULL)
+    {
+        child = first;
+        first = child->next;
+        if ((idleCount > 0) && ((first != NULL) || (task->stack != NULL)) &&
+            (ARSAL_ThreadPool_Submit (tree->pool, ARSAL_Ftw_Tree_Task, child, NULL) == ARSAL_OK))
+        {
+            // An idle worker walks it, this task keeps at least one directory
+            idleCount--;
+        }
+        else
+        {
+            child->next = task->stack;
+            task->stack = child;
+        }
+    }
+
+    if (tree->progressCallback != NULL)
+    {
+        // Read under the callback lock so that the progress never goes back
+        ARSAL_Mutex_Lock (&tree->cbMutex);
+        ARSAL_Mutex_Lock (&tree->mutex);
+        entryCount = tree->entryCount;
+        usage.size = tree->size;
+        ARSAL_Mutex_Unlock (&tree->mutex);
+        tree->progressCallback (tree->customData, entryCount, usage.size);
+        ARSAL_Mutex_Unlock (&tree->cbMutex);
+    }
+    // No else --> No progress
+
+    ARSAL_Ftw_Tree_Release (task, dir);
+}
+
+/**
+ * Walk a subtree depth first, run by the pool or by the calling thread for the root
+ */
+static void* ARSAL_Ftw_Tree_Task (void *arg)
+{
+    ARSAL_Ftw_TreeTask_t task;
+    ARSAL_Ftw_TreeDir_t *dir;
+
+    memset (&task, 0, sizeof (task));
+    task.stack = (ARSAL_Ftw_TreeDir_t *)arg;
+    task.stack->next = NULL;
+
+    while (task.stack != NULL)
+    {
+        dir = task.stack;
+        task.stack = dir->next;
+        ARSAL_Ftw_Tree_List (&task, dir);
+    }
+
+    free (task.path);
+
+    return NULL;
+}
+
+/**
+ * Run an operation on a hierarchy
+ */
+static eARSAL_ERROR ARSAL_Ftw_Tree_Run (ARSAL_Ftw_Tree_t *tree, const char *dirPath, int threadCount)
+{
+    ARSAL_ThreadPool_Config_t config;
+    ARSAL_Ftw_TreeDir_t *root = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    struct stat sb;
+    size_t len;
+
+    if ((dirPath == NULL) || (threadCount < 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check (setting result to ARSAL_ERROR_BAD_PARAMETER stops the processing)
+
+    if (result == ARSAL_OK)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = ARSAL_FTW_PARALLEL_DEFAULT_THREADS;
+        }
+        else if (threadCount > ARSAL_FTW_PARALLEL_MAX_THREADS)
+        {
+            threadCount = ARSAL_FTW_PARALLEL_MAX_THREADS;
+        }
+        // No else --> Thread count as requested
+
+        if (lstat (dirPath, &sb) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "Unable to lstat %s", dirPath);
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Stat check
+    }
+    // No else --> Processing block
+
+    if ((result == ARSAL_OK) && (!S_ISDIR (sb.st_mode)))
+    {
+        // Nothing to walk
+        if (tree->remove)
+        {
+            if (unlink (dirPath) != 0)
+            {
+                result = ARSAL_ERROR_FILE;
+            }
+            // No else --> Removed
+        }
+        else
+        {
+            tree->usage.fileCount = 1;
+            tree->usage.size = (uint64_t)sb.st_size;
+            tree->usage.diskSize = (uint64_t)sb.st_blocks * 512;
+        }
+        return result;
+    }
+    // No else --> Walk the directory
+
+    if (result == ARSAL_OK)
+    {
+        // Drop the trailing slashes, the paths are built on the root one
+        len = strlen (dirPath);
+        while ((len > 1) && (dirPath[len - 1] == '/'))
+        {
+            len--;
+        }
+        root = ARSAL_Ftw_Tree_NewDir (tree, NULL, dirPath, len);
+        if (root == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else if (!tree->remove)
+        {
+            root->usage.dirCount = 1;
+            root->usage.diskSize = (uint64_t)sb.st_blocks * 512;
+        }
+        // No else --> Nothing to count
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        if ((ARSAL_Mutex_Init (&tree->mutex) != 0) ||
+            (ARSAL_Mutex_Init (&tree->cbMutex) != 0) ||
+            (ARSAL_Cond_Init (&tree->doneCond) != 0))
+        {
+            free (root);
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        // No else --> Init check
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        if (threadCount > 1)
+        {
+            // The calling thread is the first worker
+            memset (&config, 0, sizeof (config));
+            config.minThreads = threadCount - 1;
+            config.maxThreads = threadCount - 1;
+            tree->pool = ARSAL_ThreadPool_New (&config, NULL);
+            if (tree->pool == NULL)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSAL_FTW_TREE_TAG, "Unable to start the workers, walking on a single thread");
+            }
+            // No else --> Workers started
+        }
+        // No else --> Single thread
+
+        ARSAL_Ftw_Tree_Task (root);
+
+        // The workers may still be walking the other subtrees
+        ARSAL_Mutex_Lock (&tree->mutex);
+        while (!tree->done)
+        {
+            ARSAL_Cond_Wait (&tree->doneCond, &tree->mutex);
+        }
+        ARSAL_Mutex_Unlock (&tree->mutex);
+
+        ARSAL_ThreadPool_Delete (&tree->pool);
+        ARSAL_Cond_Destroy (&tree->doneCond);
+        ARSAL_Mutex_Destroy (&tree->cbMutex);
+        ARSAL_Mutex_Destroy (&tree->mutex);
+
+        if (tree->error)
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Every entry done
+    }
+    // No else --> Processing block
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Ftw_DiskUsage (const char *dirPath, int threadCount, int reportDepth, ARSAL_Ftw_UsageCallback_t usageCallback, ARSAL_Ftw_Progress_t progressCallback, void *customData, ARSAL_Ftw_Usage_t *usage)
+{
+    ARSAL_Ftw_Tree_t tree;
+    eARSAL_ERROR result;
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "%s", dirPath ? dirPath : "null");
+
+    memset (&tree, 0, sizeof (tree));
+    tree.reportDepth = reportDepth;
+    tree.usageCallback = usageCallback;
+    tree.progressCallback = progressCallback;
+    tree.customData = customData;
+
+    result = ARSAL_Ftw_Tree_Run (&tree, dirPath, threadCount);
+
+    if (usage != NULL)
+    {
+        *usage = tree.usage;
+    }
+    // No else --> Usage not wanted
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Ftw_RemoveTree (const char *dirPath, int threadCount, ARSAL_Ftw_Progress_t progressCallback, void *customData)
+{
+    ARSAL_Ftw_Tree_t tree;
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_FTW_TREE_TAG, "%s", dirPath ? dirPath : "null");
+
+    memset (&tree, 0, sizeof (tree));
+    tree.remove = 1;
+    tree.progressCallback = progressCallback;
+    tree.customData = customData;
+
+    return ARSAL_Ftw_Tree_Run (&tree, dirPath, threadCount);
+}
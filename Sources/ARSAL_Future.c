@@ -0,0 +1,560 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Future.c
+ * @brief libARSAL futures: completion of an asynchronous operation, set once by its promise and waited for or chained by the consumers.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+
+#include "libARSAL/ARSAL_Future.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Time.h"
+
+#define ARSAL_FUTURE_TAG                "Future"
+
+#define ARSAL_FUTURE_STATE_WAITED       (1 << 0) /**< Waiting threads or a continuation, to handle under lock at completion */
+#define ARSAL_FUTURE_STATE_SETTING      (1 << 1) /**< The promise is storing the result */
+#define ARSAL_FUTURE_STATE_READY        (1 << 2) /**< The result is stored */
+
+#define ARSAL_FUTURE_BUCKET_COUNT       (64) /**< Mutexes and conditions shared by all the futures */
+#define ARSAL_FUTURE_STACK_LINKS        (8) /**< Futures waited for at once without allocation */
+
+/**
+ * Mutex protecting the links and continuations of the futures hashed to it, and condition of the threads hashed to it
+ */
+typedef struct
+{
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond;
+} ARSAL_Future_Bucket_t;
+
+/**
+ * Waiting thread, on its stack
+ */
+typedef struct
+{
+    int bucket;
+    int signalCount; /**< Completions of the futures it is linked to, protected by its bucket */
+} ARSAL_Future_Waiter_t;
+
+/**
+ * Link of a waiting thread in the list of a future
+ */
+struct _ARSAL_Future_Link_t
+{
+    struct _ARSAL_Future_Link_t *next;
+    ARSAL_Future_Waiter_t *waiter;
+};
+
+static ARSAL_Future_Bucket_t *ARSAL_Future_buckets = NULL;
+
+/**
+ * Get the bucket table, created at the first blocking use of a future
+ */
+static ARSAL_Future_Bucket_t* ARSAL_Future_GetBuckets (void)
+{
+    ARSAL_Future_Bucket_t *buckets = __atomic_load_n (&ARSAL_Future_buckets, __ATOMIC_ACQUIRE);
+    ARSAL_Future_Bucket_t *expected = NULL;
+    int initialized = 0;
+    int i;
+
+    if (buckets == NULL)
+    {
+        buckets = calloc (ARSAL_FUTURE_BUCKET_COUNT, sizeof (ARSAL_Future_Bucket_t));
+        for (i = 0; (buckets != NULL) && (i < ARSAL_FUTURE_BUCKET_COUNT); i++)
+        {
+            if ((ARSAL_Mutex_Init (&buckets[i].mutex) != 0) || (ARSAL_Cond_Init (&buckets[i].cond) != 0))
+            {
+                break;
+            }
+            // No else --> Initialized
+            initialized++;
+        }
+
+        if ((buckets != NULL) && ((initialized < ARSAL_FUTURE_BUCKET_COUNT) ||
+            (!__atomic_compare_exchange_n (&ARSAL_Future_buckets, &expected, buckets, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))))
+        {
+            // Failed, or created concurrently by another thread
+            for (i = 0; i < ARSAL_FUTURE_BUCKET_COUNT; i++)
+            {
+                ARSAL_Cond_Destroy (&buckets[i].cond);
+                ARSAL_Mutex_Destroy (&buckets[i].mutex);
+            }
+            free (buckets);
+            buckets = expected;
+        }
+        // No else --> Published, or alloc error
+
+        if (buckets == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_FUTURE_TAG, "Unable to create the wait table");
+        }
+        // No else --> Table ready
+    }
+    // No else --> Already created
+
+    return buckets;
+}
+
+static int ARSAL_Future_Hash (const void *address)
+{
+    uint32_t hash = (uint32_t)((uintptr_t)address >> 3);
+
+    hash *= 2654435761U;
+
+    return (int)((hash >> 16) % ARSAL_FUTURE_BUCKET_COUNT);
+}
+
+/**
+ * Flag a pending future to be handled under lock at completion, its bucket being locked
+ * @return 1 if flagged, 0 if the future is already completed
+ */
+static int ARSAL_Future_Flag (ARSAL_Future_t *future)
+{
+    int state = __atomic_load_n (&future->state, __ATOMIC_RELAXED);
+
+    while (!(state & ARSAL_FUTURE_STATE_READY))
+    {
+        if (__atomic_compare_exchange_n (&future->state, &state, state | ARSAL_FUTURE_STATE_WAITED, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            return 1;
+        }
+        // No else --> Changed meanwhile, check again
+    }
+
+    return 0;
+}
+
+static int ARSAL_Future_GetRemainingMs (struct timespec *start, int timeoutMs)
+{
+    struct timespec now;
+    int remainingMs;
+
+    if (timeoutMs < 0)
+    {
+        return -1;
+    }
+    // No else --> Bounded wait
+
+    ARSAL_Time_GetTime (&now);
+    remainingMs = timeoutMs - ARSAL_Time_ComputeTimespecMsTimeDiff (start, &now);
+
+    return (remainingMs > 0) ? remainingMs : 0;
+}
+
+/**
+ * Wait for any of several futures: link the thread to each of them and sleep until one is completed
+ */
+static eARSAL_ERROR ARSAL_Future_Block (ARSAL_Future_t **futures, int count, int timeoutMs, int *index)
+{
+    ARSAL_Future_Bucket_t *buckets;
+    ARSAL_Future_Bucket_t *bucket;
+    struct _ARSAL_Future_Link_t stackLinks[ARSAL_FUTURE_STACK_LINKS];
+    struct _ARSAL_Future_Link_t *links = stackLinks;
+    struct _ARSAL_Future_Link_t **link;
+    ARSAL_Future_Waiter_t waiter;
+    struct timespec start;
+    int remainingMs = timeoutMs;
+    int registered = 0;
+    int expected = 0;
+    int ready = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (ARSAL_Future_IsReady (futures[i]))
+        {
+            *index = i;
+            return ARSAL_OK;
+        }
+        // No else --> Pending
+    }
+
+    if (timeoutMs == 0)
+    {
+        return ARSAL_ERROR_TIMEOUT;
+    }
+    // No else --> Wait
+
+    ARSAL_Time_GetTime (&start);
+    buckets = ARSAL_Future_GetBuckets ();
+    if (buckets == NULL)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Alloc check
+
+    if (count > ARSAL_FUTURE_STACK_LINKS)
+    {
+        links = malloc (count * sizeof (struct _ARSAL_Future_Link_t));
+        if (links == NULL)
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Alloc check
+    }
+    // No else --> Enough links on the stack
+
+    waiter.bucket = ARSAL_Future_Hash (&waiter);
+    waiter.signalCount = 0;
+
+    for (i = 0; (i < count) && (!ready); i++)
+    {
+        bucket = &buckets[ARSAL_Future_Hash (futures[i])];
+        ARSAL_Mutex_Lock (&bucket->mutex);
+        if (ARSAL_Future_Flag (futures[i]))
+        {
+            links[i].waiter = &waiter;
+            links[i].next = futures[i]->links;
+            futures[i]->links = &links[i];
+            registered++;
+        }
+        else
+        {
+            ready = 1;
+        }
+        ARSAL_Mutex_Unlock (&bucket->mutex);
+    }
+
+    if (!ready)
+    {
+        bucket = &buckets[waiter.bucket];
+        ARSAL_Mutex_Lock (&bucket->mutex);
+        while ((waiter.signalCount == 0) && (remainingMs != 0))
+        {
+            if (remainingMs < 0)
+            {
+                ARSAL_Cond_Wait (&bucket->cond, &bucket->mutex);
+            }
+            else
+            {
+                ARSAL_Cond_Timedwait (&bucket->cond, &bucket->mutex, remainingMs);
+                remainingMs = ARSAL_Future_GetRemainingMs (&start, timeoutMs);
+            }
+        }
+        ARSAL_Mutex_Unlock (&bucket->mutex);
+    }
+    // No else --> Completed while linking
+
+    // Unlink from the futures not completed, the completed ones still have to signal the thread
+    for (i = 0; i < registered; i++)
+    {
+        bucket = &buckets[ARSAL_Future_Hash (futures[i])];
+        ARSAL_Mutex_Lock (&bucket->mutex);
+        for (link = &futures[i]->links; (*link != NULL) && (*link != &links[i]); link = &(*link)->next);
+        if (*link != NULL)
+        {
+            *link = links[i].next;
+        }
+        else
+        {
+            expected++;
+        }
+        ARSAL_Mutex_Unlock (&bucket->mutex);
+    }
+
+    if (expected > 0)
+    {
+        // The links are on this stack: wait for the completing threads to be done with them
+        bucket = &buckets[waiter.bucket];
+        ARSAL_Mutex_Lock (&bucket->mutex);
+        while (waiter.signalCount < expected)
+        {
+            ARSAL_Cond_Wait (&bucket->cond, &bucket->mutex);
+        }
+        ARSAL_Mutex_Unlock (&bucket->mutex);
+    }
+    // No else --> No completion pending
+
+    if (links != stackLinks)
+    {
+        free (links);
+    }
+    // No else --> Links on the stack
+
+    for (i = 0; i < count; i++)
+    {
+        if (ARSAL_Future_IsReady (futures[i]))
+        {
+            *index = i;
+            return ARSAL_OK;
+        }
+        // No else --> Pending
+    }
+
+    return ARSAL_ERROR_TIMEOUT;
+}
+
+/**
+ * Store the result of a future, then wake up its waiting threads and call its continuation
+ */
+static eARSAL_ERROR ARSAL_Future_Complete (ARSAL_Future_t *future, void *value, eARSAL_ERROR error)
+{
+    ARSAL_Future_Bucket_t *buckets;
+    ARSAL_Future_Bucket_t *bucket;
+    struct _ARSAL_Future_Link_t *link;
+    struct _ARSAL_Future_Link_t *next;
+    ARSAL_Future_Waiter_t *waiter;
+    ARSAL_Future_Callback_t callback;
+    void *customData;
+    int state;
+
+    if (future == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    state = __atomic_load_n (&future->state, __ATOMIC_RELAXED);
+    do
+    {
+        if (state & (ARSAL_FUTURE_STATE_SETTING | ARSAL_FUTURE_STATE_READY))
+        {
+            return ARSAL_ERROR_BAD_PARAMETER;
+        }
+        // No else --> First completion
+    }
+    while (!__atomic_compare_exchange_n (&future->state, &state, state | ARSAL_FUTURE_STATE_SETTING, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    future->value = value;
+    future->error = error;
+    state = __atomic_fetch_or (&future->state, ARSAL_FUTURE_STATE_READY, __ATOMIC_ACQ_REL);
+
+    if (state & ARSAL_FUTURE_STATE_WAITED)
+    {
+        // Created by the thread which flagged the future
+        buckets = __atomic_load_n (&ARSAL_Future_buckets, __ATOMIC_ACQUIRE);
+        bucket = &buckets[ARSAL_Future_Hash (future)];
+
+        ARSAL_Mutex_Lock (&bucket->mutex);
+        link = future->links;
+        future->links = NULL;
+        callback = future->callback;
+        customData = future->customData;
+        future->callback = NULL;
+        future->customData = NULL;
+        ARSAL_Mutex_Unlock (&bucket->mutex);
+
+        while (link != NULL)
+        {
+            // The link is on the stack of the waiter, not to be read once it is signaled
+            next = link->next;
+            waiter = link->waiter;
+            bucket = &buckets[waiter->bucket];
+            ARSAL_Mutex_Lock (&bucket->mutex);
+            waiter->signalCount++;
+            ARSAL_Cond_Broadcast (&bucket->cond);
+            ARSAL_Mutex_Unlock (&bucket->mutex);
+            link = next;
+        }
+
+        if (callback != NULL)
+        {
+            callback (future, customData);
+        }
+        // No else --> No continuation
+    }
+    // No else --> Nobody waits
+
+    return ARSAL_OK;
+}
+
+void ARSAL_Future_Init(ARSAL_Future_t *future)
+{
+    if (future != NULL)
+    {
+        future->error = ARSAL_OK;
+        future->value = NULL;
+        future->callback = NULL;
+        future->customData = NULL;
+        future->links = NULL;
+        __atomic_store_n (&future->state, 0, __ATOMIC_RELEASE);
+    }
+    // No else --> Nothing to initialize
+}
+
+int ARSAL_Future_IsReady(ARSAL_Future_t *future)
+{
+    return (future != NULL) && ((__atomic_load_n (&future->state, __ATOMIC_ACQUIRE) & ARSAL_FUTURE_STATE_READY) != 0);
+}
+
+eARSAL_ERROR ARSAL_Future_Wait(ARSAL_Future_t *future, int timeoutMs, void **value)
+{
+    eARSAL_ERROR result;
+    int index;
+
+    if (future == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    result = ARSAL_Future_Block (&future, 1, timeoutMs, &index);
+    if (result == ARSAL_OK)
+    {
+        if (value != NULL)
+        {
+            *value = future->value;
+        }
+        // No else --> Value not wanted
+        result = future->error;
+    }
+    // No else --> Not completed
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Future_WaitAny(ARSAL_Future_t **futures, int count, int timeoutMs, int *index)
+{
+    int i;
+
+    if ((futures == NULL) || (count <= 0) || (index == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    for (i = 0; i < count; i++)
+    {
+        if (futures[i] == NULL)
+        {
+            return ARSAL_ERROR_BAD_PARAMETER;
+        }
+        // No else --> Args check
+    }
+
+    return ARSAL_Future_Block (futures, count, timeoutMs, index);
+}
+
+eARSAL_ERROR ARSAL_Future_WaitAll(ARSAL_Future_t **futures, int count, int timeoutMs)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    struct timespec start;
+    int index;
+    int i;
+
+    if ((futures == NULL) || (count < 0))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_Time_GetTime (&start);
+    for (i = 0; (result == ARSAL_OK) && (i < count); i++)
+    {
+        if (futures[i] == NULL)
+        {
+            result = ARSAL_ERROR_BAD_PARAMETER;
+        }
+        else
+        {
+            result = ARSAL_Future_Block (&futures[i], 1, ARSAL_Future_GetRemainingMs (&start, timeoutMs), &index);
+        }
+    }
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Future_Then(ARSAL_Future_t *future, ARSAL_Future_Callback_t callback, void *customData)
+{
+    ARSAL_Future_Bucket_t *buckets;
+    ARSAL_Future_Bucket_t *bucket;
+    eARSAL_ERROR result = ARSAL_OK;
+    int callNow = 0;
+
+    if ((future == NULL) || (callback == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (ARSAL_Future_IsReady (future))
+    {
+        callback (future, customData);
+        return ARSAL_OK;
+    }
+    // No else --> Pending
+
+    buckets = ARSAL_Future_GetBuckets ();
+    if (buckets == NULL)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Alloc check
+
+    bucket = &buckets[ARSAL_Future_Hash (future)];
+    ARSAL_Mutex_Lock (&bucket->mutex);
+    if (future->callback != NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    else if (ARSAL_Future_Flag (future))
+    {
+        future->callback = callback;
+        future->customData = customData;
+    }
+    else
+    {
+        // Completed meanwhile
+        callNow = 1;
+    }
+    ARSAL_Mutex_Unlock (&bucket->mutex);
+
+    if (callNow)
+    {
+        callback (future, customData);
+    }
+    // No else --> Called at completion
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Promise_SetValue(ARSAL_Future_t *future, void *value)
+{
+    return ARSAL_Future_Complete (future, value, ARSAL_OK);
+}
+
+eARSAL_ERROR ARSAL_Promise_SetError(ARSAL_Future_t *future, eARSAL_ERROR error)
+{
+    if (error == ARSAL_OK)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    return ARSAL_Future_Complete (future, NULL, error);
+}
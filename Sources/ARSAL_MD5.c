@@ -35,17 +35,34 @@
  * @author david.flattin.ext@parrot.com
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* O_DIRECT */
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include "md5.h"
 #include "libARSAL/ARSAL_Error.h"
 #include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Time.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Thread.h"
 #include "libARSAL/ARSAL_MD5_Manager.h"
 #include "ARSAL_MD5.h"
 //#include "ARSAL_Singleton.h"
 
 #define ARUTILS_MD5_TAG         "Md5"
 
+#define ARSAL_MD5_BUFFER_ALIGNMENT  4096
+#define ARSAL_MD5_DROP_CACHE_STEP   (4 * 1024 * 1024)
+
 eARSAL_ERROR ARSAL_MD5_Manager_Init(ARSAL_MD5_Manager_t *manager)
 {
     eARSAL_ERROR result = ARSAL_OK;
@@ -61,6 +78,7 @@ eARSAL_ERROR ARSAL_MD5_Manager_Init(ARSAL_MD5_Manager_t *manager)
     {
         manager->md5Check = ARSAL_MD5_Check;
         manager->md5Compute = ARSAL_MD5_Compute;
+        manager->md5Object = &manager->options;
     }
     
     return result;
@@ -106,48 +124,934 @@ eARSAL_ERROR ARSAL_MD5_Check(void *md5Object, const char *filePath, const char *
 }
 
 eARSAL_ERROR ARSAL_MD5_Compute(void *md5Object, const char *filePath, uint8_t *md5, int md5Len)
+{
+    return ARSAL_MD5_ComputeFile(filePath, md5, md5Len, (const ARSAL_MD5_Options_t *)md5Object, NULL);
+}
+
+void ARSAL_MD5_Options_SetDefault(ARSAL_MD5_Options_t *options)
+{
+    options->bufferCount = ARSAL_MD5_DEFAULT_BUFFER_COUNT;
+    options->bufferSize = ARSAL_MD5_DEFAULT_BUFFER_SIZE;
+    options->ioMode = ARSAL_MD5_IO_MODE_BUFFERED;
+    options->directThreshold = ARSAL_MD5_DEFAULT_DIRECT_THRESHOLD;
+}
+
+/**
+ * @brief Progress state of a file md5 computation
+ */
+typedef struct
+{
+    ARSAL_MD5_Monitor_t *monitor;
+    struct timespec start;
+    struct timespec last;
+    uint64_t hashedSize;
+    uint64_t totalSize;
+    int fd;
+    int dropCache;
+    uint64_t droppedSize;
+} ARSAL_MD5_Progress_State_t;
+
+static void ARSAL_MD5_NotifyProgress(ARSAL_MD5_Progress_State_t *state)
+{
+    struct timespec now;
+    int32_t elapsed;
+    float rate = 0.f;
+
+    ARSAL_Time_GetTime(&now);
+    elapsed = ARSAL_Time_ComputeTimespecMsTimeDiff(&state->start, &now);
+    if (elapsed > 0)
+    {
+        rate = ((float)state->hashedSize / (1024.f * 1024.f)) / ((float)elapsed / 1000.f);
+    }
+
+    state->last = now;
+    state->monitor->progressCallback(state->monitor->customData, state->hashedSize, state->totalSize, rate);
+}
+
+/**
+ * @brief Account for hashed bytes, notify the progress if due
+ * @retval ARSAL_ERROR_CANCELED if the computation has been canceled, ARSAL_OK otherwise
+ */
+static eARSAL_ERROR ARSAL_MD5_UpdateProgress(ARSAL_MD5_Progress_State_t *state, size_t count)
 {
     eARSAL_ERROR result = ARSAL_OK;
-    uint8_t block[1024];
+    struct timespec now;
+
+    state->hashedSize += count;
+
+#if defined(POSIX_FADV_DONTNEED)
+    /* O_DIRECT fallback: drop the pages already hashed, the reader is ahead so they will not be read again */
+    if ((state->dropCache) && ((state->hashedSize - state->droppedSize) >= ARSAL_MD5_DROP_CACHE_STEP))
+    {
+        posix_fadvise(state->fd, state->droppedSize, state->hashedSize - state->droppedSize, POSIX_FADV_DONTNEED);
+        state->droppedSize = state->hashedSize;
+    }
+#endif
+
+    if (state->monitor != NULL)
+    {
+        if (state->monitor->canceled)
+        {
+            result = ARSAL_ERROR_CANCELED;
+        }
+        else if (state->monitor->progressCallback != NULL)
+        {
+            ARSAL_Time_GetTime(&now);
+            if (ARSAL_Time_ComputeTimespecMsTimeDiff(&state->last, &now) >= state->monitor->progressInterval)
+            {
+                ARSAL_MD5_NotifyProgress(state);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Digest state: the whole file md5, plus the md5 of each chunk when a manifest is computed
+ */
+typedef struct
+{
     MD5_CTX ctx;
-    FILE *file = NULL;
+    ARSAL_MD5_Manifest_t *manifest;
+    MD5_CTX chunkCtx;
+    uint32_t chunkFill;
+    uint32_t chunkCapacity;
+    uint64_t size;
+} ARSAL_MD5_Digest_t;
+
+static eARSAL_ERROR ARSAL_MD5_Digest_EndChunk(ARSAL_MD5_Digest_t *digest)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Manifest_t *manifest = digest->manifest;
+    uint64_t newCapacity;
+    uint8_t *newChunks;
+
+    if (manifest->chunkCount == digest->chunkCapacity)
+    {
+        /* The file grew since it was stat-ed */
+        newCapacity = (digest->chunkCapacity > 0) ? ((uint64_t)digest->chunkCapacity * 2) : 16;
+        if (!ARSAL_MD5_Manifest_CheckChunkCount(newCapacity))
+        {
+            /* Grow one chunk at a time near the limit */
+            newCapacity = (uint64_t)manifest->chunkCount + 1;
+        }
+
+        if (!ARSAL_MD5_Manifest_CheckChunkCount(newCapacity))
+        {
+            result = ARSAL_ERROR_BAD_PARAMETER;
+        }
+        else
+        {
+            newChunks = realloc(manifest->chunks, (size_t)newCapacity * ARSAL_MD5_LENGTH);
+            if (newChunks == NULL)
+            {
+                result = ARSAL_ERROR_ALLOC;
+            }
+            else
+            {
+                manifest->chunks = newChunks;
+                digest->chunkCapacity = (uint32_t)newCapacity;
+            }
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        AR_MD5_Final(&manifest->chunks[(size_t)manifest->chunkCount * ARSAL_MD5_LENGTH], &digest->chunkCtx);
+        manifest->chunkCount++;
+        digest->chunkFill = 0;
+    }
+
+    return result;
+}
+
+static eARSAL_ERROR ARSAL_MD5_Digest_Update(ARSAL_MD5_Digest_t *digest, const uint8_t *data, size_t size)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    uint32_t chunkSize;
     size_t count;
+
+    AR_MD5_Update(&digest->ctx, data, size);
+    digest->size += size;
+
+    while ((digest->manifest != NULL) && (size > 0) && (result == ARSAL_OK))
+    {
+        chunkSize = digest->manifest->chunkSize;
+        if (digest->chunkFill == 0)
+        {
+            AR_MD5_Init(&digest->chunkCtx);
+        }
+
+        count = chunkSize - digest->chunkFill;
+        if (count > size)
+        {
+            count = size;
+        }
+
+        AR_MD5_Update(&digest->chunkCtx, data, count);
+        digest->chunkFill += count;
+        data += count;
+        size -= count;
+
+        if (digest->chunkFill == chunkSize)
+        {
+            result = ARSAL_MD5_Digest_EndChunk(digest);
+        }
+    }
+
+    return result;
+}
+
+static eARSAL_ERROR ARSAL_MD5_Digest_Final(ARSAL_MD5_Digest_t *digest, uint8_t *md5)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+
+    AR_MD5_Final(md5, &digest->ctx);
+
+    if (digest->manifest != NULL)
+    {
+        if (digest->chunkFill > 0)
+        {
+            result = ARSAL_MD5_Digest_EndChunk(digest);
+        }
+        digest->manifest->fileSize = digest->size;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Bypass the page cache for the reads of a file
+ * @param fd The file descriptor
+ * @param[out] bypassed Set to 1 if the reads bypass the page cache, 0 if the file system does not support it
+ * @return 1 if O_DIRECT is set on the file, so that reads must be aligned, 0 otherwise (F_NOCACHE on Darwin has no alignment constraints)
+ */
+static int ARSAL_MD5_EnableDirectIo(int fd, int *bypassed)
+{
+    int direct = 0;
+    int flags;
+
+    *bypassed = 0;
+#if defined(O_DIRECT)
+    flags = fcntl(fd, F_GETFL);
+    if ((flags != -1) && (fcntl(fd, F_SETFL, flags | O_DIRECT) == 0))
+    {
+        direct = 1;
+        *bypassed = 1;
+    }
+#elif defined(F_NOCACHE)
+    (void)flags;
+    if (fcntl(fd, F_NOCACHE, 1) == 0)
+    {
+        *bypassed = 1;
+    }
+#else
+    (void)flags;
+#endif
+
+    return direct;
+}
+
+/**
+ * @brief Go back to buffered reads on a file opened with O_DIRECT
+ */
+static void ARSAL_MD5_DisableDirectIo(int fd)
+{
+#if defined(O_DIRECT)
+    int flags = fcntl(fd, F_GETFL);
+
+    if (flags != -1)
+    {
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    }
+#endif
+}
+
+/**
+ * @brief Fill a buffer from a file, retrying on short reads
+ * @note With O_DIRECT, the file offset is no longer aligned after a short read, so the file goes back to buffered reads to get the end of the file
+ * @return The number of bytes read, 0 at the end of the file, -1 on error
+ */
+static ssize_t ARSAL_MD5_ReadFull(int fd, uint8_t *buffer, size_t size, int direct)
+{
+    size_t total = 0;
+    ssize_t count;
+
+    while (total < size)
+    {
+        count = read(fd, buffer + total, size - total);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if (count == 0)
+        {
+            break;
+        }
+        total += count;
+        if ((direct) && (total < size))
+        {
+            ARSAL_MD5_DisableDirectIo(fd);
+            direct = 0;
+        }
+    }
+
+    return (ssize_t)total;
+}
+
+/**
+ * @brief Read/hash pipeline: a reader thread fills a ring of buffers, the calling thread hashes them
+ */
+typedef struct
+{
+    int fd;
+    int direct;
+    uint8_t *buffers;
+    size_t *sizes;
+    int bufferCount;
+    size_t bufferSize;
+    int readIndex;
+    int hashIndex;
+    int filled;
+    int eof;
+    int error;
+    int stop;
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond;
+} ARSAL_MD5_Pipeline_t;
+
+static void* ARSAL_MD5_Pipeline_Reader(void *arg)
+{
+    ARSAL_MD5_Pipeline_t *pipeline = (ARSAL_MD5_Pipeline_t *)arg;
+    ssize_t count;
+    int index;
+    int done = 0;
+
+    while (!done)
+    {
+        ARSAL_Mutex_Lock(&pipeline->mutex);
+        while ((pipeline->filled == pipeline->bufferCount) && (!pipeline->stop))
+        {
+            ARSAL_Cond_Wait(&pipeline->cond, &pipeline->mutex);
+        }
+        done = pipeline->stop;
+        index = pipeline->readIndex;
+        ARSAL_Mutex_Unlock(&pipeline->mutex);
+
+        if (!done)
+        {
+            count = ARSAL_MD5_ReadFull(pipeline->fd, pipeline->buffers + (index * pipeline->bufferSize), pipeline->bufferSize, pipeline->direct);
+
+            ARSAL_Mutex_Lock(&pipeline->mutex);
+            if (count < 0)
+            {
+                pipeline->error = 1;
+                done = 1;
+            }
+            else if (count == 0)
+            {
+                pipeline->eof = 1;
+                done = 1;
+            }
+            else
+            {
+                pipeline->sizes[index] = count;
+                pipeline->readIndex = (index + 1) % pipeline->bufferCount;
+                pipeline->filled++;
+                /* A short read means the end of the file */
+                if ((size_t)count < pipeline->bufferSize)
+                {
+                    pipeline->eof = 1;
+                    done = 1;
+                }
+            }
+            ARSAL_Cond_Broadcast(&pipeline->cond);
+            ARSAL_Mutex_Unlock(&pipeline->mutex);
+        }
+    }
+
+    return NULL;
+}
+
+static eARSAL_ERROR ARSAL_MD5_HashPipelined(int fd, int direct, ARSAL_MD5_Digest_t *digest, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Progress_State_t *state)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Pipeline_t pipeline;
+    ARSAL_Thread_t reader = NULL;
+    void *buffers = NULL;
+    int mutexInitialized = 0;
+    int condInitialized = 0;
+    int done = 0;
+    int index;
+
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.fd = fd;
+    pipeline.direct = direct;
+    pipeline.bufferCount = options->bufferCount;
+    pipeline.bufferSize = options->bufferSize;
+
+    if (posix_memalign(&buffers, ARSAL_MD5_BUFFER_ALIGNMENT, pipeline.bufferCount * pipeline.bufferSize) != 0)
+    {
+        buffers = NULL;
+        result = ARSAL_ERROR_ALLOC;
+    }
+    pipeline.buffers = buffers;
+
+    if (result == ARSAL_OK)
+    {
+        pipeline.sizes = calloc(pipeline.bufferCount, sizeof(size_t));
+        if (pipeline.sizes == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Mutex_Init(&pipeline.mutex) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            mutexInitialized = 1;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Cond_Init(&pipeline.cond) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            condInitialized = 1;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Thread_Create(&reader, ARSAL_MD5_Pipeline_Reader, &pipeline) != 0)
+        {
+            reader = NULL;
+            result = ARSAL_ERROR_SYSTEM;
+        }
+    }
+
+    while ((result == ARSAL_OK) && (!done))
+    {
+        ARSAL_Mutex_Lock(&pipeline.mutex);
+        while ((pipeline.filled == 0) && (!pipeline.eof) && (!pipeline.error))
+        {
+            ARSAL_Cond_Wait(&pipeline.cond, &pipeline.mutex);
+        }
+        if (pipeline.filled == 0)
+        {
+            /* The ring is drained and the reader is done */
+            result = (pipeline.error) ? ARSAL_ERROR_FILE : ARSAL_OK;
+            done = 1;
+        }
+        index = pipeline.hashIndex;
+        ARSAL_Mutex_Unlock(&pipeline.mutex);
+
+        if (!done)
+        {
+            result = ARSAL_MD5_Digest_Update(digest, pipeline.buffers + (index * pipeline.bufferSize), pipeline.sizes[index]);
+            if (result == ARSAL_OK)
+            {
+                result = ARSAL_MD5_UpdateProgress(state, pipeline.sizes[index]);
+            }
+
+            ARSAL_Mutex_Lock(&pipeline.mutex);
+            pipeline.hashIndex = (index + 1) % pipeline.bufferCount;
+            pipeline.filled--;
+            ARSAL_Cond_Broadcast(&pipeline.cond);
+            ARSAL_Mutex_Unlock(&pipeline.mutex);
+        }
+    }
+
+    if (reader != NULL)
+    {
+        ARSAL_Mutex_Lock(&pipeline.mutex);
+        pipeline.stop = 1;
+        ARSAL_Cond_Broadcast(&pipeline.cond);
+        ARSAL_Mutex_Unlock(&pipeline.mutex);
+
+        ARSAL_Thread_Join(reader, NULL);
+        ARSAL_Thread_Destroy(&reader);
+    }
+
+    if (condInitialized)
+    {
+        ARSAL_Cond_Destroy(&pipeline.cond);
+    }
+    if (mutexInitialized)
+    {
+        ARSAL_Mutex_Destroy(&pipeline.mutex);
+    }
+    free(pipeline.sizes);
+    free(buffers);
+
+    return result;
+}
+
+static eARSAL_ERROR ARSAL_MD5_HashSequential(int fd, int direct, ARSAL_MD5_Digest_t *digest, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Progress_State_t *state)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    void *buffer = NULL;
+    ssize_t count;
+
+    if (posix_memalign(&buffer, ARSAL_MD5_BUFFER_ALIGNMENT, options->bufferSize) != 0)
+    {
+        buffer = NULL;
+        result = ARSAL_ERROR_ALLOC;
+    }
+
+    while (result == ARSAL_OK)
+    {
+        count = ARSAL_MD5_ReadFull(fd, buffer, options->bufferSize, direct);
+        if (count < 0)
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        else if (count == 0)
+        {
+            break;
+        }
+        else
+        {
+            result = ARSAL_MD5_Digest_Update(digest, buffer, count);
+            if (result == ARSAL_OK)
+            {
+                result = ARSAL_MD5_UpdateProgress(state, count);
+            }
+        }
+    }
+
+    free(buffer);
+
+    return result;
+}
+
+static eARSAL_ERROR ARSAL_MD5_HashFile(const char *filePath, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Monitor_t *monitor, ARSAL_MD5_Digest_t *digest)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Options_t defaultOptions;
+    ARSAL_MD5_Options_t directOptions;
+    ARSAL_MD5_Progress_State_t state;
+    ARSAL_MD5_Manifest_t *manifest = digest->manifest;
+    struct stat sb;
+    uint64_t chunkCount;
+    int fd = -1;
+    int direct = 0;
+    int bypassed = 0;
     
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", "");
+    if (options == NULL)
+    {
+        ARSAL_MD5_Options_SetDefault(&defaultOptions);
+        options = &defaultOptions;
+    }
     
-    if ((filePath == NULL) || (md5 == NULL) || (md5Len < MD5_DIGEST_LENGTH))
+    if ((filePath == NULL) || (options->bufferCount < 1) || (options->bufferSize == 0))
     {
         result = ARSAL_ERROR_BAD_PARAMETER;
     }
     
+    memset(&state, 0, sizeof(state));
+    state.monitor = monitor;
+    
     if (result == ARSAL_OK)
     {
-        AR_MD5_Init(&ctx);
-        file = fopen(filePath, "rb");
-        if (file == NULL)
+        fd = open(filePath, O_RDONLY);
+        if ((fd < 0) || (fstat(fd, &sb) != 0))
         {
             result = ARSAL_ERROR_FILE;
         }
     }
     
+    if ((result == ARSAL_OK) && (manifest != NULL))
+    {
+        chunkCount = ((uint64_t)sb.st_size + manifest->chunkSize - 1) / manifest->chunkSize;
+        if (!ARSAL_MD5_Manifest_CheckChunkCount(chunkCount))
+        {
+            result = ARSAL_ERROR_BAD_PARAMETER;
+        }
+        else if (chunkCount > 0)
+        {
+            manifest->chunks = malloc((size_t)chunkCount * ARSAL_MD5_LENGTH);
+            if (manifest->chunks == NULL)
+            {
+                result = ARSAL_ERROR_ALLOC;
+            }
+            else
+            {
+                digest->chunkCapacity = chunkCount;
+            }
+        }
+    }
+    
+    if ((result == ARSAL_OK) && ((options->ioMode == ARSAL_MD5_IO_MODE_DIRECT) || ((options->ioMode == ARSAL_MD5_IO_MODE_AUTO) && ((uint64_t)sb.st_size >= options->directThreshold))))
+    {
+        direct = ARSAL_MD5_EnableDirectIo(fd, &bypassed);
+        if (direct)
+        {
+            /* O_DIRECT reads must be a multiple of the block size */
+            directOptions = *options;
+            directOptions.bufferSize = (options->bufferSize + ARSAL_MD5_BUFFER_ALIGNMENT - 1) & ~((size_t)ARSAL_MD5_BUFFER_ALIGNMENT - 1);
+            options = &directOptions;
+        }
+        else if (!bypassed)
+        {
+            /* Not supported by the file system (tmpfs...), drop the pages once hashed instead */
+            state.dropCache = 1;
+        }
+    }
+    
     if (result == ARSAL_OK)
     {
-        while ((count = fread(block, sizeof(uint8_t), sizeof(block), file)) > 0)
+        state.fd = fd;
+        state.totalSize = (uint64_t)sb.st_size;
+        ARSAL_Time_GetTime(&state.start);
+        state.last = state.start;
+        
+        /* The pipeline only pays off when there is more than one buffer to read */
+        if ((options->bufferCount > 1) && (state.totalSize > options->bufferSize))
         {
-            AR_MD5_Update(&ctx, block, count);
+            result = ARSAL_MD5_HashPipelined(fd, direct, digest, options, &state);
         }
+        else
+        {
+            result = ARSAL_MD5_HashSequential(fd, direct, digest, options, &state);
+        }
+    }
+    
+    if ((result == ARSAL_OK) && (monitor != NULL) && (monitor->progressCallback != NULL))
+    {
+        ARSAL_MD5_NotifyProgress(&state);
+    }
+    
+#if defined(POSIX_FADV_DONTNEED)
+    if (state.dropCache)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+#endif
+    
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_ComputeFile(const char *filePath, uint8_t *md5, int md5Len, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Monitor_t *monitor)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Digest_t digest;
+    
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", "");
+    
+    if ((md5 == NULL) || (md5Len < MD5_DIGEST_LENGTH))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        memset(&digest, 0, sizeof(digest));
+        AR_MD5_Init(&digest.ctx);
+        
+        result = ARSAL_MD5_HashFile(filePath, options, monitor, &digest);
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_Digest_Final(&digest, md5);
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_ComputeFileManifest(const char *filePath, ARSAL_MD5_Manifest_t *manifest, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Monitor_t *monitor)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Digest_t digest;
+    
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", "");
+    
+    if ((manifest == NULL) || (manifest->chunkSize == 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        memset(&digest, 0, sizeof(digest));
+        AR_MD5_Init(&digest.ctx);
+        digest.manifest = manifest;
+        manifest->chunkCount = 0;
         
-        AR_MD5_Final(md5, &ctx);
+        result = ARSAL_MD5_HashFile(filePath, options, monitor, &digest);
     }
     
-    if (file != NULL)
+    if (result == ARSAL_OK)
     {
-        fclose(file);
+        result = ARSAL_MD5_Digest_Final(&digest, manifest->md5);
     }
     
     return result;
 }
 
+/**
+ * @brief Shared state of a parallel tree hash
+ */
+typedef struct
+{
+    int fd;
+    uint64_t fileSize;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+    size_t bufferSize;
+    uint8_t *leaves;
+    uint32_t nextChunk;
+    eARSAL_ERROR result;
+    ARSAL_Mutex_t mutex;
+} ARSAL_MD5_Tree_t;
+
+static void* ARSAL_MD5_Tree_Worker(void *arg)
+{
+    ARSAL_MD5_Tree_t *tree = (ARSAL_MD5_Tree_t *)arg;
+    eARSAL_ERROR result = ARSAL_OK;
+    void *buffer = NULL;
+    MD5_CTX ctx;
+    uint32_t index = 0;
+    uint64_t offset;
+    uint64_t end;
+    ssize_t count;
+    size_t toRead;
+    int done = 0;
+
+    if (posix_memalign(&buffer, ARSAL_MD5_BUFFER_ALIGNMENT, tree->bufferSize) != 0)
+    {
+        buffer = NULL;
+        result = ARSAL_ERROR_ALLOC;
+    }
+
+    while (!done)
+    {
+        ARSAL_Mutex_Lock(&tree->mutex);
+        if (result != ARSAL_OK)
+        {
+            tree->result = result;
+        }
+        if ((tree->result != ARSAL_OK) || (tree->nextChunk == tree->chunkCount))
+        {
+            done = 1;
+        }
+        else
+        {
+            index = tree->nextChunk++;
+        }
+        ARSAL_Mutex_Unlock(&tree->mutex);
+
+        if (!done)
+        {
+            offset = (uint64_t)index * tree->chunkSize;
+            end = offset + tree->chunkSize;
+            if (end > tree->fileSize)
+            {
+                end = tree->fileSize;
+            }
+
+            AR_MD5_Init(&ctx);
+            while ((offset < end) && (result == ARSAL_OK))
+            {
+                toRead = ((end - offset) < tree->bufferSize) ? (size_t)(end - offset) : tree->bufferSize;
+                count = pread(tree->fd, buffer, toRead, (off_t)offset);
+                if ((count < 0) && (errno == EINTR))
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    /* Error, or the file shrank since it was stat-ed */
+                    result = ARSAL_ERROR_FILE;
+                }
+                else
+                {
+                    AR_MD5_Update(&ctx, buffer, count);
+                    offset += count;
+                }
+            }
+
+            if (result == ARSAL_OK)
+            {
+                AR_MD5_Final(&tree->leaves[(size_t)index * ARSAL_MD5_LENGTH], &ctx);
+            }
+        }
+    }
+
+    free(buffer);
+
+    return NULL;
+}
+
+static void ARSAL_MD5_Tree_Root(const uint8_t *leaves, uint32_t leafCount, uint8_t *md5)
+{
+    MD5_CTX ctx;
+
+    AR_MD5_Init(&ctx);
+    if (leafCount > 0)
+    {
+        AR_MD5_Update(&ctx, leaves, (size_t)leafCount * ARSAL_MD5_LENGTH);
+    }
+    AR_MD5_Final(md5, &ctx);
+}
+
+eARSAL_ERROR ARSAL_MD5_ComputeFileTree(const char *filePath, uint32_t chunkSize, int threadCount, const ARSAL_MD5_Options_t *options, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Tree_t tree;
+    ARSAL_Thread_t *threads = NULL;
+    struct stat sb;
+    uint64_t chunkCount = 0;
+    int mutexInitialized = 0;
+    int started = 0;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", "");
+
+    memset(&tree, 0, sizeof(tree));
+    tree.fd = -1;
+
+    if ((filePath == NULL) || (chunkSize == 0) || (threadCount < 0) || (md5 == NULL) || (md5Len < MD5_DIGEST_LENGTH))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        tree.fd = open(filePath, O_RDONLY);
+        if ((tree.fd < 0) || (fstat(tree.fd, &sb) != 0))
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        tree.fileSize = (uint64_t)sb.st_size;
+        tree.chunkSize = chunkSize;
+        tree.bufferSize = ((options != NULL) && (options->bufferSize > 0)) ? options->bufferSize : ARSAL_MD5_DEFAULT_BUFFER_SIZE;
+        chunkCount = (tree.fileSize + chunkSize - 1) / chunkSize;
+        if (!ARSAL_MD5_Manifest_CheckChunkCount(chunkCount))
+        {
+            result = ARSAL_ERROR_BAD_PARAMETER;
+        }
+        tree.chunkCount = (uint32_t)chunkCount;
+    }
+
+    if ((result == ARSAL_OK) && (chunkCount > 0))
+    {
+        tree.leaves = malloc((size_t)chunkCount * ARSAL_MD5_LENGTH);
+        if (tree.leaves == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Mutex_Init(&tree.mutex) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            mutexInitialized = 1;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        }
+        if ((uint64_t)threadCount > chunkCount)
+        {
+            threadCount = (int)chunkCount;
+        }
+
+        /* The calling thread is a worker too */
+        if (threadCount > 1)
+        {
+            threads = calloc(threadCount - 1, sizeof(ARSAL_Thread_t));
+            for (i = 0; (threads != NULL) && (i < threadCount - 1); i++)
+            {
+                if (ARSAL_Thread_Create(&threads[i], ARSAL_MD5_Tree_Worker, &tree) != 0)
+                {
+                    /* Go on with the workers already started */
+                    break;
+                }
+                started++;
+            }
+        }
+
+        ARSAL_MD5_Tree_Worker(&tree);
+
+        for (i = 0; i < started; i++)
+        {
+            ARSAL_Thread_Join(threads[i], NULL);
+            ARSAL_Thread_Destroy(&threads[i]);
+        }
+        free(threads);
+
+        result = tree.result;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        ARSAL_MD5_Tree_Root(tree.leaves, tree.chunkCount, md5);
+    }
+
+    if (mutexInitialized)
+    {
+        ARSAL_Mutex_Destroy(&tree.mutex);
+    }
+    if (tree.fd >= 0)
+    {
+        close(tree.fd);
+    }
+    free(tree.leaves);
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_Manifest_GetTreeRoot(const ARSAL_MD5_Manifest_t *manifest, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+
+    if ((manifest == NULL) || ((manifest->chunkCount > 0) && (manifest->chunks == NULL)) || (md5 == NULL) || (md5Len < MD5_DIGEST_LENGTH))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        ARSAL_MD5_Tree_Root(manifest->chunks, manifest->chunkCount, md5);
+    }
+
+    return result;
+}
+
 eARSAL_ERROR ARSAL_MD5_GetMd5AsTxt(const uint8_t *md5, int md5Len, char *md5Txt, int md5TxtLen)
 {
     eARSAL_ERROR result = ARSAL_OK;
@@ -38,7 +38,67 @@
 #ifndef _ARSAL_MD5_PRIVATE_H_
 #define _ARSAL_MD5_PRIVATE_H_
 
+/**
+ * @brief Progress monitor of a file md5 computation
+ * @param progressCallback The progress callback, may be NULL
+ * @param progressInterval The minimum interval between two progress callbacks, in ms
+ * @param customData The custom data given to the progress callback
+ * @param canceled Set to 1 by another thread to cancel the computation
+ */
+typedef struct
+{
+    ARSAL_MD5_Progress_t progressCallback;
+    int progressInterval;
+    void *customData;
+    volatile int canceled;
+} ARSAL_MD5_Monitor_t;
+
+/**
+ * @brief Compute the md5 of a file with the native engine
+ * @param filePath The file path onto compute its md5
+ * @param[out] md5 The md5 buffer to receive the md5
+ * @param md5Len md5 buffer length
+ * @param options The engine options, NULL for the default ones
+ * @param monitor The progress monitor, may be NULL
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_ComputeFile(const char *filePath, uint8_t *md5, int md5Len, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Monitor_t *monitor);
+
+/**
+ * @brief Compute the whole file md5 and the md5 of each chunk of a file in one pass
+ * @param filePath The file path onto compute its manifest
+ * @param manifest The manifest to fill, its chunkSize must be set and its chunks must be NULL
+ * @param options The engine options, NULL for the default ones
+ * @param monitor The progress monitor, may be NULL
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_ComputeFileManifest(const char *filePath, ARSAL_MD5_Manifest_t *manifest, const ARSAL_MD5_Options_t *options, ARSAL_MD5_Monitor_t *monitor);
 
+/**
+ * @brief Compute the tree digest of a file, hashing its chunks in parallel
+ * @param filePath The file path onto compute its tree digest
+ * @param chunkSize The size of each chunk, in bytes
+ * @param threadCount The number of hashing threads, 0 for one per online CPU
+ * @param options The engine options (only bufferSize is used), NULL for the default ones
+ * @param[out] md5 The md5 buffer to receive the root digest
+ * @param md5Len md5 buffer length
+ * @retval On success, returns ARSAL_OK. Otherwise, it returns an error number of eARSAL_ERROR
+ */
+eARSAL_ERROR ARSAL_MD5_ComputeFileTree(const char *filePath, uint32_t chunkSize, int threadCount, const ARSAL_MD5_Options_t *options, uint8_t *md5, int md5Len);
+
+/**
+ * @brief Check that the digests of a number of chunks, and the manifest serializing them, fit in memory
+ * @note Must be checked before any multiplication of a chunk count by ARSAL_MD5_LENGTH, which wraps on 32-bit targets
+ * @param chunkCount The number of chunks
+ * @return 1 if the chunk count fits in a manifest and in a size_t, else 0
+ */
+int ARSAL_MD5_Manifest_CheckChunkCount(uint64_t chunkCount);
+
+/**
+ * @brief Set the default engine options
+ * @param[out] options The options to initialize
+ */
+void ARSAL_MD5_Options_SetDefault(ARSAL_MD5_Options_t *options);
 
 eARSAL_ERROR ARSAL_MD5_Check(void *md5Object, const char *filePath, const char *md5Txt);
 
@@ -0,0 +1,712 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_MD5_Batch.c
+ * @brief Batched md5 computation of many files, with io_uring on Linux and a pool of pread threads elsewhere.
+ */
+
+#include <config.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "md5.h"
+#include "libARSAL/ARSAL_Error.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Thread.h"
+#include "libARSAL/ARSAL_MD5_Manager.h"
+#include "ARSAL_MD5.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#define ARUTILS_MD5_TAG                 "Md5"
+
+#define ARSAL_MD5_BATCH_DEFAULT_DEPTH   32
+#define ARSAL_MD5_BATCH_MAX_THREADS     16
+#define ARSAL_MD5_BATCH_ALIGNMENT       4096
+
+/**
+ * @brief Description of a batch
+ */
+typedef struct
+{
+    const char * const *filePaths;
+    int fileCount;
+    int depth;
+    size_t bufferSize;
+    uint8_t *md5s;
+    eARSAL_ERROR *results;
+    int failedCount;
+} ARSAL_MD5_Batch_t;
+
+/*****************************************
+ *
+ *             pread thread pool:
+ *
+ *****************************************/
+
+/**
+ * @brief Shared state of the pread thread pool
+ */
+typedef struct
+{
+    ARSAL_MD5_Batch_t *batch;
+    int nextFile;
+    ARSAL_Mutex_t mutex;
+} ARSAL_MD5_Batch_Pool_t;
+
+static eARSAL_ERROR ARSAL_MD5_Batch_HashOne(const char *filePath, uint8_t *buffer, size_t bufferSize, uint8_t *md5)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    MD5_CTX ctx;
+    off_t offset = 0;
+    ssize_t count;
+    int fd;
+
+    fd = open(filePath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        result = ARSAL_ERROR_FILE;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        AR_MD5_Init(&ctx);
+        do
+        {
+            count = pread(fd, buffer, bufferSize, offset);
+            if (count > 0)
+            {
+                AR_MD5_Update(&ctx, buffer, count);
+                offset += count;
+            }
+        } while ((count > 0) || ((count < 0) && (errno == EINTR)));
+
+        if (count < 0)
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        else
+        {
+            AR_MD5_Final(md5, &ctx);
+        }
+
+        close(fd);
+    }
+
+    return result;
+}
+
+static void* ARSAL_MD5_Batch_PoolWorker(void *arg)
+{
+    ARSAL_MD5_Batch_Pool_t *pool = (ARSAL_MD5_Batch_Pool_t *)arg;
+    ARSAL_MD5_Batch_t *batch = pool->batch;
+    void *buffer = NULL;
+    eARSAL_ERROR result;
+    int index;
+
+    if (posix_memalign(&buffer, ARSAL_MD5_BATCH_ALIGNMENT, batch->bufferSize) != 0)
+    {
+        buffer = NULL;
+    }
+
+    do
+    {
+        ARSAL_Mutex_Lock(&pool->mutex);
+        index = (pool->nextFile < batch->fileCount) ? pool->nextFile++ : -1;
+        ARSAL_Mutex_Unlock(&pool->mutex);
+
+        if (index >= 0)
+        {
+            result = (buffer != NULL) ? ARSAL_MD5_Batch_HashOne(batch->filePaths[index], buffer, batch->bufferSize, &batch->md5s[index * ARSAL_MD5_LENGTH]) : ARSAL_ERROR_ALLOC;
+            if (batch->results != NULL)
+            {
+                batch->results[index] = result;
+            }
+            if (result != ARSAL_OK)
+            {
+                ARSAL_Mutex_Lock(&pool->mutex);
+                batch->failedCount++;
+                ARSAL_Mutex_Unlock(&pool->mutex);
+            }
+        }
+    } while (index >= 0);
+
+    free(buffer);
+
+    return NULL;
+}
+
+static eARSAL_ERROR ARSAL_MD5_Batch_RunPool(ARSAL_MD5_Batch_t *batch)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Batch_Pool_t pool;
+    ARSAL_Thread_t threads[ARSAL_MD5_BATCH_MAX_THREADS - 1];
+    int threadCount = batch->depth;
+    int started = 0;
+    int i;
+
+    memset(&pool, 0, sizeof(pool));
+    pool.batch = batch;
+
+    if (threadCount > ARSAL_MD5_BATCH_MAX_THREADS)
+    {
+        threadCount = ARSAL_MD5_BATCH_MAX_THREADS;
+    }
+    if (threadCount > batch->fileCount)
+    {
+        threadCount = batch->fileCount;
+    }
+
+    if (ARSAL_Mutex_Init(&pool.mutex) != 0)
+    {
+        result = ARSAL_ERROR_SYSTEM;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        /* The calling thread is a worker too */
+        for (i = 0; i < threadCount - 1; i++)
+        {
+            if (ARSAL_Thread_Create(&threads[i], ARSAL_MD5_Batch_PoolWorker, &pool) != 0)
+            {
+                break;
+            }
+            started++;
+        }
+
+        ARSAL_MD5_Batch_PoolWorker(&pool);
+
+        for (i = 0; i < started; i++)
+        {
+            ARSAL_Thread_Join(threads[i], NULL);
+            ARSAL_Thread_Destroy(&threads[i]);
+        }
+
+        ARSAL_Mutex_Destroy(&pool.mutex);
+    }
+
+    return result;
+}
+
+#ifdef HAVE_LINUX_IO_URING_H
+
+/*****************************************
+ *
+ *             io_uring:
+ *
+ *****************************************/
+
+/**
+ * @brief State of a file in flight in the ring
+ */
+typedef enum
+{
+    ARSAL_MD5_BATCH_SLOT_FREE = 0,
+    ARSAL_MD5_BATCH_SLOT_OPENING,
+    ARSAL_MD5_BATCH_SLOT_READING,
+    ARSAL_MD5_BATCH_SLOT_CLOSING,
+} eARSAL_MD5_BATCH_SLOT_STATE;
+
+/**
+ * @brief A file in flight in the ring
+ */
+typedef struct
+{
+    eARSAL_MD5_BATCH_SLOT_STATE state;
+    int file;
+    int fd;
+    uint64_t offset;
+    uint8_t *buffer;
+    MD5_CTX ctx;
+    eARSAL_ERROR result;
+} ARSAL_MD5_Batch_Slot_t;
+
+/**
+ * @brief Mapped io_uring instance
+ */
+typedef struct
+{
+    int fd;
+    void *sqRing;
+    size_t sqRingSize;
+    void *cqRing;
+    size_t cqRingSize;
+    struct io_uring_sqe *sqes;
+    size_t sqesSize;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    struct io_uring_cqe *cqes;
+    unsigned pending;
+} ARSAL_MD5_Batch_Ring_t;
+
+static void ARSAL_MD5_Batch_RingClose(ARSAL_MD5_Batch_Ring_t *ring)
+{
+    if (ring->sqes != NULL)
+    {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+    if ((ring->cqRing != NULL) && (ring->cqRing != ring->sqRing))
+    {
+        munmap(ring->cqRing, ring->cqRingSize);
+    }
+    if (ring->sqRing != NULL)
+    {
+        munmap(ring->sqRing, ring->sqRingSize);
+    }
+    if (ring->fd >= 0)
+    {
+        close(ring->fd);
+    }
+}
+
+static int ARSAL_MD5_Batch_RingProbe(int ringFd)
+{
+    static const int requiredOps[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE };
+    struct io_uring_probe *probe;
+    size_t probeSize = sizeof(struct io_uring_probe) + (256 * sizeof(struct io_uring_probe_op));
+    int supported = 0;
+    unsigned i;
+
+    probe = calloc(1, probeSize);
+    if ((probe != NULL) && (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, 256) == 0))
+    {
+        supported = 1;
+        for (i = 0; i < sizeof(requiredOps) / sizeof(requiredOps[0]); i++)
+        {
+            if ((requiredOps[i] > probe->last_op) || (!(probe->ops[requiredOps[i]].flags & IO_URING_OP_SUPPORTED)))
+            {
+                supported = 0;
+            }
+        }
+    }
+    free(probe);
+
+    return supported;
+}
+
+static int ARSAL_MD5_Batch_RingOpen(ARSAL_MD5_Batch_Ring_t *ring, unsigned entries)
+{
+    struct io_uring_params params;
+    uint8_t *sq;
+    uint8_t *cq;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+
+    ring->fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0)
+    {
+        /* Kernel without io_uring, or forbidden by seccomp */
+        return -1;
+    }
+
+    if (!ARSAL_MD5_Batch_RingProbe(ring->fd))
+    {
+        ARSAL_MD5_Batch_RingClose(ring);
+        return -1;
+    }
+
+    ring->sqRingSize = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+    ring->cqRingSize = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cqRingSize > ring->sqRingSize)
+        {
+            ring->sqRingSize = ring->cqRingSize;
+        }
+        ring->cqRingSize = ring->sqRingSize;
+    }
+
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqRing == MAP_FAILED)
+    {
+        ring->sqRing = NULL;
+        ARSAL_MD5_Batch_RingClose(ring);
+        return -1;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->cqRing = ring->sqRing;
+    }
+    else
+    {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqRing == MAP_FAILED)
+        {
+            ring->cqRing = NULL;
+            ARSAL_MD5_Batch_RingClose(ring);
+            return -1;
+        }
+    }
+
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        ring->sqes = NULL;
+        ARSAL_MD5_Batch_RingClose(ring);
+        return -1;
+    }
+
+    sq = ring->sqRing;
+    cq = ring->cqRing;
+    ring->sqTail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned *)(sq + params.sq_off.array);
+    ring->cqHead = (unsigned *)(cq + params.cq_off.head);
+    ring->cqTail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    return 0;
+}
+
+static struct io_uring_sqe* ARSAL_MD5_Batch_RingGetSqe(ARSAL_MD5_Batch_Ring_t *ring, int slot)
+{
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail & *ring->sqMask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = (uint64_t)slot;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->pending++;
+
+    return sqe;
+}
+
+static void ARSAL_MD5_Batch_PrepOpen(ARSAL_MD5_Batch_Ring_t *ring, int slot, const char *filePath)
+{
+    struct io_uring_sqe *sqe = ARSAL_MD5_Batch_RingGetSqe(ring, slot);
+
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t)(uintptr_t)filePath;
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+}
+
+static void ARSAL_MD5_Batch_PrepRead(ARSAL_MD5_Batch_Ring_t *ring, int slot, ARSAL_MD5_Batch_Slot_t *state, size_t bufferSize)
+{
+    struct io_uring_sqe *sqe = ARSAL_MD5_Batch_RingGetSqe(ring, slot);
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = state->fd;
+    sqe->addr = (uint64_t)(uintptr_t)state->buffer;
+    sqe->len = bufferSize;
+    sqe->off = state->offset;
+}
+
+static void ARSAL_MD5_Batch_PrepClose(ARSAL_MD5_Batch_Ring_t *ring, int slot, ARSAL_MD5_Batch_Slot_t *state)
+{
+    struct io_uring_sqe *sqe = ARSAL_MD5_Batch_RingGetSqe(ring, slot);
+
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = state->fd;
+}
+
+/**
+ * @brief Start the next file of the batch in a free slot
+ * @return 1 if a file was started, 0 if the batch has no more files
+ */
+static int ARSAL_MD5_Batch_StartNext(ARSAL_MD5_Batch_t *batch, ARSAL_MD5_Batch_Ring_t *ring, ARSAL_MD5_Batch_Slot_t *slots, int slot, int *nextFile)
+{
+    ARSAL_MD5_Batch_Slot_t *state = &slots[slot];
+
+    if (*nextFile >= batch->fileCount)
+    {
+        state->state = ARSAL_MD5_BATCH_SLOT_FREE;
+        return 0;
+    }
+
+    state->file = (*nextFile)++;
+    state->fd = -1;
+    state->offset = 0;
+    state->result = ARSAL_OK;
+    state->state = ARSAL_MD5_BATCH_SLOT_OPENING;
+    ARSAL_MD5_Batch_PrepOpen(ring, slot, batch->filePaths[state->file]);
+
+    return 1;
+}
+
+static void ARSAL_MD5_Batch_EndFile(ARSAL_MD5_Batch_t *batch, ARSAL_MD5_Batch_Slot_t *state)
+{
+    if (state->result == ARSAL_OK)
+    {
+        AR_MD5_Final(&batch->md5s[state->file * ARSAL_MD5_LENGTH], &state->ctx);
+    }
+    else
+    {
+        batch->failedCount++;
+    }
+    if (batch->results != NULL)
+    {
+        batch->results[state->file] = state->result;
+    }
+}
+
+static eARSAL_ERROR ARSAL_MD5_Batch_RunRing(ARSAL_MD5_Batch_t *batch, ARSAL_MD5_Batch_Ring_t *ring)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Batch_Slot_t *slots = NULL;
+    uint8_t *buffers = NULL;
+    void *memory = NULL;
+    struct io_uring_cqe *cqe;
+    ARSAL_MD5_Batch_Slot_t *state;
+    unsigned head;
+    unsigned tail;
+    int inFlight = 0;
+    int nextFile = 0;
+    int slot;
+    int res;
+    long ret;
+
+    slots = calloc(batch->depth, sizeof(ARSAL_MD5_Batch_Slot_t));
+    if ((slots == NULL) || (posix_memalign(&memory, ARSAL_MD5_BATCH_ALIGNMENT, batch->depth * batch->bufferSize) != 0))
+    {
+        memory = NULL;
+        result = ARSAL_ERROR_ALLOC;
+    }
+    buffers = memory;
+
+    if (result == ARSAL_OK)
+    {
+        for (slot = 0; slot < batch->depth; slot++)
+        {
+            slots[slot].buffer = buffers + (slot * batch->bufferSize);
+            inFlight += ARSAL_MD5_Batch_StartNext(batch, ring, slots, slot, &nextFile);
+        }
+    }
+
+    /* On error the operations in flight are drained before the buffers are released */
+    while (inFlight > 0)
+    {
+        /* Submit everything queued and wait for at least one completion in a single syscall */
+        ret = syscall(__NR_io_uring_enter, ring->fd, ring->pending, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARUTILS_MD5_TAG, "io_uring_enter failed: %s", strerror(errno));
+            if (result != ARSAL_OK)
+            {
+                /* Already draining */
+                break;
+            }
+            result = ARSAL_ERROR_SYSTEM;
+            continue;
+        }
+        ring->pending -= ret;
+
+        head = *ring->cqHead;
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail)
+        {
+            cqe = &ring->cqes[head & *ring->cqMask];
+            slot = (int)cqe->user_data;
+            res = cqe->res;
+            state = &slots[slot];
+            head++;
+
+            if (result != ARSAL_OK)
+            {
+                /* Draining: release the descriptors without starting anything */
+                if ((state->state == ARSAL_MD5_BATCH_SLOT_OPENING) && (res >= 0))
+                {
+                    close(res);
+                }
+                else if (state->state == ARSAL_MD5_BATCH_SLOT_READING)
+                {
+                    close(state->fd);
+                }
+                state->state = ARSAL_MD5_BATCH_SLOT_FREE;
+                inFlight--;
+                continue;
+            }
+
+            switch (state->state)
+            {
+            case ARSAL_MD5_BATCH_SLOT_OPENING:
+                if (res < 0)
+                {
+                    state->result = ARSAL_ERROR_FILE;
+                    ARSAL_MD5_Batch_EndFile(batch, state);
+                    inFlight -= 1 - ARSAL_MD5_Batch_StartNext(batch, ring, slots, slot, &nextFile);
+                }
+                else
+                {
+                    state->fd = res;
+                    state->state = ARSAL_MD5_BATCH_SLOT_READING;
+                    AR_MD5_Init(&state->ctx);
+                    ARSAL_MD5_Batch_PrepRead(ring, slot, state, batch->bufferSize);
+                }
+                break;
+
+            case ARSAL_MD5_BATCH_SLOT_READING:
+                if (res > 0)
+                {
+                    AR_MD5_Update(&state->ctx, state->buffer, res);
+                    state->offset += res;
+                    ARSAL_MD5_Batch_PrepRead(ring, slot, state, batch->bufferSize);
+                }
+                else if (res == -EINTR || res == -EAGAIN)
+                {
+                    ARSAL_MD5_Batch_PrepRead(ring, slot, state, batch->bufferSize);
+                }
+                else
+                {
+                    if (res < 0)
+                    {
+                        state->result = ARSAL_ERROR_FILE;
+                    }
+                    state->state = ARSAL_MD5_BATCH_SLOT_CLOSING;
+                    ARSAL_MD5_Batch_PrepClose(ring, slot, state);
+                }
+                break;
+
+            case ARSAL_MD5_BATCH_SLOT_CLOSING:
+                ARSAL_MD5_Batch_EndFile(batch, state);
+                inFlight -= 1 - ARSAL_MD5_Batch_StartNext(batch, ring, slots, slot, &nextFile);
+                break;
+
+            default:
+                break;
+            }
+        }
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    if (inFlight > 0)
+    {
+        /* Not drained: the kernel may still read into the buffers after the ring is closed, keep them */
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARUTILS_MD5_TAG, "%d operations left in flight", inFlight);
+        for (slot = 0; slot < batch->depth; slot++)
+        {
+            if (slots[slot].state == ARSAL_MD5_BATCH_SLOT_READING)
+            {
+                close(slots[slot].fd);
+            }
+        }
+        memory = NULL;
+    }
+
+    free(memory);
+    free(slots);
+
+    return result;
+}
+
+#endif /* HAVE_LINUX_IO_URING_H */
+
+eARSAL_ERROR ARSAL_MD5_Manager_ComputeBatch(ARSAL_MD5_Manager_t *manager, const char * const *filePaths, int fileCount, int queueDepth, uint8_t *md5s, eARSAL_ERROR *results)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_MD5_Batch_t batch;
+    int i;
+#ifdef HAVE_LINUX_IO_URING_H
+    ARSAL_MD5_Batch_Ring_t ring;
+    unsigned entries = 1;
+    int ringOpened = 0;
+#endif
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%d files", fileCount);
+
+    if ((manager == NULL) || (filePaths == NULL) || (fileCount < 0) || (queueDepth < 0) || (md5s == NULL))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        memset(&batch, 0, sizeof(batch));
+        batch.filePaths = filePaths;
+        batch.fileCount = fileCount;
+        batch.depth = (queueDepth > 0) ? queueDepth : ARSAL_MD5_BATCH_DEFAULT_DEPTH;
+        if (batch.depth > fileCount)
+        {
+            batch.depth = fileCount;
+        }
+        batch.bufferSize = (manager->options.bufferSize > 0) ? manager->options.bufferSize : ARSAL_MD5_DEFAULT_BUFFER_SIZE;
+        batch.md5s = md5s;
+        batch.results = results;
+
+        for (i = 0; (results != NULL) && (i < fileCount); i++)
+        {
+            results[i] = ARSAL_ERROR;
+        }
+    }
+
+    if ((result == ARSAL_OK) && (fileCount > 0))
+    {
+#ifdef HAVE_LINUX_IO_URING_H
+        while (entries < (unsigned)batch.depth)
+        {
+            entries <<= 1;
+        }
+        ringOpened = (ARSAL_MD5_Batch_RingOpen(&ring, entries) == 0);
+
+        if (ringOpened)
+        {
+            result = ARSAL_MD5_Batch_RunRing(&batch, &ring);
+            ARSAL_MD5_Batch_RingClose(&ring);
+        }
+        else
+#endif
+        {
+            result = ARSAL_MD5_Batch_RunPool(&batch);
+        }
+    }
+
+    if ((result == ARSAL_OK) && (batch.failedCount > 0))
+    {
+        result = ARSAL_ERROR_FILE;
+    }
+
+    return result;
+}
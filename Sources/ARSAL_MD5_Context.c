@@ -0,0 +1,160 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_MD5_Context.c
+ * @brief Incremental md5 computation of memory buffers.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "md5.h"
+#include "libARSAL/ARSAL_Error.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_MD5_Manager.h"
+
+#define ARUTILS_MD5_TAG                 "Md5"
+
+struct _ARSAL_MD5_Context_t
+{
+    MD5_CTX ctx;
+};
+
+ARSAL_MD5_Context_t* ARSAL_MD5_Context_New(eARSAL_ERROR *error)
+{
+    ARSAL_MD5_Context_t *context = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", "");
+    
+    context = malloc(sizeof(ARSAL_MD5_Context_t));
+    if (context == NULL)
+    {
+        result = ARSAL_ERROR_ALLOC;
+    }
+    else
+    {
+        AR_MD5_Init(&context->ctx);
+    }
+    
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    return context;
+}
+
+void ARSAL_MD5_Context_Delete(ARSAL_MD5_Context_t **contextAddr)
+{
+    if (contextAddr != NULL)
+    {
+        free(*contextAddr);
+        *contextAddr = NULL;
+    }
+}
+
+eARSAL_ERROR ARSAL_MD5_Context_Reset(ARSAL_MD5_Context_t *context)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if (context == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        AR_MD5_Init(&context->ctx);
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_Context_Update(ARSAL_MD5_Context_t *context, const uint8_t *data, size_t dataSize)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if ((context == NULL) || ((data == NULL) && (dataSize > 0)))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if ((result == ARSAL_OK) && (dataSize > 0))
+    {
+        AR_MD5_Update(&context->ctx, data, dataSize);
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_Context_Final(ARSAL_MD5_Context_t *context, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if ((context == NULL) || (md5 == NULL) || (md5Len < ARSAL_MD5_LENGTH))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        AR_MD5_Final(md5, &context->ctx);
+        
+        /* Ready for the next message */
+        AR_MD5_Init(&context->ctx);
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_ComputeBuffer(const uint8_t *data, size_t dataSize, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    MD5_CTX ctx;
+    
+    if (((data == NULL) && (dataSize > 0)) || (md5 == NULL) || (md5Len < ARSAL_MD5_LENGTH))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        AR_MD5_Init(&ctx);
+        if (dataSize > 0)
+        {
+            AR_MD5_Update(&ctx, data, dataSize);
+        }
+        AR_MD5_Final(md5, &ctx);
+    }
+    
+    return result;
+}
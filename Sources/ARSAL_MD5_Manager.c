@@ -43,10 +43,30 @@
 
 #include "libARSAL/ARSAL_Error.h"
 #include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Thread.h"
 #include "libARSAL/ARSAL_MD5_Manager.h"  
+#include "ARSAL_MD5.h"
 
 #define ARUTILS_MD5_TAG "Md5"
 
+/**
+ * @brief Asynchronous MD5 job
+ */
+struct _ARSAL_MD5_Job_t
+{
+    char *filePath;
+    ARSAL_MD5_Options_t options;
+    ARSAL_MD5_Monitor_t monitor;
+    ARSAL_MD5_Completion_t completionCallback;
+    ARSAL_Thread_t thread;
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond;
+    int done;
+    eARSAL_ERROR result;
+    uint8_t md5[ARSAL_MD5_LENGTH];
+};
+
 ARSAL_MD5_Manager_t* ARSAL_MD5_Manager_New(eARSAL_ERROR *error)
 {
     ARSAL_MD5_Manager_t* newManager = NULL;
@@ -60,6 +80,10 @@ ARSAL_MD5_Manager_t* ARSAL_MD5_Manager_New(eARSAL_ERROR *error)
     {
         result = ARSAL_ERROR_ALLOC;
     }
+    else
+    {
+        ARSAL_MD5_Options_SetDefault(&newManager->options);
+    }
     
     *error = result;
     return newManager;
@@ -116,3 +140,281 @@ eARSAL_ERROR ARSAL_MD5_Manager_Compute(ARSAL_MD5_Manager_t *manager, const char
     return result;
 }
 
+eARSAL_ERROR ARSAL_MD5_Manager_SetOptions(ARSAL_MD5_Manager_t *manager, const ARSAL_MD5_Options_t *options)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if ((manager == NULL) || ((options != NULL) && ((options->bufferCount < 1) || (options->bufferSize == 0) || (options->ioMode < ARSAL_MD5_IO_MODE_BUFFERED) || (options->ioMode > ARSAL_MD5_IO_MODE_AUTO))))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        if (options != NULL)
+        {
+            manager->options = *options;
+        }
+        else
+        {
+            ARSAL_MD5_Options_SetDefault(&manager->options);
+        }
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_Manager_ComputeWithOptions(ARSAL_MD5_Manager_t *manager, const char *filePath, const ARSAL_MD5_Options_t *options, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", filePath ? filePath : "null");
+    
+    if ((manager == NULL) || (filePath == NULL))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_ComputeFile(filePath, md5, md5Len, (options != NULL) ? options : &manager->options, NULL);
+    }
+    
+    return result;
+}
+
+static void* ARSAL_MD5_Job_Run(void *arg)
+{
+    ARSAL_MD5_Job_t *job = (ARSAL_MD5_Job_t *)arg;
+    
+    job->result = ARSAL_MD5_ComputeFile(job->filePath, job->md5, sizeof(job->md5), &job->options, &job->monitor);
+    
+    if (job->completionCallback != NULL)
+    {
+        job->completionCallback(job->monitor.customData, job->result, (job->result == ARSAL_OK) ? job->md5 : NULL, sizeof(job->md5));
+    }
+    
+    ARSAL_Mutex_Lock(&job->mutex);
+    job->done = 1;
+    ARSAL_Cond_Broadcast(&job->cond);
+    ARSAL_Mutex_Unlock(&job->mutex);
+    
+    return NULL;
+}
+
+ARSAL_MD5_Job_t* ARSAL_MD5_Manager_ComputeAsync(ARSAL_MD5_Manager_t *manager, const char *filePath, ARSAL_MD5_Progress_t progressCallback, int progressInterval, ARSAL_MD5_Completion_t completionCallback, void *customData, eARSAL_ERROR *error)
+{
+    ARSAL_MD5_Job_t *job = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    int mutexInitialized = 0;
+    int condInitialized = 0;
+    
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", filePath ? filePath : "null");
+    
+    if ((manager == NULL) || (filePath == NULL) || (progressInterval < 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        job = calloc(1, sizeof(ARSAL_MD5_Job_t));
+        if (job == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        job->filePath = strdup(filePath);
+        if (job->filePath == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Mutex_Init(&job->mutex) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            mutexInitialized = 1;
+        }
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Cond_Init(&job->cond) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            condInitialized = 1;
+        }
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        job->options = manager->options;
+        job->monitor.progressCallback = progressCallback;
+        job->monitor.progressInterval = progressInterval;
+        job->monitor.customData = customData;
+        job->completionCallback = completionCallback;
+        
+        if (ARSAL_Thread_Create(&job->thread, ARSAL_MD5_Job_Run, job) != 0)
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+    }
+    
+    if ((result != ARSAL_OK) && (job != NULL))
+    {
+        if (condInitialized)
+        {
+            ARSAL_Cond_Destroy(&job->cond);
+        }
+        if (mutexInitialized)
+        {
+            ARSAL_Mutex_Destroy(&job->mutex);
+        }
+        free(job->filePath);
+        free(job);
+        job = NULL;
+    }
+    
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    return job;
+}
+
+eARSAL_ERROR ARSAL_MD5_Job_Cancel(ARSAL_MD5_Job_t *job)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if (job == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        job->monitor.canceled = 1;
+    }
+    
+    return result;
+}
+
+eARSAL_ERROR ARSAL_MD5_Job_Wait(ARSAL_MD5_Job_t *job, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if ((job == NULL) || ((md5 != NULL) && (md5Len < ARSAL_MD5_LENGTH)))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        ARSAL_Mutex_Lock(&job->mutex);
+        while (!job->done)
+        {
+            ARSAL_Cond_Wait(&job->cond, &job->mutex);
+        }
+        ARSAL_Mutex_Unlock(&job->mutex);
+        
+        result = job->result;
+    }
+    
+    if ((result == ARSAL_OK) && (md5 != NULL))
+    {
+        memcpy(md5, job->md5, sizeof(job->md5));
+    }
+    
+    return result;
+}
+
+void ARSAL_MD5_Job_Delete(ARSAL_MD5_Job_t **jobAddr)
+{
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", "");
+    
+    if (jobAddr != NULL)
+    {
+        ARSAL_MD5_Job_t *job = *jobAddr;
+        
+        if (job != NULL)
+        {
+            job->monitor.canceled = 1;
+            ARSAL_Thread_Join(job->thread, NULL);
+            ARSAL_Thread_Destroy(&job->thread);
+            ARSAL_Cond_Destroy(&job->cond);
+            ARSAL_Mutex_Destroy(&job->mutex);
+            free(job->filePath);
+            free(job);
+        }
+        
+        *jobAddr = NULL;
+    }
+}
+
+ARSAL_MD5_Manifest_t* ARSAL_MD5_Manager_ComputeManifest(ARSAL_MD5_Manager_t *manager, const char *filePath, uint32_t chunkSize, eARSAL_ERROR *error)
+{
+    ARSAL_MD5_Manifest_t *manifest = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARUTILS_MD5_TAG, "%s", filePath ? filePath : "null");
+    
+    if ((manager == NULL) || (filePath == NULL) || (chunkSize == 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        manifest = calloc(1, sizeof(ARSAL_MD5_Manifest_t));
+        if (manifest == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        manifest->chunkSize = chunkSize;
+        result = ARSAL_MD5_ComputeFileManifest(filePath, manifest, &manager->options, NULL);
+    }
+    
+    if (result != ARSAL_OK)
+    {
+        ARSAL_MD5_Manifest_Delete(&manifest);
+    }
+    
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    return manifest;
+}
+
+eARSAL_ERROR ARSAL_MD5_Manager_ComputeTree(ARSAL_MD5_Manager_t *manager, const char *filePath, uint32_t chunkSize, int threadCount, uint8_t *md5, int md5Len)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    
+    if (manager == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_MD5_ComputeFileTree(filePath, chunkSize, threadCount, &manager->options, md5, md5Len);
+    }
+    
+    return result;
+}
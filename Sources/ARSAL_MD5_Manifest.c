@@ -0,0 +1,245 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_MD5_Manifest.c
+ * @brief Chunked digest manifests, serialization and comparison.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libARSAL/ARSAL_Error.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Endianness.h"
+#include "libARSAL/ARSAL_MD5_Manager.h"
+#include "ARSAL_MD5.h"
+
+#define ARUTILS_MD5_TAG                 "Md5"
+
+#define ARSAL_MD5_MANIFEST_MAGIC        "AMD5"
+#define ARSAL_MD5_MANIFEST_VERSION      1
+
+void ARSAL_MD5_Manifest_Delete(ARSAL_MD5_Manifest_t **manifestAddr)
+{
+    if (manifestAddr != NULL)
+    {
+        ARSAL_MD5_Manifest_t *manifest = *manifestAddr;
+        
+        if (manifest != NULL)
+        {
+            free(manifest->chunks);
+            free(manifest);
+        }
+        
+        *manifestAddr = NULL;
+    }
+}
+
+eARSAL_ERROR ARSAL_MD5_Manifest_GetChunkRange(const ARSAL_MD5_Manifest_t *manifest, uint32_t index, uint64_t *offset, uint64_t *size)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    uint64_t chunkOffset = 0;
+    
+    if ((manifest == NULL) || (index >= manifest->chunkCount) || (offset == NULL) || (size == NULL))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        chunkOffset = (uint64_t)index * manifest->chunkSize;
+        *offset = chunkOffset;
+        *size = ((manifest->fileSize - chunkOffset) < manifest->chunkSize) ? (manifest->fileSize - chunkOffset) : manifest->chunkSize;
+    }
+    
+    return result;
+}
+
+int ARSAL_MD5_Manifest_CheckChunkCount(uint64_t chunkCount)
+{
+    /* Chunk indexes are 32 bits, and the serialized size must not wrap a 32-bit size_t */
+    return (chunkCount <= UINT32_MAX) && (chunkCount <= (SIZE_MAX - ARSAL_MD5_MANIFEST_HEADER_SIZE) / ARSAL_MD5_LENGTH);
+}
+
+size_t ARSAL_MD5_Manifest_GetSerializedSize(const ARSAL_MD5_Manifest_t *manifest)
+{
+    size_t size = 0;
+    
+    if ((manifest != NULL) && ARSAL_MD5_Manifest_CheckChunkCount(manifest->chunkCount))
+    {
+        size = ARSAL_MD5_MANIFEST_HEADER_SIZE + ((size_t)manifest->chunkCount * ARSAL_MD5_LENGTH);
+    }
+    
+    return size;
+}
+
+eARSAL_ERROR ARSAL_MD5_Manifest_Serialize(const ARSAL_MD5_Manifest_t *manifest, uint8_t *buffer, size_t bufferSize, size_t *written)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    size_t size = ARSAL_MD5_Manifest_GetSerializedSize(manifest);
+    uint32_t value32;
+    uint64_t value64;
+    
+    if ((manifest == NULL) || (size == 0) || (buffer == NULL) || (bufferSize < size) || ((manifest->chunkCount > 0) && (manifest->chunks == NULL)))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        /* magic[4] version[1] reserved[3] chunkSize[4] chunkCount[4] fileSize[8] md5[16] */
+        memcpy(&buffer[0], ARSAL_MD5_MANIFEST_MAGIC, 4);
+        buffer[4] = ARSAL_MD5_MANIFEST_VERSION;
+        memset(&buffer[5], 0, 3);
+        value32 = htodl(manifest->chunkSize);
+        memcpy(&buffer[8], &value32, sizeof(value32));
+        value32 = htodl(manifest->chunkCount);
+        memcpy(&buffer[12], &value32, sizeof(value32));
+        value64 = htodll(manifest->fileSize);
+        memcpy(&buffer[16], &value64, sizeof(value64));
+        memcpy(&buffer[24], manifest->md5, ARSAL_MD5_LENGTH);
+        
+        if (manifest->chunkCount > 0)
+        {
+            memcpy(&buffer[ARSAL_MD5_MANIFEST_HEADER_SIZE], manifest->chunks, (size_t)manifest->chunkCount * ARSAL_MD5_LENGTH);
+        }
+        
+        if (written != NULL)
+        {
+            *written = size;
+        }
+    }
+    
+    return result;
+}
+
+ARSAL_MD5_Manifest_t* ARSAL_MD5_Manifest_Deserialize(const uint8_t *buffer, size_t bufferSize, eARSAL_ERROR *error)
+{
+    ARSAL_MD5_Manifest_t *manifest = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    uint32_t value32;
+    uint64_t value64;
+    
+    if ((buffer == NULL) || (bufferSize < ARSAL_MD5_MANIFEST_HEADER_SIZE) ||
+        (memcmp(&buffer[0], ARSAL_MD5_MANIFEST_MAGIC, 4) != 0) || (buffer[4] != ARSAL_MD5_MANIFEST_VERSION))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        manifest = calloc(1, sizeof(ARSAL_MD5_Manifest_t));
+        if (manifest == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        memcpy(&value32, &buffer[8], sizeof(value32));
+        manifest->chunkSize = dtohl(value32);
+        memcpy(&value32, &buffer[12], sizeof(value32));
+        manifest->chunkCount = dtohl(value32);
+        memcpy(&value64, &buffer[16], sizeof(value64));
+        manifest->fileSize = dtohll(value64);
+        memcpy(manifest->md5, &buffer[24], ARSAL_MD5_LENGTH);
+        
+        if ((manifest->chunkSize == 0) ||
+            (manifest->chunkCount != (manifest->fileSize + manifest->chunkSize - 1) / manifest->chunkSize) ||
+            !ARSAL_MD5_Manifest_CheckChunkCount(manifest->chunkCount) ||
+            (ARSAL_MD5_Manifest_GetSerializedSize(manifest) > bufferSize))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARUTILS_MD5_TAG, "Corrupted manifest");
+            result = ARSAL_ERROR_BAD_PARAMETER;
+        }
+    }
+    
+    if ((result == ARSAL_OK) && (manifest->chunkCount > 0))
+    {
+        manifest->chunks = malloc((size_t)manifest->chunkCount * ARSAL_MD5_LENGTH);
+        if (manifest->chunks == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            memcpy(manifest->chunks, &buffer[ARSAL_MD5_MANIFEST_HEADER_SIZE], (size_t)manifest->chunkCount * ARSAL_MD5_LENGTH);
+        }
+    }
+    
+    if (result != ARSAL_OK)
+    {
+        ARSAL_MD5_Manifest_Delete(&manifest);
+    }
+    
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    return manifest;
+}
+
+eARSAL_ERROR ARSAL_MD5_Manifest_Diff(const ARSAL_MD5_Manifest_t *reference, const ARSAL_MD5_Manifest_t *received, uint32_t *chunks, uint32_t maxChunks, uint32_t *chunkCount)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    uint32_t count = 0;
+    uint32_t index;
+    int mismatch;
+    
+    if ((reference == NULL) || (received == NULL) || (chunkCount == NULL) || (reference->chunkSize != received->chunkSize))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    
+    if (result == ARSAL_OK)
+    {
+        for (index = 0; index < reference->chunkCount; index++)
+        {
+            mismatch = (index >= received->chunkCount) ||
+                       (memcmp(&reference->chunks[(size_t)index * ARSAL_MD5_LENGTH], &received->chunks[(size_t)index * ARSAL_MD5_LENGTH], ARSAL_MD5_LENGTH) != 0);
+            
+            if (mismatch)
+            {
+                if ((chunks != NULL) && (count < maxChunks))
+                {
+                    chunks[count] = index;
+                }
+                count++;
+            }
+        }
+        
+        *chunkCount = count;
+    }
+    
+    return result;
+}
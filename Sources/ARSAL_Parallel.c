@@ -0,0 +1,297 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Parallel.c
+ * @brief libARSAL parallel loops and reductions over index ranges, run on a work-stealing scheduler.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "libARSAL/ARSAL_Parallel.h"
+#include "libARSAL/ARSAL_Print.h"
+
+#define ARSAL_PARALLEL_TAG          "Parallel"
+
+/**
+ * A parallel loop or reduction, shared by its tasks
+ */
+typedef struct
+{
+    size_t begin;
+    size_t end;
+    size_t grainSize;
+    ARSAL_Parallel_ForBody_t forBody; /**< NULL for a reduction */
+    ARSAL_Parallel_ReduceBody_t reduceBody;
+    ARSAL_Parallel_Join_t join;
+    size_t partialSize;
+    uint8_t *partials; /**< A partial result per chunk */
+    void *customData;
+} ARSAL_Parallel_Context_t;
+
+/**
+ * Chunks [firstChunk, lastChunk) of a task
+ */
+typedef struct
+{
+    ARSAL_Parallel_Context_t *context;
+    size_t firstChunk;
+    size_t lastChunk;
+} ARSAL_Parallel_Range_t;
+
+static ARSAL_Scheduler_t *ARSAL_Parallel_defaultScheduler = NULL;
+
+static void ARSAL_Parallel_RunChunk (ARSAL_Parallel_Context_t *context, size_t chunk)
+{
+    size_t begin = context->begin + chunk * context->grainSize;
+    size_t end = ((context->end - begin) > context->grainSize) ? (begin + context->grainSize) : context->end;
+
+    if (context->forBody != NULL)
+    {
+        context->forBody (begin, end, context->customData);
+    }
+    else
+    {
+        context->reduceBody (begin, end, context->partials + chunk * context->partialSize, context->customData);
+    }
+}
+
+/**
+ * Run a range of chunks: spawn the upper half, run the lower half, then join the two halves
+ */
+static void ARSAL_Parallel_Task (ARSAL_Scheduler_t *scheduler, void *customData)
+{
+    ARSAL_Parallel_Range_t *range = (ARSAL_Parallel_Range_t *)customData;
+    ARSAL_Parallel_Context_t *context = range->context;
+    ARSAL_Parallel_Range_t lower;
+    ARSAL_Parallel_Range_t upper;
+    ARSAL_Scheduler_Group_t group;
+    size_t middle;
+
+    if (range->lastChunk - range->firstChunk == 1)
+    {
+        ARSAL_Parallel_RunChunk (context, range->firstChunk);
+    }
+    else
+    {
+        middle = range->firstChunk + (range->lastChunk - range->firstChunk) / 2;
+        lower.context = context;
+        lower.firstChunk = range->firstChunk;
+        lower.lastChunk = middle;
+        upper.context = context;
+        upper.firstChunk = middle;
+        upper.lastChunk = range->lastChunk;
+
+        ARSAL_Scheduler_Group_Init (&group);
+        if (ARSAL_Scheduler_Spawn (scheduler, &group, ARSAL_Parallel_Task, &upper) != ARSAL_OK)
+        {
+            // Not spawned, run it here
+            ARSAL_Parallel_Task (scheduler, &upper);
+        }
+        // No else --> Run by a worker, or taken back by this one
+
+        ARSAL_Parallel_Task (scheduler, &lower);
+        ARSAL_Scheduler_Wait (scheduler, &group);
+
+        if (context->join != NULL)
+        {
+            context->join (context->partials + lower.firstChunk * context->partialSize,
+                           context->partials + upper.firstChunk * context->partialSize, context->customData);
+        }
+        // No else --> Parallel loop
+    }
+}
+
+/**
+ * Choose the scheduler and the grain size of a range, and count its chunks
+ * @return The number of chunks, 1 to run the range in the calling thread
+ */
+static size_t ARSAL_Parallel_Prepare (ARSAL_Scheduler_t **scheduler, ARSAL_Parallel_Context_t *context)
+{
+    size_t count = context->end - context->begin;
+    size_t chunkCount;
+    int threadCount;
+
+    if (*scheduler == NULL)
+    {
+        *scheduler = ARSAL_Parallel_GetDefaultScheduler ();
+    }
+    // No else --> Scheduler of the caller
+
+    threadCount = ARSAL_Scheduler_GetThreadCount (*scheduler);
+    if (threadCount <= 0)
+    {
+        // No scheduler, run the range as a single chunk
+        context->grainSize = count;
+    }
+    else if (context->grainSize == ARSAL_PARALLEL_AUTO_GRAIN)
+    {
+        chunkCount = (size_t)threadCount * ARSAL_PARALLEL_CHUNKS_PER_THREAD;
+        context->grainSize = count / chunkCount + ((count % chunkCount) != 0);
+    }
+    // No else --> Grain size of the caller
+
+    if (context->grainSize == 0)
+    {
+        // Empty range
+        return 1;
+    }
+    // No else --> Count the chunks
+
+    return count / context->grainSize + ((count % context->grainSize) != 0);
+}
+
+ARSAL_Scheduler_t* ARSAL_Parallel_GetDefaultScheduler(void)
+{
+    ARSAL_Scheduler_t *scheduler = __atomic_load_n (&ARSAL_Parallel_defaultScheduler, __ATOMIC_ACQUIRE);
+    ARSAL_Scheduler_t *expected = NULL;
+    eARSAL_ERROR error = ARSAL_OK;
+
+    if (scheduler == NULL)
+    {
+        scheduler = ARSAL_Scheduler_New (0, NULL, &error);
+        if (scheduler == NULL)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_PARALLEL_TAG, "Unable to create the default scheduler: %s", ARSAL_Error_ToString (error));
+        }
+        else if (!__atomic_compare_exchange_n (&ARSAL_Parallel_defaultScheduler, &expected, scheduler, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            // Created concurrently by another thread
+            ARSAL_Scheduler_Delete (&scheduler);
+            scheduler = expected;
+        }
+        // No else --> Published
+    }
+    // No else --> Already created
+
+    return scheduler;
+}
+
+eARSAL_ERROR ARSAL_Parallel_For(ARSAL_Scheduler_t *scheduler, size_t begin, size_t end, size_t grainSize, ARSAL_Parallel_ForBody_t body, void *customData)
+{
+    ARSAL_Parallel_Context_t context;
+    ARSAL_Parallel_Range_t range;
+
+    if ((begin > end) || (body == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (begin == end)
+    {
+        return ARSAL_OK;
+    }
+    // No else --> Not empty
+
+    memset (&context, 0, sizeof (context));
+    context.begin = begin;
+    context.end = end;
+    context.grainSize = grainSize;
+    context.forBody = body;
+    context.customData = customData;
+
+    range.context = &context;
+    range.firstChunk = 0;
+    range.lastChunk = ARSAL_Parallel_Prepare (&scheduler, &context);
+
+    if (range.lastChunk == 1)
+    {
+        body (begin, end, customData);
+    }
+    else
+    {
+        ARSAL_Parallel_Task (scheduler, &range);
+    }
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_Parallel_Reduce(ARSAL_Scheduler_t *scheduler, size_t begin, size_t end, size_t grainSize, size_t partialSize, const void *identity, ARSAL_Parallel_ReduceBody_t body, ARSAL_Parallel_Join_t join, void *customData, void *result)
+{
+    ARSAL_Parallel_Context_t context;
+    ARSAL_Parallel_Range_t range;
+    eARSAL_ERROR error = ARSAL_OK;
+    size_t i;
+
+    if ((begin > end) || (partialSize == 0) || (identity == NULL) || (body == NULL) || (join == NULL) || (result == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    memset (&context, 0, sizeof (context));
+    context.begin = begin;
+    context.end = end;
+    context.grainSize = grainSize;
+    context.reduceBody = body;
+    context.join = join;
+    context.partialSize = partialSize;
+    context.customData = customData;
+
+    range.context = &context;
+    range.firstChunk = 0;
+    range.lastChunk = (begin < end) ? ARSAL_Parallel_Prepare (&scheduler, &context) : 1;
+
+    if (range.lastChunk == 1)
+    {
+        memmove (result, identity, partialSize);
+        if (begin < end)
+        {
+            body (begin, end, result, customData);
+        }
+        // No else --> Empty range
+    }
+    else
+    {
+        context.partials = malloc (range.lastChunk * partialSize);
+        if (context.partials == NULL)
+        {
+            error = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            for (i = 0; i < range.lastChunk; i++)
+            {
+                memcpy (context.partials + i * partialSize, identity, partialSize);
+            }
+
+            ARSAL_Parallel_Task (scheduler, &range);
+
+            memcpy (result, context.partials, partialSize);
+            free (context.partials);
+        }
+    }
+
+    return error;
+}
@@ -0,0 +1,842 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_PathFilter.c
+ * @brief libARSAL path filters, evaluated by the directory walks before stating the entries.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "libARSAL/ARSAL_Ftw.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "ARSAL_PathFilter.h"
+
+#define ARSAL_PATHFILTER_TAG    "PathFilter"
+
+/**
+ * Pattern list
+ */
+typedef struct
+{
+    char **patterns;
+    int count;
+    int capacity;
+} ARSAL_PathFilter_List_t;
+
+/**
+ * Glob token types
+ */
+typedef enum
+{
+    ARSAL_PATHFILTER_TOKEN_CHAR = 0, /**< One given character */
+    ARSAL_PATHFILTER_TOKEN_ANY, /**< '?': any character */
+    ARSAL_PATHFILTER_TOKEN_CLASS, /**< '[...]': a character of a class */
+    ARSAL_PATHFILTER_TOKEN_STAR, /**< '*': any characters */
+} eARSAL_PATHFILTER_TOKEN;
+
+/**
+ * Glob token
+ */
+typedef struct
+{
+    uint8_t type; /**< Type of the token: eARSAL_PATHFILTER_TOKEN */
+    uint8_t c; /**< Character of ARSAL_PATHFILTER_TOKEN_CHAR */
+    uint16_t set; /**< Index of the class of ARSAL_PATHFILTER_TOKEN_CLASS */
+} ARSAL_PathFilter_Token_t;
+
+/**
+ * Glob segment: the part of a glob between two '/'
+ */
+typedef struct
+{
+    int first; /**< Index of the first token */
+    int count; /**< Number of tokens, -1 for "**" which matches any number of directories */
+    int length; /**< Number of characters matched by the tokens other than '*' */
+    int star; /**< Whether the segment holds a '*', otherwise it matches exactly length characters */
+    int prefix; /**< Number of ARSAL_PATHFILTER_TOKEN_CHAR tokens before the first '*' */
+    int suffix; /**< Number of ARSAL_PATHFILTER_TOKEN_CHAR tokens after the last '*' */
+} ARSAL_PathFilter_Segment_t;
+
+/**
+ * Glob, compiled when it is added
+ */
+typedef struct
+{
+    ARSAL_PathFilter_Segment_t *segments;
+    int segmentCount;
+    ARSAL_PathFilter_Token_t *tokens;
+    uint8_t (*sets)[32]; /**< Classes, one bit per character */
+} ARSAL_PathFilter_Glob_t;
+
+/**
+ * Glob list
+ */
+typedef struct
+{
+    ARSAL_PathFilter_Glob_t *globs;
+    int count;
+    int capacity;
+} ARSAL_PathFilter_GlobList_t;
+
+struct _ARSAL_PathFilter_t
+{
+    ARSAL_PathFilter_GlobList_t nameGlobs; /**< Globs matched against the names */
+    ARSAL_PathFilter_GlobList_t pathGlobs; /**< Globs matched against the relative paths */
+    ARSAL_PathFilter_List_t extensions; /**< Extensions, lower case with their leading dot */
+    uint64_t minSize;
+    uint64_t maxSize;
+    int64_t minMtime;
+    int64_t maxMtime;
+    int minDepth;
+    int maxDepth;
+};
+
+static eARSAL_ERROR ARSAL_PathFilter_List_Add (ARSAL_PathFilter_List_t *list, char *pattern)
+{
+    char **patterns;
+    int capacity;
+
+    if (pattern == NULL)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Pattern copied
+
+    if (list->count >= list->capacity)
+    {
+        capacity = (list->capacity > 0) ? list->capacity * 2 : 4;
+        patterns = realloc (list->patterns, capacity * sizeof (char *));
+        if (patterns == NULL)
+        {
+            free (pattern);
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Reallocated
+        list->patterns = patterns;
+        list->capacity = capacity;
+    }
+    // No else --> No need to realloc in this case
+
+    list->patterns[list->count++] = pattern;
+
+    return ARSAL_OK;
+}
+
+static void ARSAL_PathFilter_List_Clear (ARSAL_PathFilter_List_t *list)
+{
+    int i;
+
+    for (i = 0; i < list->count; i++)
+    {
+        free (list->patterns[i]);
+    }
+    free (list->patterns);
+    memset (list, 0, sizeof (ARSAL_PathFilter_List_t));
+}
+
+static void ARSAL_PathFilter_Glob_Clear (ARSAL_PathFilter_Glob_t *glob)
+{
+    free (glob->segments);
+    free (glob->tokens);
+    free (glob->sets);
+    memset (glob, 0, sizeof (ARSAL_PathFilter_Glob_t));
+}
+
+static void ARSAL_PathFilter_GlobList_Clear (ARSAL_PathFilter_GlobList_t *list)
+{
+    int i;
+
+    for (i = 0; i < list->count; i++)
+    {
+        ARSAL_PathFilter_Glob_Clear (&list->globs[i]);
+    }
+    free (list->globs);
+    memset (list, 0, sizeof (ARSAL_PathFilter_GlobList_t));
+}
+
+/**
+ * Compile a class into a set, pattern points after the '['
+ * @return The pattern following the class, or NULL if the class is not closed in this segment: the '[' is a plain character
+ */
+static const char* ARSAL_PathFilter_CompileClass (const char *pattern, uint8_t *set)
+{
+    const char *end;
+    int negate = 0;
+    int low;
+    int high;
+    int c;
+
+    if ((*pattern == '!') || (*pattern == '^'))
+    {
+        negate = 1;
+        pattern++;
+    }
+    // No else --> Positive class
+
+    // The first character of the class is never its closing bracket
+    if ((pattern[0] == '\0') || (pattern[0] == '/'))
+    {
+        return NULL;
+    }
+    // No else --> Look for the closing bracket
+    for (end = pattern + 1; *end != ']'; end++)
+    {
+        if ((*end == '\0') || (*end == '/'))
+        {
+            return NULL;
+        }
+        // No else --> Still in the class
+    }
+
+    memset (set, 0, 32);
+    do
+    {
+        low = (unsigned char)*pattern++;
+        high = low;
+        if ((pattern[0] == '-') && (pattern != end - 1))
+        {
+            high = (unsigned char)pattern[1];
+            pattern += 2;
+        }
+        // No else --> Single character
+
+        for (c = low; c <= high; c++)
+        {
+            set[c >> 3] |= 1 << (c & 7);
+        }
+    }
+    while (pattern < end);
+
+    if (negate)
+    {
+        for (c = 0; c < 32; c++)
+        {
+            set[c] = ~set[c];
+        }
+    }
+    // No else --> Positive class
+
+    return end + 1;
+}
+
+/**
+ * Compute the literal bounds of the last segment of a glob being compiled
+ */
+static void ARSAL_PathFilter_EndSegment (ARSAL_PathFilter_Glob_t *glob, int tokenCount, const char *text, const char *textEnd)
+{
+    ARSAL_PathFilter_Segment_t *segment = &glob->segments[glob->segmentCount - 1];
+    ARSAL_PathFilter_Token_t *tokens = &glob->tokens[segment->first];
+    int i;
+
+    segment->count = tokenCount - segment->first;
+    if ((textEnd - text == 2) && (text[0] == '*') && (text[1] == '*'))
+    {
+        segment->count = -1;
+        return;
+    }
+    // No else --> Segment of a single path component
+
+    for (i = 0; i < segment->count; i++)
+    {
+        if (tokens[i].type == ARSAL_PATHFILTER_TOKEN_STAR)
+        {
+            segment->star = 1;
+        }
+        else
+        {
+            segment->length++;
+        }
+    }
+
+    if (segment->star)
+    {
+        while (tokens[segment->prefix].type == ARSAL_PATHFILTER_TOKEN_CHAR)
+        {
+            segment->prefix++;
+        }
+        while (tokens[segment->count - 1 - segment->suffix].type == ARSAL_PATHFILTER_TOKEN_CHAR)
+        {
+            segment->suffix++;
+        }
+    }
+    // No else --> Matched token by token
+}
+
+/**
+ * Compile a glob into segments of tokens
+ * @note Empty segments are kept: "a//b" only matches a path holding "//", that is none.
+ */
+static eARSAL_ERROR ARSAL_PathFilter_Compile (const char *pattern, ARSAL_PathFilter_Glob_t *glob)
+{
+    const char *text = pattern;
+    const char *next;
+    size_t length = strlen (pattern);
+    int segmentCount = 1;
+    int setCount = 0;
+    int tokenCount = 0;
+    size_t i;
+
+    memset (glob, 0, sizeof (ARSAL_PathFilter_Glob_t));
+    for (i = 0; i < length; i++)
+    {
+        segmentCount += (pattern[i] == '/');
+        setCount += (pattern[i] == '[');
+    }
+
+    if (setCount > UINT16_MAX + 1)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Set indexes fit in the tokens
+
+    glob->segments = calloc (segmentCount, sizeof (ARSAL_PathFilter_Segment_t));
+    glob->tokens = malloc ((length + 1) * sizeof (ARSAL_PathFilter_Token_t));
+    glob->sets = malloc ((setCount + 1) * sizeof (*glob->sets));
+    if ((glob->segments == NULL) || (glob->tokens == NULL) || (glob->sets == NULL))
+    {
+        ARSAL_PathFilter_Glob_Clear (glob);
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Allocated
+
+    setCount = 0;
+    glob->segmentCount = 1;
+    for (;;)
+    {
+        ARSAL_PathFilter_Token_t *token = &glob->tokens[tokenCount];
+
+        if ((*pattern == '\0') || (*pattern == '/'))
+        {
+            ARSAL_PathFilter_EndSegment (glob, tokenCount, text, pattern);
+            if (*pattern == '\0')
+            {
+                break;
+            }
+            // No else --> Next segment
+            pattern++;
+            text = pattern;
+            glob->segments[glob->segmentCount++].first = tokenCount;
+            continue;
+        }
+        // No else --> Token of the current segment
+
+        token->c = 0;
+        token->set = 0;
+        switch (*pattern)
+        {
+        case '*':
+            pattern++;
+            if ((tokenCount > glob->segments[glob->segmentCount - 1].first) && (token[-1].type == ARSAL_PATHFILTER_TOKEN_STAR))
+            {
+                // "**" inside a segment is the same as '*'
+                continue;
+            }
+            // No else --> New star
+            token->type = ARSAL_PATHFILTER_TOKEN_STAR;
+            break;
+
+        case '?':
+            pattern++;
+            token->type = ARSAL_PATHFILTER_TOKEN_ANY;
+            break;
+
+        case '[':
+            next = ARSAL_PathFilter_CompileClass (pattern + 1, glob->sets[setCount]);
+            if (next != NULL)
+            {
+                pattern = next;
+                token->type = ARSAL_PATHFILTER_TOKEN_CLASS;
+                token->set = setCount++;
+                break;
+            }
+            // No else --> No closing bracket: a plain character
+            // Fallthrough
+
+        default:
+            token->type = ARSAL_PATHFILTER_TOKEN_CHAR;
+            token->c = (unsigned char)*pattern++;
+            break;
+        }
+        tokenCount++;
+    }
+
+    return ARSAL_OK;
+}
+
+static eARSAL_ERROR ARSAL_PathFilter_GlobList_Add (ARSAL_PathFilter_GlobList_t *list, const char *pattern)
+{
+    ARSAL_PathFilter_Glob_t *globs;
+    eARSAL_ERROR result;
+    int capacity;
+
+    if (list->count >= list->capacity)
+    {
+        capacity = (list->capacity > 0) ? list->capacity * 2 : 4;
+        globs = realloc (list->globs, capacity * sizeof (ARSAL_PathFilter_Glob_t));
+        if (globs == NULL)
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Reallocated
+        list->globs = globs;
+        list->capacity = capacity;
+    }
+    // No else --> No need to realloc in this case
+
+    result = ARSAL_PathFilter_Compile (pattern, &list->globs[list->count]);
+    if (result == ARSAL_OK)
+    {
+        list->count++;
+    }
+    // No else --> Not added
+
+    return result;
+}
+
+static inline int ARSAL_PathFilter_MatchToken (const ARSAL_PathFilter_Glob_t *glob, const ARSAL_PathFilter_Token_t *token, uint8_t c)
+{
+    switch (token->type)
+    {
+    case ARSAL_PATHFILTER_TOKEN_CHAR:
+        return (token->c == c);
+    case ARSAL_PATHFILTER_TOKEN_CLASS:
+        return ((glob->sets[token->set][c >> 3] >> (c & 7)) & 1);
+    default:
+        return 1;
+    }
+}
+
+/**
+ * Match a path component against a segment
+ * @note '*' is matched with a single backtrack point, the last '*' met: the time is at most the product of the lengths.
+ */
+static int ARSAL_PathFilter_MatchSegment (const ARSAL_PathFilter_Glob_t *glob, const ARSAL_PathFilter_Segment_t *segment, const char *string, int length)
+{
+    const ARSAL_PathFilter_Token_t *tokens = &glob->tokens[segment->first];
+    const uint8_t *s = (const uint8_t *)string;
+    int count = segment->count;
+    int starToken = -1;
+    int starChar = 0;
+    int t = 0;
+    int i = 0;
+
+    if ((length < segment->length) || ((!segment->star) && (length != segment->length)))
+    {
+        return 0;
+    }
+    // No else --> Long enough
+
+    if (segment->star)
+    {
+        // The literal prefix and suffix reject most of the names at once
+        for (i = 0; i < segment->prefix; i++)
+        {
+            if (tokens[i].c != s[i])
+            {
+                return 0;
+            }
+            // No else --> Same character
+        }
+        for (i = 1; i <= segment->suffix; i++)
+        {
+            if (tokens[count - i].c != s[length - i])
+            {
+                return 0;
+            }
+            // No else --> Same character
+        }
+        // Match the middle, the suffix has to be matched by the last tokens
+        t = segment->prefix;
+        i = segment->prefix;
+        count -= segment->suffix;
+        length -= segment->suffix;
+    }
+    // No else --> Token by token
+
+    while (i < length)
+    {
+        if ((t < count) && (tokens[t].type == ARSAL_PATHFILTER_TOKEN_STAR))
+        {
+            // Match no character first, then one more at each backtrack
+            starToken = t++;
+            starChar = i;
+        }
+        else if ((t < count) && (ARSAL_PathFilter_MatchToken (glob, &tokens[t], s[i])))
+        {
+            t++;
+            i++;
+        }
+        else if (starToken >= 0)
+        {
+            t = starToken + 1;
+            i = ++starChar;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    while ((t < count) && (tokens[t].type == ARSAL_PATHFILTER_TOKEN_STAR))
+    {
+        t++;
+    }
+
+    return (t == count);
+}
+
+/**
+ * Get the path component following a component
+ * @param partial When set, the path is a directory ending with a '/'
+ * @return The next component, or NULL at the end of the path
+ */
+static const char* ARSAL_PathFilter_NextComponent (const char *component, int partial)
+{
+    const char *next = strchr (component, '/');
+
+    if ((next == NULL) || ((partial) && (next[1] == '\0')))
+    {
+        return NULL;
+    }
+    // No else --> Not the last component
+
+    return next + 1;
+}
+
+/**
+ * Match a path against a glob, component by component
+ * @note "**" segments are matched like the '*' of ARSAL_PathFilter_MatchSegment (), with a single backtrack point.
+ * @param partial When set, the path is a directory ending with a '/': match when the directory can hold a matching path
+ */
+static int ARSAL_PathFilter_MatchPath (const ARSAL_PathFilter_Glob_t *glob, const char *path, int partial)
+{
+    const ARSAL_PathFilter_Segment_t *segments = glob->segments;
+    const char *component = path;
+    const char *starComponent = NULL;
+    const char *end;
+    int starSegment = -1;
+    int s = 0;
+
+    while (component != NULL)
+    {
+        if ((s < glob->segmentCount) && (segments[s].count < 0))
+        {
+            // Match no directory first, then one more at each backtrack
+            starSegment = s++;
+            starComponent = component;
+            continue;
+        }
+        // No else --> Single component
+
+        end = strchr (component, '/');
+        if (end == NULL)
+        {
+            end = component + strlen (component);
+        }
+        // No else --> Not the last component
+
+        if ((s < glob->segmentCount) && (ARSAL_PathFilter_MatchSegment (glob, &segments[s], component, end - component)))
+        {
+            s++;
+            component = ARSAL_PathFilter_NextComponent (component, partial);
+        }
+        else if (starSegment >= 0)
+        {
+            s = starSegment + 1;
+            starComponent = ARSAL_PathFilter_NextComponent (starComponent, partial);
+            component = starComponent;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    if (partial)
+    {
+        // Entries of the directory can match the remaining segments, or the "**" can take them
+        return ((s < glob->segmentCount) || (starSegment >= 0));
+    }
+    // No else --> Full match
+
+    while ((s < glob->segmentCount) && (segments[s].count < 0))
+    {
+        s++;
+    }
+
+    return (s == glob->segmentCount);
+}
+
+ARSAL_PathFilter_t* ARSAL_PathFilter_New(eARSAL_ERROR *error)
+{
+    ARSAL_PathFilter_t *filter = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    filter = calloc (1, sizeof (ARSAL_PathFilter_t));
+    if (filter == NULL)
+    {
+        result = ARSAL_ERROR_ALLOC;
+    }
+    else
+    {
+        filter->maxSize = UINT64_MAX;
+        filter->minMtime = INT64_MIN;
+        filter->maxMtime = INT64_MAX;
+        filter->maxDepth = -1;
+    }
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return filter;
+}
+
+void ARSAL_PathFilter_Delete(ARSAL_PathFilter_t **filterAddr)
+{
+    if ((filterAddr != NULL) && (*filterAddr != NULL))
+    {
+        ARSAL_PathFilter_GlobList_Clear (&(*filterAddr)->nameGlobs);
+        ARSAL_PathFilter_GlobList_Clear (&(*filterAddr)->pathGlobs);
+        ARSAL_PathFilter_List_Clear (&(*filterAddr)->extensions);
+        free (*filterAddr);
+        *filterAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+eARSAL_ERROR ARSAL_PathFilter_AddGlob(ARSAL_PathFilter_t *filter, const char *glob)
+{
+    if ((filter == NULL) || (glob == NULL) || (glob[0] == '\0'))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (strchr (glob, '/') == NULL)
+    {
+        return ARSAL_PathFilter_GlobList_Add (&filter->nameGlobs, glob);
+    }
+    // No else --> Path glob
+
+    while (glob[0] == '/')
+    {
+        // Paths are relative to the walked directory
+        glob++;
+    }
+
+    return ARSAL_PathFilter_GlobList_Add (&filter->pathGlobs, glob);
+}
+
+eARSAL_ERROR ARSAL_PathFilter_AddExtension(ARSAL_PathFilter_t *filter, const char *extension)
+{
+    char *pattern;
+    size_t i;
+
+    if ((filter == NULL) || (extension == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (extension[0] == '.')
+    {
+        extension++;
+    }
+    // No else --> No leading dot
+
+    pattern = malloc (strlen (extension) + 2);
+    if (pattern != NULL)
+    {
+        pattern[0] = '.';
+        for (i = 0; extension[i] != '\0'; i++)
+        {
+            pattern[i + 1] = tolower ((unsigned char)extension[i]);
+        }
+        pattern[i + 1] = '\0';
+    }
+    // No else --> Alloc error
+
+    return ARSAL_PathFilter_List_Add (&filter->extensions, pattern);
+}
+
+eARSAL_ERROR ARSAL_PathFilter_SetSizeRange(ARSAL_PathFilter_t *filter, uint64_t minSize, uint64_t maxSize)
+{
+    if ((filter == NULL) || (minSize > maxSize))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    filter->minSize = minSize;
+    filter->maxSize = maxSize;
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_PathFilter_SetMtimeRange(ARSAL_PathFilter_t *filter, int64_t minMtime, int64_t maxMtime)
+{
+    if ((filter == NULL) || (minMtime > maxMtime))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    filter->minMtime = minMtime;
+    filter->maxMtime = maxMtime;
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_PathFilter_SetDepthRange(ARSAL_PathFilter_t *filter, int minDepth, int maxDepth)
+{
+    if ((filter == NULL) || (minDepth < 0) || ((maxDepth >= 0) && (minDepth > maxDepth)))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    filter->minDepth = minDepth;
+    filter->maxDepth = (maxDepth >= 0) ? maxDepth : -1;
+
+    return ARSAL_OK;
+}
+
+int ARSAL_PathFilter_MatchName(const ARSAL_PathFilter_t *filter, const char *relPath, const char *name, int depth)
+{
+    size_t nameLen;
+    size_t extensionLen;
+    int i;
+
+    if ((depth < filter->minDepth) || ((filter->maxDepth >= 0) && (depth > filter->maxDepth)))
+    {
+        return 0;
+    }
+    // No else --> In the depth range
+
+    if ((filter->nameGlobs.count == 0) && (filter->pathGlobs.count == 0) && (filter->extensions.count == 0))
+    {
+        return 1;
+    }
+    // No else --> Match one of the patterns
+
+    nameLen = strlen (name);
+    for (i = 0; i < filter->extensions.count; i++)
+    {
+        extensionLen = strlen (filter->extensions.patterns[i]);
+        if ((nameLen > extensionLen) && (strcasecmp (&name[nameLen - extensionLen], filter->extensions.patterns[i]) == 0))
+        {
+            return 1;
+        }
+        // No else --> Next extension
+    }
+
+    for (i = 0; i < filter->nameGlobs.count; i++)
+    {
+        if (ARSAL_PathFilter_MatchSegment (&filter->nameGlobs.globs[i], &filter->nameGlobs.globs[i].segments[0], name, (int)nameLen))
+        {
+            return 1;
+        }
+        // No else --> Next glob
+    }
+
+    for (i = 0; i < filter->pathGlobs.count; i++)
+    {
+        if (ARSAL_PathFilter_MatchPath (&filter->pathGlobs.globs[i], relPath, 0))
+        {
+            return 1;
+        }
+        // No else --> Next glob
+    }
+
+    return 0;
+}
+
+int ARSAL_PathFilter_MatchStat(const ARSAL_PathFilter_t *filter, const struct stat *sb)
+{
+    return (((uint64_t)sb->st_size >= filter->minSize) && ((uint64_t)sb->st_size <= filter->maxSize) &&
+            ((int64_t)sb->st_mtime >= filter->minMtime) && ((int64_t)sb->st_mtime <= filter->maxMtime));
+}
+
+int ARSAL_PathFilter_CanDescend(const ARSAL_PathFilter_t *filter, const char *relDirPath, int depth)
+{
+    int i;
+
+    if ((filter->maxDepth >= 0) && (depth >= filter->maxDepth))
+    {
+        // Its entries are too deep
+        return 0;
+    }
+    // No else --> In the depth range
+
+    if ((filter->pathGlobs.count == 0) || (filter->nameGlobs.count > 0) || (filter->extensions.count > 0))
+    {
+        // Files of any directory can match
+        return 1;
+    }
+    // No else --> Only path globs
+
+    for (i = 0; i < filter->pathGlobs.count; i++)
+    {
+        if (ARSAL_PathFilter_MatchPath (&filter->pathGlobs.globs[i], relDirPath, 1))
+        {
+            return 1;
+        }
+        // No else --> Next glob
+    }
+
+    return 0;
+}
+
+int ARSAL_PathFilter_GetStatMask(const ARSAL_PathFilter_t *filter)
+{
+    int statMask = ARSAL_FTW_STAT_TYPE;
+
+    if ((filter->minSize > 0) || (filter->maxSize < UINT64_MAX))
+    {
+        statMask |= ARSAL_FTW_STAT_SIZE;
+    }
+    // No else --> Size not checked
+
+    if ((filter->minMtime > INT64_MIN) || (filter->maxMtime < INT64_MAX))
+    {
+        statMask |= ARSAL_FTW_STAT_TIMES;
+    }
+    // No else --> Modification time not checked
+
+    return statMask;
+}
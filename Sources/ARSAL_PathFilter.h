@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_PathFilter.h
+ * @brief Path filter evaluation, used by the directory walks.
+ **/
+
+#ifndef _ARSAL_PATHFILTER_PRIVATE_H_
+#define _ARSAL_PATHFILTER_PRIVATE_H_
+
+#include <sys/stat.h>
+#include "libARSAL/ARSAL_PathFilter.h"
+
+/**
+ * @brief Check the globs, extensions and depth range of a file, before stating it
+ * @param filter The filter
+ * @param relPath The path of the file relative to the walked directory
+ * @param name The name of the file
+ * @param depth The depth of the file
+ * @return 1 if the file can match, 0 otherwise
+ */
+int ARSAL_PathFilter_MatchName(const ARSAL_PathFilter_t *filter, const char *relPath, const char *name, int depth);
+
+/**
+ * @brief Check the size and modification time ranges of a file
+ * @param filter The filter
+ * @param sb The stat of the file
+ * @return 1 if the file matches, 0 otherwise
+ */
+int ARSAL_PathFilter_MatchStat(const ARSAL_PathFilter_t *filter, const struct stat *sb);
+
+/**
+ * @brief Check whether a directory can hold matching files, before stating it
+ * @param filter The filter
+ * @param relDirPath The path of the directory relative to the walked directory, followed by a '/'
+ * @param depth The depth of the directory
+ * @return 1 if the directory must be walked, 0 if it can be pruned
+ */
+int ARSAL_PathFilter_CanDescend(const ARSAL_PathFilter_t *filter, const char *relDirPath, int depth);
+
+/**
+ * @brief Get the metadata needed by ARSAL_PathFilter_MatchStat ()
+ * @param filter The filter
+ * @return A combination of eARSAL_FTW_STAT_MASK
+ */
+int ARSAL_PathFilter_GetStatMask(const ARSAL_PathFilter_t *filter);
+
+#endif /* _ARSAL_PATHFILTER_PRIVATE_H_ */
@@ -0,0 +1,707 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Scheduler.c
+ * @brief libARSAL work-stealing task scheduler, each worker owns a Chase-Lev deque.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+
+#include "libARSAL/ARSAL_Scheduler.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+
+#define ARSAL_SCHEDULER_TAG                 "Scheduler"
+
+#define ARSAL_SCHEDULER_DEQUE_MIN_SIZE      (256)
+#define ARSAL_SCHEDULER_CACHE_LINE_SIZE     (64)
+#define ARSAL_SCHEDULER_SPIN_COUNT          (64) /**< Failed searches for a task before sleeping */
+#define ARSAL_SCHEDULER_GROUP_SLEEPING      (1 << 30) /**< Flag of the pending count of a group: a thread sleeps until it completes */
+
+/**
+ * A spawned task, recycled through free lists
+ */
+typedef struct _ARSAL_Scheduler_Job_t ARSAL_Scheduler_Job_t;
+struct _ARSAL_Scheduler_Job_t
+{
+    ARSAL_Scheduler_Task_t task;
+    void *customData;
+    ARSAL_Scheduler_Group_t *group;
+    ARSAL_Scheduler_Job_t *next; /**< Next job of a free list or of the injection queue */
+};
+
+/**
+ * Circular array of a deque, indexed by the top and bottom counters modulo its size
+ */
+typedef struct _ARSAL_Scheduler_Array_t ARSAL_Scheduler_Array_t;
+struct _ARSAL_Scheduler_Array_t
+{
+    long size; /**< Power of two */
+    ARSAL_Scheduler_Array_t *previous; /**< Array replaced when this one grew, freed with the deque since a thief may still read it */
+    ARSAL_Scheduler_Job_t *jobs[];
+};
+
+/**
+ * Worker and its deque: the owner pushes and takes at the bottom, the thieves take at the top
+ */
+typedef struct
+{
+    long top;
+    char topPadding[ARSAL_SCHEDULER_CACHE_LINE_SIZE - sizeof (long)];
+    long bottom;
+    ARSAL_Scheduler_Array_t *array;
+    ARSAL_Scheduler_Job_t *freeJobs; /**< Owner only */
+    unsigned int seed; /**< Owner only, for the choice of the victims */
+    ARSAL_Scheduler_t *scheduler;
+    ARSAL_Thread_t thread;
+    char bottomPadding[ARSAL_SCHEDULER_CACHE_LINE_SIZE];
+} ARSAL_Scheduler_Worker_t;
+
+struct _ARSAL_Scheduler_t
+{
+    int workerCount;
+    ARSAL_Scheduler_Worker_t *workers;
+    int startedCount;
+    ARSAL_Mutex_t mutex; /**< Protects the injection queue and the sleeps */
+    ARSAL_Cond_t cond; /**< Signaled for new tasks and completed groups */
+    ARSAL_Cond_t waitCond; /**< Signaled for completed groups, waited for from outside the workers */
+    ARSAL_Scheduler_Job_t *injectHead; /**< Tasks spawned from outside the workers */
+    ARSAL_Scheduler_Job_t *injectTail;
+    int sleepers; /**< Workers sleeping or about to sleep on cond */
+    int stop;
+};
+
+/**
+ * Worker of the calling thread, NULL outside the workers
+ */
+static __thread ARSAL_Scheduler_Worker_t *ARSAL_Scheduler_currentWorker = NULL;
+
+static ARSAL_Scheduler_Array_t* ARSAL_Scheduler_Array_New (long size)
+{
+    ARSAL_Scheduler_Array_t *array = malloc (sizeof (ARSAL_Scheduler_Array_t) + size * sizeof (ARSAL_Scheduler_Job_t *));
+
+    if (array != NULL)
+    {
+        array->size = size;
+        array->previous = NULL;
+    }
+    // No else --> Alloc error
+
+    return array;
+}
+
+/**
+ * Push a job at the bottom of the deque of the calling worker
+ */
+static int ARSAL_Scheduler_Push (ARSAL_Scheduler_Worker_t *worker, ARSAL_Scheduler_Job_t *job)
+{
+    ARSAL_Scheduler_Array_t *array;
+    ARSAL_Scheduler_Array_t *newArray;
+    long bottom = __atomic_load_n (&worker->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n (&worker->top, __ATOMIC_ACQUIRE);
+    long i;
+
+    array = __atomic_load_n (&worker->array, __ATOMIC_RELAXED);
+    if (bottom - top > array->size - 1)
+    {
+        // Full: copy the jobs to a twice bigger array, the old one stays readable by the thieves
+        newArray = ARSAL_Scheduler_Array_New (array->size * 2);
+        if (newArray == NULL)
+        {
+            return -1;
+        }
+        // No else --> Alloc check
+        for (i = top; i < bottom; i++)
+        {
+            newArray->jobs[i & (newArray->size - 1)] = __atomic_load_n (&array->jobs[i & (array->size - 1)], __ATOMIC_RELAXED);
+        }
+        newArray->previous = array;
+        __atomic_store_n (&worker->array, newArray, __ATOMIC_RELEASE);
+        array = newArray;
+    }
+    // No else --> Room left
+
+    __atomic_store_n (&array->jobs[bottom & (array->size - 1)], job, __ATOMIC_RELAXED);
+    __atomic_store_n (&worker->bottom, bottom + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Take the last pushed job of the deque of the calling worker
+ */
+static ARSAL_Scheduler_Job_t* ARSAL_Scheduler_Take (ARSAL_Scheduler_Worker_t *worker)
+{
+    ARSAL_Scheduler_Job_t *job = NULL;
+    ARSAL_Scheduler_Array_t *array;
+    long bottom = __atomic_load_n (&worker->bottom, __ATOMIC_RELAXED) - 1;
+    long top;
+
+    array = __atomic_load_n (&worker->array, __ATOMIC_RELAXED);
+    __atomic_store_n (&worker->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    top = __atomic_load_n (&worker->top, __ATOMIC_RELAXED);
+
+    if (top <= bottom)
+    {
+        job = __atomic_load_n (&array->jobs[bottom & (array->size - 1)], __ATOMIC_RELAXED);
+        if (top == bottom)
+        {
+            // Last job, race with the thieves for it
+            if (!__atomic_compare_exchange_n (&worker->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            {
+                job = NULL;
+            }
+            // No else --> Won
+            __atomic_store_n (&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+        }
+        // No else --> No thief can reach this job
+    }
+    else
+    {
+        // Empty
+        __atomic_store_n (&worker->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return job;
+}
+
+/**
+ * Take the oldest job of the deque of another worker
+ */
+static ARSAL_Scheduler_Job_t* ARSAL_Scheduler_Steal (ARSAL_Scheduler_Worker_t *victim)
+{
+    ARSAL_Scheduler_Job_t *job = NULL;
+    ARSAL_Scheduler_Array_t *array;
+    long top = __atomic_load_n (&victim->top, __ATOMIC_ACQUIRE);
+    long bottom;
+
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n (&victim->bottom, __ATOMIC_ACQUIRE);
+
+    if (top < bottom)
+    {
+        array = __atomic_load_n (&victim->array, __ATOMIC_ACQUIRE);
+        job = __atomic_load_n (&array->jobs[top & (array->size - 1)], __ATOMIC_RELAXED);
+        if (!__atomic_compare_exchange_n (&victim->top, &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            // Taken by the owner or by another thief
+            job = NULL;
+        }
+        // No else --> Stolen
+    }
+    // No else --> Empty
+
+    return job;
+}
+
+static int ARSAL_Scheduler_HasWork (ARSAL_Scheduler_t *scheduler)
+{
+    int i;
+
+    if (__atomic_load_n (&scheduler->injectHead, __ATOMIC_RELAXED) != NULL)
+    {
+        return 1;
+    }
+    // No else --> Check the deques
+
+    for (i = 0; i < scheduler->workerCount; i++)
+    {
+        if (__atomic_load_n (&scheduler->workers[i].bottom, __ATOMIC_RELAXED) - __atomic_load_n (&scheduler->workers[i].top, __ATOMIC_RELAXED) > 0)
+        {
+            return 1;
+        }
+        // No else --> Empty deque
+    }
+
+    return 0;
+}
+
+/**
+ * Find a job: from the deque of the calling worker, then from the injection queue, then from random victims
+ */
+static ARSAL_Scheduler_Job_t* ARSAL_Scheduler_FindJob (ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Worker_t *worker)
+{
+    ARSAL_Scheduler_Job_t *job;
+    ARSAL_Scheduler_Worker_t *victim;
+    int attempts;
+
+    job = ARSAL_Scheduler_Take (worker);
+
+    if ((job == NULL) && (__atomic_load_n (&scheduler->injectHead, __ATOMIC_RELAXED) != NULL))
+    {
+        ARSAL_Mutex_Lock (&scheduler->mutex);
+        job = scheduler->injectHead;
+        if (job != NULL)
+        {
+            __atomic_store_n (&scheduler->injectHead, job->next, __ATOMIC_RELAXED);
+            if (job->next == NULL)
+            {
+                scheduler->injectTail = NULL;
+            }
+            // No else --> Still queued jobs
+        }
+        // No else --> Taken by another thread
+        ARSAL_Mutex_Unlock (&scheduler->mutex);
+    }
+    // No else --> Got a job, or nothing injected
+
+    for (attempts = 2 * scheduler->workerCount; (job == NULL) && (attempts > 0); attempts--)
+    {
+        // xorshift
+        worker->seed ^= worker->seed << 13;
+        worker->seed ^= worker->seed >> 17;
+        worker->seed ^= worker->seed << 5;
+        victim = &scheduler->workers[worker->seed % scheduler->workerCount];
+        if (victim != worker)
+        {
+            job = ARSAL_Scheduler_Steal (victim);
+        }
+        // No else --> Already empty
+    }
+
+    return job;
+}
+
+/**
+ * Count a task of a group as complete
+ * @note The group may be released by its waiter as soon as its count is decremented, it is not read after
+ */
+static void ARSAL_Scheduler_Complete (ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Group_t *group)
+{
+    if (__atomic_sub_fetch (&group->pending, 1, __ATOMIC_SEQ_CST) == ARSAL_SCHEDULER_GROUP_SLEEPING)
+    {
+        // Wake up the threads sleeping until the group completes
+        ARSAL_Mutex_Lock (&scheduler->mutex);
+        ARSAL_Cond_Broadcast (&scheduler->cond);
+        ARSAL_Cond_Broadcast (&scheduler->waitCond);
+        ARSAL_Mutex_Unlock (&scheduler->mutex);
+    }
+    // No else --> Still pending tasks, or nobody to wake up
+}
+
+static void ARSAL_Scheduler_Run (ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Worker_t *worker, ARSAL_Scheduler_Job_t *job)
+{
+    ARSAL_Scheduler_Task_t task = job->task;
+    void *customData = job->customData;
+    ARSAL_Scheduler_Group_t *group = job->group;
+
+    // Recycle the job first, the children of the task reuse it
+    job->next = worker->freeJobs;
+    worker->freeJobs = job;
+
+    task (scheduler, customData);
+
+    ARSAL_Scheduler_Complete (scheduler, group);
+}
+
+/**
+ * Sleep until a job is spawned, the scheduler stops or the group completes
+ * @param worker The calling worker, NULL outside the workers to wait for the group only
+ * @param group The group waited for, NULL for a worker looking for jobs
+ */
+static void ARSAL_Scheduler_Sleep (ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Worker_t *worker, ARSAL_Scheduler_Group_t *group)
+{
+    int pending = 0;
+
+    ARSAL_Mutex_Lock (&scheduler->mutex);
+    // Registered before checking: a spawner or the last task of the group either sees the sleeper or is seen
+    if (group != NULL)
+    {
+        pending = __atomic_fetch_or (&group->pending, ARSAL_SCHEDULER_GROUP_SLEEPING, __ATOMIC_SEQ_CST) & ~ARSAL_SCHEDULER_GROUP_SLEEPING;
+    }
+    // No else --> Woken up by the spawners only
+
+    if (worker == NULL)
+    {
+        if (pending != 0)
+        {
+            ARSAL_Cond_Wait (&scheduler->waitCond, &scheduler->mutex);
+        }
+        // No else --> Complete
+    }
+    else
+    {
+        __atomic_add_fetch (&scheduler->sleepers, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);
+        if ((!ARSAL_Scheduler_HasWork (scheduler)) && (!__atomic_load_n (&scheduler->stop, __ATOMIC_RELAXED)) &&
+            ((group == NULL) || (pending != 0)))
+        {
+            ARSAL_Cond_Wait (&scheduler->cond, &scheduler->mutex);
+        }
+        // No else --> Something to do
+        __atomic_sub_fetch (&scheduler->sleepers, 1, __ATOMIC_SEQ_CST);
+    }
+    ARSAL_Mutex_Unlock (&scheduler->mutex);
+}
+
+static void* ARSAL_Scheduler_Worker (void *arg)
+{
+    ARSAL_Scheduler_Worker_t *worker = (ARSAL_Scheduler_Worker_t *)arg;
+    ARSAL_Scheduler_t *scheduler = worker->scheduler;
+    ARSAL_Scheduler_Job_t *job;
+    int spins = 0;
+
+    ARSAL_Scheduler_currentWorker = worker;
+
+    while (!__atomic_load_n (&scheduler->stop, __ATOMIC_ACQUIRE))
+    {
+        job = ARSAL_Scheduler_FindJob (scheduler, worker);
+        if (job != NULL)
+        {
+            ARSAL_Scheduler_Run (scheduler, worker, job);
+            spins = 0;
+        }
+        else if (++spins < ARSAL_SCHEDULER_SPIN_COUNT)
+        {
+            sched_yield ();
+        }
+        else
+        {
+            ARSAL_Scheduler_Sleep (scheduler, worker, NULL);
+            spins = 0;
+        }
+    }
+
+    ARSAL_Scheduler_currentWorker = NULL;
+
+    return NULL;
+}
+
+static void ARSAL_Scheduler_FreeJobs (ARSAL_Scheduler_Job_t *job)
+{
+    ARSAL_Scheduler_Job_t *next;
+
+    while (job != NULL)
+    {
+        next = job->next;
+        free (job);
+        job = next;
+    }
+}
+
+ARSAL_Scheduler_t* ARSAL_Scheduler_New(int threadCount, const ARSAL_Thread_Attr_t *threadAttr, eARSAL_ERROR *error)
+{
+    ARSAL_Scheduler_t *scheduler = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    int initialized = 0;
+    int i;
+
+    if (threadCount < 0)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = (int)sysconf (_SC_NPROCESSORS_ONLN);
+            threadCount = (threadCount > 0) ? threadCount : 1;
+        }
+        // No else --> Thread count as requested
+
+        scheduler = calloc (1, sizeof (ARSAL_Scheduler_t));
+        if (scheduler != NULL)
+        {
+            scheduler->workerCount = threadCount;
+            scheduler->workers = calloc (threadCount, sizeof (ARSAL_Scheduler_Worker_t));
+        }
+        // No else --> Alloc error
+
+        if ((scheduler == NULL) || (scheduler->workers == NULL))
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else if ((ARSAL_Mutex_Init (&scheduler->mutex) != 0) || (ARSAL_Cond_Init (&scheduler->cond) != 0) ||
+                 (ARSAL_Cond_Init (&scheduler->waitCond) != 0))
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            initialized = 1;
+        }
+    }
+    // No else --> Processing block
+
+    for (i = 0; (result == ARSAL_OK) && (i < threadCount); i++)
+    {
+        scheduler->workers[i].scheduler = scheduler;
+        scheduler->workers[i].seed = 2463534242U + i * 2654435761U;
+        scheduler->workers[i].array = ARSAL_Scheduler_Array_New (ARSAL_SCHEDULER_DEQUE_MIN_SIZE);
+        if (scheduler->workers[i].array == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Alloc check
+    }
+
+    for (i = 0; (result == ARSAL_OK) && (i < threadCount); i++)
+    {
+        if (ARSAL_Thread_CreateWithAttr (&scheduler->workers[i].thread, ARSAL_Scheduler_Worker, &scheduler->workers[i], threadAttr) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_SCHEDULER_TAG, "Unable to create a worker");
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            scheduler->startedCount++;
+        }
+    }
+
+    if ((result != ARSAL_OK) && (scheduler != NULL))
+    {
+        if (initialized)
+        {
+            ARSAL_Scheduler_Delete (&scheduler);
+        }
+        else
+        {
+            free (scheduler->workers);
+            free (scheduler);
+            scheduler = NULL;
+        }
+    }
+    // No else --> Keep the scheduler
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return scheduler;
+}
+
+void ARSAL_Scheduler_Delete(ARSAL_Scheduler_t **schedulerAddr)
+{
+    ARSAL_Scheduler_t *scheduler;
+    ARSAL_Scheduler_Worker_t *worker;
+    ARSAL_Scheduler_Array_t *array;
+    long i;
+    int w;
+
+    if ((schedulerAddr != NULL) && (*schedulerAddr != NULL))
+    {
+        scheduler = *schedulerAddr;
+
+        ARSAL_Mutex_Lock (&scheduler->mutex);
+        __atomic_store_n (&scheduler->stop, 1, __ATOMIC_RELEASE);
+        ARSAL_Cond_Broadcast (&scheduler->cond);
+        ARSAL_Mutex_Unlock (&scheduler->mutex);
+
+        for (w = 0; w < scheduler->startedCount; w++)
+        {
+            ARSAL_Thread_Join (scheduler->workers[w].thread, NULL);
+            ARSAL_Thread_Destroy (&scheduler->workers[w].thread);
+        }
+
+        for (w = 0; w < scheduler->workerCount; w++)
+        {
+            worker = &scheduler->workers[w];
+            if (worker->array != NULL)
+            {
+                // Dropped jobs
+                for (i = worker->top; i < worker->bottom; i++)
+                {
+                    free (worker->array->jobs[i & (worker->array->size - 1)]);
+                }
+            }
+            // No else --> Not allocated
+            while (worker->array != NULL)
+            {
+                array = worker->array;
+                worker->array = array->previous;
+                free (array);
+            }
+            ARSAL_Scheduler_FreeJobs (worker->freeJobs);
+        }
+        ARSAL_Scheduler_FreeJobs (scheduler->injectHead);
+
+        ARSAL_Cond_Destroy (&scheduler->waitCond);
+        ARSAL_Cond_Destroy (&scheduler->cond);
+        ARSAL_Mutex_Destroy (&scheduler->mutex);
+        free (scheduler->workers);
+        free (scheduler);
+
+        *schedulerAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+void ARSAL_Scheduler_Group_Init(ARSAL_Scheduler_Group_t *group)
+{
+    if (group != NULL)
+    {
+        group->pending = 0;
+    }
+    // No else --> Nothing to initialize
+}
+
+eARSAL_ERROR ARSAL_Scheduler_Spawn(ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Group_t *group, ARSAL_Scheduler_Task_t task, void *customData)
+{
+    ARSAL_Scheduler_Worker_t *worker = ARSAL_Scheduler_currentWorker;
+    ARSAL_Scheduler_Job_t *job = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    if ((scheduler == NULL) || (group == NULL) || (task == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if ((worker != NULL) && (worker->scheduler != scheduler))
+    {
+        // Task of another scheduler
+        worker = NULL;
+    }
+    // No else --> Spawn on the deque of the worker
+
+    if ((worker != NULL) && (worker->freeJobs != NULL))
+    {
+        job = worker->freeJobs;
+        worker->freeJobs = job->next;
+    }
+    // No else --> Allocate one, the workers recycle it once run
+
+    if (job == NULL)
+    {
+        job = malloc (sizeof (ARSAL_Scheduler_Job_t));
+        if (job == NULL)
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Alloc check
+    }
+    // No else --> Recycled
+
+    job->task = task;
+    job->customData = customData;
+    job->group = group;
+    job->next = NULL;
+    __atomic_add_fetch (&group->pending, 1, __ATOMIC_RELAXED);
+
+    if (worker != NULL)
+    {
+        if (ARSAL_Scheduler_Push (worker, job) != 0)
+        {
+            ARSAL_Scheduler_Complete (scheduler, group);
+            job->next = worker->freeJobs;
+            worker->freeJobs = job;
+            result = ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Pushed
+
+        // Pairs with the registration of the sleepers
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);
+        if ((result == ARSAL_OK) && (__atomic_load_n (&scheduler->sleepers, __ATOMIC_RELAXED) > 0))
+        {
+            ARSAL_Mutex_Lock (&scheduler->mutex);
+            ARSAL_Cond_Signal (&scheduler->cond);
+            ARSAL_Mutex_Unlock (&scheduler->mutex);
+        }
+        // No else --> Nobody to wake up
+    }
+    else
+    {
+        ARSAL_Mutex_Lock (&scheduler->mutex);
+        if (scheduler->injectTail != NULL)
+        {
+            scheduler->injectTail->next = job;
+        }
+        else
+        {
+            __atomic_store_n (&scheduler->injectHead, job, __ATOMIC_RELAXED);
+        }
+        scheduler->injectTail = job;
+        ARSAL_Cond_Signal (&scheduler->cond);
+        ARSAL_Mutex_Unlock (&scheduler->mutex);
+    }
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Scheduler_Wait(ARSAL_Scheduler_t *scheduler, ARSAL_Scheduler_Group_t *group)
+{
+    ARSAL_Scheduler_Worker_t *worker = ARSAL_Scheduler_currentWorker;
+    ARSAL_Scheduler_Job_t *job;
+    int pending;
+    int spins = 0;
+
+    if ((scheduler == NULL) || (group == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if ((worker != NULL) && (worker->scheduler != scheduler))
+    {
+        worker = NULL;
+    }
+    // No else --> Help from the deque of the worker
+
+    while ((__atomic_load_n (&group->pending, __ATOMIC_ACQUIRE) & ~ARSAL_SCHEDULER_GROUP_SLEEPING) != 0)
+    {
+        // Outside the workers, the children of a task run here would go to the injection queue, breadth first
+        job = (worker != NULL) ? ARSAL_Scheduler_FindJob (scheduler, worker) : NULL;
+        if (job != NULL)
+        {
+            ARSAL_Scheduler_Run (scheduler, worker, job);
+            spins = 0;
+        }
+        else if ((worker != NULL) && (++spins < ARSAL_SCHEDULER_SPIN_COUNT))
+        {
+            sched_yield ();
+        }
+        else
+        {
+            ARSAL_Scheduler_Sleep (scheduler, worker, group);
+            spins = 0;
+        }
+    }
+
+    // Complete: clear the sleeping flag for the next use of the group, unless tasks were spawned meanwhile
+    pending = ARSAL_SCHEDULER_GROUP_SLEEPING;
+    __atomic_compare_exchange_n (&group->pending, &pending, 0, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+
+    return ARSAL_OK;
+}
+
+int ARSAL_Scheduler_GetThreadCount(ARSAL_Scheduler_t *scheduler)
+{
+    return (scheduler != NULL) ? scheduler->workerCount : -1;
+}
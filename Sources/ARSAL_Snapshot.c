@@ -0,0 +1,1002 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Snapshot.c
+ * @brief libARSAL directory hierarchy snapshots and change detection.
+ **/
+
+#include <config.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "libARSAL/ARSAL_Snapshot.h"
+#include "libARSAL/ARSAL_Endianness.h"
+#include "libARSAL/ARSAL_Print.h"
+
+#define ARSAL_SNAPSHOT_TAG   "Snapshot"
+
+#define ARSAL_SNAPSHOT_MAGIC        "ARSN"
+#define ARSAL_SNAPSHOT_VERSION      (1)
+#define ARSAL_SNAPSHOT_HEADER_SIZE  (4 + 4 + 4 + 4 + 8)
+#define ARSAL_SNAPSHOT_NODE_SIZE    (4 + 4 + 4 + 4 + 4 + 8 + 8 + 8 + 8)
+
+/**
+ * Entry of a snapshot. The entries are stored depth first, the entries of a directory sorted by name.
+ */
+typedef struct
+{
+    uint32_t name; /**< Offset of the name in the names pool, the root name is the path of the hierarchy */
+    uint32_t end; /**< Index following the last entry of the subtree */
+    uint32_t mode;
+    uint32_t mtimeNsec;
+    uint32_t ctimeNsec;
+    uint64_t size;
+    int64_t mtimeSec;
+    int64_t ctimeSec;
+    uint64_t inode;
+} ARSAL_Snapshot_Node_t;
+
+struct _ARSAL_Snapshot_t
+{
+    ARSAL_Snapshot_Node_t *nodes;
+    uint32_t count;
+    uint32_t capacity;
+    char *names;
+    uint32_t namesSize;
+    uint32_t namesCapacity;
+    int64_t takenSec; /**< Time at which the walk started */
+};
+
+/**
+ * State of a snapshot walk
+ */
+typedef struct
+{
+    const ARSAL_Snapshot_t *previous;
+    ARSAL_Snapshot_t *snapshot;
+    int flags;
+    ARSAL_Snapshot_Diff_t diffCallback;
+    void *customData;
+    char *path;
+    size_t pathCapacity;
+} ARSAL_Snapshot_Scan_t;
+
+static int ARSAL_Snapshot_CompareNames (const void *a, const void *b)
+{
+    return strcmp (*(const char * const *)a, *(const char * const *)b);
+}
+
+static ARSAL_Snapshot_t* ARSAL_Snapshot_Alloc (void)
+{
+    ARSAL_Snapshot_t *snapshot = calloc (1, sizeof (ARSAL_Snapshot_t));
+
+    if (snapshot != NULL)
+    {
+        snapshot->takenSec = (int64_t)time (NULL);
+    }
+    // No else --> Alloc error
+
+    return snapshot;
+}
+
+/**
+ * Append an entry to a snapshot
+ * @return The index of the entry, -1 on alloc error
+ */
+static int64_t ARSAL_Snapshot_AddNode (ARSAL_Snapshot_t *snapshot, const char *name, const ARSAL_Snapshot_Node_t *node)
+{
+    ARSAL_Snapshot_Node_t *nodes;
+    char *names;
+    size_t nameSize = strlen (name) + 1;
+    uint32_t capacity;
+
+    if (snapshot->count >= snapshot->capacity)
+    {
+        capacity = (snapshot->capacity > 0) ? snapshot->capacity * 2 : 256;
+        nodes = realloc (snapshot->nodes, capacity * sizeof (ARSAL_Snapshot_Node_t));
+        if (nodes == NULL)
+        {
+            return -1;
+        }
+        // No else --> Reallocated
+        snapshot->nodes = nodes;
+        snapshot->capacity = capacity;
+    }
+    // No else --> No need to realloc in this case
+
+    if (snapshot->namesSize + nameSize > snapshot->namesCapacity)
+    {
+        capacity = (snapshot->namesCapacity > 0) ? snapshot->namesCapacity : 4096;
+        while (capacity < snapshot->namesSize + nameSize)
+        {
+            capacity *= 2;
+        }
+        names = realloc (snapshot->names, capacity);
+        if (names == NULL)
+        {
+            return -1;
+        }
+        // No else --> Reallocated
+        snapshot->names = names;
+        snapshot->namesCapacity = capacity;
+    }
+    // No else --> No need to realloc in this case
+
+    snapshot->nodes[snapshot->count] = *node;
+    snapshot->nodes[snapshot->count].name = snapshot->namesSize;
+    snapshot->nodes[snapshot->count].end = snapshot->count + 1;
+    memcpy (&snapshot->names[snapshot->namesSize], name, nameSize);
+    snapshot->namesSize += nameSize;
+
+    return snapshot->count++;
+}
+
+static void ARSAL_Snapshot_StatToNode (const struct stat *sb, ARSAL_Snapshot_Node_t *node)
+{
+    memset (node, 0, sizeof (ARSAL_Snapshot_Node_t));
+    node->mode = sb->st_mode;
+    node->size = sb->st_size;
+    node->inode = sb->st_ino;
+#if defined(__APPLE__)
+    node->mtimeSec = sb->st_mtimespec.tv_sec;
+    node->mtimeNsec = sb->st_mtimespec.tv_nsec;
+    node->ctimeSec = sb->st_ctimespec.tv_sec;
+    node->ctimeNsec = sb->st_ctimespec.tv_nsec;
+#else
+    node->mtimeSec = sb->st_mtim.tv_sec;
+    node->mtimeNsec = sb->st_mtim.tv_nsec;
+    node->ctimeSec = sb->st_ctim.tv_sec;
+    node->ctimeNsec = sb->st_ctim.tv_nsec;
+#endif
+}
+
+static void ARSAL_Snapshot_NodeToEntry (const ARSAL_Snapshot_Node_t *node, ARSAL_Snapshot_Entry_t *entry)
+{
+    entry->type = (S_ISDIR (node->mode)) ? ARSAL_FTW_D : ARSAL_FTW_F;
+    entry->size = node->size;
+    entry->mtimeSec = node->mtimeSec;
+    entry->mtimeNsec = node->mtimeNsec;
+    entry->inode = node->inode;
+}
+
+static int ARSAL_Snapshot_EnsurePath (ARSAL_Snapshot_Scan_t *scan, size_t size)
+{
+    char *path;
+    size_t capacity;
+    int retVal = 0;
+
+    if (size > scan->pathCapacity)
+    {
+        capacity = (scan->pathCapacity > 0) ? scan->pathCapacity : 256;
+        while (capacity < size)
+        {
+            capacity *= 2;
+        }
+        path = realloc (scan->path, capacity);
+        if (path == NULL)
+        {
+            retVal = -1;
+        }
+        else
+        {
+            scan->path = path;
+            scan->pathCapacity = capacity;
+        }
+    }
+    // No else --> No need to realloc in this case
+
+    return retVal;
+}
+
+/**
+ * Append a name to the directory path in the path buffer
+ * @return The length of the new path, 0 on alloc error
+ */
+static size_t ARSAL_Snapshot_AppendName (ARSAL_Snapshot_Scan_t *scan, size_t dirPathLen, const char *name)
+{
+    size_t nameLen = strlen (name);
+
+    if (ARSAL_Snapshot_EnsurePath (scan, dirPathLen + nameLen + 2) != 0)
+    {
+        return 0;
+    }
+    // No else --> Path buffer is large enough
+
+    scan->path[dirPathLen] = '/';
+    memcpy (&scan->path[dirPathLen + 1], name, nameLen + 1);
+
+    return dirPathLen + nameLen + 1;
+}
+
+/**
+ * Report an entry of the previous snapshot as removed, with its whole subtree
+ */
+static eARSAL_ERROR ARSAL_Snapshot_ReportRemoved (ARSAL_Snapshot_Scan_t *scan, uint32_t index, size_t pathLen)
+{
+    const ARSAL_Snapshot_t *previous = scan->previous;
+    ARSAL_Snapshot_Entry_t oldEntry;
+    eARSAL_ERROR result = ARSAL_OK;
+    size_t childPathLen;
+    uint32_t child;
+
+    if (scan->diffCallback != NULL)
+    {
+        ARSAL_Snapshot_NodeToEntry (&previous->nodes[index], &oldEntry);
+        scan->diffCallback (scan->customData, scan->path, ARSAL_SNAPSHOT_CHANGE_REMOVED, &oldEntry, NULL);
+
+        for (child = index + 1; (result == ARSAL_OK) && (child < previous->nodes[index].end); child = previous->nodes[child].end)
+        {
+            childPathLen = ARSAL_Snapshot_AppendName (scan, pathLen, &previous->names[previous->nodes[child].name]);
+            result = (childPathLen > 0) ? ARSAL_Snapshot_ReportRemoved (scan, child, childPathLen) : ARSAL_ERROR_ALLOC;
+        }
+    }
+    // No else --> Nobody to report to
+
+    return result;
+}
+
+static eARSAL_ERROR ARSAL_Snapshot_ScanDir (ARSAL_Snapshot_Scan_t *scan, size_t pathLen, int64_t prevIndex, int unchanged, DIR *dir, int openError);
+
+/**
+ * Check if the entries of a directory can be taken from the previous snapshot without reading it
+ */
+static int ARSAL_Snapshot_IsUnchangedDir (const ARSAL_Snapshot_Scan_t *scan, const ARSAL_Snapshot_Node_t *node, int64_t prevIndex)
+{
+    const ARSAL_Snapshot_Node_t *prevNode = (prevIndex >= 0) ? &scan->previous->nodes[prevIndex] : NULL;
+
+    // No entry added, removed or renamed since the previous walk. A directory modified during the second of the previous walk is read again, as it may have changed after it was read.
+    return ((prevNode != NULL) &&
+            (prevNode->mtimeSec == node->mtimeSec) && (prevNode->mtimeNsec == node->mtimeNsec) &&
+            (prevNode->ctimeSec == node->ctimeSec) && (prevNode->ctimeNsec == node->ctimeNsec) &&
+            (prevNode->inode == node->inode) && (node->mtimeSec < scan->previous->takenSec));
+}
+
+/**
+ * Add an entry to the new snapshot, compare it to the previous one and walk it if it is a directory
+ * @param pathLen The length of the path of the entry, in the path buffer
+ * @param prevIndex The index of the entry in the previous snapshot, -1 if it was not there
+ */
+static eARSAL_ERROR ARSAL_Snapshot_ScanEntry (ARSAL_Snapshot_Scan_t *scan, size_t pathLen, const char *name, const struct stat *sb, int64_t prevIndex)
+{
+    ARSAL_Snapshot_t *snapshot = scan->snapshot;
+    const ARSAL_Snapshot_Node_t *prevNode = NULL;
+    ARSAL_Snapshot_Node_t node;
+    ARSAL_Snapshot_Entry_t oldEntry;
+    ARSAL_Snapshot_Entry_t newEntry;
+    eARSAL_ERROR result = ARSAL_OK;
+    DIR *dir = NULL;
+    int unchanged = 0;
+    int openError = 0;
+    int64_t index;
+
+    ARSAL_Snapshot_StatToNode (sb, &node);
+    index = ARSAL_Snapshot_AddNode (snapshot, name, &node);
+    if (index < 0)
+    {
+        result = ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Added
+
+    if ((result == ARSAL_OK) && (prevIndex >= 0) && (S_ISDIR (scan->previous->nodes[prevIndex].mode) != S_ISDIR (node.mode)))
+    {
+        // A file replaced by a directory, or the opposite
+        result = ARSAL_Snapshot_ReportRemoved (scan, prevIndex, pathLen);
+        scan->path[pathLen] = '\0';
+        prevIndex = -1;
+    }
+    // No else --> Same type
+
+    if ((result == ARSAL_OK) && (S_ISDIR (node.mode)))
+    {
+        unchanged = ARSAL_Snapshot_IsUnchangedDir (scan, &node, prevIndex);
+        if (!unchanged)
+        {
+            dir = opendir (scan->path);
+            openError = (dir == NULL) ? errno : 0;
+            if ((openError == ENOENT) || (openError == ENOTDIR))
+            {
+                // Removed, or replaced, since its parent was read
+                ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_SNAPSHOT_TAG, "%s removed during the walk", scan->path);
+                snapshot->namesSize = snapshot->nodes[index].name;
+                snapshot->count = index;
+                return (prevIndex >= 0) ? ARSAL_Snapshot_ReportRemoved (scan, prevIndex, pathLen) : ARSAL_OK;
+            }
+            // No else --> Opened, or not readable
+        }
+        // No else --> Its entries are known
+    }
+    // No else --> Not a directory
+
+    if ((result == ARSAL_OK) && (scan->diffCallback != NULL))
+    {
+        ARSAL_Snapshot_NodeToEntry (&node, &newEntry);
+        if (prevIndex < 0)
+        {
+            scan->diffCallback (scan->customData, scan->path, ARSAL_SNAPSHOT_CHANGE_ADDED, NULL, &newEntry);
+        }
+        else
+        {
+            prevNode = &scan->previous->nodes[prevIndex];
+            if ((!S_ISDIR (node.mode)) &&
+                ((prevNode->size != node.size) || (prevNode->mtimeSec != node.mtimeSec) || (prevNode->mtimeNsec != node.mtimeNsec) || (prevNode->inode != node.inode)))
+            {
+                ARSAL_Snapshot_NodeToEntry (prevNode, &oldEntry);
+                scan->diffCallback (scan->customData, scan->path, ARSAL_SNAPSHOT_CHANGE_MODIFIED, &oldEntry, &newEntry);
+            }
+            // No else --> Unchanged, or a directory whose changes are its entries
+        }
+    }
+    // No else --> Nobody to report to
+
+    if ((result == ARSAL_OK) && (S_ISDIR (node.mode)))
+    {
+        result = ARSAL_Snapshot_ScanDir (scan, pathLen, prevIndex, unchanged, dir, openError);
+    }
+    else if (dir != NULL)
+    {
+        closedir (dir);
+    }
+    // No else --> Not a directory
+
+    if (result == ARSAL_OK)
+    {
+        snapshot->nodes[index].end = snapshot->count;
+    }
+    // No else --> Processing block
+
+    return result;
+}
+
+/**
+ * Walk the entries of a directory whose modification and change times did not move: its entries are taken from the previous snapshot
+ */
+static eARSAL_ERROR ARSAL_Snapshot_ScanUnchangedDir (ARSAL_Snapshot_Scan_t *scan, size_t pathLen, int64_t prevIndex)
+{
+    const ARSAL_Snapshot_t *previous = scan->previous;
+    eARSAL_ERROR result = ARSAL_OK;
+    struct stat sb;
+    const char *name;
+    size_t childPathLen;
+    uint32_t child;
+
+    for (child = prevIndex + 1; (result == ARSAL_OK) && (child < previous->nodes[prevIndex].end); child = previous->nodes[child].end)
+    {
+        name = &previous->names[previous->nodes[child].name];
+        if ((!S_ISDIR (previous->nodes[child].mode)) && (!(scan->flags & ARSAL_SNAPSHOT_FLAG_CHECK_FILES)))
+        {
+            result = (ARSAL_Snapshot_AddNode (scan->snapshot, name, &previous->nodes[child]) >= 0) ? ARSAL_OK : ARSAL_ERROR_ALLOC;
+            continue;
+        }
+        // No else --> Stat the entry
+
+        childPathLen = ARSAL_Snapshot_AppendName (scan, pathLen, name);
+        if (childPathLen == 0)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else if (lstat (scan->path, &sb) != 0)
+        {
+            result = ARSAL_Snapshot_ReportRemoved (scan, child, childPathLen);
+        }
+        else
+        {
+            result = ARSAL_Snapshot_ScanEntry (scan, childPathLen, name, &sb, child);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Keep the entries of a directory which cannot be read as they were in the previous snapshot
+ */
+static eARSAL_ERROR ARSAL_Snapshot_KeepPrevious (ARSAL_Snapshot_Scan_t *scan, int64_t prevIndex)
+{
+    const ARSAL_Snapshot_t *previous = scan->previous;
+    eARSAL_ERROR result = ARSAL_OK;
+    int64_t delta;
+    int64_t index;
+    uint32_t child;
+
+    if (prevIndex >= 0)
+    {
+        // The subtree is copied as is, only moved
+        delta = (int64_t)scan->snapshot->count - (prevIndex + 1);
+        for (child = prevIndex + 1; (result == ARSAL_OK) && (child < previous->nodes[prevIndex].end); child++)
+        {
+            index = ARSAL_Snapshot_AddNode (scan->snapshot, &previous->names[previous->nodes[child].name], &previous->nodes[child]);
+            if (index < 0)
+            {
+                result = ARSAL_ERROR_ALLOC;
+            }
+            else
+            {
+                scan->snapshot->nodes[index].end = previous->nodes[child].end + delta;
+            }
+        }
+    }
+    // No else --> A new directory, nothing is known about its entries
+
+    return result;
+}
+
+/**
+ * Walk the entries of a directory
+ * @param pathLen The length of the path of the directory, in the path buffer
+ * @param prevIndex The index of the directory in the previous snapshot, -1 if it was not there
+ * @param unchanged The entries are taken from the previous snapshot, the directory is not read
+ * @param dir The directory opened for reading, closed here. NULL if it is unchanged or could not be opened.
+ * @param openError The errno of the opening of the directory
+ */
+static eARSAL_ERROR ARSAL_Snapshot_ScanDir (ARSAL_Snapshot_Scan_t *scan, size_t pathLen, int64_t prevIndex, int unchanged, DIR *dir, int openError)
+{
+    const ARSAL_Snapshot_t *previous = scan->previous;
+    const ARSAL_Snapshot_Node_t *prevNode = (prevIndex >= 0) ? &previous->nodes[prevIndex] : NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    struct dirent *ent;
+    struct stat sb;
+    char *pool = NULL;
+    size_t poolSize = 0;
+    size_t poolCapacity = 0;
+    char **names = NULL;
+    size_t nameCount = 0;
+    size_t nameSize;
+    size_t childPathLen;
+    uint32_t child;
+    size_t i;
+    int cmp;
+    void *buffer;
+
+    if (unchanged)
+    {
+        return ARSAL_Snapshot_ScanUnchangedDir (scan, pathLen, prevIndex);
+    }
+    // No else --> Read the directory
+
+    if (dir == NULL)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_SNAPSHOT_TAG, "Unable to open dir %s: %s", scan->path, strerror (openError));
+        if ((openError == EACCES) || (openError == EPERM))
+        {
+            // Not readable anymore, its entries are reported again once it is
+            return ARSAL_Snapshot_KeepPrevious (scan, prevIndex);
+        }
+        // No else --> Not a change of the hierarchy
+        result = ARSAL_ERROR_FILE;
+    }
+    // No else --> Opened
+
+    // Read all the names, to walk them sorted
+    while ((result == ARSAL_OK) && ((ent = readdir (dir)) != NULL))
+    {
+        if ((ent->d_name[0] == '.') &&
+            ((ent->d_name[1] == '\0') || ((ent->d_name[1] == '.') && (ent->d_name[2] == '\0'))))
+        {
+            // Skip "." and ".."
+            continue;
+        }
+        // No else --> Keep the entry
+
+        nameSize = strlen (ent->d_name) + 1;
+        if (poolSize + nameSize > poolCapacity)
+        {
+            poolCapacity = (poolCapacity > 0) ? poolCapacity * 2 : 1024;
+            poolCapacity = (poolCapacity < poolSize + nameSize) ? poolSize + nameSize : poolCapacity;
+            buffer = realloc (pool, poolCapacity);
+            if (buffer == NULL)
+            {
+                result = ARSAL_ERROR_ALLOC;
+                break;
+            }
+            // No else --> Reallocated
+            pool = buffer;
+        }
+        // No else --> No need to realloc in this case
+
+        memcpy (&pool[poolSize], ent->d_name, nameSize);
+        poolSize += nameSize;
+        nameCount++;
+    }
+
+    if (dir != NULL)
+    {
+        closedir (dir);
+    }
+    // No else --> Close only if non-null
+
+    if ((result == ARSAL_OK) && (nameCount > 0))
+    {
+        names = malloc (nameCount * sizeof (char *));
+        if (names == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            names[0] = pool;
+            for (i = 1; i < nameCount; i++)
+            {
+                names[i] = names[i - 1] + strlen (names[i - 1]) + 1;
+            }
+            qsort (names, nameCount, sizeof (char *), ARSAL_Snapshot_CompareNames);
+        }
+    }
+    // No else --> Empty directory
+
+    // Merge the sorted names with the sorted entries of the previous snapshot
+    i = 0;
+    child = (prevIndex >= 0) ? prevIndex + 1 : 0;
+    while ((result == ARSAL_OK) && ((i < nameCount) || ((prevNode != NULL) && (child < prevNode->end))))
+    {
+        if ((prevNode == NULL) || (child >= prevNode->end))
+        {
+            cmp = -1;
+        }
+        else if (i >= nameCount)
+        {
+            cmp = 1;
+        }
+        else
+        {
+            cmp = strcmp (names[i], &previous->names[previous->nodes[child].name]);
+        }
+
+        childPathLen = ARSAL_Snapshot_AppendName (scan, pathLen, (cmp > 0) ? &previous->names[previous->nodes[child].name] : names[i]);
+        if (childPathLen == 0)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else if (cmp > 0)
+        {
+            result = ARSAL_Snapshot_ReportRemoved (scan, child, childPathLen);
+        }
+        else if (lstat (scan->path, &sb) != 0)
+        {
+            // Removed since the directory was read
+            result = (cmp == 0) ? ARSAL_Snapshot_ReportRemoved (scan, child, childPathLen) : ARSAL_OK;
+        }
+        else
+        {
+            result = ARSAL_Snapshot_ScanEntry (scan, childPathLen, names[i], &sb, (cmp == 0) ? (int64_t)child : -1);
+        }
+
+        i += (cmp <= 0) ? 1 : 0;
+        child = (cmp >= 0) ? previous->nodes[child].end : child;
+    }
+
+    free (names);
+    free (pool);
+
+    return result;
+}
+
+/**
+ * Take a snapshot, comparing it to the previous one if any
+ */
+static ARSAL_Snapshot_t* ARSAL_Snapshot_Take (const char *dirPath, const ARSAL_Snapshot_t *previous, int flags, ARSAL_Snapshot_Diff_t diffCallback, void *customData, eARSAL_ERROR *error)
+{
+    ARSAL_Snapshot_Scan_t scan;
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_Snapshot_Node_t node;
+    DIR *dir;
+    struct stat sb;
+    size_t pathLen = strlen (dirPath);
+    int64_t index = -1;
+
+    memset (&scan, 0, sizeof (scan));
+    scan.previous = previous;
+    scan.flags = flags;
+    scan.diffCallback = diffCallback;
+    scan.customData = customData;
+
+    scan.snapshot = ARSAL_Snapshot_Alloc ();
+    if ((scan.snapshot == NULL) || (ARSAL_Snapshot_EnsurePath (&scan, pathLen + 1) != 0))
+    {
+        result = ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Allocated
+
+    if (result == ARSAL_OK)
+    {
+        memcpy (scan.path, dirPath, pathLen + 1);
+        if ((lstat (dirPath, &sb) != 0) || (!S_ISDIR (sb.st_mode)))
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_SNAPSHOT_TAG, "%s is not a directory", dirPath);
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Directory found
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        ARSAL_Snapshot_StatToNode (&sb, &node);
+        index = ARSAL_Snapshot_AddNode (scan.snapshot, dirPath, &node);
+        result = (index >= 0) ? ARSAL_OK : ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Snapshot_IsUnchangedDir (&scan, &node, (previous != NULL) ? 0 : -1))
+        {
+            result = ARSAL_Snapshot_ScanDir (&scan, pathLen, 0, 1, NULL, 0);
+        }
+        else
+        {
+            dir = opendir (dirPath);
+            if (dir == NULL)
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_SNAPSHOT_TAG, "Unable to open dir %s", dirPath);
+                result = ARSAL_ERROR_FILE;
+            }
+            else
+            {
+                result = ARSAL_Snapshot_ScanDir (&scan, pathLen, (previous != NULL) ? 0 : -1, 0, dir, 0);
+            }
+        }
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        scan.snapshot->nodes[index].end = scan.snapshot->count;
+    }
+    else
+    {
+        ARSAL_Snapshot_Delete (&scan.snapshot);
+    }
+
+    free (scan.path);
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return scan.snapshot;
+}
+
+ARSAL_Snapshot_t* ARSAL_Snapshot_New(const char *dirPath, eARSAL_ERROR *error)
+{
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_SNAPSHOT_TAG, "%s", dirPath ? dirPath : "null");
+
+    if (dirPath == NULL)
+    {
+        if (error != NULL)
+        {
+            *error = ARSAL_ERROR_BAD_PARAMETER;
+        }
+        // No else --> Error is not returned
+        return NULL;
+    }
+    // No else --> Args check
+
+    return ARSAL_Snapshot_Take (dirPath, NULL, ARSAL_SNAPSHOT_FLAG_NONE, NULL, NULL, error);
+}
+
+void ARSAL_Snapshot_Delete(ARSAL_Snapshot_t **snapshotAddr)
+{
+    if ((snapshotAddr != NULL) && (*snapshotAddr != NULL))
+    {
+        free ((*snapshotAddr)->nodes);
+        free ((*snapshotAddr)->names);
+        free (*snapshotAddr);
+        *snapshotAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+ARSAL_Snapshot_t* ARSAL_Snapshot_Update(const ARSAL_Snapshot_t *previous, int flags, ARSAL_Snapshot_Diff_t diffCallback, void *customData, eARSAL_ERROR *error)
+{
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_SNAPSHOT_TAG, "%s", "");
+
+    if ((previous == NULL) || (previous->count == 0))
+    {
+        if (error != NULL)
+        {
+            *error = ARSAL_ERROR_BAD_PARAMETER;
+        }
+        // No else --> Error is not returned
+        return NULL;
+    }
+    // No else --> Args check
+
+    return ARSAL_Snapshot_Take (&previous->names[previous->nodes[0].name], previous, flags, diffCallback, customData, error);
+}
+
+int ARSAL_Snapshot_GetEntryCount(const ARSAL_Snapshot_t *snapshot)
+{
+    return (snapshot != NULL) ? (int)snapshot->count : 0;
+}
+
+static uint8_t* ARSAL_Snapshot_Write32 (uint8_t *buffer, uint32_t value)
+{
+    value = htodl (value);
+    memcpy (buffer, &value, sizeof (value));
+    return buffer + sizeof (value);
+}
+
+static uint8_t* ARSAL_Snapshot_Write64 (uint8_t *buffer, uint64_t value)
+{
+    value = htodll (value);
+    memcpy (buffer, &value, sizeof (value));
+    return buffer + sizeof (value);
+}
+
+static const uint8_t* ARSAL_Snapshot_Read32 (const uint8_t *buffer, uint32_t *value)
+{
+    memcpy (value, buffer, sizeof (*value));
+    *value = dtohl (*value);
+    return buffer + sizeof (*value);
+}
+
+static const uint8_t* ARSAL_Snapshot_Read64 (const uint8_t *buffer, uint64_t *value)
+{
+    memcpy (value, buffer, sizeof (*value));
+    *value = dtohll (*value);
+    return buffer + sizeof (*value);
+}
+
+eARSAL_ERROR ARSAL_Snapshot_Save(const ARSAL_Snapshot_t *snapshot, const char *filePath)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    uint8_t header[ARSAL_SNAPSHOT_HEADER_SIZE];
+    uint8_t record[ARSAL_SNAPSHOT_NODE_SIZE];
+    const ARSAL_Snapshot_Node_t *node;
+    uint8_t *ptr;
+    FILE *file = NULL;
+    uint32_t i;
+
+    if ((snapshot == NULL) || (filePath == NULL))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        file = fopen (filePath, "wb");
+        if (file == NULL)
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Opened
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        memcpy (header, ARSAL_SNAPSHOT_MAGIC, 4);
+        ptr = ARSAL_Snapshot_Write32 (&header[4], ARSAL_SNAPSHOT_VERSION);
+        ptr = ARSAL_Snapshot_Write32 (ptr, snapshot->count);
+        ptr = ARSAL_Snapshot_Write32 (ptr, snapshot->namesSize);
+        ARSAL_Snapshot_Write64 (ptr, (uint64_t)snapshot->takenSec);
+        if (fwrite (header, sizeof (header), 1, file) != 1)
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Written
+    }
+    // No else --> Processing block
+
+    for (i = 0; (result == ARSAL_OK) && (i < snapshot->count); i++)
+    {
+        node = &snapshot->nodes[i];
+        ptr = ARSAL_Snapshot_Write32 (record, node->name);
+        ptr = ARSAL_Snapshot_Write32 (ptr, node->end);
+        ptr = ARSAL_Snapshot_Write32 (ptr, node->mode);
+        ptr = ARSAL_Snapshot_Write32 (ptr, node->mtimeNsec);
+        ptr = ARSAL_Snapshot_Write32 (ptr, node->ctimeNsec);
+        ptr = ARSAL_Snapshot_Write64 (ptr, node->size);
+        ptr = ARSAL_Snapshot_Write64 (ptr, (uint64_t)node->mtimeSec);
+        ptr = ARSAL_Snapshot_Write64 (ptr, (uint64_t)node->ctimeSec);
+        ARSAL_Snapshot_Write64 (ptr, node->inode);
+        if (fwrite (record, sizeof (record), 1, file) != 1)
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Written
+    }
+
+    if ((result == ARSAL_OK) && (fwrite (snapshot->names, 1, snapshot->namesSize, file) != snapshot->namesSize))
+    {
+        result = ARSAL_ERROR_FILE;
+    }
+    // No else --> Written
+
+    if ((file != NULL) && (fclose (file) != 0) && (result == ARSAL_OK))
+    {
+        result = ARSAL_ERROR_FILE;
+    }
+    // No else --> Closed
+
+    return result;
+}
+
+ARSAL_Snapshot_t* ARSAL_Snapshot_Load(const char *filePath, eARSAL_ERROR *error)
+{
+    ARSAL_Snapshot_t *snapshot = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    uint8_t header[ARSAL_SNAPSHOT_HEADER_SIZE];
+    uint8_t record[ARSAL_SNAPSHOT_NODE_SIZE];
+    ARSAL_Snapshot_Node_t *node;
+    const uint8_t *ptr;
+    uint32_t version = 0;
+    uint32_t count = 0;
+    uint32_t namesSize = 0;
+    uint64_t nodesSize = 0;
+    uint64_t value;
+    FILE *file = NULL;
+    struct stat sb;
+    uint32_t i;
+
+    if (filePath == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        file = fopen (filePath, "rb");
+        result = (file != NULL) ? ARSAL_OK : ARSAL_ERROR_FILE;
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        if ((fread (header, sizeof (header), 1, file) != 1) || (memcmp (header, ARSAL_SNAPSHOT_MAGIC, 4) != 0))
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        else
+        {
+            ptr = ARSAL_Snapshot_Read32 (&header[4], &version);
+            ptr = ARSAL_Snapshot_Read32 (ptr, &count);
+            ptr = ARSAL_Snapshot_Read32 (ptr, &namesSize);
+            ARSAL_Snapshot_Read64 (ptr, &value);
+            if ((version != ARSAL_SNAPSHOT_VERSION) || (count == 0) || (namesSize == 0))
+            {
+                result = ARSAL_ERROR_FILE;
+            }
+            // No else --> Valid header
+        }
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        // The sizes are untrusted: bound them by the file before allocating, and the node array by the address space
+        nodesSize = (uint64_t)count * sizeof (ARSAL_Snapshot_Node_t);
+        if ((fstat (fileno (file), &sb) != 0) ||
+            ((uint64_t)ARSAL_SNAPSHOT_HEADER_SIZE + ((uint64_t)count * ARSAL_SNAPSHOT_NODE_SIZE) + namesSize > (uint64_t)sb.st_size) ||
+            ((size_t)nodesSize != nodesSize))
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Sizes consistent with the file
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        snapshot = ARSAL_Snapshot_Alloc ();
+        if (snapshot != NULL)
+        {
+            snapshot->takenSec = (int64_t)value;
+            snapshot->nodes = malloc ((size_t)nodesSize);
+            snapshot->names = malloc (namesSize);
+        }
+        // No else --> Alloc error
+        if ((snapshot == NULL) || (snapshot->nodes == NULL) || (snapshot->names == NULL))
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            snapshot->capacity = count;
+            snapshot->namesCapacity = namesSize;
+        }
+    }
+    // No else --> Processing block
+
+    for (i = 0; (result == ARSAL_OK) && (i < count); i++)
+    {
+        if (fread (record, sizeof (record), 1, file) != 1)
+        {
+            result = ARSAL_ERROR_FILE;
+            break;
+        }
+        // No else --> Read
+        node = &snapshot->nodes[i];
+        ptr = ARSAL_Snapshot_Read32 (record, &node->name);
+        ptr = ARSAL_Snapshot_Read32 (ptr, &node->end);
+        ptr = ARSAL_Snapshot_Read32 (ptr, &node->mode);
+        ptr = ARSAL_Snapshot_Read32 (ptr, &node->mtimeNsec);
+        ptr = ARSAL_Snapshot_Read32 (ptr, &node->ctimeNsec);
+        ptr = ARSAL_Snapshot_Read64 (ptr, &node->size);
+        ptr = ARSAL_Snapshot_Read64 (ptr, &value);
+        node->mtimeSec = (int64_t)value;
+        ptr = ARSAL_Snapshot_Read64 (ptr, &value);
+        node->ctimeSec = (int64_t)value;
+        ARSAL_Snapshot_Read64 (ptr, &node->inode);
+
+        // The walks trust the subtree bounds: check them
+        if ((node->name >= namesSize) || (node->end <= i) || (node->end > count) || ((!S_ISDIR (node->mode)) && (node->end != i + 1)))
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        // No else --> Valid entry
+        snapshot->count = i + 1;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        if ((fread (snapshot->names, 1, namesSize, file) != namesSize) || (snapshot->names[namesSize - 1] != '\0') || (snapshot->nodes[0].end != count))
+        {
+            result = ARSAL_ERROR_FILE;
+        }
+        else
+        {
+            snapshot->namesSize = namesSize;
+        }
+    }
+    // No else --> Processing block
+
+    if (file != NULL)
+    {
+        fclose (file);
+    }
+    // No else --> Close only if non-null
+
+    if (result != ARSAL_OK)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_SNAPSHOT_TAG, "Unable to load snapshot %s", filePath ? filePath : "null");
+        ARSAL_Snapshot_Delete (&snapshot);
+    }
+    // No else --> Loaded
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return snapshot;
+}
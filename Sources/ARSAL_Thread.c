@@ -34,9 +34,15 @@
  * @date 05/18/2012
  * @author frederic.dhaeyer@parrot.com
  */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* sched_setaffinity */
+#endif
 #include <stdlib.h>
 #include <config.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
 #include <libARSAL/ARSAL_Thread.h>
 #include <libARSAL/ARSAL_Print.h>
 
@@ -46,6 +52,89 @@
 #error The pthread.h header is required in order to build the library
 #endif
 
+#if defined(__linux__)
+#include <sys/prctl.h>
+#endif
+
+#define ARSAL_THREAD_TAG "ARSAL_Thread"
+
+/**
+ * @brief Startup of a thread created with attributes, shared with the creator until the attributes are applied
+ */
+typedef struct {
+    ARSAL_Thread_Routine_t routine;
+    void *arg;
+    const ARSAL_Thread_Attr_t *attr;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int done;
+    int result;
+} ARSAL_Thread_Start_t;
+
+/**
+ * @brief Apply the attributes which can only be set by the thread itself
+ */
+static int ARSAL_Thread_ApplySelf(const ARSAL_Thread_Attr_t *attr)
+{
+    int result = 0;
+#if defined(__linux__)
+    cpu_set_t cpus;
+    int cpu;
+
+    if (attr->affinity != 0) {
+        CPU_ZERO(&cpus);
+        for (cpu = 0; cpu < 64; cpu++) {
+            if (attr->affinity & ((uint64_t)1 << cpu)) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+            result = errno;
+        }
+    }
+
+    if ((result == 0) && (attr->name[0] != '\0')) {
+        if (prctl(PR_SET_NAME, (unsigned long)attr->name, 0, 0, 0) != 0) {
+            result = errno;
+        }
+    }
+#elif defined(__APPLE__)
+    if (attr->affinity != 0) {
+        /* The affinity is only a hint given by tags on this platform */
+        result = ENOTSUP;
+    }
+
+    if ((result == 0) && (attr->name[0] != '\0')) {
+        result = pthread_setname_np(attr->name);
+    }
+#else
+    if ((attr->affinity != 0) || (attr->name[0] != '\0')) {
+        result = ENOTSUP;
+    }
+#endif
+
+    return result;
+}
+
+static void* ARSAL_Thread_Trampoline(void *arg)
+{
+    ARSAL_Thread_Start_t *start = (ARSAL_Thread_Start_t *)arg;
+    ARSAL_Thread_Routine_t routine = start->routine;
+    void *routineArg = start->arg;
+    int result;
+
+    result = ARSAL_Thread_ApplySelf(start->attr);
+
+    /* The creator frees the startup once done is set */
+    pthread_mutex_lock(&start->mutex);
+    start->result = result;
+    start->done = 1;
+    pthread_cond_signal(&start->cond);
+    pthread_mutex_unlock(&start->mutex);
+
+    return (result == 0) ? routine(routineArg) : NULL;
+}
+
 int ARSAL_Thread_Create(ARSAL_Thread_t *thread, ARSAL_Thread_Routine_t routine, void *arg)
 {
     int result = 0;
@@ -67,6 +156,108 @@ int ARSAL_Thread_Create(ARSAL_Thread_t *thread, ARSAL_Thread_Routine_t routine,
     return result;
 }
 
+void ARSAL_Thread_Attr_Init(ARSAL_Thread_Attr_t *attr)
+{
+    if (attr != NULL) {
+        memset(attr, 0, sizeof(ARSAL_Thread_Attr_t));
+        attr->guardSize = ARSAL_THREAD_DEFAULT_GUARD_SIZE;
+        attr->policy = ARSAL_THREAD_SCHED_OTHER;
+    }
+}
+
+int ARSAL_Thread_CreateWithAttr(ARSAL_Thread_t *thread, ARSAL_Thread_Routine_t routine, void *arg, const ARSAL_Thread_Attr_t *attr)
+{
+    int result = 0;
+
+#if defined(HAVE_PTHREAD_H)
+    ARSAL_Thread_Start_t start;
+    struct sched_param param;
+    pthread_attr_t pattr;
+    pthread_t *pthread;
+
+    if (attr == NULL) {
+        return ARSAL_Thread_Create(thread, routine, arg);
+    }
+
+    if ((thread == NULL) || (routine == NULL) ||
+        ((attr->policy != ARSAL_THREAD_SCHED_OTHER) && (attr->policy != ARSAL_THREAD_SCHED_FIFO) && (attr->policy != ARSAL_THREAD_SCHED_RR))) {
+        return EINVAL;
+    }
+
+    result = pthread_attr_init(&pattr);
+    if (result != 0) {
+        return result;
+    }
+
+    if ((result == 0) && (attr->stackSize != 0)) {
+        result = pthread_attr_setstacksize(&pattr, attr->stackSize);
+    }
+
+    if ((result == 0) && (attr->guardSize != ARSAL_THREAD_DEFAULT_GUARD_SIZE)) {
+        result = pthread_attr_setguardsize(&pattr, attr->guardSize);
+    }
+
+    if ((result == 0) && (attr->policy != ARSAL_THREAD_SCHED_OTHER)) {
+        /* Without explicit scheduling, the policy of the creator would be inherited */
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = attr->priority;
+        result = pthread_attr_setinheritsched(&pattr, PTHREAD_EXPLICIT_SCHED);
+        if (result == 0) {
+            result = pthread_attr_setschedpolicy(&pattr, (attr->policy == ARSAL_THREAD_SCHED_FIFO) ? SCHED_FIFO : SCHED_RR);
+        }
+        if (result == 0) {
+            result = pthread_attr_setschedparam(&pattr, &param);
+        }
+    }
+
+    pthread = (result == 0) ? (pthread_t *)calloc(1, sizeof(pthread_t)) : NULL;
+    if ((result == 0) && (pthread == NULL)) {
+        result = ENOMEM;
+    }
+
+    if (result == 0) {
+        memset(&start, 0, sizeof(start));
+        start.routine = routine;
+        start.arg = arg;
+        start.attr = attr;
+        pthread_mutex_init(&start.mutex, NULL);
+        pthread_cond_init(&start.cond, NULL);
+
+        result = pthread_create(pthread, &pattr, ARSAL_Thread_Trampoline, &start);
+        if (result == 0) {
+            /* Wait for the affinity and the name, so that their errors are returned */
+            pthread_mutex_lock(&start.mutex);
+            while (!start.done) {
+                pthread_cond_wait(&start.cond, &start.mutex);
+            }
+            result = start.result;
+            pthread_mutex_unlock(&start.mutex);
+
+            if (result != 0) {
+                pthread_join(*pthread, NULL);
+            }
+        }
+
+        pthread_cond_destroy(&start.cond);
+        pthread_mutex_destroy(&start.mutex);
+
+        if (result != 0) {
+            free(pthread);
+        } else {
+            *thread = (ARSAL_Thread_t)pthread;
+        }
+    }
+
+    pthread_attr_destroy(&pattr);
+
+    if (result != 0) {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARSAL_THREAD_TAG, "Unable to create the thread %s: %s", attr->name, strerror(result));
+    }
+#endif
+
+    return result;
+}
+
 int ARSAL_Thread_Join(ARSAL_Thread_t thread, void **retval)
 {
     int result = 0;
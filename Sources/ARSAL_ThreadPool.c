@@ -0,0 +1,534 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_ThreadPool.c
+ * @brief libARSAL thread pool running short tasks on a fixed or elastic set of workers.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "libARSAL/ARSAL_ThreadPool.h"
+#include "libARSAL/ARSAL_Future.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Time.h"
+
+#define ARSAL_THREADPOOL_TAG    "ThreadPool"
+
+/**
+ * State of a worker slot
+ */
+typedef enum
+{
+    ARSAL_THREADPOOL_SLOT_FREE = 0,
+    ARSAL_THREADPOOL_SLOT_RUNNING,
+    ARSAL_THREADPOOL_SLOT_EXITED, /**< The worker returned, its thread is still to join */
+} eARSAL_THREADPOOL_SLOT;
+
+/**
+ * Queued task, recycled through the free list of the pool
+ */
+typedef struct _ARSAL_ThreadPool_Job_t ARSAL_ThreadPool_Job_t;
+struct _ARSAL_ThreadPool_Job_t
+{
+    ARSAL_ThreadPool_Task_t task;
+    void *customData;
+    ARSAL_Future_t *future;
+    ARSAL_ThreadPool_Job_t *next;
+};
+
+typedef struct
+{
+    ARSAL_ThreadPool_t *pool;
+    ARSAL_Thread_t thread;
+    eARSAL_THREADPOOL_SLOT state;
+} ARSAL_ThreadPool_Slot_t;
+
+struct _ARSAL_ThreadPool_t
+{
+    int minThreads;
+    int maxThreads;
+    int idleTimeoutMs;
+    ARSAL_Thread_Attr_t threadAttr;
+    int hasThreadAttr;
+    ARSAL_ThreadPool_Slot_t *slots;
+    ARSAL_Mutex_t mutex; /**< Protects the fields below and the slot states */
+    ARSAL_Cond_t workCond;
+    ARSAL_ThreadPool_Job_t *head;
+    ARSAL_ThreadPool_Job_t *tail;
+    ARSAL_ThreadPool_Job_t *freeJobs;
+    int shutdown;
+    int joining; /**< A shutdown is joining the workers */
+    ARSAL_ThreadPool_Metrics_t metrics;
+};
+
+static void* ARSAL_ThreadPool_Worker (void *arg);
+
+/**
+ * Start a worker in a free slot, the pool mutex being locked
+ * @return 0 on success, -1 if no slot is free or the thread cannot be created
+ */
+static int ARSAL_ThreadPool_Spawn (ARSAL_ThreadPool_t *pool)
+{
+    ARSAL_ThreadPool_Slot_t *slot = NULL;
+    int retVal = -1;
+    int i;
+
+    for (i = 0; (slot == NULL) && (i < pool->maxThreads); i++)
+    {
+        if (pool->slots[i].state == ARSAL_THREADPOOL_SLOT_EXITED)
+        {
+            // The worker is past its last access to the pool
+            ARSAL_Thread_Join (pool->slots[i].thread, NULL);
+            ARSAL_Thread_Destroy (&pool->slots[i].thread);
+            pool->slots[i].state = ARSAL_THREADPOOL_SLOT_FREE;
+        }
+        // No else --> Running or already free
+
+        if (pool->slots[i].state == ARSAL_THREADPOOL_SLOT_FREE)
+        {
+            slot = &pool->slots[i];
+        }
+        // No else --> Used
+    }
+
+    if (slot != NULL)
+    {
+        slot->pool = pool;
+        if (ARSAL_Thread_CreateWithAttr (&slot->thread, ARSAL_ThreadPool_Worker, slot, pool->hasThreadAttr ? &pool->threadAttr : NULL) == 0)
+        {
+            slot->state = ARSAL_THREADPOOL_SLOT_RUNNING;
+            pool->metrics.threadCount++;
+            retVal = 0;
+        }
+        else
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_THREADPOOL_TAG, "Unable to create a worker");
+        }
+    }
+    // No else --> All the workers are running
+
+    return retVal;
+}
+
+static void* ARSAL_ThreadPool_Worker (void *arg)
+{
+    ARSAL_ThreadPool_Slot_t *slot = (ARSAL_ThreadPool_Slot_t *)arg;
+    ARSAL_ThreadPool_t *pool = slot->pool;
+    ARSAL_ThreadPool_Job_t *job;
+    ARSAL_Future_t *future;
+    struct timespec idleStart;
+    struct timespec now;
+    void *result;
+    int remainingMs;
+
+    ARSAL_Mutex_Lock (&pool->mutex);
+    while (1)
+    {
+        // The idle time runs from the end of the last task, whatever wakes the worker up meanwhile
+        ARSAL_Time_GetTime (&idleStart);
+        remainingMs = pool->idleTimeoutMs;
+        while ((pool->head == NULL) && (!pool->shutdown) && (remainingMs > 0))
+        {
+            pool->metrics.idleThreadCount++;
+            if (pool->metrics.threadCount > pool->minThreads)
+            {
+                ARSAL_Cond_Timedwait (&pool->workCond, &pool->mutex, remainingMs);
+                ARSAL_Time_GetTime (&now);
+                remainingMs = pool->idleTimeoutMs - ARSAL_Time_ComputeTimespecMsTimeDiff (&idleStart, &now);
+            }
+            else
+            {
+                ARSAL_Cond_Wait (&pool->workCond, &pool->mutex);
+                // Not counted while the worker was needed for the minimum
+                ARSAL_Time_GetTime (&idleStart);
+            }
+            pool->metrics.idleThreadCount--;
+        }
+
+        if ((pool->head == NULL) && ((pool->shutdown) || (pool->metrics.threadCount > pool->minThreads)))
+        {
+            // Nothing left to do, or idle for the whole timeout above the minimum
+            break;
+        }
+        else if (pool->head == NULL)
+        {
+            // Timed out while the other workers exited
+            continue;
+        }
+        // No else --> Got a task
+
+        job = pool->head;
+        pool->head = job->next;
+        if (pool->head == NULL)
+        {
+            pool->tail = NULL;
+        }
+        // No else --> Still queued tasks
+        pool->metrics.queueDepth--;
+        pool->metrics.activeTaskCount++;
+        ARSAL_Mutex_Unlock (&pool->mutex);
+
+        result = job->task (job->customData);
+        future = job->future;
+        if (future != NULL)
+        {
+            ARSAL_Promise_SetValue (future, result);
+        }
+        // No else --> Completion not wanted
+
+        ARSAL_Mutex_Lock (&pool->mutex);
+        pool->metrics.activeTaskCount--;
+        pool->metrics.completedCount++;
+        job->next = pool->freeJobs;
+        pool->freeJobs = job;
+    }
+
+    pool->metrics.threadCount--;
+    if (!pool->joining)
+    {
+        // Joined by the next spawn or by the shutdown
+        slot->state = ARSAL_THREADPOOL_SLOT_EXITED;
+    }
+    // No else --> The shutdown joins all the running slots
+    ARSAL_Mutex_Unlock (&pool->mutex);
+
+    return NULL;
+}
+
+ARSAL_ThreadPool_t* ARSAL_ThreadPool_New(const ARSAL_ThreadPool_Config_t *config, eARSAL_ERROR *error)
+{
+    ARSAL_ThreadPool_t *pool = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    int initialized = 0;
+    int i;
+
+    if ((config != NULL) &&
+        ((config->minThreads < 0) || (config->maxThreads < 1) || (config->minThreads > config->maxThreads) || (config->idleTimeoutMs < 0)))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        pool = calloc (1, sizeof (ARSAL_ThreadPool_t));
+        if (pool == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Allocated
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        pool->minThreads = (config != NULL) ? config->minThreads : ARSAL_THREADPOOL_DEFAULT_THREADS;
+        pool->maxThreads = (config != NULL) ? config->maxThreads : ARSAL_THREADPOOL_DEFAULT_THREADS;
+        pool->idleTimeoutMs = ((config != NULL) && (config->idleTimeoutMs > 0)) ? config->idleTimeoutMs : ARSAL_THREADPOOL_DEFAULT_IDLE_TIMEOUT_MS;
+        if ((config != NULL) && (config->threadAttr != NULL))
+        {
+            pool->threadAttr = *config->threadAttr;
+            pool->hasThreadAttr = 1;
+        }
+        // No else --> Default attributes
+
+        pool->slots = calloc (pool->maxThreads, sizeof (ARSAL_ThreadPool_Slot_t));
+        if (pool->slots == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else if ((ARSAL_Mutex_Init (&pool->mutex) != 0) || (ARSAL_Cond_Init (&pool->workCond) != 0))
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            initialized = 1;
+        }
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        ARSAL_Mutex_Lock (&pool->mutex);
+        for (i = 0; (result == ARSAL_OK) && (i < pool->minThreads); i++)
+        {
+            if (ARSAL_ThreadPool_Spawn (pool) != 0)
+            {
+                result = ARSAL_ERROR_SYSTEM;
+            }
+            // No else --> Started
+        }
+        ARSAL_Mutex_Unlock (&pool->mutex);
+    }
+    // No else --> Processing block
+
+    if ((result != ARSAL_OK) && (pool != NULL))
+    {
+        if (initialized)
+        {
+            ARSAL_ThreadPool_Shutdown (pool, 0);
+            ARSAL_Cond_Destroy (&pool->workCond);
+            ARSAL_Mutex_Destroy (&pool->mutex);
+        }
+        // No else --> No worker
+        free (pool->slots);
+        free (pool);
+        pool = NULL;
+    }
+    // No else --> Keep the pool
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return pool;
+}
+
+void ARSAL_ThreadPool_Delete(ARSAL_ThreadPool_t **poolAddr)
+{
+    ARSAL_ThreadPool_t *pool;
+    ARSAL_ThreadPool_Job_t *job;
+
+    if ((poolAddr != NULL) && (*poolAddr != NULL))
+    {
+        pool = *poolAddr;
+
+        ARSAL_ThreadPool_Shutdown (pool, 1);
+
+        while (pool->freeJobs != NULL)
+        {
+            job = pool->freeJobs;
+            pool->freeJobs = job->next;
+            free (job);
+        }
+        ARSAL_Cond_Destroy (&pool->workCond);
+        ARSAL_Mutex_Destroy (&pool->mutex);
+        free (pool->slots);
+        free (pool);
+
+        *poolAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+eARSAL_ERROR ARSAL_ThreadPool_Submit(ARSAL_ThreadPool_t *pool, ARSAL_ThreadPool_Task_t task, void *customData, ARSAL_Future_t *future)
+{
+    ARSAL_ThreadPool_Job_t *job = NULL;
+    ARSAL_ThreadPool_Job_t *previous;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    if ((pool == NULL) || (task == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (future != NULL)
+    {
+        // Pending until a worker runs the task, or the shutdown drops it
+        ARSAL_Future_Init (future);
+    }
+    // No else --> Completion not wanted
+
+    ARSAL_Mutex_Lock (&pool->mutex);
+    if (pool->shutdown)
+    {
+        result = ARSAL_ERROR_CANCELED;
+    }
+    else if (pool->freeJobs != NULL)
+    {
+        job = pool->freeJobs;
+        pool->freeJobs = job->next;
+    }
+    else
+    {
+        job = malloc (sizeof (ARSAL_ThreadPool_Job_t));
+        result = (job != NULL) ? ARSAL_OK : ARSAL_ERROR_ALLOC;
+    }
+
+    if (result == ARSAL_OK)
+    {
+        job->task = task;
+        job->customData = customData;
+        job->future = future;
+        job->next = NULL;
+        previous = pool->tail;
+        if (pool->tail != NULL)
+        {
+            pool->tail->next = job;
+        }
+        else
+        {
+            pool->head = job;
+        }
+        pool->tail = job;
+
+        pool->metrics.submittedCount++;
+        pool->metrics.queueDepth++;
+        if (pool->metrics.queueDepth > pool->metrics.maxQueueDepth)
+        {
+            pool->metrics.maxQueueDepth = pool->metrics.queueDepth;
+        }
+        // No else --> Not a new maximum
+
+        if ((pool->metrics.queueDepth > pool->metrics.idleThreadCount) && (pool->metrics.threadCount < pool->maxThreads) &&
+            (ARSAL_ThreadPool_Spawn (pool) != 0) && (pool->metrics.threadCount == 0))
+        {
+            // Grow the pool rather than wait for a busy worker; without any worker the task would never run
+            pool->tail = previous;
+            if (previous != NULL)
+            {
+                previous->next = NULL;
+            }
+            else
+            {
+                pool->head = NULL;
+            }
+            pool->metrics.submittedCount--;
+            pool->metrics.queueDepth--;
+            job->next = pool->freeJobs;
+            pool->freeJobs = job;
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            // Enough workers, the idle ones are woken up anyway
+            ARSAL_Cond_Signal (&pool->workCond);
+        }
+    }
+    // No else --> Not queued
+    ARSAL_Mutex_Unlock (&pool->mutex);
+
+    if ((result != ARSAL_OK) && (future != NULL))
+    {
+        // Never pending without a task to complete it
+        ARSAL_Promise_SetError (future, result);
+    }
+    // No else --> Queued, or completion not wanted
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_ThreadPool_Shutdown(ARSAL_ThreadPool_t *pool, int drain)
+{
+    ARSAL_ThreadPool_Job_t *canceled = NULL;
+    ARSAL_ThreadPool_Job_t *last = NULL;
+    ARSAL_ThreadPool_Job_t *job;
+    int i;
+
+    if (pool == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_Mutex_Lock (&pool->mutex);
+    pool->shutdown = 1;
+    pool->joining = 1;
+    if (!drain)
+    {
+        // The futures are completed once unlocked: their continuations may call the pool
+        canceled = pool->head;
+        for (job = canceled; job != NULL; job = job->next)
+        {
+            pool->metrics.queueDepth--;
+            pool->metrics.canceledCount++;
+            last = job;
+        }
+        pool->head = NULL;
+        pool->tail = NULL;
+    }
+    // No else --> The workers run the queued tasks before exiting
+
+    if ((pool->head != NULL) && (pool->metrics.threadCount == 0))
+    {
+        // Elastic pool without any worker left
+        ARSAL_ThreadPool_Spawn (pool);
+    }
+    // No else --> The running workers drain the queue
+    ARSAL_Cond_Broadcast (&pool->workCond);
+    ARSAL_Mutex_Unlock (&pool->mutex);
+
+    if (canceled != NULL)
+    {
+        for (job = canceled; job != NULL; job = job->next)
+        {
+            if (job->future != NULL)
+            {
+                ARSAL_Promise_SetError (job->future, ARSAL_ERROR_CANCELED);
+            }
+            // No else --> Completion not wanted
+        }
+
+        // Shut down: the free jobs are not taken anymore, only released by the deletion
+        ARSAL_Mutex_Lock (&pool->mutex);
+        last->next = pool->freeJobs;
+        pool->freeJobs = canceled;
+        ARSAL_Mutex_Unlock (&pool->mutex);
+    }
+    // No else --> Nothing dropped
+
+    // The slots do not change anymore: no spawn once shut down, and the exiting workers leave their state
+    for (i = 0; i < pool->maxThreads; i++)
+    {
+        if (pool->slots[i].state != ARSAL_THREADPOOL_SLOT_FREE)
+        {
+            ARSAL_Thread_Join (pool->slots[i].thread, NULL);
+            ARSAL_Thread_Destroy (&pool->slots[i].thread);
+            pool->slots[i].state = ARSAL_THREADPOOL_SLOT_FREE;
+        }
+        // No else --> No thread
+    }
+
+    return ARSAL_OK;
+}
+
+eARSAL_ERROR ARSAL_ThreadPool_GetMetrics(ARSAL_ThreadPool_t *pool, ARSAL_ThreadPool_Metrics_t *metrics)
+{
+    if ((pool == NULL) || (metrics == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_Mutex_Lock (&pool->mutex);
+    *metrics = pool->metrics;
+    ARSAL_Mutex_Unlock (&pool->mutex);
+
+    return ARSAL_OK;
+}
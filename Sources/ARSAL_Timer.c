@@ -0,0 +1,634 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Timer.c
+ * @brief libARSAL timer service: one-shot and periodic timers run by a single thread on a hierarchical timing wheel.
+ **/
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "libARSAL/ARSAL_Timer.h"
+#include "libARSAL/ARSAL_Print.h"
+#include "libARSAL/ARSAL_Mutex.h"
+#include "libARSAL/ARSAL_Time.h"
+
+#define ARSAL_TIMER_TAG                 "Timer"
+
+#define ARSAL_TIMER_WHEEL_BITS          (8)
+#define ARSAL_TIMER_WHEEL_SIZE          (1 << ARSAL_TIMER_WHEEL_BITS)
+#define ARSAL_TIMER_WHEEL_MASK          (ARSAL_TIMER_WHEEL_SIZE - 1)
+#define ARSAL_TIMER_WHEEL_LEVELS        (4)
+#define ARSAL_TIMER_WHEEL_MAX_TICKS     ((((uint64_t)1) << (ARSAL_TIMER_WHEEL_BITS * ARSAL_TIMER_WHEEL_LEVELS)) - 1) /**< Farthest expiry the wheel can hold, farther ones are moved down again when reached */
+#define ARSAL_TIMER_ENTRIES_MIN_CAPACITY (64)
+
+/**
+ * An armed timer, linked in a slot of the wheel
+ */
+typedef struct _ARSAL_Timer_Entry_t ARSAL_Timer_Entry_t;
+struct _ARSAL_Timer_Entry_t
+{
+    ARSAL_Timer_Entry_t *next; /**< Next entry of the slot, or of the free list */
+    ARSAL_Timer_Entry_t **pprev; /**< Link pointing to this entry, NULL if not armed */
+    uint64_t expires; /**< Expiry tick */
+    uint64_t periodTicks; /**< 0 for a one-shot timer */
+    ARSAL_Timer_Callback_t callback;
+    void *customData;
+    uint32_t index; /**< Index in the entry table, low half of the identifier */
+    uint32_t generation; /**< High half of the identifier, changed when the entry is released */
+};
+
+/**
+ * A callback submitted to the pool
+ */
+typedef struct
+{
+    ARSAL_Timer_Callback_t callback;
+    void *customData;
+} ARSAL_Timer_Dispatch_t;
+
+struct _ARSAL_Timer_t
+{
+    ARSAL_Mutex_t mutex;
+    ARSAL_Cond_t cond;
+    ARSAL_Thread_t thread;
+    int threadStarted;
+    int stop;
+    int64_t resolutionUs;
+    ARSAL_ThreadPool_t *pool;
+    struct timespec start; /**< Time of the tick 0 */
+    uint64_t currentTick; /**< Last tick processed */
+    uint64_t wakeTick; /**< Tick the timer thread sleeps until */
+    ARSAL_Timer_Entry_t *wheel[ARSAL_TIMER_WHEEL_LEVELS][ARSAL_TIMER_WHEEL_SIZE];
+    ARSAL_Timer_Entry_t **entries; /**< Entry table, indexed by the identifiers */
+    uint32_t entryCount;
+    uint32_t entryCapacity;
+    ARSAL_Timer_Entry_t *freeEntries;
+    uint64_t driftSumUs;
+    ARSAL_Timer_Metrics_t metrics;
+};
+
+/**
+ * Elapsed time since the tick 0, in microseconds
+ */
+static int64_t ARSAL_Timer_GetElapsedUs (ARSAL_Timer_t *timer)
+{
+    struct timespec now;
+
+    ARSAL_Time_GetTime (&now);
+
+    return ((int64_t)(now.tv_sec - timer->start.tv_sec) * 1000000) + ((now.tv_nsec - timer->start.tv_nsec) / 1000);
+}
+
+static void ARSAL_Timer_Link (ARSAL_Timer_Entry_t **head, ARSAL_Timer_Entry_t *entry)
+{
+    entry->next = *head;
+    if (entry->next != NULL)
+    {
+        entry->next->pprev = &entry->next;
+    }
+    // No else --> First entry
+    entry->pprev = head;
+    *head = entry;
+}
+
+static void ARSAL_Timer_Unlink (ARSAL_Timer_Entry_t *entry)
+{
+    *entry->pprev = entry->next;
+    if (entry->next != NULL)
+    {
+        entry->next->pprev = entry->pprev;
+    }
+    // No else --> Last entry
+    entry->next = NULL;
+    entry->pprev = NULL;
+}
+
+/**
+ * Link an entry in the slot of its expiry, on the finest level able to hold it
+ */
+static void ARSAL_Timer_Insert (ARSAL_Timer_t *timer, ARSAL_Timer_Entry_t *entry)
+{
+    uint64_t delta = entry->expires - timer->currentTick;
+    uint64_t expires = entry->expires;
+    int level = 0;
+
+    if (delta > ARSAL_TIMER_WHEEL_MAX_TICKS)
+    {
+        expires = timer->currentTick + ARSAL_TIMER_WHEEL_MAX_TICKS;
+        delta = ARSAL_TIMER_WHEEL_MAX_TICKS;
+    }
+    // No else --> Within the wheel
+
+    while ((level < ARSAL_TIMER_WHEEL_LEVELS - 1) && (delta >= ((uint64_t)1 << (ARSAL_TIMER_WHEEL_BITS * (level + 1)))))
+    {
+        level++;
+    }
+
+    ARSAL_Timer_Link (&timer->wheel[level][(expires >> (ARSAL_TIMER_WHEEL_BITS * level)) & ARSAL_TIMER_WHEEL_MASK], entry);
+}
+
+/**
+ * Release an entry for reuse, its identifier becoming invalid
+ */
+static void ARSAL_Timer_Release (ARSAL_Timer_t *timer, ARSAL_Timer_Entry_t *entry)
+{
+    entry->generation++;
+    if (entry->generation == 0)
+    {
+        entry->generation = 1;
+    }
+    // No else --> Never 0, so no identifier is ARSAL_TIMER_INVALID_ID
+    entry->callback = NULL;
+    entry->customData = NULL;
+    entry->next = timer->freeEntries;
+    timer->freeEntries = entry;
+    timer->metrics.activeCount--;
+}
+
+static void* ARSAL_Timer_DispatchTask (void *customData)
+{
+    ARSAL_Timer_Dispatch_t *dispatch = (ARSAL_Timer_Dispatch_t *)customData;
+
+    dispatch->callback (dispatch->customData);
+    free (dispatch);
+
+    return NULL;
+}
+
+/**
+ * Call the callback of a timer, or submit it to the pool
+ */
+static void ARSAL_Timer_Call (ARSAL_Timer_t *timer, ARSAL_Timer_Callback_t callback, void *customData)
+{
+    ARSAL_Timer_Dispatch_t *dispatch;
+
+    if (timer->pool == NULL)
+    {
+        callback (customData);
+        return;
+    }
+    // No else --> Run by the pool
+
+    dispatch = malloc (sizeof (ARSAL_Timer_Dispatch_t));
+    if (dispatch != NULL)
+    {
+        dispatch->callback = callback;
+        dispatch->customData = customData;
+        if (ARSAL_ThreadPool_Submit (timer->pool, ARSAL_Timer_DispatchTask, dispatch, NULL) != ARSAL_OK)
+        {
+            free (dispatch);
+            dispatch = NULL;
+        }
+        // No else --> Submitted
+    }
+    // No else --> Alloc error
+
+    if (dispatch == NULL)
+    {
+        // Better late than never
+        ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSAL_TIMER_TAG, "Unable to submit a callback to the pool, calling it on the timer thread");
+        callback (customData);
+    }
+    // No else --> Submitted
+}
+
+/**
+ * Process the next tick, the mutex being locked
+ * @note The mutex is unlocked while calling the callbacks
+ * @param targetTick The tick of the current time, to skip the missed periods
+ */
+static void ARSAL_Timer_Advance (ARSAL_Timer_t *timer, uint64_t targetTick)
+{
+    ARSAL_Timer_Entry_t *expired;
+    ARSAL_Timer_Entry_t *entry;
+    ARSAL_Timer_Callback_t callback;
+    void *customData;
+    uint64_t skipped;
+    int64_t driftUs;
+    uint32_t index;
+    int level;
+
+    timer->currentTick++;
+
+    // At the wrap of a level, move the entries of the matching slot of the next level down
+    index = timer->currentTick & ARSAL_TIMER_WHEEL_MASK;
+    for (level = 1; (index == 0) && (level < ARSAL_TIMER_WHEEL_LEVELS); level++)
+    {
+        index = (timer->currentTick >> (ARSAL_TIMER_WHEEL_BITS * level)) & ARSAL_TIMER_WHEEL_MASK;
+        expired = timer->wheel[level][index];
+        timer->wheel[level][index] = NULL;
+        while (expired != NULL)
+        {
+            entry = expired;
+            expired = entry->next;
+            ARSAL_Timer_Insert (timer, entry);
+        }
+    }
+
+    // Detach the expired slot: the entries canceled meanwhile unlink from the local list
+    expired = timer->wheel[0][timer->currentTick & ARSAL_TIMER_WHEEL_MASK];
+    timer->wheel[0][timer->currentTick & ARSAL_TIMER_WHEEL_MASK] = NULL;
+    if (expired != NULL)
+    {
+        expired->pprev = &expired;
+    }
+    // No else --> Nothing expires
+
+    while ((expired != NULL) && (!timer->stop))
+    {
+        entry = expired;
+        ARSAL_Timer_Unlink (entry);
+        callback = entry->callback;
+        customData = entry->customData;
+
+        driftUs = ARSAL_Timer_GetElapsedUs (timer) - (int64_t)entry->expires * timer->resolutionUs;
+        driftUs = (driftUs > 0) ? driftUs : 0;
+        timer->driftSumUs += driftUs;
+        timer->metrics.firedCount++;
+        timer->metrics.maxDriftUs = (driftUs > timer->metrics.maxDriftUs) ? (uint32_t)driftUs : timer->metrics.maxDriftUs;
+
+        if (entry->periodTicks != 0)
+        {
+            // Rearmed relative to its expiry, skipping the periods already past
+            entry->expires += entry->periodTicks;
+            if (entry->expires <= targetTick)
+            {
+                skipped = (targetTick - entry->expires) / entry->periodTicks + 1;
+                entry->expires += skipped * entry->periodTicks;
+                timer->metrics.overrunCount += skipped;
+            }
+            // No else --> On time
+            ARSAL_Timer_Insert (timer, entry);
+        }
+        else
+        {
+            ARSAL_Timer_Release (timer, entry);
+        }
+
+        ARSAL_Mutex_Unlock (&timer->mutex);
+        ARSAL_Timer_Call (timer, callback, customData);
+        ARSAL_Mutex_Lock (&timer->mutex);
+    }
+
+    while (expired != NULL)
+    {
+        // Stopped: the remaining entries are dropped
+        entry = expired;
+        ARSAL_Timer_Unlink (entry);
+        ARSAL_Timer_Release (timer, entry);
+    }
+}
+
+/**
+ * Find the next tick to wake up at: the next expiry on the first level, or its wrap
+ */
+static uint64_t ARSAL_Timer_GetNextTick (ARSAL_Timer_t *timer)
+{
+    uint64_t tick = timer->currentTick + 1;
+
+    if (timer->metrics.activeCount == 0)
+    {
+        return UINT64_MAX;
+    }
+    // No else --> Armed timers
+
+    while (((tick & ARSAL_TIMER_WHEEL_MASK) != 0) && (timer->wheel[0][tick & ARSAL_TIMER_WHEEL_MASK] == NULL))
+    {
+        tick++;
+    }
+
+    return tick;
+}
+
+static void* ARSAL_Timer_Run (void *arg)
+{
+    ARSAL_Timer_t *timer = (ARSAL_Timer_t *)arg;
+    uint64_t targetTick;
+    int64_t waitUs;
+
+    ARSAL_Mutex_Lock (&timer->mutex);
+    while (!timer->stop)
+    {
+        targetTick = (uint64_t)(ARSAL_Timer_GetElapsedUs (timer) / timer->resolutionUs);
+        while ((timer->currentTick < targetTick) && (!timer->stop))
+        {
+            ARSAL_Timer_Advance (timer, targetTick);
+        }
+
+        if (!timer->stop)
+        {
+            timer->wakeTick = ARSAL_Timer_GetNextTick (timer);
+            if (timer->wakeTick == UINT64_MAX)
+            {
+                ARSAL_Cond_Wait (&timer->cond, &timer->mutex);
+            }
+            else
+            {
+                waitUs = (int64_t)timer->wakeTick * timer->resolutionUs - ARSAL_Timer_GetElapsedUs (timer);
+                if (waitUs > 0)
+                {
+                    // Rounded up, the tick is reached when woken up
+                    ARSAL_Cond_Timedwait (&timer->cond, &timer->mutex, (int)((waitUs + 999) / 1000));
+                }
+                // No else --> Already late
+            }
+        }
+        // No else --> Stopped
+    }
+    ARSAL_Mutex_Unlock (&timer->mutex);
+
+    return NULL;
+}
+
+ARSAL_Timer_t* ARSAL_Timer_New(const ARSAL_Timer_Config_t *config, eARSAL_ERROR *error)
+{
+    ARSAL_Timer_t *timer = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    int initialized = 0;
+
+    if ((config != NULL) && (config->resolutionMs < 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        timer = calloc (1, sizeof (ARSAL_Timer_t));
+        if (timer == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Alloc check
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        timer->resolutionUs = (int64_t)(((config != NULL) && (config->resolutionMs > 0)) ? config->resolutionMs : ARSAL_TIMER_DEFAULT_RESOLUTION_MS) * 1000;
+        timer->pool = (config != NULL) ? config->pool : NULL;
+        timer->wakeTick = UINT64_MAX;
+        ARSAL_Time_GetTime (&timer->start);
+
+        if ((ARSAL_Mutex_Init (&timer->mutex) != 0) || (ARSAL_Cond_Init (&timer->cond) != 0))
+        {
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            initialized = 1;
+        }
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        if (ARSAL_Thread_CreateWithAttr (&timer->thread, ARSAL_Timer_Run, timer, (config != NULL) ? config->threadAttr : NULL) != 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_TIMER_TAG, "Unable to create the timer thread");
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        else
+        {
+            timer->threadStarted = 1;
+        }
+    }
+    // No else --> Processing block
+
+    if ((result != ARSAL_OK) && (timer != NULL))
+    {
+        if (initialized)
+        {
+            ARSAL_Timer_Delete (&timer);
+        }
+        else
+        {
+            free (timer);
+            timer = NULL;
+        }
+    }
+    // No else --> Keep the timer service
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return timer;
+}
+
+void ARSAL_Timer_Delete(ARSAL_Timer_t **timerAddr)
+{
+    ARSAL_Timer_t *timer;
+    uint32_t i;
+
+    if ((timerAddr != NULL) && (*timerAddr != NULL))
+    {
+        timer = *timerAddr;
+
+        if (timer->threadStarted)
+        {
+            ARSAL_Mutex_Lock (&timer->mutex);
+            timer->stop = 1;
+            ARSAL_Cond_Signal (&timer->cond);
+            ARSAL_Mutex_Unlock (&timer->mutex);
+
+            ARSAL_Thread_Join (timer->thread, NULL);
+            ARSAL_Thread_Destroy (&timer->thread);
+        }
+        // No else --> Not started
+
+        for (i = 0; i < timer->entryCount; i++)
+        {
+            free (timer->entries[i]);
+        }
+        free (timer->entries);
+
+        ARSAL_Cond_Destroy (&timer->cond);
+        ARSAL_Mutex_Destroy (&timer->mutex);
+        free (timer);
+
+        *timerAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+eARSAL_ERROR ARSAL_Timer_Add(ARSAL_Timer_t *timer, uint32_t delayMs, uint32_t periodMs, ARSAL_Timer_Callback_t callback, void *customData, ARSAL_Timer_Id_t *id)
+{
+    ARSAL_Timer_Entry_t *entry = NULL;
+    ARSAL_Timer_Entry_t **entries;
+    eARSAL_ERROR result = ARSAL_OK;
+    uint32_t capacity;
+    uint64_t nowTick;
+    int64_t elapsedUs;
+    int64_t expiresUs;
+
+    if ((timer == NULL) || (callback == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_Mutex_Lock (&timer->mutex);
+
+    entry = timer->freeEntries;
+    if (entry != NULL)
+    {
+        timer->freeEntries = entry->next;
+    }
+    else
+    {
+        if (timer->entryCount == timer->entryCapacity)
+        {
+            capacity = (timer->entryCapacity > 0) ? timer->entryCapacity * 2 : ARSAL_TIMER_ENTRIES_MIN_CAPACITY;
+            entries = realloc (timer->entries, capacity * sizeof (ARSAL_Timer_Entry_t *));
+            if (entries != NULL)
+            {
+                timer->entries = entries;
+                timer->entryCapacity = capacity;
+            }
+            // No else --> Alloc error
+        }
+        // No else --> Room left
+
+        if (timer->entryCount < timer->entryCapacity)
+        {
+            entry = calloc (1, sizeof (ARSAL_Timer_Entry_t));
+        }
+        // No else --> Alloc error
+
+        if (entry != NULL)
+        {
+            entry->index = timer->entryCount;
+            entry->generation = 1;
+            timer->entries[timer->entryCount++] = entry;
+        }
+        else
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARSAL_OK)
+    {
+        elapsedUs = ARSAL_Timer_GetElapsedUs (timer);
+        if (timer->metrics.activeCount == 0)
+        {
+            // Empty wheel, not processed while the timer thread slept: catch up at once
+            nowTick = (uint64_t)(elapsedUs / timer->resolutionUs);
+            timer->currentTick = (nowTick > timer->currentTick) ? nowTick : timer->currentTick;
+        }
+        // No else --> Processed by the timer thread
+
+        // Rounded up to the next tick, and never on the tick already processed
+        expiresUs = elapsedUs + (int64_t)delayMs * 1000;
+        entry->expires = (uint64_t)((expiresUs + timer->resolutionUs - 1) / timer->resolutionUs);
+        entry->expires = (entry->expires > timer->currentTick) ? entry->expires : timer->currentTick + 1;
+        entry->periodTicks = (periodMs > 0) ? (((uint64_t)periodMs * 1000 + timer->resolutionUs - 1) / timer->resolutionUs) : 0;
+        entry->callback = callback;
+        entry->customData = customData;
+        ARSAL_Timer_Insert (timer, entry);
+        timer->metrics.activeCount++;
+
+        if (entry->expires < timer->wakeTick)
+        {
+            // Expires before the timer thread wakes up
+            ARSAL_Cond_Signal (&timer->cond);
+        }
+        // No else --> Processed in time
+
+        if (id != NULL)
+        {
+            *id = ((ARSAL_Timer_Id_t)entry->generation << 32) | entry->index;
+        }
+        // No else --> Identifier not wanted
+    }
+    // No else --> Processing block
+
+    ARSAL_Mutex_Unlock (&timer->mutex);
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Timer_Cancel(ARSAL_Timer_t *timer, ARSAL_Timer_Id_t id)
+{
+    ARSAL_Timer_Entry_t *entry = NULL;
+    eARSAL_ERROR result = ARSAL_ERROR_BAD_PARAMETER;
+    uint32_t index = (uint32_t)(id & 0xFFFFFFFF);
+
+    if (timer == NULL)
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_Mutex_Lock (&timer->mutex);
+
+    if (index < timer->entryCount)
+    {
+        entry = timer->entries[index];
+    }
+    // No else --> Unknown
+
+    if ((entry != NULL) && (entry->generation == (uint32_t)(id >> 32)) && (entry->pprev != NULL))
+    {
+        ARSAL_Timer_Unlink (entry);
+        ARSAL_Timer_Release (timer, entry);
+        timer->metrics.canceledCount++;
+        result = ARSAL_OK;
+    }
+    // No else --> Fired, canceled, or reused by another timer
+
+    ARSAL_Mutex_Unlock (&timer->mutex);
+
+    return result;
+}
+
+eARSAL_ERROR ARSAL_Timer_GetMetrics(ARSAL_Timer_t *timer, ARSAL_Timer_Metrics_t *metrics)
+{
+    if ((timer == NULL) || (metrics == NULL))
+    {
+        return ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    ARSAL_Mutex_Lock (&timer->mutex);
+    *metrics = timer->metrics;
+    metrics->meanDriftUs = (timer->metrics.firedCount > 0) ? (uint32_t)(timer->driftSumUs / timer->metrics.firedCount) : 0;
+    ARSAL_Mutex_Unlock (&timer->mutex);
+
+    return ARSAL_OK;
+}
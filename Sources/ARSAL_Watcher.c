@@ -0,0 +1,794 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARSAL_Watcher.c
+ * @brief libARSAL live directory hierarchy watcher, based on inotify.
+ **/
+
+#include <config.h>
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
+
+#include "libARSAL/ARSAL_Watcher.h"
+#include "libARSAL/ARSAL_DirIter.h"
+#include "libARSAL/ARSAL_Print.h"
+
+#define ARSAL_WATCHER_TAG   "Watcher"
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+#define ARSAL_WATCHER_MASK  (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK)
+#define ARSAL_WATCHER_BUFFER_SIZE   (64 * 1024)
+#define ARSAL_WATCHER_MAX_READS     (16) /**< Maximum number of buffers read from inotify to build a batch */
+#define ARSAL_WATCHER_DROPPED       (-1) /**< Change cancelled by a later one, not reported */
+
+/**
+ * Watched directory
+ */
+typedef struct
+{
+    int wd;
+    char *path;
+} ARSAL_Watcher_Watch_t;
+
+/**
+ * Pending change
+ */
+typedef struct
+{
+    size_t path; /**< Offset of the path in the pool */
+    int event; /**< eARSAL_WATCHER_EVENT, or ARSAL_WATCHER_DROPPED */
+    eARSAL_FTW_TYPE type;
+} ARSAL_Watcher_Change_t;
+
+struct _ARSAL_Watcher_t
+{
+    int fd;
+    char *rootPath;
+    ARSAL_Watcher_Watch_t *watches; /**< Watched directories, sorted by watch descriptor */
+    int watchCount;
+    int watchCapacity;
+    ARSAL_Watcher_Change_t *changes; /**< Batch of changes, in the order of their first event */
+    int changeCount;
+    int changeCapacity;
+    int changePos; /**< Index of the first change not delivered yet */
+    int *hash; /**< Index + 1 of the change of each path, 0 for empty slots */
+    int hashCapacity;
+    char *pool;
+    size_t poolSize;
+    size_t poolCapacity;
+    char *path;
+    size_t pathCapacity;
+    int overflow;
+    char *buffer;
+};
+
+static uint32_t ARSAL_Watcher_Hash (const char *path)
+{
+    uint32_t hash = 2166136261u;
+
+    for (; *path != '\0'; path++)
+    {
+        hash = (hash ^ (uint8_t)*path) * 16777619u;
+    }
+
+    return hash;
+}
+
+static int ARSAL_Watcher_FindWatch (const ARSAL_Watcher_t *watcher, int wd)
+{
+    int low = 0;
+    int high = watcher->watchCount - 1;
+    int middle;
+
+    while (low <= high)
+    {
+        middle = (low + high) / 2;
+        if (watcher->watches[middle].wd == wd)
+        {
+            return middle;
+        }
+        else if (watcher->watches[middle].wd < wd)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return -1;
+}
+
+static void ARSAL_Watcher_RemoveWatchAt (ARSAL_Watcher_t *watcher, int index)
+{
+    free (watcher->watches[index].path);
+    memmove (&watcher->watches[index], &watcher->watches[index + 1], (watcher->watchCount - index - 1) * sizeof (ARSAL_Watcher_Watch_t));
+    watcher->watchCount--;
+}
+
+/**
+ * Watch a directory
+ * @return ARSAL_OK, also when the directory vanished before it could be watched
+ */
+static eARSAL_ERROR ARSAL_Watcher_AddWatch (ARSAL_Watcher_t *watcher, const char *path)
+{
+    ARSAL_Watcher_Watch_t *watches;
+    eARSAL_ERROR result = ARSAL_OK;
+    char *pathCopy;
+    int capacity;
+    int index;
+    int wd;
+
+    wd = inotify_add_watch (watcher->fd, path, ARSAL_WATCHER_MASK);
+    if (wd < 0)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_WATCHER_TAG, "Unable to watch %s : %s", path, strerror (errno));
+        return ((errno == ENOENT) || (errno == ENOTDIR)) ? ARSAL_OK : ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Watched
+
+    pathCopy = strdup (path);
+    if (pathCopy == NULL)
+    {
+        inotify_rm_watch (watcher->fd, wd);
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Copied
+
+    index = ARSAL_Watcher_FindWatch (watcher, wd);
+    if (index >= 0)
+    {
+        // Already watched, through another path
+        free (watcher->watches[index].path);
+        watcher->watches[index].path = pathCopy;
+        return ARSAL_OK;
+    }
+    // No else --> New watch
+
+    if (watcher->watchCount >= watcher->watchCapacity)
+    {
+        capacity = (watcher->watchCapacity > 0) ? watcher->watchCapacity * 2 : 64;
+        watches = realloc (watcher->watches, capacity * sizeof (ARSAL_Watcher_Watch_t));
+        if (watches == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            watcher->watches = watches;
+            watcher->watchCapacity = capacity;
+        }
+    }
+    // No else --> No need to realloc in this case
+
+    if (result == ARSAL_OK)
+    {
+        // The descriptors are allocated increasing: this is almost always an append
+        for (index = watcher->watchCount; (index > 0) && (watcher->watches[index - 1].wd > wd); index--);
+        memmove (&watcher->watches[index + 1], &watcher->watches[index], (watcher->watchCount - index) * sizeof (ARSAL_Watcher_Watch_t));
+        watcher->watches[index].wd = wd;
+        watcher->watches[index].path = pathCopy;
+        watcher->watchCount++;
+    }
+    else
+    {
+        inotify_rm_watch (watcher->fd, wd);
+        free (pathCopy);
+    }
+
+    return result;
+}
+
+/**
+ * Stop watching a directory moved out of the hierarchy, and its subdirectories
+ */
+static void ARSAL_Watcher_RemoveSubtree (ARSAL_Watcher_t *watcher, const char *path)
+{
+    size_t pathLen = strlen (path);
+    int i;
+
+    for (i = watcher->watchCount - 1; i >= 0; i--)
+    {
+        if ((strncmp (watcher->watches[i].path, path, pathLen) == 0) &&
+            ((watcher->watches[i].path[pathLen] == '\0') || (watcher->watches[i].path[pathLen] == '/')))
+        {
+            inotify_rm_watch (watcher->fd, watcher->watches[i].wd);
+            ARSAL_Watcher_RemoveWatchAt (watcher, i);
+        }
+        // No else --> Out of the subtree
+    }
+}
+
+static eARSAL_ERROR ARSAL_Watcher_RebuildHash (ARSAL_Watcher_t *watcher, int capacity)
+{
+    int *hash;
+    uint32_t slot;
+    int i;
+
+    hash = calloc (capacity, sizeof (int));
+    if (hash == NULL)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Allocated
+
+    for (i = 0; i < watcher->changeCount; i++)
+    {
+        slot = ARSAL_Watcher_Hash (&watcher->pool[watcher->changes[i].path]) & (capacity - 1);
+        while (hash[slot] != 0)
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        hash[slot] = i + 1;
+    }
+
+    free (watcher->hash);
+    watcher->hash = hash;
+    watcher->hashCapacity = capacity;
+
+    return ARSAL_OK;
+}
+
+/**
+ * Add a change to the batch, coalescing it with the pending change of the same path
+ */
+static eARSAL_ERROR ARSAL_Watcher_AddChange (ARSAL_Watcher_t *watcher, const char *path, eARSAL_WATCHER_EVENT event, eARSAL_FTW_TYPE type)
+{
+    ARSAL_Watcher_Change_t *change = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+    size_t pathSize = strlen (path) + 1;
+    size_t poolCapacity;
+    uint32_t slot;
+    void *buffer;
+    int capacity;
+
+    slot = ARSAL_Watcher_Hash (path) & (watcher->hashCapacity - 1);
+    while ((change == NULL) && (watcher->hash[slot] != 0))
+    {
+        if (strcmp (&watcher->pool[watcher->changes[watcher->hash[slot] - 1].path], path) == 0)
+        {
+            change = &watcher->changes[watcher->hash[slot] - 1];
+        }
+        else
+        {
+            slot = (slot + 1) & (watcher->hashCapacity - 1);
+        }
+    }
+
+    if (change != NULL)
+    {
+        switch (change->event)
+        {
+        case ARSAL_WATCHER_EVENT_ADDED:
+            // Created then written is still created, created then deleted is nothing
+            change->event = (event == ARSAL_WATCHER_EVENT_REMOVED) ? ARSAL_WATCHER_DROPPED : ARSAL_WATCHER_EVENT_ADDED;
+            break;
+        case ARSAL_WATCHER_EVENT_REMOVED:
+            // Deleted then created again is replaced
+            change->event = (event == ARSAL_WATCHER_EVENT_ADDED) ? ARSAL_WATCHER_EVENT_MODIFIED : ARSAL_WATCHER_EVENT_REMOVED;
+            break;
+        case ARSAL_WATCHER_EVENT_MODIFIED:
+            change->event = (event == ARSAL_WATCHER_EVENT_REMOVED) ? ARSAL_WATCHER_EVENT_REMOVED : ARSAL_WATCHER_EVENT_MODIFIED;
+            break;
+        default:
+            change->event = event;
+            break;
+        }
+        change->type = type;
+        return ARSAL_OK;
+    }
+    // No else --> First change of this path in the batch
+
+    if (watcher->changeCount >= watcher->changeCapacity)
+    {
+        capacity = watcher->changeCapacity * 2;
+        buffer = realloc (watcher->changes, capacity * sizeof (ARSAL_Watcher_Change_t));
+        if (buffer == NULL)
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Reallocated
+        watcher->changes = buffer;
+        watcher->changeCapacity = capacity;
+        result = ARSAL_Watcher_RebuildHash (watcher, capacity * 2);
+        if (result != ARSAL_OK)
+        {
+            return result;
+        }
+        // No else --> Rebuilt
+
+        slot = ARSAL_Watcher_Hash (path) & (watcher->hashCapacity - 1);
+        while (watcher->hash[slot] != 0)
+        {
+            slot = (slot + 1) & (watcher->hashCapacity - 1);
+        }
+    }
+    // No else --> No need to realloc in this case
+
+    if (watcher->poolSize + pathSize > watcher->poolCapacity)
+    {
+        poolCapacity = (watcher->poolCapacity > 0) ? watcher->poolCapacity * 2 : 4096;
+        while (poolCapacity < watcher->poolSize + pathSize)
+        {
+            poolCapacity *= 2;
+        }
+        buffer = realloc (watcher->pool, poolCapacity);
+        if (buffer == NULL)
+        {
+            return ARSAL_ERROR_ALLOC;
+        }
+        // No else --> Reallocated
+        watcher->pool = buffer;
+        watcher->poolCapacity = poolCapacity;
+    }
+    // No else --> No need to realloc in this case
+
+    memcpy (&watcher->pool[watcher->poolSize], path, pathSize);
+    change = &watcher->changes[watcher->changeCount];
+    change->path = watcher->poolSize;
+    change->event = event;
+    change->type = type;
+    watcher->poolSize += pathSize;
+    watcher->hash[slot] = ++watcher->changeCount;
+
+    return result;
+}
+
+/**
+ * Watch all the directories of a hierarchy
+ * @param report Report the entries of the hierarchy as added, the root excepted
+ */
+static eARSAL_ERROR ARSAL_Watcher_WatchTree (ARSAL_Watcher_t *watcher, const char *path, int report)
+{
+    ARSAL_DirIter_t *iter;
+    const ARSAL_DirIter_Entry_t *entry;
+    eARSAL_ERROR result = ARSAL_OK;
+    eARSAL_ERROR iterError = ARSAL_OK;
+
+    iter = ARSAL_DirIter_New (path, 0, ARSAL_FTW_STAT_TYPE, &result);
+
+    while ((result == ARSAL_OK) && ((entry = ARSAL_DirIter_Next (iter, &iterError)) != NULL))
+    {
+        if (entry->type == ARSAL_FTW_D)
+        {
+            result = ARSAL_Watcher_AddWatch (watcher, entry->path);
+        }
+        // No else --> Only directories are watched
+
+        if ((result == ARSAL_OK) && (report) && (entry->level > 0))
+        {
+            result = ARSAL_Watcher_AddChange (watcher, entry->path, ARSAL_WATCHER_EVENT_ADDED, entry->type);
+        }
+        // No else --> Not reported
+    }
+
+    ARSAL_DirIter_Delete (&iter);
+
+    if ((result == ARSAL_OK) && (iterError != ARSAL_OK) && (!report))
+    {
+        // Only the first walk fails: a new directory may be removed while it is walked
+        result = iterError;
+    }
+    // No else --> Walked
+
+    return result;
+}
+
+static int ARSAL_Watcher_EnsurePath (ARSAL_Watcher_t *watcher, size_t size)
+{
+    char *path;
+    size_t capacity;
+
+    if (size > watcher->pathCapacity)
+    {
+        capacity = (watcher->pathCapacity > 0) ? watcher->pathCapacity : 256;
+        while (capacity < size)
+        {
+            capacity *= 2;
+        }
+        path = realloc (watcher->path, capacity);
+        if (path == NULL)
+        {
+            return -1;
+        }
+        // No else --> Reallocated
+        watcher->path = path;
+        watcher->pathCapacity = capacity;
+    }
+    // No else --> No need to realloc in this case
+
+    return 0;
+}
+
+/**
+ * Add the changes of an inotify event to the batch
+ */
+static eARSAL_ERROR ARSAL_Watcher_HandleEvent (ARSAL_Watcher_t *watcher, const struct inotify_event *ev)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    eARSAL_FTW_TYPE type = (ev->mask & IN_ISDIR) ? ARSAL_FTW_D : ARSAL_FTW_F;
+    const char *dirPath;
+    size_t dirPathLen;
+    size_t nameLen;
+    int index;
+
+    if (ev->mask & IN_Q_OVERFLOW)
+    {
+        ARSAL_PRINT (ARSAL_PRINT_WARNING, ARSAL_WATCHER_TAG, "Event queue overflow");
+        watcher->overflow = 1;
+        return ARSAL_OK;
+    }
+    // No else --> Event of a watched directory
+
+    index = ARSAL_Watcher_FindWatch (watcher, ev->wd);
+    if (index < 0)
+    {
+        // Event queued before the watch was removed
+        return ARSAL_OK;
+    }
+    // No else --> Known directory
+
+    if (ev->mask & IN_IGNORED)
+    {
+        ARSAL_Watcher_RemoveWatchAt (watcher, index);
+        return ARSAL_OK;
+    }
+    // No else --> Change
+
+    dirPath = watcher->watches[index].path;
+    if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+    {
+        // The parent directory reports the others
+        if (strcmp (dirPath, watcher->rootPath) == 0)
+        {
+            result = ARSAL_Watcher_AddChange (watcher, dirPath, ARSAL_WATCHER_EVENT_REMOVED, ARSAL_FTW_D);
+        }
+        // No else --> Reported by the parent
+        return result;
+    }
+    // No else --> Change of an entry of the directory
+
+    if (ev->len == 0)
+    {
+        return ARSAL_OK;
+    }
+    // No else --> Named entry
+
+    dirPathLen = strlen (dirPath);
+    nameLen = strlen (ev->name);
+    if (ARSAL_Watcher_EnsurePath (watcher, dirPathLen + nameLen + 2) != 0)
+    {
+        return ARSAL_ERROR_ALLOC;
+    }
+    // No else --> Path buffer is large enough
+    memcpy (watcher->path, dirPath, dirPathLen);
+    watcher->path[dirPathLen] = '/';
+    memcpy (&watcher->path[dirPathLen + 1], ev->name, nameLen + 1);
+
+    if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+    {
+        result = ARSAL_Watcher_AddChange (watcher, watcher->path, ARSAL_WATCHER_EVENT_ADDED, type);
+        if ((result == ARSAL_OK) && (type == ARSAL_FTW_D))
+        {
+            // Entries may have been created before the watch
+            result = ARSAL_Watcher_WatchTree (watcher, watcher->path, 1);
+        }
+        // No else --> Not a directory
+    }
+    else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+    {
+        result = ARSAL_Watcher_AddChange (watcher, watcher->path, ARSAL_WATCHER_EVENT_REMOVED, type);
+        if ((result == ARSAL_OK) && (type == ARSAL_FTW_D) && (ev->mask & IN_MOVED_FROM))
+        {
+            // Its watches still exist, with paths out of the hierarchy
+            ARSAL_Watcher_RemoveSubtree (watcher, watcher->path);
+        }
+        // No else --> The watches of a deleted directory are removed by the kernel
+    }
+    else if (ev->mask & IN_CLOSE_WRITE)
+    {
+        result = ARSAL_Watcher_AddChange (watcher, watcher->path, ARSAL_WATCHER_EVENT_MODIFIED, type);
+    }
+    // No else --> Not watched
+
+    return result;
+}
+
+/**
+ * Read the pending inotify events in a new batch
+ */
+static eARSAL_ERROR ARSAL_Watcher_ReadBatch (ARSAL_Watcher_t *watcher)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    const struct inotify_event *ev;
+    ssize_t readSize = 0;
+    ssize_t offset;
+    int reads;
+
+    watcher->changeCount = 0;
+    watcher->changePos = 0;
+    watcher->poolSize = 0;
+    memset (watcher->hash, 0, watcher->hashCapacity * sizeof (int));
+
+    for (reads = 0; (result == ARSAL_OK) && (reads < ARSAL_WATCHER_MAX_READS); reads++)
+    {
+        readSize = read (watcher->fd, watcher->buffer, ARSAL_WATCHER_BUFFER_SIZE);
+        if (readSize <= 0)
+        {
+            if ((readSize < 0) && (errno != EAGAIN) && (errno != EINTR))
+            {
+                ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_WATCHER_TAG, "read error : %s", strerror (errno));
+                result = ARSAL_ERROR_SYSTEM;
+            }
+            // No else --> Nothing more to read
+            break;
+        }
+        // No else --> Got events
+
+        for (offset = 0; (result == ARSAL_OK) && (offset < readSize); offset += sizeof (struct inotify_event) + ev->len)
+        {
+            ev = (const struct inotify_event *)&watcher->buffer[offset];
+            result = ARSAL_Watcher_HandleEvent (watcher, ev);
+        }
+    }
+
+    return result;
+}
+
+ARSAL_Watcher_t* ARSAL_Watcher_New(const char *dirPath, eARSAL_ERROR *error)
+{
+    ARSAL_Watcher_t *watcher = NULL;
+    eARSAL_ERROR result = ARSAL_OK;
+
+    ARSAL_PRINT (ARSAL_PRINT_DEBUG, ARSAL_WATCHER_TAG, "%s", dirPath ? dirPath : "null");
+
+    if (dirPath == NULL)
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if (result == ARSAL_OK)
+    {
+        watcher = calloc (1, sizeof (ARSAL_Watcher_t));
+        if (watcher == NULL)
+        {
+            result = ARSAL_ERROR_ALLOC;
+        }
+        else
+        {
+            watcher->fd = -1;
+            watcher->rootPath = strdup (dirPath);
+            watcher->changeCapacity = 64;
+            watcher->changes = malloc (watcher->changeCapacity * sizeof (ARSAL_Watcher_Change_t));
+            watcher->buffer = malloc (ARSAL_WATCHER_BUFFER_SIZE);
+            if ((watcher->rootPath == NULL) || (watcher->changes == NULL) || (watcher->buffer == NULL) ||
+                (ARSAL_Watcher_RebuildHash (watcher, watcher->changeCapacity * 2) != ARSAL_OK))
+            {
+                result = ARSAL_ERROR_ALLOC;
+            }
+            // No else --> Allocated
+        }
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        watcher->fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+        if (watcher->fd < 0)
+        {
+            ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_WATCHER_TAG, "inotify_init1 error : %s", strerror (errno));
+            result = ARSAL_ERROR_SYSTEM;
+        }
+        // No else --> Created
+    }
+    // No else --> Processing block
+
+    if (result == ARSAL_OK)
+    {
+        result = ARSAL_Watcher_WatchTree (watcher, dirPath, 0);
+    }
+    // No else --> Processing block
+
+    if ((result == ARSAL_OK) && (watcher->watchCount == 0))
+    {
+        ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_WATCHER_TAG, "%s is not a directory", dirPath);
+        result = ARSAL_ERROR_FILE;
+    }
+    // No else --> Watching
+
+    if (result != ARSAL_OK)
+    {
+        ARSAL_Watcher_Delete (&watcher);
+    }
+    // No else --> Keep the watcher
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return watcher;
+}
+
+void ARSAL_Watcher_Delete(ARSAL_Watcher_t **watcherAddr)
+{
+    ARSAL_Watcher_t *watcher;
+    int i;
+
+    if ((watcherAddr != NULL) && (*watcherAddr != NULL))
+    {
+        watcher = *watcherAddr;
+
+        if (watcher->fd >= 0)
+        {
+            // Closing the descriptor removes all the watches
+            close (watcher->fd);
+        }
+        // No else --> Not created
+        for (i = 0; i < watcher->watchCount; i++)
+        {
+            free (watcher->watches[i].path);
+        }
+        free (watcher->watches);
+        free (watcher->changes);
+        free (watcher->hash);
+        free (watcher->pool);
+        free (watcher->path);
+        free (watcher->buffer);
+        free (watcher->rootPath);
+        free (watcher);
+
+        *watcherAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+int ARSAL_Watcher_GetFd(const ARSAL_Watcher_t *watcher)
+{
+    return (watcher != NULL) ? watcher->fd : -1;
+}
+
+int ARSAL_Watcher_ReadEvents(ARSAL_Watcher_t *watcher, ARSAL_Watcher_Event_t *events, int maxEvents, eARSAL_ERROR *error)
+{
+    eARSAL_ERROR result = ARSAL_OK;
+    ARSAL_Watcher_Change_t *change;
+    int count = 0;
+
+    if ((watcher == NULL) || (events == NULL) || (maxEvents <= 0))
+    {
+        result = ARSAL_ERROR_BAD_PARAMETER;
+    }
+    // No else --> Args check
+
+    if ((result == ARSAL_OK) && (watcher->changePos >= watcher->changeCount) && (!watcher->overflow))
+    {
+        // The previous batch is delivered, its paths are no longer used
+        result = ARSAL_Watcher_ReadBatch (watcher);
+    }
+    // No else --> Deliver the rest of the batch
+
+    if ((result == ARSAL_OK) && (watcher->overflow))
+    {
+        events[count].path = watcher->rootPath;
+        events[count].event = ARSAL_WATCHER_EVENT_OVERFLOW;
+        events[count].type = ARSAL_FTW_D;
+        count++;
+        watcher->overflow = 0;
+    }
+    // No else --> No event lost
+
+    while ((result == ARSAL_OK) && (count < maxEvents) && (watcher->changePos < watcher->changeCount))
+    {
+        change = &watcher->changes[watcher->changePos++];
+        if (change->event != ARSAL_WATCHER_DROPPED)
+        {
+            events[count].path = &watcher->pool[change->path];
+            events[count].event = change->event;
+            events[count].type = change->type;
+            count++;
+        }
+        // No else --> Cancelled change
+    }
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+    // No else --> Error is not returned
+
+    return count;
+}
+
+#else
+
+struct _ARSAL_Watcher_t
+{
+    int fd;
+};
+
+ARSAL_Watcher_t* ARSAL_Watcher_New(const char *dirPath, eARSAL_ERROR *error)
+{
+    (void)dirPath;
+
+    ARSAL_PRINT (ARSAL_PRINT_ERROR, ARSAL_WATCHER_TAG, "Not supported on this platform");
+
+    if (error != NULL)
+    {
+        *error = ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Error is not returned
+
+    return NULL;
+}
+
+void ARSAL_Watcher_Delete(ARSAL_Watcher_t **watcherAddr)
+{
+    if ((watcherAddr != NULL) && (*watcherAddr != NULL))
+    {
+        free (*watcherAddr);
+        *watcherAddr = NULL;
+    }
+    // No else --> Nothing to delete
+}
+
+int ARSAL_Watcher_GetFd(const ARSAL_Watcher_t *watcher)
+{
+    (void)watcher;
+
+    return -1;
+}
+
+int ARSAL_Watcher_ReadEvents(ARSAL_Watcher_t *watcher, ARSAL_Watcher_Event_t *events, int maxEvents, eARSAL_ERROR *error)
+{
+    (void)watcher;
+    (void)events;
+    (void)maxEvents;
+
+    if (error != NULL)
+    {
+        *error = ARSAL_ERROR_SYSTEM;
+    }
+    // No else --> Error is not returned
+
+    return 0;
+}
+
+#endif /* HAVE_SYS_INOTIFY_H */
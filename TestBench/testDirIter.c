@@ -0,0 +1,277 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testDirIter.c
+ * @brief Checks the visit order of ARSAL_DirIter, ARSAL_DirIter_SkipSubtree () and the unreadable entries on a small tree.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_DirIter.h>
+
+#define TAG "testDirIter"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* Directories end with a '/' */
+static const char *const treeEntries[] =
+{
+    "a/", "a/a1", "a/a2", "b/", "b/b1", "b/c/", "b/c/c1", "d",
+};
+
+/* Sorted walk skipping the subtree of b, relative to the root */
+static const char *const expectedOrder[] =
+{
+    "", "/a", "/a/a1", "/a/a2", "/b", "/d",
+};
+
+/* Sorted walk with a and b not searchable, relative to the root */
+static const char *const unreadableOrder[] =
+{
+    "", "/a", "/b", "/b/b1", "/b/c", "/d",
+};
+
+static const eARSAL_FTW_TYPE unreadableTypes[] =
+{
+    ARSAL_FTW_D, ARSAL_FTW_DNR, ARSAL_FTW_D, ARSAL_FTW_NS, ARSAL_FTW_NS, ARSAL_FTW_F,
+};
+
+static int errCount = 0;
+
+static int createTree(const char *root)
+{
+    char path[256];
+    size_t len;
+    size_t i;
+    int fd;
+
+    for (i = 0; i < sizeof(treeEntries) / sizeof(treeEntries[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, treeEntries[i]);
+        len = strlen(path);
+        if (path[len - 1] == '/')
+        {
+            path[len - 1] = '\0';
+            if (mkdir(path, 0755) != 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+            if (fd < 0)
+            {
+                return -1;
+            }
+            close(fd);
+        }
+    }
+
+    return 0;
+}
+
+static void testSortedSkip(const char *root)
+{
+    const ARSAL_DirIter_Entry_t *entry;
+    ARSAL_DirIter_t *iter;
+    eARSAL_ERROR error;
+    size_t rootLen = strlen(root);
+    size_t count = 0;
+    size_t expectedCount = sizeof(expectedOrder) / sizeof(expectedOrder[0]);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "SORTED SKIP TEST ...\n");
+
+    iter = ARSAL_DirIter_New(root, 0, ARSAL_FTW_STAT_TYPE, &error);
+    TEST_CHECK(iter != NULL, "Unable to create the iterator: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK((iter == NULL) || (ARSAL_DirIter_SetSorted(iter, 1) == ARSAL_OK), "Unable to sort the walk\n");
+
+    while ((iter != NULL) && ((entry = ARSAL_DirIter_Next(iter, &error)) != NULL))
+    {
+        TEST_CHECK((count < expectedCount) && (strcmp(&entry->path[rootLen], expectedOrder[count]) == 0),
+                   "Entry %zu is \"%s\", expected \"%s\"\n", count, &entry->path[rootLen], (count < expectedCount) ? expectedOrder[count] : "(end)");
+        if (strcmp(&entry->path[rootLen], "/b") == 0)
+        {
+            TEST_CHECK(entry->type == ARSAL_FTW_D, "b is not reported as a directory\n");
+            TEST_CHECK(ARSAL_DirIter_SkipSubtree(iter) == ARSAL_OK, "Unable to skip the subtree of b\n");
+        }
+        count++;
+    }
+
+    TEST_CHECK(error == ARSAL_OK, "Walk error: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(count == expectedCount, "Got %zu entries, expected %zu\n", count, expectedCount);
+    ARSAL_DirIter_Delete(&iter);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testUnsortedSkip(const char *root)
+{
+    const ARSAL_DirIter_Entry_t *entry;
+    ARSAL_DirIter_t *iter;
+    eARSAL_ERROR error;
+    size_t rootLen = strlen(root);
+    const char *name;
+    char parent[256] = "";
+    int count = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "UNSORTED SKIP TEST ...\n");
+
+    iter = ARSAL_DirIter_New(root, 0, ARSAL_FTW_STAT_TYPE, &error);
+    TEST_CHECK(iter != NULL, "Unable to create the iterator: %s\n", ARSAL_Error_ToString(error));
+
+    while ((iter != NULL) && ((entry = ARSAL_DirIter_Next(iter, &error)) != NULL))
+    {
+        name = &entry->path[rootLen];
+        TEST_CHECK(strncmp(name, "/b/", 3) != 0, "\"%s\" is under the skipped directory\n", name);
+
+        /* Each entry follows its directory, before any sibling of it */
+        if (entry->level >= 2)
+        {
+            TEST_CHECK(strncmp(name, parent, strlen(parent)) == 0, "\"%s\" does not follow its directory \"%s\"\n", name, parent);
+        }
+        else
+        {
+            /* A file has no entry, none can follow it */
+            snprintf(parent, sizeof(parent), "%s/", name);
+        }
+
+        if (strcmp(name, "/b") == 0)
+        {
+            ARSAL_DirIter_SkipSubtree(iter);
+        }
+        count++;
+    }
+
+    TEST_CHECK(error == ARSAL_OK, "Walk error: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(count == 6, "Got %d entries, expected 6\n", count);
+    ARSAL_DirIter_Delete(&iter);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testUnreadable(const char *root)
+{
+    const ARSAL_DirIter_Entry_t *entry;
+    ARSAL_DirIter_t *iter;
+    eARSAL_ERROR error;
+    size_t rootLen = strlen(root);
+    size_t count = 0;
+    size_t expectedCount = sizeof(unreadableOrder) / sizeof(unreadableOrder[0]);
+    char pathA[256];
+    char pathB[256];
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "UNREADABLE TEST ...\n");
+
+    if (geteuid() == 0)
+    {
+        /* The permissions are not checked for root */
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "Run as root, skipped\n");
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+        return;
+    }
+
+    /* a cannot be opened, the entries of b can be listed but not stated */
+    snprintf(pathA, sizeof(pathA), "%s/a", root);
+    snprintf(pathB, sizeof(pathB), "%s/b", root);
+    chmod(pathA, 0);
+    chmod(pathB, 0644);
+
+    iter = ARSAL_DirIter_New(root, 0, ARSAL_FTW_STAT_SIZE, &error);
+    TEST_CHECK(iter != NULL, "Unable to create the iterator: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK((iter == NULL) || (ARSAL_DirIter_SetSorted(iter, 1) == ARSAL_OK), "Unable to sort the walk\n");
+
+    while ((iter != NULL) && ((entry = ARSAL_DirIter_Next(iter, &error)) != NULL))
+    {
+        TEST_CHECK((count < expectedCount) && (strcmp(&entry->path[rootLen], unreadableOrder[count]) == 0),
+                   "Entry %zu is \"%s\", expected \"%s\"\n", count, &entry->path[rootLen], (count < expectedCount) ? unreadableOrder[count] : "(end)");
+        TEST_CHECK((count >= expectedCount) || (entry->type == unreadableTypes[count]),
+                   "Entry \"%s\" has type %d, expected %d\n", &entry->path[rootLen], (int)entry->type, (count < expectedCount) ? (int)unreadableTypes[count] : -1);
+        TEST_CHECK((entry->type != ARSAL_FTW_NS) || (entry->sb.st_mode == 0), "Entry \"%s\" is not stated but has a mode\n", &entry->path[rootLen]);
+        count++;
+    }
+
+    TEST_CHECK(error == ARSAL_OK, "Walk error: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(count == expectedCount, "Got %zu entries, expected %zu\n", count, expectedCount);
+    ARSAL_DirIter_Delete(&iter);
+
+    chmod(pathA, 0755);
+    chmod(pathB, 0755);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char root[] = "/tmp/testDirIter.XXXXXX";
+
+    (void)argc;
+    (void)argv;
+
+    if ((mkdtemp(root) == NULL) || (createTree(root) != 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to create the test tree, aborting tests\n");
+        return 1;
+    }
+
+    testSortedSkip(root);
+    testUnsortedSkip(root);
+    testUnreadable(root);
+
+    ARSAL_Ftw_RemoveTree(root, 1, NULL, NULL);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
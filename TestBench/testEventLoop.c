@@ -0,0 +1,232 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testEventLoop.c
+ * @brief Checks that ARSAL_EventLoop runs the functions posted from another thread in order, and stops on request.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_EventLoop.h>
+
+#define TAG "testEventLoop"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define TEST_POST_COUNT (1000)
+#define TEST_STOP_DELAY_MS (50)
+
+typedef struct
+{
+    ARSAL_EventLoop_t *loop;
+    int indexes[TEST_POST_COUNT];
+    int runCount;
+    int stopCount;
+} testState_t;
+
+typedef struct
+{
+    testState_t *state;
+    int index;
+} testPost_t;
+
+static int errCount = 0;
+
+static void postCallback(ARSAL_EventLoop_t *loop, void *customData)
+{
+    testPost_t *post = (testPost_t *)customData;
+    testState_t *state = post->state;
+
+    (void)loop;
+    if (state->runCount < TEST_POST_COUNT)
+    {
+        state->indexes[state->runCount] = post->index;
+    }
+    state->runCount++;
+}
+
+static void stopCallback(ARSAL_EventLoop_t *loop, void *customData)
+{
+    testState_t *state = (testState_t *)customData;
+
+    state->stopCount++;
+    ARSAL_EventLoop_Stop(loop);
+}
+
+static void *postThread(void *arg)
+{
+    testPost_t *posts = (testPost_t *)arg;
+    testState_t *state = posts[0].state;
+    eARSAL_ERROR error;
+    int i;
+
+    for (i = 0; i < TEST_POST_COUNT; i++)
+    {
+        error = ARSAL_EventLoop_Post(state->loop, postCallback, &posts[i]);
+        TEST_CHECK(error == ARSAL_OK, "Unable to post the function %d: %s\n", i, ARSAL_Error_ToString(error));
+    }
+    error = ARSAL_EventLoop_Post(state->loop, stopCallback, state);
+    TEST_CHECK(error == ARSAL_OK, "Unable to post the stop: %s\n", ARSAL_Error_ToString(error));
+
+    return NULL;
+}
+
+static void *stopThread(void *arg)
+{
+    ARSAL_EventLoop_t *loop = (ARSAL_EventLoop_t *)arg;
+
+    usleep(TEST_STOP_DELAY_MS * 1000);
+    TEST_CHECK(ARSAL_EventLoop_Stop(loop) == ARSAL_OK, "Unable to stop the loop\n");
+
+    return NULL;
+}
+
+static void testPostOrder(ARSAL_EventLoop_t *loop)
+{
+    testPost_t *posts;
+    testState_t *state;
+    ARSAL_Thread_t thread = NULL;
+    eARSAL_ERROR error;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "POST ORDER TEST ...\n");
+
+    state = calloc(1, sizeof(*state));
+    posts = calloc(TEST_POST_COUNT, sizeof(*posts));
+    if ((state == NULL) || (posts == NULL))
+    {
+        TEST_CHECK(0, "Unable to allocate the posts\n");
+        free(state);
+        free(posts);
+        return;
+    }
+    state->loop = loop;
+    for (i = 0; i < TEST_POST_COUNT; i++)
+    {
+        posts[i].state = state;
+        posts[i].index = i;
+    }
+
+    TEST_CHECK(ARSAL_Thread_Create(&thread, postThread, posts) == 0, "Unable to create the posting thread\n");
+    if (thread != NULL)
+    {
+        error = ARSAL_EventLoop_Run(loop);
+        TEST_CHECK(error == ARSAL_OK, "The loop failed: %s\n", ARSAL_Error_ToString(error));
+        ARSAL_Thread_Join(thread, NULL);
+        ARSAL_Thread_Destroy(&thread);
+
+        TEST_CHECK(state->runCount == TEST_POST_COUNT, "%d functions run, expected %d\n", state->runCount, TEST_POST_COUNT);
+        TEST_CHECK(state->stopCount == 1, "The stop ran %d times\n", state->stopCount);
+        for (i = 0; (i < state->runCount) && (i < TEST_POST_COUNT); i++)
+        {
+            if (state->indexes[i] != i)
+            {
+                TEST_CHECK(0, "The function %d ran at the position %d\n", state->indexes[i], i);
+                break;
+            }
+        }
+    }
+
+    free(posts);
+    free(state);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testStop(ARSAL_EventLoop_t *loop)
+{
+    ARSAL_Thread_t thread = NULL;
+    struct timespec start;
+    struct timespec end;
+    eARSAL_ERROR error;
+    int elapsedMs;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "STOP TEST ...\n");
+
+    ARSAL_Time_GetTime(&start);
+    TEST_CHECK(ARSAL_Thread_Create(&thread, stopThread, loop) == 0, "Unable to create the stopping thread\n");
+    if (thread != NULL)
+    {
+        error = ARSAL_EventLoop_Run(loop);
+        ARSAL_Time_GetTime(&end);
+        elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&start, &end);
+        TEST_CHECK(error == ARSAL_OK, "The loop failed: %s\n", ARSAL_Error_ToString(error));
+        TEST_CHECK(elapsedMs >= TEST_STOP_DELAY_MS - 1, "The loop returned after %d ms, before the stop\n", elapsedMs);
+        ARSAL_Thread_Join(thread, NULL);
+        ARSAL_Thread_Destroy(&thread);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    ARSAL_EventLoop_t *loop;
+    eARSAL_ERROR error;
+
+    (void)argc;
+    (void)argv;
+
+    loop = ARSAL_EventLoop_New(&error);
+    TEST_CHECK(loop != NULL, "Unable to create the loop: %s\n", ARSAL_Error_ToString(error));
+    if (loop != NULL)
+    {
+        testPostOrder(loop);
+        testStop(loop);
+        ARSAL_EventLoop_Delete(&loop);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
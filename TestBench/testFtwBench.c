@@ -0,0 +1,485 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testFtwBench.c
+ * @brief Directory traversal benchmark on a synthetic tree, JSON output on stdout.
+ *
+ * Usage: testFtwBench [-d workDir] [-f fanOut] [-l depth] [-n filesPerDir] [-s symlinksPerDir] [-z fileSize] [-k]
+ *
+ * - generates a tree of depth levels of fanOut subdirectories under workDir (use a tmpfs or a local file system),
+ *   each directory holding filesPerDir files of fileSize bytes and symlinksPerDir symbolic links to its first file
+ * - walks it with each walker: native or internal nftw, stat-mask, sorted, iterator, parallel and disk usage
+ * - reports entries per second with a warm cache and with a cold one (root only, null otherwise),
+ *   and the number of system calls per entry (Linux, counted with ptrace, null when not allowed)
+ * - removes the tree unless -k is given
+ *
+ * The exit code is the number of walkers which did not see every entry of the tree.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/ptrace.h>
+#endif
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_DirIter.h>
+
+#define BENCH_MIN_DURATION_MS   (200)
+#define BENCH_MAX_OPEN_DIRS     (32)
+
+typedef int (*walkFunction_t)(const char *root);
+
+typedef struct
+{
+    const char *name;
+    walkFunction_t walk;
+} walker_t;
+
+static uint64_t entryCount;
+
+static double elapsedSeconds(const struct timespec *start)
+{
+    struct timespec now;
+
+    ARSAL_Time_GetTime(&now);
+    return (double)(now.tv_sec - start->tv_sec) + ((double)(now.tv_nsec - start->tv_nsec) / 1e9);
+}
+
+static void printRate(const char *key, double rate, const char *separator)
+{
+    if (rate >= 0.)
+    {
+        printf("\"%s\": %.0f%s", key, rate, separator);
+    }
+    else
+    {
+        printf("\"%s\": null%s", key, separator);
+    }
+}
+
+/*
+ * Tree generation
+ */
+
+static int writeFile(const char *path, size_t size)
+{
+    static const char data[4096];
+    size_t count;
+    int ret = -1;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd >= 0)
+    {
+        ret = 0;
+        while ((ret == 0) && (size > 0))
+        {
+            count = (size < sizeof(data)) ? size : sizeof(data);
+            ret = (write(fd, data, count) == (ssize_t)count) ? 0 : -1;
+            size -= count;
+        }
+        close(fd);
+    }
+
+    return ret;
+}
+
+static int generateDir(char *path, size_t pathLen, int level, int fanOut, int depth, int fileCount, int symlinkCount, size_t fileSize, uint64_t *entries)
+{
+    int ret = 0;
+    int i;
+
+    if (mkdir(path, 0755) != 0)
+    {
+        return -1;
+    }
+    (*entries)++;
+
+    for (i = 0; (ret == 0) && (i < fileCount); i++)
+    {
+        snprintf(&path[pathLen], 512 - pathLen, "/file_%d", i);
+        ret = writeFile(path, fileSize);
+        (*entries)++;
+    }
+
+    for (i = 0; (ret == 0) && (i < symlinkCount); i++)
+    {
+        /* Links to a file only, so that the walkers following them do not see more entries */
+        snprintf(&path[pathLen], 512 - pathLen, "/link_%d", i);
+        ret = symlink((fileCount > 0) ? "file_0" : "missing", path);
+        (*entries)++;
+    }
+
+    for (i = 0; (ret == 0) && (level < depth) && (i < fanOut); i++)
+    {
+        snprintf(&path[pathLen], 512 - pathLen, "/dir_%d", i);
+        ret = generateDir(path, strlen(path), level + 1, fanOut, depth, fileCount, symlinkCount, fileSize, entries);
+    }
+
+    path[pathLen] = '\0';
+
+    return ret;
+}
+
+static int dropCaches(void)
+{
+    int ret = -1;
+    int fd;
+
+    sync();
+    fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+    if (fd >= 0)
+    {
+        /* Page cache, dentries and inodes */
+        ret = (write(fd, "3", 1) == 1) ? 0 : -1;
+        close(fd);
+    }
+
+    return ret;
+}
+
+/*
+ * Walkers, each one counts the entries in entryCount
+ */
+
+static int ftwCallback(const char *fpath, const struct stat *sb, eARSAL_FTW_TYPE typeflag)
+{
+    (void)fpath;
+    (void)sb;
+    (void)typeflag;
+    entryCount++;
+    return 0;
+}
+
+static int nftwCallback(const char *fpath, const struct stat *sb, eARSAL_FTW_TYPE typeflag, ARSAL_FTW_t *ftwbuf)
+{
+    (void)fpath;
+    (void)sb;
+    (void)typeflag;
+    (void)ftwbuf;
+    entryCount++;
+    return 0;
+}
+
+static int walkFtw(const char *root)
+{
+    return ARSAL_Ftw(root, ftwCallback, BENCH_MAX_OPEN_DIRS);
+}
+
+static int walkNftw(const char *root)
+{
+    return ARSAL_Nftw(root, nftwCallback, BENCH_MAX_OPEN_DIRS, ARSAL_FTW_NOFLAGS);
+}
+
+static int walkNftwInternal(const char *root)
+{
+    return ARSAL_Nftw_WithStatMask(root, nftwCallback, BENCH_MAX_OPEN_DIRS, ARSAL_FTW_NOFLAGS, ARSAL_FTW_STAT_ALL);
+}
+
+static int walkNftwStatType(const char *root)
+{
+    return ARSAL_Nftw_WithStatMask(root, nftwCallback, BENCH_MAX_OPEN_DIRS, ARSAL_FTW_NOFLAGS, ARSAL_FTW_STAT_TYPE);
+}
+
+static int walkNftwStatSize(const char *root)
+{
+    return ARSAL_Nftw_WithStatMask(root, nftwCallback, BENCH_MAX_OPEN_DIRS, ARSAL_FTW_NOFLAGS, ARSAL_FTW_STAT_SIZE);
+}
+
+static int walkNftwSorted(const char *root)
+{
+    return ARSAL_Nftw_Sorted(root, nftwCallback, BENCH_MAX_OPEN_DIRS, ARSAL_FTW_NOFLAGS);
+}
+
+static int walkNftwParallel(const char *root)
+{
+    /* Serial callbacks, the counter is not atomic */
+    return ARSAL_Nftw_Parallel(root, nftwCallback, 0, ARSAL_FTW_NOFLAGS, ARSAL_FTW_ORDER_SERIAL);
+}
+
+static int walkDirIter(const char *root)
+{
+    ARSAL_DirIter_t *iter;
+    eARSAL_ERROR error;
+
+    iter = ARSAL_DirIter_New(root, BENCH_MAX_OPEN_DIRS, ARSAL_FTW_STAT_TYPE, &error);
+    while ((iter != NULL) && (ARSAL_DirIter_Next(iter, &error) != NULL))
+    {
+        entryCount++;
+    }
+    ARSAL_DirIter_Delete(&iter);
+
+    return (error == ARSAL_OK) ? 0 : -1;
+}
+
+static int walkDiskUsage(const char *root)
+{
+    ARSAL_Ftw_Usage_t usage;
+    eARSAL_ERROR error;
+
+    error = ARSAL_Ftw_DiskUsage(root, 0, 0, NULL, NULL, NULL, &usage);
+    entryCount += usage.fileCount + usage.dirCount;
+
+    return (error == ARSAL_OK) ? 0 : -1;
+}
+
+static const walker_t walkers[] =
+{
+    { "ftw", walkFtw },
+    { "nftw", walkNftw },
+    { "nftw_internal", walkNftwInternal },
+    { "nftw_stat_type", walkNftwStatType },
+    { "nftw_stat_size", walkNftwStatSize },
+    { "nftw_sorted", walkNftwSorted },
+    { "nftw_parallel", walkNftwParallel },
+    { "diriter", walkDirIter },
+    { "disk_usage", walkDiskUsage },
+};
+
+/*
+ * Measures
+ */
+
+/* Returns the number of entries per second, or -1 on error */
+static double benchWarm(const walker_t *walker, const char *root)
+{
+    struct timespec start;
+    uint64_t total = 0;
+    double seconds;
+    int ret;
+
+    /* Warm the cache up */
+    ret = walker->walk(root);
+
+    ARSAL_Time_GetTime(&start);
+    do
+    {
+        entryCount = 0;
+        ret |= walker->walk(root);
+        total += entryCount;
+        seconds = elapsedSeconds(&start);
+    } while ((ret == 0) && (seconds * 1000. < BENCH_MIN_DURATION_MS));
+
+    return ((ret == 0) && (seconds > 0.)) ? (double)total / seconds : -1.;
+}
+
+static double benchCold(const walker_t *walker, const char *root)
+{
+    struct timespec start;
+    double seconds;
+    int ret;
+
+    if (dropCaches() != 0)
+    {
+        return -1.;
+    }
+
+    entryCount = 0;
+    ARSAL_Time_GetTime(&start);
+    ret = walker->walk(root);
+    seconds = elapsedSeconds(&start);
+
+    return ((ret == 0) && (seconds > 0.)) ? (double)entryCount / seconds : -1.;
+}
+
+/* Returns the number of system calls of a walk, from a traced child process, or -1 when it cannot be traced */
+static double countSyscalls(const walker_t *walker, const char *root)
+{
+#ifdef __linux__
+    uint64_t stops = 0;
+    pid_t pid;
+    pid_t tid;
+    int traced = 0;
+    int status;
+    int sig;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+        raise(SIGSTOP);
+        _exit((walker->walk(root) == 0) ? 0 : 1);
+    }
+    else if (pid < 0)
+    {
+        return -1.;
+    }
+
+    if ((waitpid(pid, &status, 0) == pid) && (WIFSTOPPED(status)) &&
+        (ptrace(PTRACE_SETOPTIONS, pid, NULL, (void *)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE)) == 0))
+    {
+        traced = 1;
+        ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+    }
+    else
+    {
+        kill(pid, SIGKILL);
+    }
+
+    /* Every thread stops on the entry and on the exit of each system call */
+    while ((tid = waitpid(-1, &status, __WALL)) > 0)
+    {
+        if (!WIFSTOPPED(status))
+        {
+            if ((tid == pid) && ((!WIFEXITED(status)) || (WEXITSTATUS(status) != 0)))
+            {
+                traced = 0;
+            }
+            continue;
+        }
+
+        sig = 0;
+        if (WSTOPSIG(status) == (SIGTRAP | 0x80))
+        {
+            stops++;
+        }
+        else if ((WSTOPSIG(status) != SIGTRAP) && (WSTOPSIG(status) != SIGSTOP))
+        {
+            /* Forward the real signals, drop the clone events and the initial stops of the threads */
+            sig = WSTOPSIG(status);
+        }
+        ptrace(PTRACE_SYSCALL, tid, NULL, (void *)(long)sig);
+    }
+
+    return (traced) ? (double)stops / 2. : -1.;
+#else
+    return -1.;
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    const char *workDir = "/tmp";
+    char root[512];
+    int fanOut = 8;
+    int depth = 3;
+    int fileCount = 32;
+    int symlinkCount = 2;
+    size_t fileSize = 0;
+    int keep = 0;
+    uint64_t expected = 0;
+    struct timespec start;
+    double syscalls;
+    size_t count = sizeof(walkers) / sizeof(walkers[0]);
+    size_t i;
+    int failed = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:f:l:n:s:z:k")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            workDir = optarg;
+            break;
+        case 'f':
+            fanOut = atoi(optarg);
+            break;
+        case 'l':
+            depth = atoi(optarg);
+            break;
+        case 'n':
+            fileCount = atoi(optarg);
+            break;
+        case 's':
+            symlinkCount = atoi(optarg);
+            break;
+        case 'z':
+            fileSize = strtoul(optarg, NULL, 0);
+            break;
+        case 'k':
+            keep = 1;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d workDir] [-f fanOut] [-l depth] [-n filesPerDir] [-s symlinksPerDir] [-z fileSize] [-k]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Keep stdout for the JSON report */
+    ARSAL_Print_SetMinimumLevel(ARSAL_PRINT_WARNING);
+
+    snprintf(root, sizeof(root), "%s/ftwbench_tree", workDir);
+    ARSAL_Ftw_RemoveTree(root, 0, NULL, NULL);
+
+    ARSAL_Time_GetTime(&start);
+    if (generateDir(root, strlen(root), 0, fanOut, depth, fileCount, symlinkCount, fileSize, &expected) != 0)
+    {
+        fprintf(stderr, "cannot generate the tree in %s: %s\n", root, strerror(errno));
+        ARSAL_Ftw_RemoveTree(root, 0, NULL, NULL);
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"tree\": { \"path\": \"%s\", \"fan_out\": %d, \"depth\": %d, \"files\": %d, \"symlinks\": %d, \"file_size\": %lu, \"entries\": %llu, \"generation_s\": %.3f },\n",
+           root, fanOut, depth, fileCount, symlinkCount, (unsigned long)fileSize, (unsigned long long)expected, elapsedSeconds(&start));
+
+    printf("  \"walkers\": [\n");
+    for (i = 0; i < count; i++)
+    {
+        entryCount = 0;
+        if ((walkers[i].walk(root) != 0) || (entryCount != expected))
+        {
+            failed++;
+        }
+        printf("    { \"walker\": \"%s\", \"entries\": %llu, ", walkers[i].name, (unsigned long long)entryCount);
+        printRate("warm_eps", benchWarm(&walkers[i], root), ", ");
+        printRate("cold_eps", benchCold(&walkers[i], root), ", ");
+
+        syscalls = countSyscalls(&walkers[i], root);
+        if ((syscalls >= 0.) && (expected > 0))
+        {
+            printf("\"syscalls_per_entry\": %.3f }%s\n", syscalls / (double)expected, (i + 1 < count) ? "," : "");
+        }
+        else
+        {
+            printf("\"syscalls_per_entry\": null }%s\n", (i + 1 < count) ? "," : "");
+        }
+    }
+    printf("  ]\n");
+    printf("}\n");
+
+    if (!keep)
+    {
+        ARSAL_Ftw_RemoveTree(root, 0, NULL, NULL);
+    }
+
+    return failed;
+}
@@ -0,0 +1,337 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testFtwParallel.c
+ * @brief Checks ARSAL_Nftw_Parallel () against ARSAL_Nftw () on a generated tree.
+ *
+ * The entries found must be the same in every order, and in the same order as ARSAL_Nftw () with ARSAL_FTW_ORDER_PREORDER,
+ * including when the callback skips subtrees or stops the walk.
+ * The tree holds more directories than the workers may read ahead, to also check the walk with a slow callback.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Ftw.h>
+
+#define TAG "testFtwParallel"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* 7 + 49 + 343 directories, 3 files in each directory of the last level and 1 in the others */
+#define TEST_TREE_FANOUT        (7)
+#define TEST_TREE_DEPTH         (3)
+#define TEST_TREE_LEAF_FILES    (3)
+#define TEST_MAX_ENTRIES        (4096)
+#define TEST_THREADS            (4)
+#define TEST_STOP_INDEX         (100)
+#define TEST_STOP_VALUE         (42)
+#define TEST_SLOW_CALLBACK_US   (50)
+
+typedef enum
+{
+    TEST_MODE_RECORD = 0,   /**< Record every entry */
+    TEST_MODE_SKIP,         /**< Skip the subtrees of the directories named d1 */
+    TEST_MODE_STOP,         /**< Stop at the TEST_STOP_INDEX-th entry */
+} eTEST_MODE;
+
+typedef struct
+{
+    char *paths[TEST_MAX_ENTRIES];
+    int count;
+} testRecord_t;
+
+static int errCount = 0;
+static ARSAL_Mutex_t recordMutex;
+static testRecord_t *currentRecord;
+static eTEST_MODE currentMode;
+static int currentRetVal;
+static int slowCallback;
+static size_t rootLen;
+
+static int createLevel(char *path, size_t len, int level)
+{
+    int retVal = 0;
+    int fileCount = (level == TEST_TREE_DEPTH) ? TEST_TREE_LEAF_FILES : 1;
+    int fd;
+    int i;
+
+    for (i = 0; (retVal == 0) && (i < fileCount); i++)
+    {
+        snprintf(&path[len], 32, "/f%d", i);
+        fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (fd < 0)
+        {
+            retVal = -1;
+        }
+        else
+        {
+            close(fd);
+        }
+    }
+
+    for (i = 0; (retVal == 0) && (level < TEST_TREE_DEPTH) && (i < TEST_TREE_FANOUT); i++)
+    {
+        snprintf(&path[len], 32, "/d%d", i);
+        if (mkdir(path, 0755) != 0)
+        {
+            retVal = -1;
+        }
+        else
+        {
+            retVal = createLevel(path, strlen(path), level + 1);
+        }
+    }
+    path[len] = '\0';
+
+    return retVal;
+}
+
+static void resetRecord(testRecord_t *record)
+{
+    int i;
+
+    for (i = 0; i < record->count; i++)
+    {
+        free(record->paths[i]);
+    }
+    record->count = 0;
+}
+
+static int recordCallback(const char *fpath, const struct stat *sb, eARSAL_FTW_TYPE typeflag, ARSAL_FTW_t *ftwbuf)
+{
+    testRecord_t *record = currentRecord;
+    const char *name = &fpath[rootLen];
+    const char *last = strrchr(fpath, '/');
+    int retVal = 0;
+    int index;
+
+    (void)sb;
+
+    TEST_CHECK((typeflag == ARSAL_FTW_D) || (typeflag == ARSAL_FTW_F), "\"%s\" is reported with the type %d\n", name, typeflag);
+    TEST_CHECK((last != NULL) && (ftwbuf->base == last + 1 - fpath), "\"%s\" is reported with the base %d\n", name, ftwbuf->base);
+
+    if (slowCallback)
+    {
+        usleep(TEST_SLOW_CALLBACK_US);
+    }
+
+    ARSAL_Mutex_Lock(&recordMutex);
+    index = record->count;
+    if (index < TEST_MAX_ENTRIES)
+    {
+        record->paths[index] = strdup(name);
+        record->count++;
+    }
+    ARSAL_Mutex_Unlock(&recordMutex);
+
+    if ((currentMode == TEST_MODE_SKIP) && (typeflag == ARSAL_FTW_D) && (strcmp(&fpath[ftwbuf->base], "d1") == 0))
+    {
+        retVal = ARSAL_FTW_SKIP_SUBTREE;
+    }
+    else if ((currentMode == TEST_MODE_STOP) && (index == TEST_STOP_INDEX - 1))
+    {
+        retVal = currentRetVal;
+    }
+    // No else --> Continue
+
+    return retVal;
+}
+
+static int comparePaths(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int walk(const char *root, int parallel, eARSAL_FTW_ORDER order, eARSAL_FTW_FLAG flags, testRecord_t *record)
+{
+    resetRecord(record);
+    currentRecord = record;
+
+    return parallel ? ARSAL_Nftw_Parallel(root, recordCallback, TEST_THREADS, flags, order) : ARSAL_Nftw(root, recordCallback, 16, flags);
+}
+
+static void compareRecords(const char *name, testRecord_t *reference, testRecord_t *record, int sorted)
+{
+    int i;
+
+    if (sorted)
+    {
+        qsort(reference->paths, reference->count, sizeof(reference->paths[0]), comparePaths);
+        qsort(record->paths, record->count, sizeof(record->paths[0]), comparePaths);
+    }
+
+    TEST_CHECK(record->count == reference->count, "%s: %d entries, expected %d\n", name, record->count, reference->count);
+    for (i = 0; (i < record->count) && (i < reference->count); i++)
+    {
+        if (strcmp(record->paths[i], reference->paths[i]) != 0)
+        {
+            TEST_CHECK(0, "%s: entry %d is \"%s\", expected \"%s\"\n", name, i, record->paths[i], reference->paths[i]);
+            break;
+        }
+    }
+}
+
+static void testWalks(const char *root, eTEST_MODE mode, eARSAL_FTW_FLAG flags, testRecord_t *reference, testRecord_t *record)
+{
+    static const char *const orderNames[] = { "NONE", "SERIAL" };
+    int expectedRet;
+    int retVal;
+    int order;
+
+    currentMode = mode;
+    expectedRet = walk(root, 0, ARSAL_FTW_ORDER_NONE, flags, reference);
+    TEST_CHECK(reference->count > 0, "ARSAL_Nftw found nothing\n");
+
+    /* In the same order, first with a fast callback, then with one slow enough to let the workers read as far ahead as they may */
+    for (slowCallback = 0; slowCallback <= 1; slowCallback++)
+    {
+        retVal = walk(root, 1, ARSAL_FTW_ORDER_PREORDER, flags, record);
+        TEST_CHECK(retVal == expectedRet, "PREORDER (slow %d): returned %d, expected %d\n", slowCallback, retVal, expectedRet);
+        compareRecords(slowCallback ? "Slow PREORDER" : "PREORDER", reference, record, 0);
+    }
+    slowCallback = 0;
+
+    /* The same entries in any order */
+    for (order = ARSAL_FTW_ORDER_NONE; order <= ARSAL_FTW_ORDER_SERIAL; order++)
+    {
+        retVal = walk(root, 1, order, flags, record);
+        TEST_CHECK(retVal == expectedRet, "%s: returned %d, expected %d\n", orderNames[order], retVal, expectedRet);
+        if (mode == TEST_MODE_STOP)
+        {
+            /* The other threads may find a few more entries before they see the stop */
+            TEST_CHECK((record->count >= reference->count) && (record->count < reference->count + TEST_THREADS * TEST_TREE_FANOUT * 2),
+                       "%s: %d entries found with the stop\n", orderNames[order], record->count);
+        }
+        else
+        {
+            compareRecords(orderNames[order], reference, record, 1);
+        }
+    }
+}
+
+static void testEntries(const char *root, testRecord_t *reference, testRecord_t *record)
+{
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "ENTRIES TEST ...\n");
+
+    testWalks(root, TEST_MODE_RECORD, ARSAL_FTW_NOFLAGS, reference, record);
+    TEST_CHECK(reference->count == 1 + (7 + 49 + 343) + (1 + 7 + 49) + (343 * TEST_TREE_LEAF_FILES), "ARSAL_Nftw found %d entries\n", reference->count);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testSkipSubtree(const char *root, testRecord_t *reference, testRecord_t *record)
+{
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "SKIP SUBTREE TEST ...\n");
+
+    testWalks(root, TEST_MODE_SKIP, ARSAL_FTW_ACTIONRETVAL, reference, record);
+    for (i = 0; i < record->count; i++)
+    {
+        TEST_CHECK(strstr(record->paths[i], "/d1/") == NULL, "\"%s\" is under a skipped directory\n", record->paths[i]);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testStop(const char *root, testRecord_t *reference, testRecord_t *record)
+{
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "STOP TEST ...\n");
+
+    /* ARSAL_FTW_STOP with ARSAL_FTW_ACTIONRETVAL, any other value without */
+    currentRetVal = ARSAL_FTW_STOP;
+    testWalks(root, TEST_MODE_STOP, ARSAL_FTW_ACTIONRETVAL, reference, record);
+    TEST_CHECK(reference->count == TEST_STOP_INDEX, "ARSAL_Nftw stopped after %d entries\n", reference->count);
+
+    currentRetVal = TEST_STOP_VALUE;
+    testWalks(root, TEST_MODE_STOP, ARSAL_FTW_NOFLAGS, reference, record);
+    TEST_CHECK(reference->count == TEST_STOP_INDEX, "ARSAL_Nftw stopped after %d entries\n", reference->count);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char root[256] = "/tmp/testFtwParallel.XXXXXX";
+    testRecord_t *reference;
+    testRecord_t *record;
+
+    (void)argc;
+    (void)argv;
+
+    reference = calloc(1, sizeof(testRecord_t));
+    record = calloc(1, sizeof(testRecord_t));
+    if ((reference == NULL) || (record == NULL) || (ARSAL_Mutex_Init(&recordMutex) != 0) ||
+        (mkdtemp(root) == NULL) || (createLevel(root, strlen(root), 0) != 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to create the test tree, aborting tests\n");
+        return 1;
+    }
+    rootLen = strlen(root);
+
+    testEntries(root, reference, record);
+    testSkipSubtree(root, reference, record);
+    testStop(root, reference, record);
+
+    resetRecord(reference);
+    resetRecord(record);
+    free(reference);
+    free(record);
+    ARSAL_Mutex_Destroy(&recordMutex);
+    ARSAL_Ftw_RemoveTree(root, 1, NULL, NULL);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
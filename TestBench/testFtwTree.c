@@ -0,0 +1,247 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testFtwTree.c
+ * @brief Checks ARSAL_Ftw_DiskUsage () and ARSAL_Ftw_RemoveTree () on a generated tree.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Ftw.h>
+
+#define TAG "testFtwTree"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* Each directory above the leaves holds TREE_FANOUT subdirectories and TREE_FILES files of FILE_SIZE bytes */
+#define TREE_FANOUT (4)
+#define TREE_DEPTH (3)
+#define TREE_FILES (5)
+#define FILE_SIZE (1000)
+#define THREAD_COUNT (4)
+
+typedef struct
+{
+    int count; /* Calls of the usage callback */
+    int topCount; /* Calls on the directories of level 1 */
+    uint64_t lastEntryCount;
+    uint64_t lastSize;
+    int progressCount;
+} Report_t;
+
+static int errCount = 0;
+
+static int createFile(const char *path)
+{
+    char content[FILE_SIZE];
+    int fd;
+    int ret = 0;
+
+    memset(content, 'x', sizeof(content));
+    fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (write(fd, content, sizeof(content)) != (ssize_t)sizeof(content))
+    {
+        ret = -1;
+    }
+    close(fd);
+
+    return ret;
+}
+
+/* Create the files and subdirectories of a directory, return the number of directories created or -1 */
+static int createTree(const char *path, int depth)
+{
+    char child[256];
+    int count = 0;
+    int ret;
+    int i;
+
+    for (i = 0; i < TREE_FILES; i++)
+    {
+        snprintf(child, sizeof(child), "%s/f%d", path, i);
+        if (createFile(child) != 0)
+        {
+            return -1;
+        }
+    }
+
+    for (i = 0; (depth > 0) && (i < TREE_FANOUT); i++)
+    {
+        snprintf(child, sizeof(child), "%s/d%d", path, i);
+        if (mkdir(child, 0755) != 0)
+        {
+            return -1;
+        }
+        ret = createTree(child, depth - 1);
+        if (ret < 0)
+        {
+            return -1;
+        }
+        count += ret + 1;
+    }
+
+    return count;
+}
+
+static void usageCallback(void *customData, const char *path, int level, const ARSAL_Ftw_Usage_t *usage)
+{
+    Report_t *report = (Report_t *)customData;
+    /* Directories of a subtree of depth TREE_DEPTH - 1 */
+    uint64_t dirCount = 1 + TREE_FANOUT + (TREE_FANOUT * TREE_FANOUT);
+
+    TEST_CHECK((level >= 0) && (level <= 1), "\"%s\" reported at level %d, deeper than asked\n", path, level);
+    if (level == 1)
+    {
+        TEST_CHECK((usage->dirCount == dirCount) && (usage->fileCount == dirCount * TREE_FILES) && (usage->size == dirCount * TREE_FILES * FILE_SIZE),
+                   "\"%s\": %" PRIu64 " directories, %" PRIu64 " files, %" PRIu64 " bytes\n", path, usage->dirCount, usage->fileCount, usage->size);
+        report->topCount++;
+    }
+    report->count++;
+}
+
+static void progressCallback(void *customData, uint64_t entryCount, uint64_t size)
+{
+    Report_t *report = (Report_t *)customData;
+
+    TEST_CHECK((entryCount >= report->lastEntryCount) && (size >= report->lastSize), "Progress went back\n");
+    report->lastEntryCount = entryCount;
+    report->lastSize = size;
+    report->progressCount++;
+}
+
+static void testDiskUsage(const char *root, int dirCount)
+{
+    ARSAL_Ftw_Usage_t usage;
+    Report_t report;
+    eARSAL_ERROR error;
+    uint64_t fileCount = (uint64_t)(dirCount + 1) * TREE_FILES;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "DISK USAGE TEST ...\n");
+
+    memset(&report, 0, sizeof(report));
+    memset(&usage, 0, sizeof(usage));
+    error = ARSAL_Ftw_DiskUsage(root, THREAD_COUNT, 1, usageCallback, progressCallback, &report, &usage);
+    TEST_CHECK(error == ARSAL_OK, "Disk usage error: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(usage.dirCount == (uint64_t)dirCount + 1, "Got %" PRIu64 " directories, expected %d\n", usage.dirCount, dirCount + 1);
+    TEST_CHECK(usage.fileCount == fileCount, "Got %" PRIu64 " files, expected %" PRIu64 "\n", usage.fileCount, fileCount);
+    TEST_CHECK(usage.size == fileCount * FILE_SIZE, "Got %" PRIu64 " bytes, expected %" PRIu64 "\n", usage.size, fileCount * FILE_SIZE);
+    TEST_CHECK(usage.diskSize >= usage.size, "Disk size %" PRIu64 " below the size\n", usage.diskSize);
+    TEST_CHECK(report.topCount == TREE_FANOUT, "Got %d reports at level 1, expected %d\n", report.topCount, TREE_FANOUT);
+    TEST_CHECK(report.count == TREE_FANOUT + 1, "Got %d reports, expected %d\n", report.count, TREE_FANOUT + 1);
+    TEST_CHECK((report.progressCount > 0) && (report.lastSize == usage.size), "Last progress at %" PRIu64 " bytes, expected %" PRIu64 "\n", report.lastSize, usage.size);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testRemoveTree(const char *root)
+{
+    char outside[] = "/tmp/testFtwTreeOut.XXXXXX";
+    char path[256];
+    char link[256];
+    struct stat sb;
+    Report_t report;
+    eARSAL_ERROR error;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "REMOVE TREE TEST ...\n");
+
+    /* A link to a directory out of the tree, which must not be followed */
+    TEST_CHECK(mkdtemp(outside) != NULL, "Unable to create the outside directory\n");
+    snprintf(path, sizeof(path), "%s/kept", outside);
+    TEST_CHECK(createFile(path) == 0, "Unable to create \"%s\"\n", path);
+    snprintf(link, sizeof(link), "%s/d0/link", root);
+    TEST_CHECK(symlink(outside, link) == 0, "Unable to create \"%s\"\n", link);
+
+    memset(&report, 0, sizeof(report));
+    error = ARSAL_Ftw_RemoveTree(root, THREAD_COUNT, progressCallback, &report);
+    TEST_CHECK(error == ARSAL_OK, "Remove error: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(lstat(root, &sb) != 0, "\"%s\" still exists\n", root);
+    TEST_CHECK(stat(path, &sb) == 0, "\"%s\" was removed through the link\n", path);
+    TEST_CHECK(report.progressCount > 0, "No progress reported\n");
+
+    /* A file alone */
+    error = ARSAL_Ftw_RemoveTree(path, THREAD_COUNT, NULL, NULL);
+    TEST_CHECK(error == ARSAL_OK, "Remove error on a file: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(lstat(path, &sb) != 0, "\"%s\" still exists\n", path);
+
+    error = ARSAL_Ftw_RemoveTree(outside, THREAD_COUNT, NULL, NULL);
+    TEST_CHECK((error == ARSAL_OK) && (lstat(outside, &sb) != 0), "Unable to remove \"%s\"\n", outside);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char root[] = "/tmp/testFtwTree.XXXXXX";
+    int dirCount = -1;
+
+    (void)argc;
+    (void)argv;
+
+    if ((mkdtemp(root) == NULL) || ((dirCount = createTree(root, TREE_DEPTH)) < 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to create the test tree, aborting tests\n");
+        return 1;
+    }
+
+    testDiskUsage(root, dirCount);
+    testRemoveTree(root);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,169 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testFuture.c
+ * @brief Checks that ARSAL_Future_WaitAny times out on pending futures, and returns the future completed by another thread.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_Future.h>
+
+#define TAG "testFuture"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define TEST_FUTURE_COUNT (4)
+#define TEST_COMPLETED_INDEX (2)
+#define TEST_TIMEOUT_MS (100)
+#define TEST_COMPLETION_DELAY_MS (50)
+/* Late wake up tolerated on a loaded machine */
+#define TEST_LATE_MARGIN_MS (150)
+
+static int errCount = 0;
+static int completionValue = 42;
+
+static void *completeThread(void *arg)
+{
+    ARSAL_Future_t *future = (ARSAL_Future_t *)arg;
+
+    usleep(TEST_COMPLETION_DELAY_MS * 1000);
+    ARSAL_Promise_SetValue(future, &completionValue);
+
+    return NULL;
+}
+
+static void testWaitAnyTimeout(ARSAL_Future_t **futures)
+{
+    struct timespec start;
+    struct timespec end;
+    eARSAL_ERROR error;
+    int elapsedMs;
+    int index = -1;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "WAIT ANY TIMEOUT TEST ...\n");
+
+    error = ARSAL_Future_WaitAny(futures, TEST_FUTURE_COUNT, 0, &index);
+    TEST_CHECK(error == ARSAL_ERROR_TIMEOUT, "The check of pending futures returned %s\n", ARSAL_Error_ToString(error));
+
+    ARSAL_Time_GetTime(&start);
+    error = ARSAL_Future_WaitAny(futures, TEST_FUTURE_COUNT, TEST_TIMEOUT_MS, &index);
+    ARSAL_Time_GetTime(&end);
+    elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&start, &end);
+    TEST_CHECK(error == ARSAL_ERROR_TIMEOUT, "The wait for pending futures returned %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(elapsedMs >= TEST_TIMEOUT_MS, "The wait timed out after %d ms, expected %d ms\n", elapsedMs, TEST_TIMEOUT_MS);
+    TEST_CHECK(elapsedMs <= TEST_TIMEOUT_MS + TEST_LATE_MARGIN_MS, "The wait timed out late, after %d ms\n", elapsedMs);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testWaitAnyCompletion(ARSAL_Future_t **futures)
+{
+    ARSAL_Thread_t thread = NULL;
+    struct timespec start;
+    struct timespec end;
+    eARSAL_ERROR error;
+    void *value = NULL;
+    int elapsedMs;
+    int index = -1;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "WAIT ANY COMPLETION TEST ...\n");
+
+    ARSAL_Time_GetTime(&start);
+    TEST_CHECK(ARSAL_Thread_Create(&thread, completeThread, futures[TEST_COMPLETED_INDEX]) == 0, "Unable to create the completing thread\n");
+    if (thread != NULL)
+    {
+        error = ARSAL_Future_WaitAny(futures, TEST_FUTURE_COUNT, TEST_COMPLETION_DELAY_MS + TEST_LATE_MARGIN_MS + 1000, &index);
+        ARSAL_Time_GetTime(&end);
+        elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&start, &end);
+        TEST_CHECK(error == ARSAL_OK, "The wait returned %s\n", ARSAL_Error_ToString(error));
+        TEST_CHECK(index == TEST_COMPLETED_INDEX, "The wait returned the future %d, expected %d\n", index, TEST_COMPLETED_INDEX);
+        TEST_CHECK(elapsedMs <= TEST_COMPLETION_DELAY_MS + TEST_LATE_MARGIN_MS, "The wait returned after %d ms\n", elapsedMs);
+
+        error = ARSAL_Future_Wait(futures[TEST_COMPLETED_INDEX], 0, &value);
+        TEST_CHECK((error == ARSAL_OK) && (value == &completionValue), "The completed future holds %s\n", ARSAL_Error_ToString(error));
+
+        /* Completed futures are returned without waiting, the first one when several are */
+        ARSAL_Promise_SetError(futures[TEST_FUTURE_COUNT - 1], ARSAL_ERROR_CANCELED);
+        error = ARSAL_Future_WaitAny(futures, TEST_FUTURE_COUNT, -1, &index);
+        TEST_CHECK((error == ARSAL_OK) && (index == TEST_COMPLETED_INDEX), "The wait for completed futures returned %s and the future %d\n", ARSAL_Error_ToString(error), index);
+
+        ARSAL_Thread_Join(thread, NULL);
+        ARSAL_Thread_Destroy(&thread);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    ARSAL_Future_t storage[TEST_FUTURE_COUNT];
+    ARSAL_Future_t *futures[TEST_FUTURE_COUNT];
+    int i;
+
+    (void)argc;
+    (void)argv;
+
+    for (i = 0; i < TEST_FUTURE_COUNT; i++)
+    {
+        ARSAL_Future_Init(&storage[i]);
+        futures[i] = &storage[i];
+    }
+
+    testWaitAnyTimeout(futures);
+    testWaitAnyCompletion(futures);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,450 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testMd5Bench.c
+ * @brief Hashing throughput benchmark, JSON output on stdout.
+ *
+ * Usage: testMd5Bench [-d workDir] [-m maxBufferSize] [-f fileSize] [-n batchFileCount] [-b batchFileSize]
+ *
+ * - checks the RFC 1321 test vectors against the buffer, incremental and file paths
+ * - hashes in-memory buffers from 64 B to maxBufferSize (1 GB by default)
+ * - hashes a file with each read mode of the engine, warm and cold cache
+ * - hashes a batch of files one by one and with ARSAL_MD5_Manager_ComputeBatch, cold cache
+ *
+ * The exit code is the number of failed test vectors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_MD5_Manager.h>
+
+#define BENCH_MIN_DURATION_MS   (200)
+#define BENCH_MIN_BUFFER_SIZE   (64)
+#define BENCH_TREE_CHUNK_SIZE   (4 * 1024 * 1024)
+
+typedef struct
+{
+    const char *message;
+    const char *md5Txt;
+} testVector_t;
+
+static const testVector_t testVectors[] =
+{
+    { "", "d41d8cd98f00b204e9800998ecf8427e" },
+    { "a", "0cc175b9c0f1b6a831c399e269772661" },
+    { "abc", "900150983cd24fb0d6963f7d28e17f72" },
+    { "message digest", "f96b697d7cb7938d525a2f31aaf161d0" },
+    { "abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b" },
+    { "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "d174ab98d277d9f5a5611c2c9f419d9f" },
+    { "12345678901234567890123456789012345678901234567890123456789012345678901234567890", "57edf4a22be3c955ac49da2e2107b67a" },
+};
+
+static double elapsedSeconds(const struct timespec *start)
+{
+    struct timespec now;
+
+    ARSAL_Time_GetTime(&now);
+    return (double)(now.tv_sec - start->tv_sec) + ((double)(now.tv_nsec - start->tv_nsec) / 1e9);
+}
+
+static double toMBps(uint64_t size, double seconds)
+{
+    return (seconds > 0.) ? ((double)size / (1024. * 1024.)) / seconds : 0.;
+}
+
+static void toTxt(const uint8_t *md5, char *md5Txt)
+{
+    int i;
+
+    for (i = 0; i < ARSAL_MD5_LENGTH; i++)
+    {
+        sprintf(&md5Txt[i * 2], "%02x", md5[i]);
+    }
+}
+
+static int writeFile(const char *path, const uint8_t *data, size_t size)
+{
+    int ret = -1;
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd >= 0)
+    {
+        ret = ((size == 0) || (write(fd, data, size) == (ssize_t)size)) ? 0 : -1;
+        /* Clean pages can be dropped from the page cache */
+        fsync(fd);
+        close(fd);
+    }
+
+    return ret;
+}
+
+static int writeRandomFile(const char *path, uint64_t size)
+{
+    uint8_t *block = malloc(1024 * 1024);
+    uint64_t written = 0;
+    size_t count;
+    int ret = 0;
+    int fd;
+    size_t i;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ((fd < 0) || (block == NULL))
+    {
+        ret = -1;
+    }
+
+    while ((ret == 0) && (written < size))
+    {
+        for (i = 0; i < 1024 * 1024; i++)
+        {
+            block[i] = (uint8_t)rand();
+        }
+        count = ((size - written) < 1024 * 1024) ? (size_t)(size - written) : 1024 * 1024;
+        ret = (write(fd, block, count) == (ssize_t)count) ? 0 : -1;
+        written += count;
+    }
+
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+    free(block);
+
+    return ret;
+}
+
+static void dropCache(const char *path)
+{
+#if defined(POSIX_FADV_DONTNEED)
+    int fd = open(path, O_RDONLY);
+
+    if (fd >= 0)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+#endif
+}
+
+static int checkVectors(ARSAL_MD5_Manager_t *manager, const char *workDir)
+{
+    int failed = 0;
+    char path[512];
+    char md5Txt[ARSAL_MD5_LENGTH * 2 + 1];
+    uint8_t md5[ARSAL_MD5_LENGTH];
+    ARSAL_MD5_Context_t *context;
+    size_t vector;
+    size_t len;
+    size_t i;
+
+    snprintf(path, sizeof(path), "%s/md5bench_vector", workDir);
+    context = ARSAL_MD5_Context_New(NULL);
+
+    printf("  \"vectors\": [\n");
+    for (vector = 0; vector < sizeof(testVectors) / sizeof(testVectors[0]); vector++)
+    {
+        const testVector_t *test = &testVectors[vector];
+        int bufferOk, incrementalOk, fileOk;
+
+        len = strlen(test->message);
+
+        ARSAL_MD5_ComputeBuffer((const uint8_t *)test->message, len, md5, sizeof(md5));
+        toTxt(md5, md5Txt);
+        bufferOk = (strcmp(md5Txt, test->md5Txt) == 0);
+
+        /* One byte at a time, to cross every block boundary */
+        for (i = 0; i < len; i++)
+        {
+            ARSAL_MD5_Context_Update(context, (const uint8_t *)&test->message[i], 1);
+        }
+        ARSAL_MD5_Context_Final(context, md5, sizeof(md5));
+        toTxt(md5, md5Txt);
+        incrementalOk = (strcmp(md5Txt, test->md5Txt) == 0);
+
+        fileOk = ((writeFile(path, (const uint8_t *)test->message, len) == 0) && (ARSAL_MD5_Manager_Check(manager, path, test->md5Txt) == ARSAL_OK));
+
+        failed += (!bufferOk) + (!incrementalOk) + (!fileOk);
+        printf("    { \"message\": \"%s\", \"buffer\": %s, \"incremental\": %s, \"file\": %s }%s\n", test->message,
+               bufferOk ? "true" : "false", incrementalOk ? "true" : "false", fileOk ? "true" : "false",
+               (vector + 1 < sizeof(testVectors) / sizeof(testVectors[0])) ? "," : "");
+    }
+    printf("  ],\n");
+
+    unlink(path);
+    ARSAL_MD5_Context_Delete(&context);
+
+    return failed;
+}
+
+static void benchMemory(uint64_t maxSize)
+{
+    uint8_t *buffer;
+    uint8_t md5[ARSAL_MD5_LENGTH];
+    struct timespec start;
+    uint64_t size;
+    uint64_t total;
+    double seconds;
+    size_t i;
+
+    /* Fall back to smaller maximum sizes on boards without that much memory */
+    do
+    {
+        buffer = malloc(maxSize);
+        if (buffer == NULL)
+        {
+            maxSize /= 4;
+        }
+    } while ((buffer == NULL) && (maxSize >= BENCH_MIN_BUFFER_SIZE));
+
+    for (i = 0; (buffer != NULL) && (i < maxSize); i++)
+    {
+        buffer[i] = (uint8_t)rand();
+    }
+
+    printf("  \"memory\": [\n");
+    for (size = BENCH_MIN_BUFFER_SIZE; (buffer != NULL) && (size <= maxSize); size *= 4)
+    {
+        total = 0;
+        ARSAL_Time_GetTime(&start);
+        do
+        {
+            ARSAL_MD5_ComputeBuffer(buffer, size, md5, sizeof(md5));
+            total += size;
+            seconds = elapsedSeconds(&start);
+        } while (seconds * 1000. < BENCH_MIN_DURATION_MS);
+
+        printf("    { \"size\": %llu, \"mbps\": %.1f }%s\n", (unsigned long long)size, toMBps(total, seconds), (size * 4 <= maxSize) ? "," : "");
+    }
+    printf("  ],\n");
+
+    free(buffer);
+}
+
+static double benchFile(ARSAL_MD5_Manager_t *manager, const char *path, uint64_t fileSize, const char *mode, int cold)
+{
+    ARSAL_MD5_Options_t options;
+    uint8_t md5[ARSAL_MD5_LENGTH];
+    struct timespec start;
+    eARSAL_ERROR error;
+    double seconds;
+
+    memset(&options, 0, sizeof(options));
+    options.bufferCount = ARSAL_MD5_DEFAULT_BUFFER_COUNT;
+    options.bufferSize = ARSAL_MD5_DEFAULT_BUFFER_SIZE;
+    options.ioMode = ARSAL_MD5_IO_MODE_BUFFERED;
+    options.directThreshold = ARSAL_MD5_DEFAULT_DIRECT_THRESHOLD;
+
+    if (strcmp(mode, "pipelined") == 0)
+    {
+        options.bufferCount = 4;
+        options.bufferSize = 1024 * 1024;
+    }
+    else if (strcmp(mode, "direct") == 0)
+    {
+        options.bufferCount = 4;
+        options.bufferSize = 1024 * 1024;
+        options.ioMode = ARSAL_MD5_IO_MODE_DIRECT;
+    }
+
+    if (cold)
+    {
+        dropCache(path);
+    }
+    else
+    {
+        /* Warm the cache up */
+        ARSAL_MD5_Manager_ComputeWithOptions(manager, path, &options, md5, sizeof(md5));
+    }
+
+    ARSAL_Time_GetTime(&start);
+    if (strcmp(mode, "tree") == 0)
+    {
+        error = ARSAL_MD5_Manager_ComputeTree(manager, path, BENCH_TREE_CHUNK_SIZE, 0, md5, sizeof(md5));
+    }
+    else
+    {
+        error = ARSAL_MD5_Manager_ComputeWithOptions(manager, path, &options, md5, sizeof(md5));
+    }
+    seconds = elapsedSeconds(&start);
+
+    return (error == ARSAL_OK) ? toMBps(fileSize, seconds) : -1.;
+}
+
+static void benchFiles(ARSAL_MD5_Manager_t *manager, const char *workDir, uint64_t fileSize)
+{
+    static const char *modes[] = { "sequential", "pipelined", "direct", "tree" };
+    char path[512];
+    size_t i;
+
+    snprintf(path, sizeof(path), "%s/md5bench_file", workDir);
+    if (writeRandomFile(path, fileSize) != 0)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+        return;
+    }
+
+    printf("  \"file\": { \"size\": %llu, \"modes\": [\n", (unsigned long long)fileSize);
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        printf("    { \"mode\": \"%s\", \"warm_mbps\": %.1f, \"cold_mbps\": %.1f }%s\n", modes[i],
+               benchFile(manager, path, fileSize, modes[i], 0), benchFile(manager, path, fileSize, modes[i], 1),
+               (i + 1 < sizeof(modes) / sizeof(modes[0])) ? "," : "");
+    }
+    printf("  ] },\n");
+
+    unlink(path);
+}
+
+static void benchBatch(ARSAL_MD5_Manager_t *manager, const char *workDir, int fileCount, uint64_t fileSize)
+{
+    char **paths = calloc(fileCount, sizeof(char *));
+    uint8_t *md5s = malloc(fileCount * ARSAL_MD5_LENGTH);
+    struct timespec start;
+    double oneByOne = -1.;
+    double batch = -1.;
+    eARSAL_ERROR error = ARSAL_OK;
+    int i;
+
+    for (i = 0; (paths != NULL) && (md5s != NULL) && (i < fileCount); i++)
+    {
+        paths[i] = malloc(512);
+        if ((paths[i] == NULL) || (snprintf(paths[i], 512, "%s/md5bench_batch_%d", workDir, i) < 0) || (writeRandomFile(paths[i], fileSize) != 0))
+        {
+            error = ARSAL_ERROR_FILE;
+            break;
+        }
+    }
+
+    if ((error == ARSAL_OK) && (paths != NULL) && (md5s != NULL))
+    {
+        for (i = 0; i < fileCount; i++)
+        {
+            dropCache(paths[i]);
+        }
+        ARSAL_Time_GetTime(&start);
+        for (i = 0; (error == ARSAL_OK) && (i < fileCount); i++)
+        {
+            error = ARSAL_MD5_Manager_Compute(manager, paths[i], &md5s[i * ARSAL_MD5_LENGTH], ARSAL_MD5_LENGTH);
+        }
+        oneByOne = (error == ARSAL_OK) ? toMBps(fileSize * fileCount, elapsedSeconds(&start)) : -1.;
+
+        for (i = 0; i < fileCount; i++)
+        {
+            dropCache(paths[i]);
+        }
+        ARSAL_Time_GetTime(&start);
+        error = ARSAL_MD5_Manager_ComputeBatch(manager, (const char * const *)paths, fileCount, 0, md5s, NULL);
+        batch = (error == ARSAL_OK) ? toMBps(fileSize * fileCount, elapsedSeconds(&start)) : -1.;
+    }
+
+    printf("  \"batch\": { \"files\": %d, \"size\": %llu, \"one_by_one_mbps\": %.1f, \"batch_mbps\": %.1f }\n",
+           fileCount, (unsigned long long)fileSize, oneByOne, batch);
+
+    for (i = 0; (paths != NULL) && (i < fileCount); i++)
+    {
+        if (paths[i] != NULL)
+        {
+            unlink(paths[i]);
+            free(paths[i]);
+        }
+    }
+    free(paths);
+    free(md5s);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *workDir = "/tmp";
+    uint64_t maxBufferSize = 1024 * 1024 * 1024;
+    uint64_t fileSize = 256 * 1024 * 1024;
+    uint64_t batchFileSize = 64 * 1024;
+    int batchFileCount = 1024;
+    ARSAL_MD5_Manager_t *manager;
+    eARSAL_ERROR error;
+    int failed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:m:f:n:b:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            workDir = optarg;
+            break;
+        case 'm':
+            maxBufferSize = strtoull(optarg, NULL, 0);
+            break;
+        case 'f':
+            fileSize = strtoull(optarg, NULL, 0);
+            break;
+        case 'n':
+            batchFileCount = atoi(optarg);
+            break;
+        case 'b':
+            batchFileSize = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d workDir] [-m maxBufferSize] [-f fileSize] [-n batchFileCount] [-b batchFileSize]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Keep stdout for the JSON report */
+    ARSAL_Print_SetMinimumLevel(ARSAL_PRINT_WARNING);
+
+    manager = ARSAL_MD5_Manager_New(&error);
+    if (error == ARSAL_OK)
+    {
+        error = ARSAL_MD5_Manager_Init(manager);
+    }
+    if (error != ARSAL_OK)
+    {
+        fprintf(stderr, "cannot create the md5 manager: %s\n", ARSAL_Error_ToString(error));
+        return 1;
+    }
+
+    printf("{\n");
+    failed = checkVectors(manager, workDir);
+    benchMemory(maxBufferSize);
+    benchFiles(manager, workDir, fileSize);
+    benchBatch(manager, workDir, batchFileCount, batchFileSize);
+    printf("}\n");
+
+    ARSAL_MD5_Manager_Close(manager);
+    ARSAL_MD5_Manager_Delete(&manager);
+
+    return failed;
+}
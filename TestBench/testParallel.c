@@ -0,0 +1,337 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testParallel.c
+ * @brief Checks the chunks run by ARSAL_Parallel_For () and the results of ARSAL_Parallel_Reduce ().
+ *
+ * The partial results of a reduction must be joined in the order of the indexes, whatever the scheduling.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Scheduler.h>
+#include <libARSAL/ARSAL_Parallel.h>
+
+#define TAG "testParallel"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define RANGE_SIZE (100000)
+#define RANGE_BEGIN (13)
+#define NESTED_SIZE (64)
+#define RUN_COUNT (5)
+
+typedef struct
+{
+    int *marks;
+    size_t grainSize;
+    int badChunks; /* Chunks larger than the grain */
+} Marks_t;
+
+/* Partial result checking the order of the joins: the indexes it covers must be contiguous */
+typedef struct
+{
+    size_t first;
+    size_t last;
+    int empty;
+    int ordered;
+} Span_t;
+
+static int errCount = 0;
+
+static void markBody(size_t begin, size_t end, void *customData)
+{
+    Marks_t *marks = (Marks_t *)customData;
+    size_t i;
+
+    if ((marks->grainSize != ARSAL_PARALLEL_AUTO_GRAIN) && (end - begin > marks->grainSize))
+    {
+        __atomic_fetch_add(&marks->badChunks, 1, __ATOMIC_RELAXED);
+    }
+    for (i = begin; i < end; i++)
+    {
+        marks->marks[i]++;
+    }
+}
+
+static void nestedBody(size_t begin, size_t end, void *customData)
+{
+    Marks_t *marks = (Marks_t *)customData;
+    Marks_t inner;
+    size_t i;
+
+    /* A loop run from a task of the scheduler */
+    for (i = begin; i < end; i++)
+    {
+        inner.marks = &marks->marks[i * NESTED_SIZE];
+        inner.grainSize = 4;
+        inner.badChunks = 0;
+        TEST_CHECK(ARSAL_Parallel_For(NULL, 0, NESTED_SIZE, inner.grainSize, markBody, &inner) == ARSAL_OK, "Nested loop %zu failed\n", i);
+        TEST_CHECK(inner.badChunks == 0, "Nested loop %zu has chunks larger than the grain\n", i);
+    }
+}
+
+static void sumBody(size_t begin, size_t end, void *partial, void *customData)
+{
+    uint64_t *sum = (uint64_t *)partial;
+    size_t i;
+
+    (void)customData;
+
+    for (i = begin; i < end; i++)
+    {
+        *sum += i;
+    }
+}
+
+static void sumJoin(void *partial, const void *other, void *customData)
+{
+    (void)customData;
+
+    *(uint64_t *)partial += *(const uint64_t *)other;
+}
+
+static void floatBody(size_t begin, size_t end, void *partial, void *customData)
+{
+    float *sum = (float *)partial;
+    size_t i;
+
+    (void)customData;
+
+    for (i = begin; i < end; i++)
+    {
+        *sum += 1.0f / (float)(i + 1);
+    }
+}
+
+static void floatJoin(void *partial, const void *other, void *customData)
+{
+    (void)customData;
+
+    *(float *)partial += *(const float *)other;
+}
+
+static void spanBody(size_t begin, size_t end, void *partial, void *customData)
+{
+    Span_t *span = (Span_t *)partial;
+
+    (void)customData;
+
+    if (begin < end)
+    {
+        span->ordered = span->ordered && (span->empty || (span->last + 1 == begin));
+        if (span->empty)
+        {
+            span->first = begin;
+        }
+        span->last = end - 1;
+        span->empty = 0;
+    }
+}
+
+static void spanJoin(void *partial, const void *other, void *customData)
+{
+    Span_t *span = (Span_t *)partial;
+    const Span_t *next = (const Span_t *)other;
+
+    (void)customData;
+
+    span->ordered = span->ordered && next->ordered;
+    if (!next->empty)
+    {
+        span->ordered = span->ordered && (span->empty || (span->last + 1 == next->first));
+        if (span->empty)
+        {
+            span->first = next->first;
+        }
+        span->last = next->last;
+        span->empty = 0;
+    }
+}
+
+static void testFor(ARSAL_Scheduler_t *scheduler)
+{
+    static const size_t grains[] = { ARSAL_PARALLEL_AUTO_GRAIN, 1, 7, 1000, 2 * RANGE_SIZE };
+    Marks_t marks;
+    int badCount;
+    size_t g;
+    size_t i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "FOR TEST ...\n");
+
+    marks.marks = calloc(RANGE_SIZE + RANGE_BEGIN + 1, sizeof(int));
+    TEST_CHECK(marks.marks != NULL, "Unable to allocate the marks\n");
+
+    for (g = 0; (marks.marks != NULL) && (g < sizeof(grains) / sizeof(grains[0])); g++)
+    {
+        memset(marks.marks, 0, (RANGE_SIZE + RANGE_BEGIN + 1) * sizeof(int));
+        marks.grainSize = grains[g];
+        marks.badChunks = 0;
+        TEST_CHECK(ARSAL_Parallel_For(scheduler, RANGE_BEGIN, RANGE_BEGIN + RANGE_SIZE, grains[g], markBody, &marks) == ARSAL_OK, "Loop failed with grain %zu\n", grains[g]);
+
+        /* Each index of the range once, none out of it */
+        badCount = 0;
+        for (i = 0; i < RANGE_SIZE + RANGE_BEGIN + 1; i++)
+        {
+            badCount += (marks.marks[i] != (((i >= RANGE_BEGIN) && (i < RANGE_BEGIN + RANGE_SIZE)) ? 1 : 0));
+        }
+        TEST_CHECK(badCount == 0, "%d indexes not run exactly as expected with grain %zu\n", badCount, grains[g]);
+        TEST_CHECK(marks.badChunks == 0, "%d chunks larger than the grain %zu\n", marks.badChunks, grains[g]);
+    }
+
+    /* Empty range and bad parameters */
+    TEST_CHECK(ARSAL_Parallel_For(scheduler, 5, 5, ARSAL_PARALLEL_AUTO_GRAIN, markBody, &marks) == ARSAL_OK, "Empty loop failed\n");
+    TEST_CHECK(ARSAL_Parallel_For(scheduler, 0, 10, ARSAL_PARALLEL_AUTO_GRAIN, NULL, NULL) == ARSAL_ERROR_BAD_PARAMETER, "Loop without body accepted\n");
+
+    free(marks.marks);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testNestedFor(void)
+{
+    Marks_t marks;
+    int badCount = 0;
+    size_t i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "NESTED FOR TEST ...\n");
+
+    marks.marks = calloc(NESTED_SIZE * NESTED_SIZE, sizeof(int));
+    marks.grainSize = 1;
+    marks.badChunks = 0;
+    TEST_CHECK(marks.marks != NULL, "Unable to allocate the marks\n");
+
+    if (marks.marks != NULL)
+    {
+        TEST_CHECK(ARSAL_Parallel_For(NULL, 0, NESTED_SIZE, 1, nestedBody, &marks) == ARSAL_OK, "Outer loop failed\n");
+        for (i = 0; i < NESTED_SIZE * NESTED_SIZE; i++)
+        {
+            badCount += (marks.marks[i] != 1);
+        }
+        TEST_CHECK(badCount == 0, "%d indexes not run exactly once\n", badCount);
+    }
+
+    free(marks.marks);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testReduce(ARSAL_Scheduler_t *scheduler)
+{
+    const uint64_t zero = 0;
+    const float zeroFloat = 0.0f;
+    const Span_t emptySpan = { 0, 0, 1, 1 };
+    uint64_t sum = 1;
+    uint64_t expected = ((uint64_t)(RANGE_BEGIN + RANGE_SIZE) * (RANGE_BEGIN + RANGE_SIZE - 1) - (uint64_t)RANGE_BEGIN * (RANGE_BEGIN - 1)) / 2;
+    float floatSum;
+    float firstFloatSum = 0.0f;
+    Span_t span;
+    int run;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "REDUCE TEST ...\n");
+
+    TEST_CHECK(ARSAL_Parallel_Reduce(scheduler, RANGE_BEGIN, RANGE_BEGIN + RANGE_SIZE, ARSAL_PARALLEL_AUTO_GRAIN, sizeof(sum), &zero, sumBody, sumJoin, NULL, &sum) == ARSAL_OK,
+               "Sum failed\n");
+    TEST_CHECK(sum == expected, "Sum is %" PRIu64 ", expected %" PRIu64 "\n", sum, expected);
+
+    /* The partial results are joined in the order of the indexes */
+    memcpy(&span, &emptySpan, sizeof(span));
+    TEST_CHECK(ARSAL_Parallel_Reduce(scheduler, RANGE_BEGIN, RANGE_BEGIN + RANGE_SIZE, 3, sizeof(span), &emptySpan, spanBody, spanJoin, NULL, &span) == ARSAL_OK,
+               "Span failed\n");
+    TEST_CHECK(span.ordered && (!span.empty) && (span.first == RANGE_BEGIN) && (span.last == RANGE_BEGIN + RANGE_SIZE - 1),
+               "Span [%zu, %zu] joined %s\n", span.first, span.last, span.ordered ? "in order" : "out of order");
+
+    /* So a floating-point sum does not depend on the scheduling */
+    for (run = 0; run < RUN_COUNT; run++)
+    {
+        floatSum = -1.0f;
+        TEST_CHECK(ARSAL_Parallel_Reduce(scheduler, 0, RANGE_SIZE, 64, sizeof(floatSum), &zeroFloat, floatBody, floatJoin, NULL, &floatSum) == ARSAL_OK,
+                   "Float sum failed\n");
+        if (run == 0)
+        {
+            firstFloatSum = floatSum;
+        }
+        TEST_CHECK(memcmp(&floatSum, &firstFloatSum, sizeof(float)) == 0, "Float sum %.9g differs from the first one %.9g\n", floatSum, firstFloatSum);
+    }
+
+    /* The identity for an empty range */
+    sum = 1;
+    TEST_CHECK(ARSAL_Parallel_Reduce(scheduler, 7, 7, ARSAL_PARALLEL_AUTO_GRAIN, sizeof(sum), &zero, sumBody, sumJoin, NULL, &sum) == ARSAL_OK,
+               "Empty sum failed\n");
+    TEST_CHECK(sum == 0, "Empty sum is %" PRIu64 "\n", sum);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    ARSAL_Scheduler_t *scheduler;
+    eARSAL_ERROR error;
+
+    (void)argc;
+    (void)argv;
+
+    scheduler = ARSAL_Scheduler_New(4, NULL, &error);
+    TEST_CHECK(scheduler != NULL, "Unable to create the scheduler: %s\n", ARSAL_Error_ToString(error));
+
+    if (scheduler != NULL)
+    {
+        testFor(scheduler);
+        testReduce(scheduler);
+    }
+    testNestedFor();
+
+    ARSAL_Scheduler_Delete(&scheduler);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,296 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testPathFilter.c
+ * @brief Checks the globs and extensions of ARSAL_PathFilter, and the pruning of the directories they exclude, on a small tree.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_DirIter.h>
+#include <libARSAL/ARSAL_PathFilter.h>
+
+#define TAG "testPathFilter"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define TEST_LONG_NAME_LEN  (200)
+
+typedef struct
+{
+    const char *globs[2]; /* Globs, or extensions when prefixed by "ext:" */
+    const char *expected[6]; /* Files matched, in the order of a sorted walk, NULL terminated */
+} testCase_t;
+
+/* Directories end with a '/' */
+static const char *const treeEntries[] =
+{
+    "media/", "media/DCIM1/", "media/DCIM1/1a.jpg", "media/DCIM1/sub/", "media/DCIM1/sub/2.jpg",
+    "media/DCIM2/", "media/DCIM2/x.jpg", "media/DCIM2/3.JPG", "other/", "other/4.jpg", "top.mp4",
+};
+
+static const testCase_t testCases[] =
+{
+    { { "media/DCIM?/[0-9]*.jpg" }, { "media/DCIM1/1a.jpg" } },
+    { { "**/*.jpg" }, { "media/DCIM1/1a.jpg", "media/DCIM1/sub/2.jpg", "media/DCIM2/x.jpg", "other/4.jpg" } },
+    { { "media/**/sub/*" }, { "media/DCIM1/sub/2.jpg" } },
+    { { "/media/DCIM2/*" }, { "media/DCIM2/3.JPG", "media/DCIM2/x.jpg" } },
+    { { "*.mp4", "other/*" }, { "other/4.jpg", "top.mp4" } },
+    { { "[!a-z]*.jpg" }, { "media/DCIM1/1a.jpg", "media/DCIM1/sub/2.jpg", "other/4.jpg" } },
+    { { "ext:JPG" }, { "media/DCIM1/1a.jpg", "media/DCIM1/sub/2.jpg", "media/DCIM2/3.JPG", "media/DCIM2/x.jpg", "other/4.jpg" } },
+    { { "?op.mp[!3]" }, { "top.mp4" } },
+    { { "media/DCIM[" }, { NULL } },
+};
+
+static int errCount = 0;
+
+static int createTree(const char *root)
+{
+    char path[512];
+    size_t len;
+    size_t i;
+    int fd;
+
+    for (i = 0; i < sizeof(treeEntries) / sizeof(treeEntries[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, treeEntries[i]);
+        len = strlen(path);
+        if (path[len - 1] == '/')
+        {
+            path[len - 1] = '\0';
+            if (mkdir(path, 0755) != 0)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+            if (fd < 0)
+            {
+                return -1;
+            }
+            close(fd);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Walk the tree with a filter, the error code of the walk is returned in error
+ * @return The number of files matched, -1 if the filter cannot be set up
+ */
+static int walkFiltered(const char *root, const ARSAL_PathFilter_t *filter, const char *const *expected, eARSAL_ERROR *error)
+{
+    const ARSAL_DirIter_Entry_t *entry;
+    ARSAL_DirIter_t *iter;
+    size_t rootLen = strlen(root);
+    int count = 0;
+
+    iter = ARSAL_DirIter_New(root, 0, ARSAL_FTW_STAT_TYPE, error);
+    if ((iter == NULL) || (ARSAL_DirIter_SetSorted(iter, 1) != ARSAL_OK) || (ARSAL_DirIter_SetFilter(iter, filter) != ARSAL_OK))
+    {
+        ARSAL_DirIter_Delete(&iter);
+        return -1;
+    }
+
+    while ((entry = ARSAL_DirIter_Next(iter, error)) != NULL)
+    {
+        if (expected != NULL)
+        {
+            TEST_CHECK((expected[count] != NULL) && (strcmp(&entry->path[rootLen + 1], expected[count]) == 0),
+                       "File %d is \"%s\", expected \"%s\"\n", count, &entry->path[rootLen + 1], (expected[count] != NULL) ? expected[count] : "(end)");
+            if (expected[count] == NULL)
+            {
+                expected = NULL;
+            }
+        }
+        count++;
+    }
+    TEST_CHECK((expected == NULL) || (expected[count] == NULL), "Only %d files matched\n", count);
+
+    ARSAL_DirIter_Delete(&iter);
+
+    return count;
+}
+
+static void testGlobs(const char *root)
+{
+    ARSAL_PathFilter_t *filter;
+    eARSAL_ERROR error;
+    size_t i;
+    int j;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "GLOB TEST ...\n");
+
+    for (i = 0; i < sizeof(testCases) / sizeof(testCases[0]); i++)
+    {
+        filter = ARSAL_PathFilter_New(&error);
+        for (j = 0; (filter != NULL) && (j < 2) && (testCases[i].globs[j] != NULL); j++)
+        {
+            if (strncmp(testCases[i].globs[j], "ext:", 4) == 0)
+            {
+                error = ARSAL_PathFilter_AddExtension(filter, &testCases[i].globs[j][4]);
+            }
+            else
+            {
+                error = ARSAL_PathFilter_AddGlob(filter, testCases[i].globs[j]);
+            }
+            TEST_CHECK(error == ARSAL_OK, "Unable to add \"%s\": %s\n", testCases[i].globs[j], ARSAL_Error_ToString(error));
+        }
+
+        TEST_CHECK(walkFiltered(root, filter, testCases[i].expected, &error) >= 0, "Unable to walk with \"%s\"\n", testCases[i].globs[0]);
+        ARSAL_PathFilter_Delete(&filter);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testPrune(const char *root)
+{
+    static const char *const globExpected[] = { "media/DCIM1/1a.jpg", NULL };
+    static const char *const depthExpected[] = { "top.mp4", NULL };
+    ARSAL_PathFilter_t *filter;
+    eARSAL_ERROR error = ARSAL_OK;
+    char path[512];
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "PRUNE TEST ...\n");
+
+    /* A directory the walks cannot open, without the root privileges: the walks fail if they do not prune it */
+    snprintf(path, sizeof(path), "%s/locked", root);
+    TEST_CHECK((mkdir(path, 0755) == 0) && (chmod(path, 0) == 0), "Unable to create the locked directory\n");
+
+    /* It cannot hold "media/..." paths */
+    filter = ARSAL_PathFilter_New(NULL);
+    TEST_CHECK((filter != NULL) && (ARSAL_PathFilter_AddGlob(filter, "media/DCIM1/*") == ARSAL_OK), "Unable to create the filter\n");
+    TEST_CHECK(walkFiltered(root, filter, globExpected, &error) == 1, "The walk pruned by a path glob did not match a single file\n");
+    TEST_CHECK(error == ARSAL_OK, "The walk pruned by a path glob failed: %s\n", ARSAL_Error_ToString(error));
+    ARSAL_PathFilter_Delete(&filter);
+
+    /* Its entries are too deep */
+    filter = ARSAL_PathFilter_New(NULL);
+    TEST_CHECK((filter != NULL) && (ARSAL_PathFilter_SetDepthRange(filter, 0, 1) == ARSAL_OK), "Unable to create the filter\n");
+    TEST_CHECK(walkFiltered(root, filter, depthExpected, &error) == 1, "The walk pruned by depth did not match a single file\n");
+    TEST_CHECK(error == ARSAL_OK, "The walk pruned by depth failed: %s\n", ARSAL_Error_ToString(error));
+    ARSAL_PathFilter_Delete(&filter);
+
+    chmod(path, 0755);
+    rmdir(path);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testBacktracking(const char *root)
+{
+    static const char *const expected[] = { NULL };
+    ARSAL_PathFilter_t *filter;
+    struct timespec start;
+    struct timespec end;
+    char path[512];
+    eARSAL_ERROR error;
+    int elapsedMs;
+    int fd;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "BACKTRACKING TEST ...\n");
+
+    /* A recursive matcher tries every split of the name between the stars */
+    snprintf(path, sizeof(path), "%s/%0*d", root, TEST_LONG_NAME_LEN, 0);
+    memset(&path[strlen(root) + 1], 'a', TEST_LONG_NAME_LEN);
+    fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    TEST_CHECK(fd >= 0, "Unable to create the long name file\n");
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    filter = ARSAL_PathFilter_New(NULL);
+    TEST_CHECK((filter != NULL) && (ARSAL_PathFilter_AddGlob(filter, "a*a*a*a*a*a*a*a*a*a*a*a*b") == ARSAL_OK), "Unable to create the filter\n");
+
+    ARSAL_Time_GetTime(&start);
+    TEST_CHECK(walkFiltered(root, filter, expected, &error) == 0, "The long name matched\n");
+    ARSAL_Time_GetTime(&end);
+    elapsedMs = ARSAL_Time_ComputeTimespecMsTimeDiff(&start, &end);
+    TEST_CHECK(elapsedMs < 1000, "The walk took %d ms\n", elapsedMs);
+    ARSAL_PathFilter_Delete(&filter);
+
+    unlink(path);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char root[] = "/tmp/testPathFilter.XXXXXX";
+
+    (void)argc;
+    (void)argv;
+
+    if ((mkdtemp(root) == NULL) || (createTree(root) != 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to create the test tree, aborting tests\n");
+        return 1;
+    }
+
+    testGlobs(root);
+    testPrune(root);
+    testBacktracking(root);
+
+    ARSAL_Ftw_RemoveTree(root, 1, NULL, NULL);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,220 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testScheduler.c
+ * @brief Checks the results of ARSAL_Scheduler on recursive tasks and on many small tasks.
+ *
+ * Nested waits must not block a worker, even with a single one.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Scheduler.h>
+
+#define TAG "testScheduler"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define FIB_N (24)
+#define FIB_CUTOFF (8)
+#define TASK_COUNT (10000)
+
+typedef struct
+{
+    int n;
+    uint64_t result;
+} Fib_t;
+
+typedef struct
+{
+    int *done;
+    int count;
+} Batch_t;
+
+static int errCount = 0;
+
+static uint64_t fibSerial(int n)
+{
+    return (n < 2) ? (uint64_t)n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+static void fibTask(ARSAL_Scheduler_t *scheduler, void *customData)
+{
+    Fib_t *fib = (Fib_t *)customData;
+    ARSAL_Scheduler_Group_t group;
+    Fib_t left;
+    Fib_t right;
+
+    if (fib->n < FIB_CUTOFF)
+    {
+        fib->result = fibSerial(fib->n);
+        return;
+    }
+
+    left.n = fib->n - 1;
+    right.n = fib->n - 2;
+    ARSAL_Scheduler_Group_Init(&group);
+    TEST_CHECK(ARSAL_Scheduler_Spawn(scheduler, &group, fibTask, &left) == ARSAL_OK, "Unable to spawn fib(%d)\n", left.n);
+    /* The second half runs in this task, the first one may be stolen */
+    fibTask(scheduler, &right);
+    TEST_CHECK(ARSAL_Scheduler_Wait(scheduler, &group) == ARSAL_OK, "Unable to wait for fib(%d)\n", left.n);
+    fib->result = left.result + right.result;
+}
+
+static void markTask(ARSAL_Scheduler_t *scheduler, void *customData)
+{
+    (void)scheduler;
+
+    *(int *)customData += 1;
+}
+
+static void batchTask(ARSAL_Scheduler_t *scheduler, void *customData)
+{
+    Batch_t *batch = (Batch_t *)customData;
+    ARSAL_Scheduler_Group_t group;
+    int i;
+
+    /* Spawned from a task: pushed on the deque of the worker */
+    ARSAL_Scheduler_Group_Init(&group);
+    for (i = 0; i < batch->count; i++)
+    {
+        TEST_CHECK(ARSAL_Scheduler_Spawn(scheduler, &group, markTask, &batch->done[i]) == ARSAL_OK, "Unable to spawn task %d\n", i);
+    }
+    TEST_CHECK(ARSAL_Scheduler_Wait(scheduler, &group) == ARSAL_OK, "Unable to wait for the batch\n");
+}
+
+static void testFib(int threadCount)
+{
+    ARSAL_Scheduler_t *scheduler;
+    ARSAL_Scheduler_Group_t group;
+    eARSAL_ERROR error;
+    Fib_t fib;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "FIB TEST WITH %d THREADS ...\n", threadCount);
+
+    scheduler = ARSAL_Scheduler_New(threadCount, NULL, &error);
+    TEST_CHECK(scheduler != NULL, "Unable to create the scheduler: %s\n", ARSAL_Error_ToString(error));
+    if (scheduler == NULL)
+    {
+        return;
+    }
+    TEST_CHECK(ARSAL_Scheduler_GetThreadCount(scheduler) == threadCount, "Got %d workers, expected %d\n", ARSAL_Scheduler_GetThreadCount(scheduler), threadCount);
+
+    /* Spawned from another thread: queued for the workers, waited for by sleeping */
+    fib.n = FIB_N;
+    fib.result = 0;
+    ARSAL_Scheduler_Group_Init(&group);
+    TEST_CHECK(ARSAL_Scheduler_Spawn(scheduler, &group, fibTask, &fib) == ARSAL_OK, "Unable to spawn fib(%d)\n", fib.n);
+    TEST_CHECK(ARSAL_Scheduler_Wait(scheduler, &group) == ARSAL_OK, "Unable to wait for fib(%d)\n", fib.n);
+    TEST_CHECK(fib.result == fibSerial(FIB_N), "fib(%d) = %" PRIu64 ", expected %" PRIu64 "\n", FIB_N, fib.result, fibSerial(FIB_N));
+
+    ARSAL_Scheduler_Delete(&scheduler);
+    TEST_CHECK(scheduler == NULL, "The scheduler pointer was not reset\n");
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testManyTasks(void)
+{
+    ARSAL_Scheduler_t *scheduler;
+    ARSAL_Scheduler_Group_t group;
+    eARSAL_ERROR error;
+    Batch_t batch;
+    int *done;
+    int badCount = 0;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "MANY TASKS TEST ...\n");
+
+    done = calloc(2 * TASK_COUNT, sizeof(int));
+    scheduler = ARSAL_Scheduler_New(4, NULL, &error);
+    TEST_CHECK((done != NULL) && (scheduler != NULL), "Unable to create the scheduler: %s\n", ARSAL_Error_ToString(error));
+
+    if ((done != NULL) && (scheduler != NULL))
+    {
+        /* Half spawned from this thread, half from a task */
+        batch.done = &done[TASK_COUNT];
+        batch.count = TASK_COUNT;
+        ARSAL_Scheduler_Group_Init(&group);
+        TEST_CHECK(ARSAL_Scheduler_Spawn(scheduler, &group, batchTask, &batch) == ARSAL_OK, "Unable to spawn the batch\n");
+        for (i = 0; i < TASK_COUNT; i++)
+        {
+            TEST_CHECK(ARSAL_Scheduler_Spawn(scheduler, &group, markTask, &done[i]) == ARSAL_OK, "Unable to spawn task %d\n", i);
+        }
+        TEST_CHECK(ARSAL_Scheduler_Wait(scheduler, &group) == ARSAL_OK, "Unable to wait for the tasks\n");
+
+        /* Each task ran exactly once */
+        for (i = 0; i < 2 * TASK_COUNT; i++)
+        {
+            badCount += (done[i] != 1);
+        }
+        TEST_CHECK(badCount == 0, "%d tasks did not run exactly once\n", badCount);
+    }
+
+    ARSAL_Scheduler_Delete(&scheduler);
+    free(done);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    testFib(1);
+    testFib(4);
+    testManyTasks();
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,295 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testSnapshot.c
+ * @brief Checks the changes reported by ARSAL_Snapshot_Update () and the ARSAL_Snapshot_Save () / ARSAL_Snapshot_Load () round trip on a small tree.
+ *
+ * A saved snapshot whose header announces more entries than the file holds must be rejected.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_Snapshot.h>
+
+#define TAG "testSnapshot"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define MAX_CHANGES (16)
+
+/* Directories end with a '/' */
+static const char *const treeEntries[] =
+{
+    "a/", "a/a1", "a/a2", "b/", "b/b1", "b/c/", "b/c/c1", "d",
+};
+
+typedef struct
+{
+    char path[256];
+    eARSAL_SNAPSHOT_CHANGE change;
+} Change_t;
+
+typedef struct
+{
+    size_t rootLen;
+    int count;
+    Change_t changes[MAX_CHANGES];
+} Changes_t;
+
+static int errCount = 0;
+
+static int writeFile(const char *path, const char *content)
+{
+    int fd;
+    int ret = 0;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (write(fd, content, strlen(content)) != (ssize_t)strlen(content))
+    {
+        ret = -1;
+    }
+    close(fd);
+
+    return ret;
+}
+
+static int createTree(const char *root)
+{
+    char path[256];
+    size_t len;
+    size_t i;
+
+    for (i = 0; i < sizeof(treeEntries) / sizeof(treeEntries[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, treeEntries[i]);
+        len = strlen(path);
+        if (path[len - 1] == '/')
+        {
+            path[len - 1] = '\0';
+            if (mkdir(path, 0755) != 0)
+            {
+                return -1;
+            }
+        }
+        else if (writeFile(path, "x") != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void diffCallback(void *customData, const char *path, eARSAL_SNAPSHOT_CHANGE change, const ARSAL_Snapshot_Entry_t *oldEntry, const ARSAL_Snapshot_Entry_t *newEntry)
+{
+    Changes_t *changes = (Changes_t *)customData;
+
+    TEST_CHECK((change == ARSAL_SNAPSHOT_CHANGE_ADDED) == (oldEntry == NULL), "\"%s\": old entry inconsistent with change %d\n", path, change);
+    TEST_CHECK((change == ARSAL_SNAPSHOT_CHANGE_REMOVED) == (newEntry == NULL), "\"%s\": new entry inconsistent with change %d\n", path, change);
+
+    if (changes->count < MAX_CHANGES)
+    {
+        snprintf(changes->changes[changes->count].path, sizeof(changes->changes[0].path), "%s", &path[changes->rootLen]);
+        changes->changes[changes->count].change = change;
+    }
+    changes->count++;
+}
+
+static int findChange(const Changes_t *changes, const char *path, eARSAL_SNAPSHOT_CHANGE change)
+{
+    int i;
+
+    for (i = 0; (i < changes->count) && (i < MAX_CHANGES); i++)
+    {
+        if ((strcmp(changes->changes[i].path, path) == 0) && (changes->changes[i].change == change))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static ARSAL_Snapshot_t *testUpdate(const char *root, ARSAL_Snapshot_t *first)
+{
+    ARSAL_Snapshot_t *second = NULL;
+    ARSAL_Snapshot_t *third = NULL;
+    Changes_t changes;
+    eARSAL_ERROR error;
+    char path[256];
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "UPDATE TEST ...\n");
+
+    /* One file added, one removed, one rewritten in place, and a whole directory removed */
+    snprintf(path, sizeof(path), "%s/a/a3", root);
+    TEST_CHECK(writeFile(path, "x") == 0, "Unable to create \"%s\"\n", path);
+    snprintf(path, sizeof(path), "%s/a/a1", root);
+    TEST_CHECK(unlink(path) == 0, "Unable to remove \"%s\"\n", path);
+    snprintf(path, sizeof(path), "%s/d", root);
+    TEST_CHECK(writeFile(path, "longer") == 0, "Unable to rewrite \"%s\"\n", path);
+    snprintf(path, sizeof(path), "%s/b/c", root);
+    TEST_CHECK(ARSAL_Ftw_RemoveTree(path, 1, NULL, NULL) == ARSAL_OK, "Unable to remove \"%s\"\n", path);
+
+    memset(&changes, 0, sizeof(changes));
+    changes.rootLen = strlen(root);
+    second = ARSAL_Snapshot_Update(first, ARSAL_SNAPSHOT_FLAG_CHECK_FILES, diffCallback, &changes, &error);
+    TEST_CHECK(second != NULL, "Unable to update the snapshot: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(findChange(&changes, "/a/a3", ARSAL_SNAPSHOT_CHANGE_ADDED), "Added file not reported\n");
+    TEST_CHECK(findChange(&changes, "/a/a1", ARSAL_SNAPSHOT_CHANGE_REMOVED), "Removed file not reported\n");
+    TEST_CHECK(findChange(&changes, "/d", ARSAL_SNAPSHOT_CHANGE_MODIFIED), "Rewritten file not reported\n");
+    TEST_CHECK(findChange(&changes, "/b/c", ARSAL_SNAPSHOT_CHANGE_REMOVED), "Removed directory not reported\n");
+    TEST_CHECK(findChange(&changes, "/b/c/c1", ARSAL_SNAPSHOT_CHANGE_REMOVED), "File of a removed directory not reported\n");
+    TEST_CHECK(changes.count == 5, "Got %d changes, expected 5\n", changes.count);
+    TEST_CHECK(ARSAL_Snapshot_GetEntryCount(second) == 7, "Got %d entries, expected 7\n", ARSAL_Snapshot_GetEntryCount(second));
+
+    /* Nothing changed since */
+    memset(&changes, 0, sizeof(changes));
+    changes.rootLen = strlen(root);
+    third = ARSAL_Snapshot_Update(second, ARSAL_SNAPSHOT_FLAG_CHECK_FILES, diffCallback, &changes, &error);
+    TEST_CHECK(third != NULL, "Unable to update the snapshot: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(changes.count == 0, "Got %d changes on an unchanged tree\n", changes.count);
+    ARSAL_Snapshot_Delete(&third);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+
+    return second;
+}
+
+static void testSaveLoad(const char *root, const ARSAL_Snapshot_t *snapshot)
+{
+    ARSAL_Snapshot_t *loaded = NULL;
+    ARSAL_Snapshot_t *updated = NULL;
+    Changes_t changes;
+    eARSAL_ERROR error;
+    char path[256];
+    uint8_t count[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    FILE *file;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "SAVE LOAD TEST ...\n");
+
+    snprintf(path, sizeof(path), "%s.snapshot", root);
+    TEST_CHECK(ARSAL_Snapshot_Save(snapshot, path) == ARSAL_OK, "Unable to save the snapshot\n");
+
+    loaded = ARSAL_Snapshot_Load(path, &error);
+    TEST_CHECK(loaded != NULL, "Unable to load the snapshot: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(ARSAL_Snapshot_GetEntryCount(loaded) == ARSAL_Snapshot_GetEntryCount(snapshot), "Got %d entries, expected %d\n",
+               ARSAL_Snapshot_GetEntryCount(loaded), ARSAL_Snapshot_GetEntryCount(snapshot));
+
+    /* The loaded snapshot describes the same tree */
+    memset(&changes, 0, sizeof(changes));
+    changes.rootLen = strlen(root);
+    updated = ARSAL_Snapshot_Update(loaded, ARSAL_SNAPSHOT_FLAG_CHECK_FILES, diffCallback, &changes, &error);
+    TEST_CHECK(updated != NULL, "Unable to update the loaded snapshot: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(changes.count == 0, "Got %d changes from the loaded snapshot\n", changes.count);
+    ARSAL_Snapshot_Delete(&updated);
+    ARSAL_Snapshot_Delete(&loaded);
+
+    /* Entry count of the header, after the magic and the version */
+    file = fopen(path, "r+b");
+    TEST_CHECK((file != NULL) && (fseek(file, 8, SEEK_SET) == 0) && (fwrite(count, sizeof(count), 1, file) == 1), "Unable to patch the snapshot\n");
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    loaded = ARSAL_Snapshot_Load(path, &error);
+    TEST_CHECK((loaded == NULL) && (error == ARSAL_ERROR_FILE), "Snapshot with a bad entry count loaded: %s\n", ARSAL_Error_ToString(error));
+    ARSAL_Snapshot_Delete(&loaded);
+
+    unlink(path);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char root[] = "/tmp/testSnapshot.XXXXXX";
+    ARSAL_Snapshot_t *first = NULL;
+    ARSAL_Snapshot_t *second = NULL;
+    eARSAL_ERROR error;
+
+    (void)argc;
+    (void)argv;
+
+    if ((mkdtemp(root) == NULL) || (createTree(root) != 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to create the test tree, aborting tests\n");
+        return 1;
+    }
+
+    first = ARSAL_Snapshot_New(root, &error);
+    TEST_CHECK(first != NULL, "Unable to take the snapshot: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(ARSAL_Snapshot_GetEntryCount(first) == 9, "Got %d entries, expected 9\n", ARSAL_Snapshot_GetEntryCount(first));
+
+    if (first != NULL)
+    {
+        second = testUpdate(root, first);
+    }
+    if (second != NULL)
+    {
+        testSaveLoad(root, second);
+    }
+
+    ARSAL_Snapshot_Delete(&second);
+    ARSAL_Snapshot_Delete(&first);
+    ARSAL_Ftw_RemoveTree(root, 1, NULL, NULL);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,230 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testThreadPool.c
+ * @brief Checks the behavior of ARSAL_ThreadPool when its workers cannot be started, and when it drops queued tasks.
+ *
+ * A stack size of one byte is refused by the system, so every worker spawn fails.
+ * The continuations of the dropped tasks must be able to call the pool.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_Future.h>
+#include <libARSAL/ARSAL_ThreadPool.h>
+
+#define TAG "testThreadPool"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define TEST_SUBMIT_COUNT (3)
+
+static int errCount = 0;
+static int taskRunCount = 0;
+static int callbackCount = 0;
+
+static void *task(void *customData)
+{
+    taskRunCount++;
+    return customData;
+}
+
+static void *slowTask(void *customData)
+{
+    usleep(100000);
+    return customData;
+}
+
+static void canceledCallback(ARSAL_Future_t *future, void *customData)
+{
+    ARSAL_ThreadPool_t *pool = (ARSAL_ThreadPool_t *)customData;
+    ARSAL_ThreadPool_Metrics_t metrics;
+    eARSAL_ERROR error;
+
+    error = ARSAL_Future_Wait(future, 0, NULL);
+    TEST_CHECK(error == ARSAL_ERROR_CANCELED, "The future of the dropped task holds %s\n", ARSAL_Error_ToString(error));
+
+    /* Would deadlock if the future was completed under the pool lock */
+    error = ARSAL_ThreadPool_GetMetrics(pool, &metrics);
+    TEST_CHECK(error == ARSAL_OK, "Unable to get the metrics from the continuation: %s\n", ARSAL_Error_ToString(error));
+    callbackCount++;
+}
+
+static void initFailingAttr(ARSAL_Thread_Attr_t *attr)
+{
+    ARSAL_Thread_Attr_Init(attr);
+    attr->stackSize = 1;
+}
+
+static void testElasticSpawnFailure(void)
+{
+    ARSAL_ThreadPool_Config_t config;
+    ARSAL_ThreadPool_Metrics_t metrics;
+    ARSAL_Thread_Attr_t attr;
+    ARSAL_ThreadPool_t *pool;
+    ARSAL_Future_t future;
+    eARSAL_ERROR error;
+    void *value = NULL;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "ELASTIC POOL SPAWN FAILURE TEST ...\n");
+
+    initFailingAttr(&attr);
+    memset(&config, 0, sizeof(config));
+    config.minThreads = 0;
+    config.maxThreads = 2;
+    config.threadAttr = &attr;
+
+    /* No worker is started at the creation */
+    pool = ARSAL_ThreadPool_New(&config, &error);
+    TEST_CHECK(pool != NULL, "Unable to create the pool: %s\n", ARSAL_Error_ToString(error));
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < TEST_SUBMIT_COUNT; i++)
+    {
+        error = ARSAL_ThreadPool_Submit(pool, task, &future, &future);
+        TEST_CHECK(error == ARSAL_ERROR_SYSTEM, "The submit %d returned %s, expected %s\n", i, ARSAL_Error_ToString(error), ARSAL_Error_ToString(ARSAL_ERROR_SYSTEM));
+
+        /* The refused task is not left in the queue, and its future is completed */
+        TEST_CHECK(ARSAL_Future_IsReady(&future), "The future of the refused task is pending\n");
+        error = ARSAL_Future_Wait(&future, 0, &value);
+        TEST_CHECK(error == ARSAL_ERROR_SYSTEM, "The future of the refused task holds %s\n", ARSAL_Error_ToString(error));
+    }
+
+    error = ARSAL_ThreadPool_GetMetrics(pool, &metrics);
+    TEST_CHECK(error == ARSAL_OK, "Unable to get the metrics: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(metrics.threadCount == 0, "%d workers running\n", metrics.threadCount);
+    TEST_CHECK(metrics.queueDepth == 0, "%d tasks left in the queue\n", metrics.queueDepth);
+    TEST_CHECK(metrics.completedCount == 0, "%llu tasks completed\n", (unsigned long long)metrics.completedCount);
+
+    ARSAL_ThreadPool_Delete(&pool);
+    TEST_CHECK(pool == NULL, "The pool is not reset by the deletion\n");
+    TEST_CHECK(taskRunCount == 0, "%d refused tasks ran\n", taskRunCount);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testFixedSpawnFailure(void)
+{
+    ARSAL_ThreadPool_Config_t config;
+    ARSAL_Thread_Attr_t attr;
+    ARSAL_ThreadPool_t *pool;
+    eARSAL_ERROR error = ARSAL_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "FIXED POOL SPAWN FAILURE TEST ...\n");
+
+    initFailingAttr(&attr);
+    memset(&config, 0, sizeof(config));
+    config.minThreads = 2;
+    config.maxThreads = 2;
+    config.threadAttr = &attr;
+
+    /* The workers are started at the creation, which fails */
+    pool = ARSAL_ThreadPool_New(&config, &error);
+    TEST_CHECK(pool == NULL, "The pool was created without workers\n");
+    TEST_CHECK(error == ARSAL_ERROR_SYSTEM, "The creation returned %s, expected %s\n", ARSAL_Error_ToString(error), ARSAL_Error_ToString(ARSAL_ERROR_SYSTEM));
+    ARSAL_ThreadPool_Delete(&pool);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testShutdownContinuation(void)
+{
+    ARSAL_ThreadPool_Config_t config;
+    ARSAL_ThreadPool_t *pool;
+    ARSAL_Future_t slowFuture;
+    ARSAL_Future_t droppedFuture;
+    eARSAL_ERROR error;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "SHUTDOWN CONTINUATION TEST ...\n");
+
+    memset(&config, 0, sizeof(config));
+    config.minThreads = 1;
+    config.maxThreads = 1;
+
+    pool = ARSAL_ThreadPool_New(&config, &error);
+    TEST_CHECK(pool != NULL, "Unable to create the pool: %s\n", ARSAL_Error_ToString(error));
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    /* The single worker is busy, the second task stays queued and is dropped */
+    TEST_CHECK(ARSAL_ThreadPool_Submit(pool, slowTask, NULL, &slowFuture) == ARSAL_OK, "Unable to submit the slow task\n");
+    TEST_CHECK(ARSAL_ThreadPool_Submit(pool, task, NULL, &droppedFuture) == ARSAL_OK, "Unable to submit the dropped task\n");
+    TEST_CHECK(ARSAL_Future_Then(&droppedFuture, canceledCallback, pool) == ARSAL_OK, "Unable to set the continuation\n");
+
+    error = ARSAL_ThreadPool_Shutdown(pool, 0);
+    TEST_CHECK(error == ARSAL_OK, "Unable to shut the pool down: %s\n", ARSAL_Error_ToString(error));
+    TEST_CHECK(callbackCount == 1, "The continuation was called %d times\n", callbackCount);
+
+    ARSAL_ThreadPool_Delete(&pool);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    testElasticSpawnFailure();
+    testFixedSpawnFailure();
+    testShutdownContinuation();
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
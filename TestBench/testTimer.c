@@ -0,0 +1,198 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testTimer.c
+ * @brief Checks that ARSAL_Timer fires timers in order across the levels of its wheel.
+ *
+ * With a 1 ms tick, the first level of the wheel holds 256 ticks: the timers around 256 ms and beyond
+ * are armed on the second level, and cascade to the first one when the wheel reaches them.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Time.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Timer.h>
+
+#define TAG "testTimer"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+/* Late firing tolerated on a loaded machine */
+#define TEST_LATE_MARGIN_MS (150)
+
+/* Armed in this order, fired sorted by delay */
+static const uint32_t delaysMs[] = { 600, 5, 300, 257, 1, 255, 256, 513, 511, 512 };
+#define TEST_TIMER_COUNT    (sizeof(delaysMs) / sizeof(delaysMs[0]))
+
+/* Canceled before it fires, on the second level of the wheel */
+#define TEST_CANCELED_DELAY_MS  (400)
+
+typedef struct
+{
+    ARSAL_Mutex_t mutex;
+    struct timespec start;
+    int firedIndexes[TEST_TIMER_COUNT + 1];
+    int firedMs[TEST_TIMER_COUNT + 1];
+    int firedCount;
+} testState_t;
+
+typedef struct
+{
+    testState_t *state;
+    int index;
+} testTimer_t;
+
+static int errCount = 0;
+
+static void timerCallback(void *customData)
+{
+    testTimer_t *timer = (testTimer_t *)customData;
+    testState_t *state = timer->state;
+    struct timespec now;
+
+    ARSAL_Time_GetTime(&now);
+    ARSAL_Mutex_Lock(&state->mutex);
+    if (state->firedCount <= (int)TEST_TIMER_COUNT)
+    {
+        state->firedIndexes[state->firedCount] = timer->index;
+        state->firedMs[state->firedCount] = ARSAL_Time_ComputeTimespecMsTimeDiff(&state->start, &now);
+        state->firedCount++;
+    }
+    ARSAL_Mutex_Unlock(&state->mutex);
+}
+
+static void testCascade(void)
+{
+    ARSAL_Timer_Config_t config;
+    ARSAL_Timer_Metrics_t metrics;
+    testTimer_t timers[TEST_TIMER_COUNT + 1];
+    ARSAL_Timer_Id_t canceledId = ARSAL_TIMER_INVALID_ID;
+    ARSAL_Timer_t *service;
+    testState_t state;
+    eARSAL_ERROR error;
+    uint32_t delay;
+    uint32_t previous = 0;
+    int index;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "CASCADE TEST ...\n");
+
+    memset(&config, 0, sizeof(config));
+    memset(&state, 0, sizeof(state));
+    config.resolutionMs = 1;
+    ARSAL_Mutex_Init(&state.mutex);
+
+    service = ARSAL_Timer_New(&config, &error);
+    TEST_CHECK(service != NULL, "Unable to create the timer service: %s\n", ARSAL_Error_ToString(error));
+    if (service == NULL)
+    {
+        ARSAL_Mutex_Destroy(&state.mutex);
+        return;
+    }
+
+    ARSAL_Time_GetTime(&state.start);
+    for (i = 0; i < (int)TEST_TIMER_COUNT; i++)
+    {
+        timers[i].state = &state;
+        timers[i].index = i;
+        error = ARSAL_Timer_Add(service, delaysMs[i], 0, timerCallback, &timers[i], NULL);
+        TEST_CHECK(error == ARSAL_OK, "Unable to add the %u ms timer: %s\n", delaysMs[i], ARSAL_Error_ToString(error));
+    }
+    timers[TEST_TIMER_COUNT].state = &state;
+    timers[TEST_TIMER_COUNT].index = TEST_TIMER_COUNT;
+    error = ARSAL_Timer_Add(service, TEST_CANCELED_DELAY_MS, 0, timerCallback, &timers[TEST_TIMER_COUNT], &canceledId);
+    TEST_CHECK(error == ARSAL_OK, "Unable to add the canceled timer: %s\n", ARSAL_Error_ToString(error));
+
+    usleep(100 * 1000);
+    TEST_CHECK(ARSAL_Timer_Cancel(service, canceledId) == ARSAL_OK, "Unable to cancel the %u ms timer\n", TEST_CANCELED_DELAY_MS);
+
+    usleep((600 + TEST_LATE_MARGIN_MS + 100) * 1000);
+    TEST_CHECK(ARSAL_Timer_Cancel(service, canceledId) == ARSAL_ERROR_BAD_PARAMETER, "The canceled timer is still known\n");
+
+    ARSAL_Mutex_Lock(&state.mutex);
+    TEST_CHECK(state.firedCount == (int)TEST_TIMER_COUNT, "%d timers fired, expected %d\n", state.firedCount, (int)TEST_TIMER_COUNT);
+    for (i = 0; (i < state.firedCount) && (i <= (int)TEST_TIMER_COUNT); i++)
+    {
+        index = state.firedIndexes[i];
+        TEST_CHECK(index < (int)TEST_TIMER_COUNT, "The canceled timer fired after %d ms\n", state.firedMs[i]);
+        if (index >= (int)TEST_TIMER_COUNT)
+        {
+            continue;
+        }
+        delay = delaysMs[index];
+        TEST_CHECK(delay >= previous, "The %u ms timer fired after the %u ms one\n", delay, previous);
+        TEST_CHECK(state.firedMs[i] >= (int)delay, "The %u ms timer fired early, after %d ms\n", delay, state.firedMs[i]);
+        TEST_CHECK(state.firedMs[i] <= (int)delay + TEST_LATE_MARGIN_MS, "The %u ms timer fired late, after %d ms\n", delay, state.firedMs[i]);
+        previous = delay;
+    }
+    ARSAL_Mutex_Unlock(&state.mutex);
+
+    TEST_CHECK((ARSAL_Timer_GetMetrics(service, &metrics) == ARSAL_OK) && (metrics.activeCount == 0) &&
+               (metrics.firedCount == TEST_TIMER_COUNT) && (metrics.canceledCount == 1), "Bad timer metrics\n");
+
+    ARSAL_Timer_Delete(&service);
+    ARSAL_Mutex_Destroy(&state.mutex);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    testCascade();
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
@@ -0,0 +1,284 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file testWatcher.c
+ * @brief Checks the changes reported by ARSAL_Watcher_ReadEvents () on a small tree.
+ *
+ * The exit code is the number of errors.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Ftw.h>
+#include <libARSAL/ARSAL_Watcher.h>
+
+#define TAG "testWatcher"
+
+#define TEST_CHECK(COND, ...)                                           \
+    do                                                                  \
+    {                                                                   \
+        if (!(COND))                                                    \
+        {                                                               \
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, __VA_ARGS__);           \
+            errCount++;                                                 \
+        }                                                               \
+    } while (0)
+
+#define MAX_CHANGES (16)
+#define POLL_TIMEOUT_MS (200)
+
+/* Directories end with a '/' */
+static const char *const treeEntries[] =
+{
+    "a/", "a/a1", "b/", "b/b1", "b/c/", "b/c/c1", "d",
+};
+
+typedef struct
+{
+    char path[256];
+    eARSAL_WATCHER_EVENT event;
+    eARSAL_FTW_TYPE type;
+} Change_t;
+
+typedef struct
+{
+    int count;
+    Change_t changes[MAX_CHANGES];
+} Changes_t;
+
+static int errCount = 0;
+
+static int writeFile(const char *root, const char *name, const char *content)
+{
+    char path[256];
+    int fd;
+    int ret = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (write(fd, content, strlen(content)) != (ssize_t)strlen(content))
+    {
+        ret = -1;
+    }
+    close(fd);
+
+    return ret;
+}
+
+static int createTree(const char *root)
+{
+    char path[256];
+    size_t len;
+    size_t i;
+
+    for (i = 0; i < sizeof(treeEntries) / sizeof(treeEntries[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, treeEntries[i]);
+        len = strlen(path);
+        if (path[len - 1] == '/')
+        {
+            path[len - 1] = '\0';
+            if (mkdir(path, 0755) != 0)
+            {
+                return -1;
+            }
+        }
+        else if (writeFile(root, treeEntries[i], "x") != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Read the changes until none comes for POLL_TIMEOUT_MS */
+static void readChanges(ARSAL_Watcher_t *watcher, size_t rootLen, Changes_t *changes)
+{
+    ARSAL_Watcher_Event_t events[4];
+    struct pollfd pfd;
+    eARSAL_ERROR error;
+    int count;
+    int i;
+
+    memset(changes, 0, sizeof(*changes));
+    pfd.fd = ARSAL_Watcher_GetFd(watcher);
+    pfd.events = POLLIN;
+
+    while (poll(&pfd, 1, POLL_TIMEOUT_MS) > 0)
+    {
+        /* Small batches, to also check the changes kept for the next call */
+        while ((count = ARSAL_Watcher_ReadEvents(watcher, events, 4, &error)) > 0)
+        {
+            for (i = 0; i < count; i++)
+            {
+                if (changes->count < MAX_CHANGES)
+                {
+                    snprintf(changes->changes[changes->count].path, sizeof(changes->changes[0].path), "%s", &events[i].path[rootLen]);
+                    changes->changes[changes->count].event = events[i].event;
+                    changes->changes[changes->count].type = events[i].type;
+                }
+                changes->count++;
+            }
+        }
+        TEST_CHECK(error == ARSAL_OK, "Read error: %s\n", ARSAL_Error_ToString(error));
+    }
+}
+
+static void checkChange(const Changes_t *changes, const char *path, eARSAL_WATCHER_EVENT event, eARSAL_FTW_TYPE type)
+{
+    int found = 0;
+    int i;
+
+    for (i = 0; (i < changes->count) && (i < MAX_CHANGES); i++)
+    {
+        if (strcmp(changes->changes[i].path, path) == 0)
+        {
+            found++;
+            TEST_CHECK((changes->changes[i].event == event) && (changes->changes[i].type == type),
+                       "\"%s\" reported as %d type %d, expected %d type %d\n", path,
+                       changes->changes[i].event, changes->changes[i].type, event, type);
+        }
+    }
+
+    TEST_CHECK(found == 1, "\"%s\" reported %d times, expected once\n", path, found);
+}
+
+static void testFiles(const char *root, ARSAL_Watcher_t *watcher)
+{
+    Changes_t changes;
+    char path[256];
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "FILES TEST ...\n");
+
+    TEST_CHECK(writeFile(root, "a/a2", "x") == 0, "Unable to create a/a2\n");
+    snprintf(path, sizeof(path), "%s/b/b1", root);
+    TEST_CHECK(unlink(path) == 0, "Unable to remove b/b1\n");
+    TEST_CHECK(writeFile(root, "d", "longer") == 0, "Unable to rewrite d\n");
+    /* Created then deleted between two reads: not reported */
+    TEST_CHECK(writeFile(root, "tmp", "x") == 0, "Unable to create tmp\n");
+    snprintf(path, sizeof(path), "%s/tmp", root);
+    TEST_CHECK(unlink(path) == 0, "Unable to remove tmp\n");
+
+    readChanges(watcher, strlen(root), &changes);
+    checkChange(&changes, "/a/a2", ARSAL_WATCHER_EVENT_ADDED, ARSAL_FTW_F);
+    checkChange(&changes, "/b/b1", ARSAL_WATCHER_EVENT_REMOVED, ARSAL_FTW_F);
+    checkChange(&changes, "/d", ARSAL_WATCHER_EVENT_MODIFIED, ARSAL_FTW_F);
+    TEST_CHECK(changes.count == 3, "Got %d changes, expected 3\n", changes.count);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+static void testDirectories(const char *root, ARSAL_Watcher_t *watcher)
+{
+    Changes_t changes;
+    char path[256];
+    char newPath[256];
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "DIRECTORIES TEST ...\n");
+
+    /* A directory filled before the watcher sees it: its entries are reported with it */
+    snprintf(path, sizeof(path), "%s/e", root);
+    TEST_CHECK(mkdir(path, 0755) == 0, "Unable to create e\n");
+    TEST_CHECK(writeFile(root, "e/e1", "x") == 0, "Unable to create e/e1\n");
+
+    readChanges(watcher, strlen(root), &changes);
+    checkChange(&changes, "/e", ARSAL_WATCHER_EVENT_ADDED, ARSAL_FTW_D);
+    checkChange(&changes, "/e/e1", ARSAL_WATCHER_EVENT_ADDED, ARSAL_FTW_F);
+    TEST_CHECK(changes.count == 2, "Got %d changes, expected 2\n", changes.count);
+
+    /* The new directory is watched */
+    TEST_CHECK(writeFile(root, "e/e2", "x") == 0, "Unable to create e/e2\n");
+    readChanges(watcher, strlen(root), &changes);
+    checkChange(&changes, "/e/e2", ARSAL_WATCHER_EVENT_ADDED, ARSAL_FTW_F);
+    TEST_CHECK(changes.count == 1, "Got %d changes, expected 1\n", changes.count);
+
+    /* A directory moved within the hierarchy */
+    snprintf(path, sizeof(path), "%s/b/c", root);
+    snprintf(newPath, sizeof(newPath), "%s/a/c", root);
+    TEST_CHECK(rename(path, newPath) == 0, "Unable to move b/c\n");
+    readChanges(watcher, strlen(root), &changes);
+    checkChange(&changes, "/b/c", ARSAL_WATCHER_EVENT_REMOVED, ARSAL_FTW_D);
+    checkChange(&changes, "/a/c", ARSAL_WATCHER_EVENT_ADDED, ARSAL_FTW_D);
+    checkChange(&changes, "/a/c/c1", ARSAL_WATCHER_EVENT_ADDED, ARSAL_FTW_F);
+    TEST_CHECK(changes.count == 3, "Got %d changes, expected 3\n", changes.count);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "END OF TEST\n");
+}
+
+int main(int argc, char *argv[])
+{
+    char root[] = "/tmp/testWatcher.XXXXXX";
+    ARSAL_Watcher_t *watcher = NULL;
+    eARSAL_ERROR error;
+
+    (void)argc;
+    (void)argv;
+
+    if ((mkdtemp(root) == NULL) || (createTree(root) != 0))
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "Unable to create the test tree, aborting tests\n");
+        return 1;
+    }
+
+    watcher = ARSAL_Watcher_New(root, &error);
+    TEST_CHECK(watcher != NULL, "Unable to create the watcher: %s\n", ARSAL_Error_ToString(error));
+
+    if (watcher != NULL)
+    {
+        testFiles(root, watcher);
+        testDirectories(root, watcher);
+    }
+
+    ARSAL_Watcher_Delete(&watcher);
+    ARSAL_Ftw_RemoveTree(root, 1, NULL, NULL);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "<<< SUMMARY : >>>\n");
+    if (errCount == 0)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    NO ERROR\n");
+    }
+    else
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "    %d ERROR%c\n", errCount, (errCount > 1) ? 'S' : ' ');
+    }
+
+    return errCount;
+}
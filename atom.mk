@@ -37,14 +37,29 @@ LOCAL_CFLAGS := \
 
 LOCAL_SRC_FILES := \
 	Sources/ARSAL_Ftw.c \
+	Sources/ARSAL_DirIter.c \
+	Sources/ARSAL_PathFilter.c \
+	Sources/ARSAL_Ftw_Parallel.c \
+	Sources/ARSAL_Ftw_Tree.c \
+	Sources/ARSAL_Snapshot.c \
+	Sources/ARSAL_Watcher.c \
 	Sources/ARSAL_MD5.c \
+	Sources/ARSAL_MD5_Batch.c \
+	Sources/ARSAL_MD5_Context.c \
 	Sources/ARSAL_MD5_Manager.c \
+	Sources/ARSAL_MD5_Manifest.c \
 	Sources/ARSAL_Mutex.c \
 	Sources/ARSAL_Print.c \
 	Sources/ARSAL_Sem.c \
+	Sources/ARSAL_Future.c \
 	Sources/ARSAL_Socket.c \
+	Sources/ARSAL_EventLoop.c \
 	Sources/ARSAL_Time.c \
+	Sources/ARSAL_Timer.c \
 	Sources/ARSAL_Thread.c \
+	Sources/ARSAL_ThreadPool.c \
+	Sources/ARSAL_Scheduler.c \
+	Sources/ARSAL_Parallel.c \
 	Sources/md5.c \
 	gen/Sources/ARSAL_Error.c
 
@@ -53,14 +68,24 @@ LOCAL_INSTALL_HEADERS := \
 	Includes/libARSAL/ARSAL_Endianness.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Error.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Ftw.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_DirIter.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_PathFilter.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Snapshot.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Watcher.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_MD5_Manager.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Mutex.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Print.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Sem.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Future.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Singleton.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Socket.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_EventLoop.h:usr/include/libARSAL/ \
 	Includes/libARSAL/ARSAL_Thread.h:usr/include/libARSAL/ \
-	Includes/libARSAL/ARSAL_Time.h:usr/include/libARSAL/
+	Includes/libARSAL/ARSAL_ThreadPool.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Scheduler.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Parallel.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Time.h:usr/include/libARSAL/ \
+	Includes/libARSAL/ARSAL_Timer.h:usr/include/libARSAL/
 
 ifeq ("$(TARGET_OS_FLAVOUR)","android")
 LOCAL_LDLIBS += -llog
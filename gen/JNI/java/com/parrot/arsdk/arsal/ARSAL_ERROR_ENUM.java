@@ -55,6 +55,10 @@ public enum ARSAL_ERROR_ENUM {
     ARSAL_ERROR_BAD_PARAMETER (-997, "ARSAL bad parameter error"),
    /** ARSAL file error */
     ARSAL_ERROR_FILE (-996, "ARSAL file error"),
+   /** ARSAL operation canceled */
+    ARSAL_ERROR_CANCELED (-995, "ARSAL operation canceled"),
+   /** ARSAL operation timed out */
+    ARSAL_ERROR_TIMEOUT (-994, "ARSAL operation timed out"),
    /** ARSAL md5 error */
     ARSAL_ERROR_MD5 (-2000, "ARSAL md5 error"),
    /** BLE connection generic error */
@@ -44,7 +44,11 @@ public enum ARSAL_FTW_TYPE_ENUM {
    /** Dummy value for all unknown cases */
     eARSAL_FTW_TYPE_UNKNOWN_ENUM_VALUE (Integer.MIN_VALUE, "Dummy value for all unknown cases"),
    ARSAL_FTW_F (0),
-   ARSAL_FTW_D (1);
+   ARSAL_FTW_D (1),
+   /** Directory which cannot be read */
+    ARSAL_FTW_DNR (2, "Directory which cannot be read"),
+   /** Entry which cannot be stated, sb is zeroed */
+    ARSAL_FTW_NS (3, "Entry which cannot be stated, sb is zeroed");
 
     private final int value;
     private final String comment;
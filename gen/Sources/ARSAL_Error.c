@@ -62,6 +62,12 @@ const char* ARSAL_Error_ToString (eARSAL_ERROR error)
     case ARSAL_ERROR_FILE:
         return "ARSAL file error";
         break;
+    case ARSAL_ERROR_CANCELED:
+        return "ARSAL operation canceled";
+        break;
+    case ARSAL_ERROR_TIMEOUT:
+        return "ARSAL operation timed out";
+        break;
     case ARSAL_ERROR_MD5:
         return "ARSAL md5 error";
         break;